@@ -43,6 +43,8 @@
 
 #include "densityfittingforceprovider.h"
 
+#include <algorithm>
+#include <limits>
 #include <numeric>
 
 #include "gromacs/compat/optional.h"
@@ -50,12 +52,15 @@
 #include "gromacs/math/densityfit.h"
 #include "gromacs/math/densityfittingforce.h"
 #include "gromacs/math/exponentialmovingaverage.h"
+#include "gromacs/math/functions.h"
 #include "gromacs/math/gausstransform.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/mdtypes/commrec.h"
 #include "gromacs/mdtypes/enerdata.h"
 #include "gromacs/mdtypes/forceoutput.h"
 #include "gromacs/mdtypes/iforceprovider.h"
 #include "gromacs/pbcutil/pbc.h"
+#include "gromacs/utility/exceptions.h"
 
 #include "densityfittingamplitudelookup.h"
 #include "densityfittingparameters.h"
@@ -82,6 +87,33 @@ GaussianSpreadKernelParameters::Shape makeSpreadKernel(real sigma, real nSigma,
              nSigma };
 }
 
+/*! \internal \brief Determine the lattice region that is reached by Gaussians at coordinates.
+ *
+ * \param[in] coordinates the Gaussian centers in lattice coordinates
+ * \param[in] extent of the lattice
+ * \param[in] spreadRange of the Gaussians in lattice points
+ * \returns the bounding box of all spread ranges within the lattice
+ */
+IntegerBox spreadRegionOfCoordinates(ArrayRef<const RVec> coordinates,
+                                     const dynamicExtents3D& extent,
+                                     const IVec&             spreadRange)
+{
+    IVec begin = { std::numeric_limits<int>::max(), std::numeric_limits<int>::max(),
+                   std::numeric_limits<int>::max() };
+    IVec end   = { 0, 0, 0 };
+    for (const RVec& r : coordinates)
+    {
+        const IVec closestLatticePoint(roundToInt(r[XX]), roundToInt(r[YY]), roundToInt(r[ZZ]));
+        const IntegerBox range = spreadRangeWithinLattice(closestLatticePoint, extent, spreadRange);
+        if (!range.empty())
+        {
+            begin = elementWiseMin(begin, range.begin());
+            end   = elementWiseMax(end, range.end());
+        }
+    }
+    return { begin, end };
+}
+
 } // namespace
 
 /********************************************************************
@@ -114,7 +146,8 @@ private:
     GaussianSpreadKernelParameters::Shape spreadKernel_;
     GaussTransform3D                      gaussTransform_;
     DensitySimilarityMeasure              measure_;
-    DensityFittingForce                   densityFittingForce_;
+    //! Force evaluation, one copy per thread, because each holds working data
+    std::vector<DensityFittingForce> densityFittingForces_;
     //! the local atom coordinates transformed into the grid coordinate system
     std::vector<RVec>             transformedCoordinates_;
     std::vector<RVec>             forces_;
@@ -144,7 +177,7 @@ DensityFittingForceProvider::Impl::Impl(const DensityFittingParameters&
                                    transformationToDensityLattice.scaleOperationOnly())),
     gaussTransform_(referenceDensity.extents(), spreadKernel_),
     measure_(parameters.similarityMeasureMethod_, referenceDensity),
-    densityFittingForce_(spreadKernel_),
+    densityFittingForces_(1, DensityFittingForce(spreadKernel_)),
     transformedCoordinates_(localAtomSet_.numAtomsLocal()),
     amplitudeLookup_(parameters_.amplitudeLookupMethod_),
     transformationToDensityLattice_(transformationToDensityLattice),
@@ -228,13 +261,8 @@ void DensityFittingForceProvider::Impl::calculateForces(const ForceProviderInput
         }
     }
 
-    auto amplitudeIterator = amplitudes.cbegin();
-
-    for (const auto& r : transformedCoordinates_)
-    {
-        gaussTransform_.add({ r, *amplitudeIterator });
-        ++amplitudeIterator;
-    }
+    const int numThreads = std::max(1, gmx_omp_nthreads_get(emntDefault));
+    gaussTransform_.add(transformedCoordinates_, amplitudes, numThreads);
 
     // communicate grid
     if (havePPDomainDecomposition(&forceProviderInput.cr_))
@@ -244,16 +272,34 @@ void DensityFittingForceProvider::Impl::calculateForces(const ForceProviderInput
                  gaussTransform_.view().data(), &forceProviderInput.cr_);
     }
 
-    // calculate grid derivative
+    // calculate grid derivative, only where the local atoms pick up forces
+    const IntegerBox spreadRegion = spreadRegionOfCoordinates(
+            transformedCoordinates_, gaussTransform_.constView().extents(),
+            spreadKernel_.latticeSpreadRange());
     const DensitySimilarityMeasure::density& densityDerivative =
-            measure_.gradient(gaussTransform_.constView());
+            measure_.gradient(gaussTransform_.constView(), spreadRegion);
     // calculate forces
     forces_.resize(localAtomSet_.numAtomsLocal());
-    std::transform(
-            std::begin(transformedCoordinates_), std::end(transformedCoordinates_), std::begin(amplitudes),
-            std::begin(forces_), [&densityDerivative, this](const RVec r, real amplitude) {
-                return densityFittingForce_.evaluateForce({ r, amplitude }, densityDerivative);
-            });
+    if (ssize(densityFittingForces_) < numThreads)
+    {
+        densityFittingForces_.resize(numThreads, densityFittingForces_[0]);
+    }
+    const int numAtoms = ssize(transformedCoordinates_);
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int thread = 0; thread < numThreads; thread++)
+    {
+        try
+        {
+            const int atomBegin = (numAtoms * thread) / numThreads;
+            const int atomEnd   = (numAtoms * (thread + 1)) / numThreads;
+            for (int i = atomBegin; i < atomEnd; i++)
+            {
+                forces_[i] = densityFittingForces_[thread].evaluateForce(
+                        { transformedCoordinates_[i], amplitudes[i] }, densityDerivative);
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
 
     transformationToDensityLattice_.scaleOperationOnly().inverseIgnoringZeroScale(forces_);
 
@@ -58,6 +58,7 @@
 #include "gromacs/fileio/xvgr.h"
 #include "gromacs/gmxlib/network.h"
 #include "gromacs/math/utilities.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/mdrunutility/multisim.h"
 #include "gromacs/mdtypes/awh_history.h"
 #include "gromacs/mdtypes/awh_params.h"
@@ -76,6 +77,47 @@
 namespace gmx
 {
 
+namespace
+{
+
+//! The minimum number of points per thread for loops over points to be run in parallel.
+constexpr gmx::index c_minNumPointsPerThread = 1000;
+
+/*! \brief
+ * Calls \p function for each index in [0, \p numIndices), divided over OpenMP threads.
+ *
+ * Loops over the neighborhood of the coordinate are too short for threading
+ * to pay off, so this is only used for loops that can cover the whole grid,
+ * which for 3- and 4-dimensional grids can consist of millions of points.
+ *
+ * \param[in] numIndices  The number of indices to loop over.
+ * \param[in] function    Function taking an index, should only modify data for that index.
+ */
+template<typename Function>
+void parallelForIndices(gmx::index numIndices, Function function)
+{
+    const int numThreads = static_cast<int>(std::max<gmx::index>(
+            1, std::min<gmx::index>(gmx_omp_nthreads_get(emntDefault),
+                                    numIndices / c_minNumPointsPerThread)));
+
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int thread = 0; thread < numThreads; thread++)
+    {
+        try
+        {
+            const gmx::index begin = (numIndices * thread) / numThreads;
+            const gmx::index end   = (numIndices * (thread + 1)) / numThreads;
+            for (gmx::index i = begin; i < end; i++)
+            {
+                function(i);
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+}
+
+} // namespace
+
 void BiasState::getPmf(gmx::ArrayRef<float> pmf) const
 {
     GMX_ASSERT(pmf.size() == points_.size(), "pmf should have the size of the bias grid");
@@ -139,15 +181,21 @@ void sumOverSimulations(gmx::ArrayRef<T> arrayRef, const t_commrec* commRecord,
 /*! \brief
  * Sum PMF over multiple simulations, when requested.
  *
+ * Only points in the (merged) update list can have been sampled since
+ * the last sum. All other points have values that are identical over
+ * the simulations, so these are left untouched.
+ *
  * \param[in,out] pointState         The state of the points in the bias.
  * \param[in]     numSharedUpdate    The number of biases sharing the histogram.
  * \param[in]     commRecord         Struct for intra-simulation communication.
  * \param[in]     multiSimComm       Struct for multi-simulation communication.
+ * \param[in]     updateList         List of points that could have been sampled.
  */
 void sumPmf(gmx::ArrayRef<PointState> pointState,
             int                       numSharedUpdate,
             const t_commrec*          commRecord,
-            const gmx_multisim_t*     multiSimComm)
+            const gmx_multisim_t*     multiSimComm,
+            const std::vector<int>&   updateList)
 {
     if (numSharedUpdate == 1)
     {
@@ -158,23 +206,25 @@ void sumPmf(gmx::ArrayRef<PointState> pointState,
     GMX_ASSERT(numSharedUpdate == multiSimComm->nsim,
                "Sharing within a simulation is not implemented (yet)");
 
-    std::vector<double> buffer(pointState.size());
+    std::vector<double> buffer(updateList.size());
 
     /* Need to temporarily exponentiate the log weights to sum over simulations */
     for (size_t i = 0; i < buffer.size(); i++)
     {
-        buffer[i] = pointState[i].inTargetRegion() ? std::exp(-pointState[i].logPmfSum()) : 0;
+        const PointState& ps = pointState[updateList[i]];
+        buffer[i]            = ps.inTargetRegion() ? std::exp(-ps.logPmfSum()) : 0;
     }
 
     sumOverSimulations(gmx::ArrayRef<double>(buffer), commRecord, multiSimComm);
 
     /* Take log again to get (non-normalized) PMF */
     double normFac = 1.0 / numSharedUpdate;
-    for (gmx::index i = 0; i < pointState.ssize(); i++)
+    for (size_t i = 0; i < buffer.size(); i++)
     {
-        if (pointState[i].inTargetRegion())
+        PointState& ps = pointState[updateList[i]];
+        if (ps.inTargetRegion())
         {
-            pointState[i].setLogPmfSum(-std::log(buffer[i] * normFac));
+            ps.setLogPmfSum(-std::log(buffer[i] * normFac));
         }
     }
 }
@@ -254,8 +304,7 @@ void BiasState::calcConvolvedPmf(const std::vector<DimParams>& dimParams,
     std::vector<float> pmf(numPoints);
     getPmf(pmf);
 
-    for (size_t m = 0; m < numPoints; m++)
-    {
+    parallelForIndices(numPoints, [&](gmx::index m) {
         double           freeEnergyWeights = 0;
         const GridPoint& point             = grid.point(m);
         for (auto& neighbor : point.neighbor)
@@ -274,7 +323,7 @@ void BiasState::calcConvolvedPmf(const std::vector<DimParams>& dimParams,
         GMX_RELEASE_ASSERT(freeEnergyWeights > 0,
                            "Attempting to do log(<= 0) in AWH convolved PMF calculation.");
         (*convolvedPmf)[m] = -std::log(static_cast<float>(freeEnergyWeights));
-    }
+    });
 }
 
 namespace
@@ -609,43 +658,6 @@ void BiasState::doSkippedUpdatesInNeighborhood(const BiasParams& params, const G
 namespace
 {
 
-/*! \brief
- * Merge update lists from multiple sharing simulations.
- *
- * \param[in,out] updateList    Update list for this simulation (assumed >= npoints long).
- * \param[in]     numPoints     Total number of points.
- * \param[in]     commRecord    Struct for intra-simulation communication.
- * \param[in]     multiSimComm  Struct for multi-simulation communication.
- */
-void mergeSharedUpdateLists(std::vector<int>*     updateList,
-                            int                   numPoints,
-                            const t_commrec*      commRecord,
-                            const gmx_multisim_t* multiSimComm)
-{
-    std::vector<int> numUpdatesOfPoint;
-
-    /* Flag the update points of this sim.
-       TODO: we can probably avoid allocating this array and just use the input array. */
-    numUpdatesOfPoint.resize(numPoints, 0);
-    for (auto& pointIndex : *updateList)
-    {
-        numUpdatesOfPoint[pointIndex] = 1;
-    }
-
-    /* Sum over the sims to get all the flagged points */
-    sumOverSimulations(arrayRefFromArray(numUpdatesOfPoint.data(), numPoints), commRecord, multiSimComm);
-
-    /* Collect the indices of the flagged points in place. The resulting array will be the merged update list.*/
-    updateList->clear();
-    for (int m = 0; m < numPoints; m++)
-    {
-        if (numUpdatesOfPoint[m] > 0)
-        {
-            updateList->push_back(m);
-        }
-    }
-}
-
 /*! \brief
  * Generate an update list of points sampled since the last update.
  *
@@ -691,6 +703,54 @@ void makeLocalUpdateList(const Grid&                    grid,
     }
 }
 
+/*! \brief
+ * Merge update lists from multiple sharing simulations.
+ *
+ * Between updates each simulation only samples points within a rectangular
+ * region of the grid. Only these regions are communicated, instead of flags
+ * for all points of the grid, and the merged list is the union of the local
+ * update lists of all regions.
+ *
+ * \param[in]     grid              The AWH grid.
+ * \param[in]     points            The point state.
+ * \param[in]     originUpdatelist  The origin of the region sampled by this simulation.
+ * \param[in]     endUpdatelist     The end of the region sampled by this simulation.
+ * \param[in,out] updateList        Update list for this simulation, returns the merged list.
+ * \param[in]     commRecord        Struct for intra-simulation communication.
+ * \param[in]     multiSimComm      Struct for multi-simulation communication.
+ */
+void mergeSharedUpdateLists(const Grid&                    grid,
+                            const std::vector<PointState>& points,
+                            const awh_ivec                 originUpdatelist,
+                            const awh_ivec                 endUpdatelist,
+                            std::vector<int>*              updateList,
+                            const t_commrec*               commRecord,
+                            const gmx_multisim_t*          multiSimComm)
+{
+    const int numDim = grid.numDimensions();
+
+    /* Collect the origin and end of the sampled regions of all sims */
+    std::vector<int> regions(multiSimComm->nsim * 2 * numDim, 0);
+    for (int d = 0; d < numDim; d++)
+    {
+        regions[(multiSimComm->sim * 2) * numDim + d]     = originUpdatelist[d];
+        regions[(multiSimComm->sim * 2 + 1) * numDim + d] = endUpdatelist[d];
+    }
+    sumOverSimulations(gmx::ArrayRef<int>(regions), commRecord, multiSimComm);
+
+    /* Concatenate the update lists of all regions, then sort and remove duplicates */
+    updateList->clear();
+    std::vector<int> regionUpdateList;
+    for (int sim = 0; sim < multiSimComm->nsim; sim++)
+    {
+        makeLocalUpdateList(grid, points, &regions[(sim * 2) * numDim],
+                            &regions[(sim * 2 + 1) * numDim], &regionUpdateList);
+        updateList->insert(updateList->end(), regionUpdateList.begin(), regionUpdateList.end());
+    }
+    std::sort(updateList->begin(), updateList->end());
+    updateList->erase(std::unique(updateList->begin(), updateList->end()), updateList->end());
+}
+
 } // namespace
 
 void BiasState::resetLocalUpdateRange(const Grid& grid)
@@ -999,10 +1059,8 @@ static void normalizeFreeEnergyAndPmfSum(std::vector<PointState>* pointState)
 {
     double minF = freeEnergyMinimumValue(*pointState);
 
-    for (PointState& ps : *pointState)
-    {
-        ps.normalizeFreeEnergyAndPmfSum(minF);
-    }
+    parallelForIndices(pointState->size(),
+                       [&](gmx::index m) { (*pointState)[m].normalizeFreeEnergyAndPmfSum(minF); });
 }
 
 void BiasState::updateFreeEnergyAndAddSamplesToHistogram(const std::vector<DimParams>& dimParams,
@@ -1028,7 +1086,8 @@ void BiasState::updateFreeEnergyAndAddSamplesToHistogram(const std::vector<DimPa
     makeLocalUpdateList(grid, points_, originUpdatelist_, endUpdatelist_, updateList);
     if (params.numSharedUpdate > 1)
     {
-        mergeSharedUpdateLists(updateList, points_.size(), commRecord, multiSimComm);
+        mergeSharedUpdateLists(grid, points_, originUpdatelist_, endUpdatelist_, updateList,
+                               commRecord, multiSimComm);
     }
 
     /* Reset the range for the next update */
@@ -1037,7 +1096,7 @@ void BiasState::updateFreeEnergyAndAddSamplesToHistogram(const std::vector<DimPa
     /* Add samples to histograms for all local points and sync simulations if needed */
     sumHistograms(points_, weightSumCovering_, params.numSharedUpdate, commRecord, multiSimComm, *updateList);
 
-    sumPmf(points_, params.numSharedUpdate, commRecord, multiSimComm);
+    sumPmf(points_, params.numSharedUpdate, commRecord, multiSimComm, *updateList);
 
     /* Renormalize the free energy if values are too large. */
     bool needToNormalizeFreeEnergy = false;
@@ -1109,10 +1168,11 @@ void BiasState::updateFreeEnergyAndAddSamplesToHistogram(const std::vector<DimPa
     setHistogramUpdateScaleFactors(params, newHistogramSize, histogramSize_.histogramSize(),
                                    &weightHistScalingNew, &logPmfsumScalingNew);
 
-    /* Update free energy and reference weight histogram for points in the update list. */
-    for (int pointIndex : *updateList)
-    {
-        PointState* pointStateToUpdate = &points_[pointIndex];
+    /* Update free energy and reference weight histogram for points in the update list.
+     * The points are independent, so for large (global) updates we use threads.
+     */
+    parallelForIndices(updateList->size(), [&](gmx::index listIndex) {
+        PointState* pointStateToUpdate = &points_[(*updateList)[listIndex]];
 
         /* Do updates from previous update steps that were skipped because this point was at that time non-local. */
         if (params.skipUpdates())
@@ -1125,7 +1185,7 @@ void BiasState::updateFreeEnergyAndAddSamplesToHistogram(const std::vector<DimPa
         /* Now do an update with new sampling data. */
         pointStateToUpdate->updateWithNewSampling(params, histogramSize_.numUpdates(),
                                                   weightHistScalingNew, logPmfsumScalingNew);
-    }
+    });
 
     /* Only update the histogram size after we are done with the local point updates */
     histogramSize_.setHistogramSize(newHistogramSize, weightHistScalingNew);
@@ -1143,10 +1203,9 @@ void BiasState::updateFreeEnergyAndAddSamplesToHistogram(const std::vector<DimPa
 
     /* Update the bias. The bias is updated separately and last since it simply a function of
        the free energy and the target distribution and we want to avoid doing extra work. */
-    for (int pointIndex : *updateList)
-    {
-        points_[pointIndex].updateBias();
-    }
+    parallelForIndices(updateList->size(), [&](gmx::index listIndex) {
+        points_[(*updateList)[listIndex]].updateBias();
+    });
 
     /* Increase the update counter. */
     histogramSize_.incrementNumUpdates();
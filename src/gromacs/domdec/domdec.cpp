@@ -51,7 +51,9 @@
 #include <cstring>
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
+#include <thread>
 
 #include "gromacs/domdec/builder.h"
 #include "gromacs/domdec/collect.h"
@@ -257,213 +259,547 @@ void dd_get_constraint_range(const gmx_domdec_t* dd, int* at_start, int* at_end)
     *at_end   = dd->comm->atomRanges.end(DDAtomRanges::Type::Constraints);
 }
 
-void dd_move_x(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle)
+/*! \brief MPI tag offset for the coordinate halo exchange, the pulse index is added
+ *
+ * The halo exchange can be in flight while other communication between
+ * the same ranks takes place, so we need tags that are not used elsewhere.
+ */
+static constexpr int c_mpiTagHaloX = 1000;
+//! MPI tag offset for the force halo exchange, the pulse index is added
+static constexpr int c_mpiTagHaloF = 2000;
+
+//! The number of spin iterations before yielding when waiting for a neighbor rank
+static constexpr int c_numSpinsBeforeYield = 1000;
+
+/*! \brief Waits until the value of \p signal is at least \p sequenceNumber
+ *
+ * We yield after some time, as we might oversubscribe the cores.
+ */
+static void waitForSignal(const std::atomic<int64_t>& signal, int64_t sequenceNumber)
 {
-    wallcycle_start(wcycle, ewcMOVEX);
+    int numSpins = 0;
+    while (signal.load(std::memory_order_acquire) < sequenceNumber)
+    {
+        if (numSpins < c_numSpinsBeforeYield)
+        {
+            numSpins++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
 
-    int                    nzone, nat_tot;
-    gmx_domdec_comm_t*     comm;
-    gmx_domdec_comm_dim_t* cd;
-    rvec                   shift = { 0, 0, 0 };
-    gmx_bool               bPBC, bScrew;
+/*! \brief Returns the exchange on the neighbor rank which we communicate with through
+ * shared memory in pulse \p k, returns nullptr when MPI is used
+ *
+ * \param[in] halo          The halo exchange
+ * \param[in] k             The pulse index in the order of communication
+ * \param[in] dimIndex      The DD dimension index
+ * \param[in] neighborIndex The index of the neighbor, as for gmx_domdec_t::neighbor
+ */
+static DDHaloExchange*
+sharedMemoryNeighbor(const DDHaloExchange& halo, int k, int dimIndex, int neighborIndex)
+{
+    return (k < c_maxNumSharedMemoryHaloPulses ? halo.sharedMemoryNeighbors[dimIndex][neighborIndex]
+                                               : nullptr);
+}
 
-    comm = dd->comm;
+/*! \brief Starts sending \p sendBuffer in pulse \p k of \p halo
+ *
+ * With shared memory, the receiver reads directly from \p sendBuffer.
+ * In both cases \p sendBuffer should not be modified until haloWaitSends() returns.
+ */
+static void haloSend(const gmx_domdec_t*            dd,
+                     DDHaloExchange*                halo,
+                     int                            k,
+                     int                            dimIndex,
+                     int                            direction,
+                     gmx::ArrayRef<const gmx::RVec> sendBuffer,
+                     int                            mpiTag)
+{
+    /* We send to neighbor 0 when moving forward and to 1 backward */
+    if (sharedMemoryNeighbor(*halo, k, dimIndex, direction == dddirForward ? 0 : 1))
+    {
+        DDSharedMemoryHaloPulse& sharedPulse = halo->sharedMemoryPulses[k];
+        sharedPulse.data                     = sendBuffer.data();
+        sharedPulse.numElements              = sendBuffer.size();
+        sharedPulse.ready.store(halo->sequenceNumber, std::memory_order_release);
+    }
+    else
+    {
+        ddIsendRvec(dd, dimIndex, direction, sendBuffer, mpiTag, &halo->sendRequests[k]);
+    }
+}
 
-    nzone   = 1;
-    nat_tot = comm->atomRanges.numHomeAtoms();
-    for (int d = 0; d < dd->ndim; d++)
+/*! \brief Posts the receive for pulse \p k of \p halo, does nothing with shared memory */
+static void haloPostReceive(const gmx_domdec_t*      dd,
+                            DDHaloExchange*          halo,
+                            int                      k,
+                            int                      dimIndex,
+                            int                      direction,
+                            gmx::ArrayRef<gmx::RVec> receiveBuffer,
+                            int                      mpiTag)
+{
+    if (!sharedMemoryNeighbor(*halo, k, dimIndex, direction == dddirForward ? 1 : 0))
     {
-        bPBC   = (dd->ci[dd->dim[d]] == 0);
-        bScrew = (bPBC && dd->unitCellInfo.haveScrewPBC && dd->dim[d] == XX);
-        if (bPBC)
+        ddIrecvRvec(dd, dimIndex, direction, receiveBuffer, mpiTag, &halo->receiveRequests[k]);
+    }
+}
+
+/*! \brief Waits for the data of pulse \p k of \p halo to arrive and returns it
+ *
+ * With MPI the data is received in \p receiveBuffer. With shared memory
+ * a view of the send buffer of the neighbor is returned instead. This
+ * view is valid until haloReleaseReceive() is called.
+ */
+static gmx::ArrayRef<const gmx::RVec> haloWaitReceive(DDHaloExchange*                halo,
+                                                      int                            k,
+                                                      int                            dimIndex,
+                                                      int                            direction,
+                                                      gmx::ArrayRef<const gmx::RVec> receiveBuffer)
+{
+    const DDHaloExchange* sender =
+            sharedMemoryNeighbor(*halo, k, dimIndex, direction == dddirForward ? 1 : 0);
+    if (sender)
+    {
+        const DDSharedMemoryHaloPulse& sharedPulse = sender->sharedMemoryPulses[k];
+        waitForSignal(sharedPulse.ready, halo->sequenceNumber);
+        GMX_ASSERT(sharedPulse.numElements == receiveBuffer.ssize(),
+                   "The neighbor should send the number of elements we expect");
+
+        return gmx::constArrayRefFromArray(sharedPulse.data, sharedPulse.numElements);
+    }
+    else
+    {
+        ddWaitAll(gmx::arrayRefFromArray(&halo->receiveRequests[k], 1));
+
+        return receiveBuffer;
+    }
+}
+
+//! Signals the sender that we are done reading the data returned by haloWaitReceive()
+static void haloReleaseReceive(const DDHaloExchange& halo, int k, int dimIndex, int direction)
+{
+    DDHaloExchange* sender =
+            sharedMemoryNeighbor(halo, k, dimIndex, direction == dddirForward ? 1 : 0);
+    if (sender)
+    {
+        sender->sharedMemoryPulses[k].consumed.store(halo.sequenceNumber,
+                                                     std::memory_order_release);
+    }
+}
+
+/*! \brief Waits until the receivers are done with the data of all our sends
+ *
+ * \p direction is the send direction, which is backward for coordinates
+ * and forward for forces, which are communicated in reverse pulse order.
+ */
+static void haloWaitSends(DDHaloExchange* halo, int direction)
+{
+    const int numPulses = halo->pulses.size();
+    for (int k = 0; k < numPulses; k++)
+    {
+        const int dimIndex = (direction == dddirForward ? halo->pulses[numPulses - 1 - k].dimIndex
+                                                        : halo->pulses[k].dimIndex);
+        if (sharedMemoryNeighbor(*halo, k, dimIndex, direction == dddirForward ? 0 : 1))
         {
-            copy_rvec(box[dd->dim[d]], shift);
+            waitForSignal(halo->sharedMemoryPulses[k].consumed, halo->sequenceNumber);
         }
-        cd = &comm->cd[d];
-        for (const gmx_domdec_ind_t& ind : cd->ind)
+        else
         {
-            DDBufferAccess<gmx::RVec> sendBufferAccess(comm->rvecBuffer, ind.nsend[nzone + 1]);
-            gmx::ArrayRef<gmx::RVec>& sendBuffer = sendBufferAccess.buffer;
-            int                       n          = 0;
-            if (!bPBC)
+            ddWaitAll(gmx::arrayRefFromArray(&halo->sendRequests[k], 1));
+        }
+    }
+}
+
+//! Sets up the list of pulses of the halo exchange, in coordinate communication order
+static void setHaloPulses(const gmx_domdec_t& dd, DDHaloExchange* halo)
+{
+    const gmx_domdec_comm_t& comm = *dd.comm;
+
+    halo->pulses.clear();
+    int numZones   = 1;
+    int atomOffset = comm.atomRanges.numHomeAtoms();
+    for (int d = 0; d < dd.ndim; d++)
+    {
+        const gmx_domdec_comm_dim_t& cd = comm.cd[d];
+        for (int p = 0; p < cd.numPulses(); p++)
+        {
+            halo->pulses.push_back({ d, p, numZones, atomOffset });
+            atomOffset += cd.ind[p].nrecv[numZones + 1];
+        }
+        numZones += numZones;
+    }
+
+    const size_t numPulses = halo->pulses.size();
+    halo->sendBuffers.resize(numPulses);
+    halo->receiveBuffers.resize(numPulses);
+    halo->sendRequests.resize(numPulses);
+    halo->receiveRequests.resize(numPulses);
+}
+
+/*! \brief Packs the coordinates for pulse \p pulseIndex and starts sending them */
+static void sendHaloCoordinates(const gmx_domdec_t*            dd,
+                                DDHaloExchange*                halo,
+                                int                            pulseIndex,
+                                gmx::ArrayRef<const gmx::RVec> x)
+{
+    const DDHaloPulse&      pulse = halo->pulses[pulseIndex];
+    const int               dim   = dd->dim[pulse.dimIndex];
+    const gmx_domdec_ind_t& ind   = dd->comm->cd[pulse.dimIndex].ind[pulse.pulseIndex];
+
+    const bool bPBC   = (dd->ci[dim] == 0);
+    const bool bScrew = (bPBC && dd->unitCellInfo.haveScrewPBC && dim == XX);
+    rvec       shift  = { 0, 0, 0 };
+    if (bPBC)
+    {
+        copy_rvec(halo->box[dim], shift);
+    }
+
+    std::vector<gmx::RVec>& sendBuffer = halo->sendBuffers[pulseIndex];
+    sendBuffer.resize(ind.nsend[pulse.numZones + 1]);
+    int n = 0;
+    if (!bPBC)
+    {
+        for (int j : ind.index)
+        {
+            sendBuffer[n] = x[j];
+            n++;
+        }
+    }
+    else if (!bScrew)
+    {
+        for (int j : ind.index)
+        {
+            /* We need to shift the coordinates */
+            for (int d = 0; d < DIM; d++)
             {
-                for (int j : ind.index)
-                {
-                    sendBuffer[n] = x[j];
-                    n++;
-                }
+                sendBuffer[n][d] = x[j][d] + shift[d];
             }
-            else if (!bScrew)
+            n++;
+        }
+    }
+    else
+    {
+        for (int j : ind.index)
+        {
+            /* Shift x */
+            sendBuffer[n][XX] = x[j][XX] + shift[XX];
+            /* Rotate y and z.
+             * This operation requires a special shift force
+             * treatment, which is performed in calc_vir.
+             */
+            sendBuffer[n][YY] = halo->box[YY][YY] - x[j][YY];
+            sendBuffer[n][ZZ] = halo->box[ZZ][ZZ] - x[j][ZZ];
+            n++;
+        }
+    }
+
+    haloSend(dd, halo, pulseIndex, pulse.dimIndex, dddirBackward, sendBuffer,
+             c_mpiTagHaloX + pulseIndex);
+}
+
+void dd_move_x_start(gmx_domdec_t*            dd,
+                     const matrix             box,
+                     gmx::ArrayRef<gmx::RVec> x,
+                     gmx_wallcycle*           wcycle)
+{
+    wallcycle_start(wcycle, ewcMOVEX);
+
+    DDHaloExchange* halo = &dd->comm->haloExchangeX;
+    GMX_ASSERT(!halo->inProgress,
+               "Can not start a coordinate halo exchange while one is in progress");
+
+    setHaloPulses(*dd, halo);
+    copy_mat(box, halo->box);
+    halo->sequenceNumber++;
+
+    /* Post all receives, so the data can arrive while we wait for earlier pulses */
+    for (size_t k = 0; k < halo->pulses.size(); k++)
+    {
+        const DDHaloPulse&           pulse = halo->pulses[k];
+        const gmx_domdec_comm_dim_t& cd    = dd->comm->cd[pulse.dimIndex];
+        const int numReceive               = cd.ind[pulse.pulseIndex].nrecv[pulse.numZones + 1];
+
+        gmx::ArrayRef<gmx::RVec> receiveBuffer;
+        if (cd.receiveInPlace)
+        {
+            receiveBuffer = gmx::arrayRefFromArray(x.data() + pulse.atomOffset, numReceive);
+        }
+        else
+        {
+            halo->receiveBuffers[k].resize(numReceive);
+            receiveBuffer = halo->receiveBuffers[k];
+        }
+        haloPostReceive(dd, halo, k, pulse.dimIndex, dddirBackward, receiveBuffer,
+                        c_mpiTagHaloX + k);
+    }
+
+    /* The first pulse only sends home atoms, which are present now */
+    if (!halo->pulses.empty())
+    {
+        sendHaloCoordinates(dd, halo, 0, x);
+    }
+
+    halo->inProgress = true;
+
+    wallcycle_stop(wcycle, ewcMOVEX);
+}
+
+void dd_move_x_finish(gmx_domdec_t* dd, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle)
+{
+    wallcycle_start(wcycle, ewcMOVEX);
+
+    DDHaloExchange* halo = &dd->comm->haloExchangeX;
+    GMX_ASSERT(halo->inProgress, "Can only finish a coordinate halo exchange that was started");
+
+    const int numPulses = halo->pulses.size();
+    for (int k = 0; k < numPulses; k++)
+    {
+        const DDHaloPulse&           pulse      = halo->pulses[k];
+        const gmx_domdec_comm_dim_t& cd         = dd->comm->cd[pulse.dimIndex];
+        const gmx_domdec_ind_t&      ind        = cd.ind[pulse.pulseIndex];
+        const int                    numReceive = ind.nrecv[pulse.numZones + 1];
+
+        gmx::ArrayRef<gmx::RVec> receiveBuffer;
+        if (cd.receiveInPlace)
+        {
+            receiveBuffer = gmx::arrayRefFromArray(x.data() + pulse.atomOffset, numReceive);
+        }
+        else
+        {
+            receiveBuffer = halo->receiveBuffers[k];
+        }
+        gmx::ArrayRef<const gmx::RVec> received =
+                haloWaitReceive(halo, k, pulse.dimIndex, dddirBackward, receiveBuffer);
+
+        if (cd.receiveInPlace)
+        {
+            /* With shared memory we read from the send buffer of our neighbor */
+            if (received.data() != receiveBuffer.data())
             {
-                for (int j : ind.index)
-                {
-                    /* We need to shift the coordinates */
-                    for (int d = 0; d < DIM; d++)
-                    {
-                        sendBuffer[n][d] = x[j][d] + shift[d];
-                    }
-                    n++;
-                }
+                std::copy(received.begin(), received.end(), receiveBuffer.begin());
             }
-            else
+        }
+        else
+        {
+            int j = 0;
+            for (int zone = 0; zone < pulse.numZones; zone++)
             {
-                for (int j : ind.index)
+                for (int i = ind.cell2at0[zone]; i < ind.cell2at1[zone]; i++)
                 {
-                    /* Shift x */
-                    sendBuffer[n][XX] = x[j][XX] + shift[XX];
-                    /* Rotate y and z.
-                     * This operation requires a special shift force
-                     * treatment, which is performed in calc_vir.
-                     */
-                    sendBuffer[n][YY] = box[YY][YY] - x[j][YY];
-                    sendBuffer[n][ZZ] = box[ZZ][ZZ] - x[j][ZZ];
-                    n++;
+                    x[i] = received[j++];
                 }
             }
+        }
 
-            DDBufferAccess<gmx::RVec> receiveBufferAccess(
-                    comm->rvecBuffer2, cd->receiveInPlace ? 0 : ind.nrecv[nzone + 1]);
+        haloReleaseReceive(*halo, k, pulse.dimIndex, dddirBackward);
 
-            gmx::ArrayRef<gmx::RVec> receiveBuffer;
-            if (cd->receiveInPlace)
-            {
-                receiveBuffer = gmx::arrayRefFromArray(x.data() + nat_tot, ind.nrecv[nzone + 1]);
-            }
-            else
-            {
-                receiveBuffer = receiveBufferAccess.buffer;
-            }
-            /* Send and receive the coordinates */
-            ddSendrecv(dd, d, dddirBackward, sendBuffer, receiveBuffer);
+        /* Now all data for the next pulse is present */
+        if (k + 1 < numPulses)
+        {
+            sendHaloCoordinates(dd, halo, k + 1, x);
+        }
+    }
 
-            if (!cd->receiveInPlace)
+    haloWaitSends(halo, dddirBackward);
+
+    halo->inProgress = false;
+
+    wallcycle_stop(wcycle, ewcMOVEX);
+}
+
+void dd_move_x(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle)
+{
+    dd_move_x_start(dd, box, x, wcycle);
+    dd_move_x_finish(dd, x, wcycle);
+}
+
+/*! \brief Starts sending the forces for force pulse \p k
+ *
+ * The force pulses are in reverse order of the coordinate pulses.
+ */
+static void sendHaloForces(const gmx_domdec_t*            dd,
+                           DDHaloExchange*                halo,
+                           int                            k,
+                           gmx::ArrayRef<const gmx::RVec> f)
+{
+    const DDHaloPulse&           pulse   = halo->pulses[halo->pulses.size() - 1 - k];
+    const gmx_domdec_comm_dim_t& cd      = dd->comm->cd[pulse.dimIndex];
+    const gmx_domdec_ind_t&      ind     = cd.ind[pulse.pulseIndex];
+    const int                    numSend = ind.nrecv[pulse.numZones + 1];
+
+    gmx::ArrayRef<const gmx::RVec> sendBuffer;
+    if (cd.receiveInPlace)
+    {
+        /* No force contributions are added to these atoms after this,
+         * so we can send directly from the force buffer.
+         */
+        sendBuffer = gmx::constArrayRefFromArray(f.data() + pulse.atomOffset, numSend);
+    }
+    else
+    {
+        std::vector<gmx::RVec>& buffer = halo->sendBuffers[k];
+        buffer.resize(numSend);
+        int j = 0;
+        for (int zone = 0; zone < pulse.numZones; zone++)
+        {
+            for (int i = ind.cell2at0[zone]; i < ind.cell2at1[zone]; i++)
             {
-                int j = 0;
-                for (int zone = 0; zone < nzone; zone++)
-                {
-                    for (int i = ind.cell2at0[zone]; i < ind.cell2at1[zone]; i++)
-                    {
-                        x[i] = receiveBuffer[j++];
-                    }
-                }
+                buffer[j++] = f[i];
             }
-            nat_tot += ind.nrecv[nzone + 1];
         }
-        nzone += nzone;
+        sendBuffer = buffer;
     }
+    haloSend(dd, halo, k, pulse.dimIndex, dddirForward, sendBuffer, c_mpiTagHaloF + k);
+}
 
-    wallcycle_stop(wcycle, ewcMOVEX);
+void dd_move_f_start(gmx_domdec_t*               dd,
+                     gmx::ForceWithShiftForces* forceWithShiftForces,
+                     gmx_wallcycle*             wcycle)
+{
+    wallcycle_start(wcycle, ewcMOVEF);
+
+    DDHaloExchange* halo = &dd->comm->haloExchangeF;
+    GMX_ASSERT(!halo->inProgress, "Can not start a force halo exchange while one is in progress");
+
+    setHaloPulses(*dd, halo);
+    halo->sequenceNumber++;
+
+    /* Post all receives, so the data can arrive while we wait for earlier pulses */
+    const int numPulses = halo->pulses.size();
+    for (int k = 0; k < numPulses; k++)
+    {
+        const DDHaloPulse&      pulse = halo->pulses[numPulses - 1 - k];
+        const gmx_domdec_ind_t& ind   = dd->comm->cd[pulse.dimIndex].ind[pulse.pulseIndex];
+
+        halo->receiveBuffers[k].resize(ind.nsend[pulse.numZones + 1]);
+        haloPostReceive(dd, halo, k, pulse.dimIndex, dddirForward, halo->receiveBuffers[k],
+                        c_mpiTagHaloF + k);
+    }
+
+    /* The first force pulse sends the forces on the atoms received in
+     * the last coordinate pulse, which have no contributions from
+     * other pulses and are thus complete now.
+     */
+    if (numPulses > 0)
+    {
+        sendHaloForces(dd, halo, 0, forceWithShiftForces->force());
+    }
+
+    halo->inProgress = true;
+
+    wallcycle_stop(wcycle, ewcMOVEF);
 }
 
-void dd_move_f(gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces, gmx_wallcycle* wcycle)
+void dd_move_f_finish(gmx_domdec_t*               dd,
+                      gmx::ForceWithShiftForces* forceWithShiftForces,
+                      gmx_wallcycle*             wcycle)
 {
     wallcycle_start(wcycle, ewcMOVEF);
 
+    DDHaloExchange* halo = &dd->comm->haloExchangeF;
+    GMX_ASSERT(halo->inProgress, "Can only finish a force halo exchange that was started");
+
     gmx::ArrayRef<gmx::RVec> f      = forceWithShiftForces->force();
     gmx::ArrayRef<gmx::RVec> fshift = forceWithShiftForces->shiftForces();
 
-    gmx_domdec_comm_t& comm    = *dd->comm;
-    int                nzone   = comm.zones.n / 2;
-    int                nat_tot = comm.atomRanges.end(DDAtomRanges::Type::Zones);
-    for (int d = dd->ndim - 1; d >= 0; d--)
+    const int numPulses = halo->pulses.size();
+    for (int k = 0; k < numPulses; k++)
     {
+        const DDHaloPulse&      pulse = halo->pulses[numPulses - 1 - k];
+        const int               dim   = dd->dim[pulse.dimIndex];
+        const gmx_domdec_ind_t& ind   = dd->comm->cd[pulse.dimIndex].ind[pulse.pulseIndex];
+
         /* Only forces in domains near the PBC boundaries need to
            consider PBC in the treatment of fshift */
-        const bool shiftForcesNeedPbc =
-                (forceWithShiftForces->computeVirial() && dd->ci[dd->dim[d]] == 0);
+        const bool shiftForcesNeedPbc = (forceWithShiftForces->computeVirial() && dd->ci[dim] == 0);
         const bool applyScrewPbc =
-                (shiftForcesNeedPbc && dd->unitCellInfo.haveScrewPBC && dd->dim[d] == XX);
+                (shiftForcesNeedPbc && dd->unitCellInfo.haveScrewPBC && dim == XX);
         /* Determine which shift vector we need */
-        ivec vis        = { 0, 0, 0 };
-        vis[dd->dim[d]] = 1;
-        const int is    = IVEC2IS(vis);
-
-        /* Loop over the pulses */
-        const gmx_domdec_comm_dim_t& cd = comm.cd[d];
-        for (int p = cd.numPulses() - 1; p >= 0; p--)
-        {
-            const gmx_domdec_ind_t&   ind = cd.ind[p];
-            DDBufferAccess<gmx::RVec> receiveBufferAccess(comm.rvecBuffer, ind.nsend[nzone + 1]);
-            gmx::ArrayRef<gmx::RVec>& receiveBuffer = receiveBufferAccess.buffer;
-
-            nat_tot -= ind.nrecv[nzone + 1];
+        ivec vis = { 0, 0, 0 };
+        vis[dim] = 1;
+        const int is = IVEC2IS(vis);
 
-            DDBufferAccess<gmx::RVec> sendBufferAccess(
-                    comm.rvecBuffer2, cd.receiveInPlace ? 0 : ind.nrecv[nzone + 1]);
+        /* With shared memory we add the forces directly from the buffer of our neighbor */
+        gmx::ArrayRef<const gmx::RVec> receiveBuffer =
+                haloWaitReceive(halo, k, pulse.dimIndex, dddirForward, halo->receiveBuffers[k]);
 
-            gmx::ArrayRef<gmx::RVec> sendBuffer;
-            if (cd.receiveInPlace)
-            {
-                sendBuffer = gmx::arrayRefFromArray(f.data() + nat_tot, ind.nrecv[nzone + 1]);
-            }
-            else
+        /* Add the received forces */
+        int n = 0;
+        if (!shiftForcesNeedPbc)
+        {
+            for (int j : ind.index)
             {
-                sendBuffer = sendBufferAccess.buffer;
-                int j      = 0;
-                for (int zone = 0; zone < nzone; zone++)
+                for (int d = 0; d < DIM; d++)
                 {
-                    for (int i = ind.cell2at0[zone]; i < ind.cell2at1[zone]; i++)
-                    {
-                        sendBuffer[j++] = f[i];
-                    }
+                    f[j][d] += receiveBuffer[n][d];
                 }
+                n++;
             }
-            /* Communicate the forces */
-            ddSendrecv(dd, d, dddirForward, sendBuffer, receiveBuffer);
-            /* Add the received forces */
-            int n = 0;
-            if (!shiftForcesNeedPbc)
+        }
+        else if (!applyScrewPbc)
+        {
+            for (int j : ind.index)
             {
-                for (int j : ind.index)
+                for (int d = 0; d < DIM; d++)
                 {
-                    for (int d = 0; d < DIM; d++)
-                    {
-                        f[j][d] += receiveBuffer[n][d];
-                    }
-                    n++;
+                    f[j][d] += receiveBuffer[n][d];
+                }
+                /* Add this force to the shift force */
+                for (int d = 0; d < DIM; d++)
+                {
+                    fshift[is][d] += receiveBuffer[n][d];
                 }
+                n++;
             }
-            else if (!applyScrewPbc)
+        }
+        else
+        {
+            for (int j : ind.index)
             {
-                for (int j : ind.index)
+                /* Rotate the force */
+                f[j][XX] += receiveBuffer[n][XX];
+                f[j][YY] -= receiveBuffer[n][YY];
+                f[j][ZZ] -= receiveBuffer[n][ZZ];
+                if (shiftForcesNeedPbc)
                 {
-                    for (int d = 0; d < DIM; d++)
-                    {
-                        f[j][d] += receiveBuffer[n][d];
-                    }
                     /* Add this force to the shift force */
                     for (int d = 0; d < DIM; d++)
                     {
                         fshift[is][d] += receiveBuffer[n][d];
                     }
-                    n++;
-                }
-            }
-            else
-            {
-                for (int j : ind.index)
-                {
-                    /* Rotate the force */
-                    f[j][XX] += receiveBuffer[n][XX];
-                    f[j][YY] -= receiveBuffer[n][YY];
-                    f[j][ZZ] -= receiveBuffer[n][ZZ];
-                    if (shiftForcesNeedPbc)
-                    {
-                        /* Add this force to the shift force */
-                        for (int d = 0; d < DIM; d++)
-                        {
-                            fshift[is][d] += receiveBuffer[n][d];
-                        }
-                    }
-                    n++;
                 }
+                n++;
             }
         }
-        nzone /= 2;
+
+        haloReleaseReceive(*halo, k, pulse.dimIndex, dddirForward);
+
+        /* Now all contributions to the forces sent in the next pulse are present */
+        if (k + 1 < numPulses)
+        {
+            sendHaloForces(dd, halo, k + 1, f);
+        }
     }
+
+    haloWaitSends(halo, dddirForward);
+
+    halo->inProgress = false;
+
     wallcycle_stop(wcycle, ewcMOVEF);
 }
 
+void dd_move_f(gmx_domdec_t*               dd,
+               gmx::ForceWithShiftForces* forceWithShiftForces,
+               gmx_wallcycle*             wcycle)
+{
+    dd_move_f_start(dd, forceWithShiftForces, wcycle);
+    dd_move_f_finish(dd, forceWithShiftForces, wcycle);
+}
+
 /* Convenience function for extracting a real buffer from an rvec buffer
  *
  * To reduce the number of temporary communication buffers and avoid
@@ -1009,6 +1345,11 @@ bool ddHaveSplitConstraints(const gmx_domdec_t& dd)
     return dd.comm->systemInfo.haveSplitConstraints;
 }
 
+bool ddUsesHaloExchangeOverlap(const gmx_domdec_t& dd)
+{
+    return dd.comm->ddSettings.useHaloExchangeOverlap;
+}
+
 bool ddUsesUpdateGroups(const gmx_domdec_t& dd)
 {
     return dd.comm->systemInfo.useUpdateGroups;
@@ -2847,6 +3188,62 @@ static void set_ddgrid_parameters(const gmx::MDLogger& mdlog,
     dd->ga2la = new gmx_ga2la_t(natoms_tot, static_cast<int>(vol_frac * natoms_tot));
 }
 
+/*! \brief Sets up halo exchange through shared memory with the neighbor ranks where possible
+ *
+ * Neighbors can read our halo data directly when they share our address
+ * space and are on the same physical node. Note that with thread-MPI all
+ * ranks are in the same process. Each rank decides per neighbor, using
+ * the same information on both sides, so the decisions match.
+ */
+static void setupSharedMemoryHaloExchange(const gmx::MDLogger& mdlog, gmx_domdec_t* dd)
+{
+    gmx_domdec_comm_t* comm = dd->comm;
+
+    const bool         useSharedMemory  = comm->ddSettings.useSharedMemoryHaloExchange;
+    const std::int64_t physicalNodeHash = gmx_physicalnode_id_hash();
+
+    std::array<std::int64_t, 4> ourInfo = {
+        { useSharedMemory ? 1 : 0, physicalNodeHash,
+          reinterpret_cast<intptr_t>(&comm->haloExchangeX),
+          reinterpret_cast<intptr_t>(&comm->haloExchangeF) }
+    };
+
+    int numSharedMemoryNeighbors = 0;
+    for (int d = 0; d < dd->ndim; d++)
+    {
+        for (int direction : { dddirForward, dddirBackward })
+        {
+            std::array<std::int64_t, 4> neighborInfo = { { 0 } };
+            ddSendrecv<std::int64_t>(dd, d, direction, ourInfo, neighborInfo);
+
+            /* We receive from neighbor 1 when moving forward and from 0 backward */
+            const int neighborIndex = (direction == dddirForward ? 1 : 0);
+
+            DDHaloExchange* neighborHaloExchangeX = nullptr;
+            DDHaloExchange* neighborHaloExchangeF = nullptr;
+            if (useSharedMemory && neighborInfo[0] != 0 && neighborInfo[1] == physicalNodeHash)
+            {
+                neighborHaloExchangeX =
+                        reinterpret_cast<DDHaloExchange*>(static_cast<intptr_t>(neighborInfo[2]));
+                neighborHaloExchangeF =
+                        reinterpret_cast<DDHaloExchange*>(static_cast<intptr_t>(neighborInfo[3]));
+                numSharedMemoryNeighbors++;
+            }
+            comm->haloExchangeX.sharedMemoryNeighbors[d][neighborIndex] = neighborHaloExchangeX;
+            comm->haloExchangeF.sharedMemoryNeighbors[d][neighborIndex] = neighborHaloExchangeF;
+        }
+    }
+
+    if (useSharedMemory && dd->ndim > 0)
+    {
+        GMX_LOG(mdlog.info)
+                .appendTextFormatted(
+                        "The halo exchange uses shared memory in %d out of %d communication "
+                        "directions",
+                        numSharedMemoryNeighbors, 2 * dd->ndim);
+    }
+}
+
 /*! \brief Get some important DD parameters which can be modified by env.vars */
 static DDSettings getDDSettings(const gmx::MDLogger&     mdlog,
                                 const DomdecOptions&     options,
@@ -2855,16 +3252,20 @@ static DDSettings getDDSettings(const gmx::MDLogger&     mdlog,
 {
     DDSettings ddSettings;
 
-    ddSettings.useSendRecv2        = (dd_getenv(mdlog, "GMX_DD_USE_SENDRECV2", 0) != 0);
-    ddSettings.dlb_scale_lim       = dd_getenv(mdlog, "GMX_DLB_MAX_BOX_SCALING", 10);
-    ddSettings.request1D           = bool(dd_getenv(mdlog, "GMX_DD_1D", 0));
-    ddSettings.useDDOrderZYX       = bool(dd_getenv(mdlog, "GMX_DD_ORDER_ZYX", 0));
-    ddSettings.useCartesianReorder = bool(dd_getenv(mdlog, "GMX_NO_CART_REORDER", 1));
-    ddSettings.eFlop               = dd_getenv(mdlog, "GMX_DLB_BASED_ON_FLOPS", 0);
-    const int recload              = dd_getenv(mdlog, "GMX_DD_RECORD_LOAD", 1);
-    ddSettings.nstDDDump           = dd_getenv(mdlog, "GMX_DD_NST_DUMP", 0);
-    ddSettings.nstDDDumpGrid       = dd_getenv(mdlog, "GMX_DD_NST_DUMP_GRID", 0);
-    ddSettings.DD_debug            = dd_getenv(mdlog, "GMX_DD_DEBUG", 0);
+    ddSettings.useSendRecv2           = (dd_getenv(mdlog, "GMX_DD_USE_SENDRECV2", 0) != 0);
+    ddSettings.dlb_scale_lim          = dd_getenv(mdlog, "GMX_DLB_MAX_BOX_SCALING", 10);
+    ddSettings.request1D              = bool(dd_getenv(mdlog, "GMX_DD_1D", 0));
+    ddSettings.useDDOrderZYX          = bool(dd_getenv(mdlog, "GMX_DD_ORDER_ZYX", 0));
+    ddSettings.useCartesianReorder    = bool(dd_getenv(mdlog, "GMX_NO_CART_REORDER", 1));
+    ddSettings.eFlop                  = dd_getenv(mdlog, "GMX_DLB_BASED_ON_FLOPS", 0);
+    const int recload                 = dd_getenv(mdlog, "GMX_DD_RECORD_LOAD", 1);
+    ddSettings.nstDDDump              = dd_getenv(mdlog, "GMX_DD_NST_DUMP", 0);
+    ddSettings.nstDDDumpGrid          = dd_getenv(mdlog, "GMX_DD_NST_DUMP_GRID", 0);
+    ddSettings.DD_debug               = dd_getenv(mdlog, "GMX_DD_DEBUG", 0);
+    ddSettings.useHaloExchangeOverlap = !bool(dd_getenv(mdlog, "GMX_DD_NO_HALO_OVERLAP", 0));
+    /* Reading the halo data directly from the neighbor rank requires a shared address space */
+    ddSettings.useSharedMemoryHaloExchange =
+            (GMX_THREAD_MPI && dd_getenv(mdlog, "GMX_DD_NO_SHARED_MEMORY_HALO", 0) == 0);
 
     if (ddSettings.useSendRecv2)
     {
@@ -2875,6 +3276,14 @@ static DDSettings getDDSettings(const gmx::MDLogger&     mdlog,
                         "communication");
     }
 
+    if (!ddSettings.useHaloExchangeOverlap)
+    {
+        GMX_LOG(mdlog.info)
+                .appendText(
+                        "Will not overlap the CPU halo exchange of coordinates and forces with "
+                        "local computation");
+    }
+
     if (ddSettings.eFlop)
     {
         GMX_LOG(mdlog.info).appendText("Will load balance based on FLOP count");
@@ -3087,6 +3496,8 @@ gmx_domdec_t* DomainDecompositionBuilder::Impl::build(LocalAtomSetManager* atomS
         set_ddgrid_parameters(mdlog_, dd, options_.dlbScaling, &mtop_, &ir_, &ddbox_);
 
         setup_neighbor_relations(dd);
+
+        setupSharedMemoryHaloExchange(mdlog_, dd);
     }
 
     /* Set overallocation to avoid frequent reallocation of arrays */
@@ -156,6 +156,9 @@ bool ddHaveSplitConstraints(const gmx_domdec_t& dd);
 /*! \brief Return whether update groups are used */
 bool ddUsesUpdateGroups(const gmx_domdec_t& dd);
 
+/*! \brief Return whether the CPU halo exchange may be overlapped with local computation */
+bool ddUsesHaloExchangeOverlap(const gmx_domdec_t& dd);
+
 /*! \brief Return whether the DD has a single dimension
  *
  * The GPU halo exchange code requires a 1D DD, and its setup code can
@@ -216,6 +219,20 @@ void dd_cycles_add(const gmx_domdec_t* dd, float cycles, int ddCycl);
 /*! \brief Communicate the coordinates to the neighboring cells and do pbc. */
 void dd_move_x(struct gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle);
 
+/*! \brief Start the non-blocking communication of the coordinates to the neighboring cells
+ *
+ * Posts all receives and sends the first pulse. Until dd_move_x_finish()
+ * is called, the home coordinates in \p x should not be modified and
+ * the non-local coordinates should not be accessed.
+ */
+void dd_move_x_start(struct gmx_domdec_t*     dd,
+                     const matrix             box,
+                     gmx::ArrayRef<gmx::RVec> x,
+                     gmx_wallcycle*           wcycle);
+
+/*! \brief Finish the communication of the coordinates started with dd_move_x_start() */
+void dd_move_x_finish(struct gmx_domdec_t* dd, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle);
+
 /*! \brief Sum the forces over the neighboring cells.
  *
  * When fshift!=NULL the shift forces are updated to obtain
@@ -223,6 +240,20 @@ void dd_move_x(struct gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVe
  */
 void dd_move_f(struct gmx_domdec_t* dd, gmx::ForceWithShiftForces* forceWithShiftForces, gmx_wallcycle* wcycle);
 
+/*! \brief Start the non-blocking summation of the forces over the neighboring cells
+ *
+ * All force contributions to non-local atoms should be present. Until
+ * dd_move_f_finish() is called, only forces on home atoms can be added.
+ */
+void dd_move_f_start(struct gmx_domdec_t*       dd,
+                     gmx::ForceWithShiftForces* forceWithShiftForces,
+                     gmx_wallcycle*             wcycle);
+
+/*! \brief Finish the force summation started with dd_move_f_start() */
+void dd_move_f_finish(struct gmx_domdec_t*       dd,
+                      gmx::ForceWithShiftForces* forceWithShiftForces,
+                      gmx_wallcycle*             wcycle);
+
 /*! \brief Communicate a real for each atom to the neighboring cells. */
 void dd_atom_spread_real(struct gmx_domdec_t* dd, real v[]);
 
@@ -46,11 +46,15 @@
 
 #include "config.h"
 
+#include <array>
+#include <atomic>
+
 #include "gromacs/domdec/domdec.h"
 #include "gromacs/domdec/domdec_struct.h"
 #include "gromacs/mdlib/updategroupscog.h"
 #include "gromacs/timing/cyclecounter.h"
 #include "gromacs/topology/block.h"
+#include "gromacs/utility/gmxmpi.h"
 
 struct t_commrec;
 
@@ -417,6 +421,81 @@ struct dd_comm_setup_work_t
     int nsend_zone = 0;
 };
 
+/*! \brief Description of one pulse of the halo exchange
+ *
+ * The pulses are ordered linearly over dimensions and pulses per dimension.
+ */
+struct DDHaloPulse
+{
+    //! The index of the DD dimension
+    int dimIndex = 0;
+    //! The index of the pulse along the dimension
+    int pulseIndex = 0;
+    //! The number of zones communicated before this pulse
+    int numZones = 0;
+    //! The local atom index where the atoms received in this pulse start
+    int atomOffset = 0;
+};
+
+//! The maximum number of halo pulses that can use shared-memory communication
+static constexpr int c_maxNumSharedMemoryHaloPulses = 32;
+
+/*! \brief Signaling for one pulse of a halo exchange through shared memory
+ *
+ * This is owned by the sending rank. The sender sets the data pointer
+ * and size and then sets \p ready to the sequence number of the exchange.
+ * The receiver waits for that, reads the data directly from the memory
+ * of the sender and then sets \p consumed to the same sequence number.
+ * Only after that the sender is allowed to modify the data again.
+ */
+struct DDSharedMemoryHaloPulse
+{
+    //! Pointer to the data to be read by the receiver
+    const gmx::RVec* data = nullptr;
+    //! The number of elements in \p data
+    int numElements = 0;
+    //! The sequence number of the last exchange for which the data is ready
+    std::atomic<int64_t> ready{ 0 };
+    //! The sequence number of the last exchange for which the data has been read
+    std::atomic<int64_t> consumed{ 0 };
+};
+
+/*! \brief State of a non-blocking halo exchange of coordinates or forces
+ *
+ * Pulses send data received in earlier pulses, so they need to be
+ * executed in order. But all receives are posted at the start of
+ * the exchange and each pulse is sent as soon as its data is present,
+ * so the communication can overlap with computation done between
+ * starting and finishing the exchange.
+ */
+struct DDHaloExchange
+{
+    //! Whether an exchange has been started and not yet finished
+    bool inProgress = false;
+    //! The box, used for applying PBC shifts to coordinates
+    matrix box = { { 0 } };
+    //! The pulses in the order of communication
+    std::vector<DDHaloPulse> pulses;
+    //! Send buffer for each pulse, these need to be valid until the send completes
+    std::vector<std::vector<gmx::RVec>> sendBuffers;
+    //! Receive buffer for each pulse, unused when receiving in place
+    std::vector<std::vector<gmx::RVec>> receiveBuffers;
+    //! The send request for each pulse
+    std::vector<MPI_Request> sendRequests;
+    //! The receive request for each pulse
+    std::vector<MPI_Request> receiveRequests;
+    //! The sequence number of the current exchange, used for shared-memory signaling
+    int64_t sequenceNumber = 0;
+    //! Shared-memory signaling for the pulses sent by this rank
+    std::array<DDSharedMemoryHaloPulse, c_maxNumSharedMemoryHaloPulses> sharedMemoryPulses;
+    /*! \brief The same exchange on the neighbor ranks, indexed as gmx_domdec_t::neighbor
+     *
+     * A pointer is only set when the neighbor shares our address space
+     * and is on the same physical node, otherwise it is nullptr and MPI is used.
+     */
+    std::array<std::array<DDHaloExchange*, 2>, DIM> sharedMemoryNeighbors = { { { nullptr } } };
+};
+
 /*! \brief Information about the simulated system */
 struct DDSystemInfo
 {
@@ -466,6 +545,10 @@ struct DDSettings
 {
     //! Use MPI_Sendrecv communication instead of non-blocking calls
     bool useSendRecv2 = false;
+    //! Overlap the halo exchange on the CPU with local computation
+    bool useHaloExchangeOverlap = true;
+    //! Let ranks in the same process read the halo data directly from each others memory
+    bool useSharedMemoryHaloExchange = true;
 
     /* Information for managing the dynamic load balancing */
     //! Maximum DLB scaling per load balancing step in percent
@@ -664,6 +747,11 @@ struct gmx_domdec_comm_t // NOLINT (clang-analyzer-optin.performance.Padding)
     /**< Another rvec comm. buffer */
     DDBuffer<gmx::RVec> rvecBuffer2;
 
+    /**< The state of the non-blocking coordinate halo exchange */
+    DDHaloExchange haloExchangeX;
+    /**< The state of the non-blocking force halo exchange */
+    DDHaloExchange haloExchangeF;
+
     /* Communication buffers for local redistribution */
     /**< Charge group flag comm. buffers */
     std::array<std::vector<int>, DIM * 2> cggl_flag;
@@ -131,6 +131,8 @@ template void ddSendrecv(const gmx_domdec_t*, int, int, gmx::ArrayRef<int>, gmx:
 template void ddSendrecv(const gmx_domdec_t*, int, int, gmx::ArrayRef<real>, gmx::ArrayRef<real>);
 //! Specialization of extern template for gmx::RVec
 template void ddSendrecv(const gmx_domdec_t*, int, int, gmx::ArrayRef<gmx::RVec>, gmx::ArrayRef<gmx::RVec>);
+//! Specialization of extern template for std::int64_t
+template void ddSendrecv(const gmx_domdec_t*, int, int, gmx::ArrayRef<std::int64_t>, gmx::ArrayRef<std::int64_t>);
 
 void dd_sendrecv2_rvec(const struct gmx_domdec_t gmx_unused* dd,
                        int gmx_unused ddimind,
@@ -203,6 +205,66 @@ void dd_sendrecv2_rvec(const struct gmx_domdec_t gmx_unused* dd,
 #endif
 }
 
+void ddIsendRvec(const gmx_domdec_t gmx_unused*            dd,
+                 int gmx_unused                            ddDimensionIndex,
+                 int gmx_unused                            direction,
+                 gmx::ArrayRef<const gmx::RVec> gmx_unused sendBuffer,
+                 int gmx_unused                            mpiTag,
+                 MPI_Request*                              request)
+{
+#if GMX_MPI
+    if (!sendBuffer.empty())
+    {
+        const int sendRank = dd->neighbor[ddDimensionIndex][direction == dddirForward ? 0 : 1];
+
+        /* MPI_Isend does not accept a const buffer pointer with MPI 2 */
+        MPI_Isend(const_cast<gmx::RVec*>(sendBuffer.data()), sendBuffer.size() * sizeof(gmx::RVec),
+                  MPI_BYTE, sendRank, mpiTag, dd->mpi_comm_all, request);
+    }
+    else
+    {
+        *request = MPI_REQUEST_NULL;
+    }
+#else
+    *request = nullptr;
+#endif
+}
+
+void ddIrecvRvec(const gmx_domdec_t gmx_unused*      dd,
+                 int gmx_unused                      ddDimensionIndex,
+                 int gmx_unused                      direction,
+                 gmx::ArrayRef<gmx::RVec> gmx_unused receiveBuffer,
+                 int gmx_unused                      mpiTag,
+                 MPI_Request*                        request)
+{
+#if GMX_MPI
+    if (!receiveBuffer.empty())
+    {
+        const int receiveRank = dd->neighbor[ddDimensionIndex][direction == dddirForward ? 1 : 0];
+
+        MPI_Irecv(receiveBuffer.data(), receiveBuffer.size() * sizeof(gmx::RVec), MPI_BYTE,
+                  receiveRank, mpiTag, dd->mpi_comm_all, request);
+    }
+    else
+    {
+        *request = MPI_REQUEST_NULL;
+    }
+#else
+    *request = nullptr;
+#endif
+}
+
+void ddWaitAll(gmx::ArrayRef<MPI_Request> gmx_unused requests)
+{
+#if GMX_MPI
+    if (!requests.empty())
+    {
+        // NOLINTNEXTLINE(clang-analyzer-optin.mpi.MPI-Checker)
+        MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+    }
+#endif
+}
+
 void dd_bcast(const gmx_domdec_t gmx_unused* dd, int gmx_unused nbytes, void gmx_unused* data)
 {
 #if GMX_MPI
@@ -49,8 +49,11 @@
 #ifndef GMX_DOMDEC_DOMDEC_NETWORK_H
 #define GMX_DOMDEC_DOMDEC_NETWORK_H
 
+#include <cstdint>
+
 #include "gromacs/math/vectypes.h"
 #include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/gmxmpi.h"
 
 struct gmx_domdec_t;
 
@@ -141,6 +144,13 @@ extern template void ddSendrecv<gmx::RVec>(const gmx_domdec_t*      dd,
                                            gmx::ArrayRef<gmx::RVec> sendBuffer,
                                            gmx::ArrayRef<gmx::RVec> receiveBuffer);
 
+//! Extern declaration for std::int64_t specialization
+extern template void ddSendrecv<std::int64_t>(const gmx_domdec_t*         dd,
+                                              int                         ddDimensionIndex,
+                                              int                         direction,
+                                              gmx::ArrayRef<std::int64_t> sendBuffer,
+                                              gmx::ArrayRef<std::int64_t> receiveBuffer);
+
 /*! \brief Move revc's in the comm. region one cell along the domain decomposition
  *
  * Moves in dimension indexed by ddimind, simultaneously in the forward
@@ -158,6 +168,39 @@ void dd_sendrecv2_rvec(const struct gmx_domdec_t* dd,
                        int                        n_r_bw);
 
 
+/*! \brief Starts a non-blocking send of rvec's in the comm. region one cell along
+ * the domain decomposition
+ *
+ * Sends in the dimension indexed by ddDimensionIndex, either forward
+ * (direction=dddirFoward) or backward (direction=dddirBackward).
+ * The contents of \p sendBuffer should not be changed until \p request
+ * has completed. When \p sendBuffer is empty, nothing is sent and
+ * \p request is set to the null request.
+ */
+void ddIsendRvec(const gmx_domdec_t*            dd,
+                 int                            ddDimensionIndex,
+                 int                            direction,
+                 gmx::ArrayRef<const gmx::RVec> sendBuffer,
+                 int                            mpiTag,
+                 MPI_Request*                   request);
+
+/*! \brief Starts a non-blocking receive of rvec's in the comm. region one cell along
+ * the domain decomposition
+ *
+ * Receives the data sent with ddIsendRvec() with the same dimension index,
+ * direction and tag. When \p receiveBuffer is empty, nothing is received
+ * and \p request is set to the null request.
+ */
+void ddIrecvRvec(const gmx_domdec_t*      dd,
+                 int                      ddDimensionIndex,
+                 int                      direction,
+                 gmx::ArrayRef<gmx::RVec> receiveBuffer,
+                 int                      mpiTag,
+                 MPI_Request*             request);
+
+/*! \brief Waits for the completion of all \p requests of non-blocking communication */
+void ddWaitAll(gmx::ArrayRef<MPI_Request> requests);
+
 /* The functions below perform the same operations as the MPI functions
  * with the same name appendices, but over the domain decomposition
  * nodes only.
@@ -1048,6 +1048,34 @@ static inline void check_assign_interactions_atom(int                       i,
 {
     gmx::ArrayRef<const DDPairInteractionRanges> iZones = zones->iZones;
 
+    /* Prefetch the global to local entries of the atoms of all
+     * multi-atom interactions of atom i, so the latencies of the lookups
+     * below overlap instead of adding up.
+     */
+    for (int j = ind_start; j < ind_end;)
+    {
+        const int ftype = rtil[j];
+        const int nral  = NRAL(ftype);
+        if (interaction_function[ftype].flags & IF_VSITE)
+        {
+            j += 2 + nral + 2;
+        }
+        else
+        {
+            if (nral >= 2)
+            {
+                int atomsGlobal[MAXATOMLIST];
+                for (int k = 0; k < nral; k++)
+                {
+                    atomsGlobal[k] = bInterMolInteractions ? rtil[j + 2 + k]
+                                                           : i_gl + rtil[j + 2 + k] - i_mol;
+                }
+                dd->ga2la->prefetch(gmx::constArrayRefFromArray(atomsGlobal, nral));
+            }
+            j += 2 + nral;
+        }
+    }
+
     int j = ind_start;
     while (j < ind_end)
     {
@@ -50,11 +50,11 @@
  * There are two methods implemented for finding the local atom number
  * belonging to a global atom number:
  * 1) a simple, direct array
- * 2) a hash table consisting of list of linked lists indexed with
- *    the global number modulo mod.
+ * 2) an open-addressing hash table with cache-line sized buckets indexed
+ *    with the global number modulo the table size.
  * Memory requirements:
  * 1) numAtomsTotal*2 ints
- * 2) numAtomsLocal*(2+1-2(1-e^-1/2))*4 ints
+ * 2) numAtomsLocal*(1.5 to 3)*3 ints
  * where numAtomsLocal is the number of atoms in the home + communicated zones.
  * Method 1 is faster for low parallelization, 2 for high parallelization.
  * We switch to method 2 when it uses less than half the memory method 1.
@@ -52,6 +52,7 @@
 #include <vector>
 
 #include "gromacs/domdec/hashedmap.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/gmxassert.h"
 
 /*! \libinternal \brief Global to local atom mapping
@@ -123,6 +124,30 @@ public:
         }
     }
 
+    /*! \brief Prefetches the entries for a batch of global atom indices
+     *
+     * Prefetching the entries of all atoms of one or more interactions
+     * before looking them up hides the memory latency of the lookups.
+     *
+     * \param[in] a_gl  The global atom indices
+     */
+    void prefetch(gmx::ArrayRef<const int> a_gl) const
+    {
+        for (const int a : a_gl)
+        {
+            if (usingDirect_)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                __builtin_prefetch(data_.direct.data() + a);
+#endif
+            }
+            else
+            {
+                data_.hashed.prefetch(a);
+            }
+        }
+    }
+
     //! Returns the local atom index if it is a home atom, nullptr otherwise
     const int* findHome(int a_gl) const
     {
@@ -53,8 +53,10 @@
 #include <vector>
 
 #include "gromacs/compat/utility.h"
+#include "gromacs/utility/alignedallocator.h"
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxassert.h"
 
 namespace gmx
 {
@@ -64,17 +66,38 @@ namespace gmx
  * Efficiently manages mapping from integer keys to values.
  * Note that this basically implements a subset of the functionality of
  * std::unordered_map, but is an order of magnitude faster.
+ *
+ * The table uses open addressing with buckets of c_bucketSize keys,
+ * which fill exactly one cache line. A key is looked up by comparing
+ * all keys in its home bucket at once, which compilers vectorize,
+ * and moving on to the next bucket only when the home bucket is full.
+ * The keys are hashed by masking, so consecutive keys, such as the global
+ * indices of the atoms in a molecule, share a bucket and a lookup of
+ * all atoms of a bonded interaction usually touches a single cache line.
+ *
+ * The two most negative integer values are reserved for marking
+ * empty and erased entries and can not be used as keys.
  */
 template<class T>
 class HashedMap
 {
 private:
-    /*! \libinternal \brief Structure for the key/value hash table */
-    struct hashEntry
+    //! The number of keys per bucket, chosen such that the keys fill a 64-byte cache line
+    static constexpr int c_bucketSize = 16;
+    //! Log2 of c_bucketSize
+    static constexpr int c_bucketSizeLog2 = 4;
+    //! Key value for empty entries, terminates a search
+    static constexpr int c_emptyKey = INT_MIN;
+    //! Key value for erased entries, does not terminate a search
+    static constexpr int c_erasedKey = INT_MIN + 1;
+
+    static_assert(c_bucketSize == (1 << c_bucketSizeLog2), "The bucket size should match its log2");
+
+    /*! \libinternal \brief A bucket with the keys and values for c_bucketSize entries */
+    struct Bucket
     {
-        int key = -1;  /**< The key */
-        T   value;     /**< The value(s) */
-        int next = -1; /**< Index in the list of the next element with the same hash, -1 if none */
+        int keys[c_bucketSize];   /**< The keys, c_emptyKey or c_erasedKey when not in use */
+        T   values[c_bucketSize]; /**< The values */
     };
 
     /*! \brief The table size is set to at least this factor time the nr of keys */
@@ -83,6 +106,66 @@ private:
     static constexpr float c_relTableSizeThresholdMin = 1.3;
     /*! \brief Threshold for decreasing the table size */
     static constexpr float c_relTableSizeThresholdMax = 3.5;
+    /*! \brief The maximum fraction of used and erased entries before we need to grow the table */
+    static constexpr float c_maxLoadFactor = 0.75;
+
+    //! Returns whether an entry with key \p key is free for storing a new element
+    static bool isFree(int key) { return key == c_emptyKey || key == c_erasedKey; }
+
+    //! Returns the index of the home bucket of \p key
+    int homeBucket(int key) const { return (key >> c_bucketSizeLog2) & bucketMask_; }
+
+    //! Returns the index of the bucket after \p bucket, wraps around at the end of the table
+    int nextBucket(int bucket) const { return (bucket + 1) & bucketMask_; }
+
+    /*! \brief Returns the entry index of \p key in \p bucket or -1 when not present
+     *
+     * This is written as a loop without early exit, so it is vectorized.
+     */
+    static int findInBucket(const Bucket& bucket, int key)
+    {
+        int index = -1;
+        for (int i = 0; i < c_bucketSize; i++)
+        {
+            index = (bucket.keys[i] == key ? i : index);
+        }
+        return index;
+    }
+
+    //! Returns whether \p bucket contains an empty entry
+    static bool bucketHasEmptyEntry(const Bucket& bucket)
+    {
+        bool haveEmpty = false;
+        for (int i = 0; i < c_bucketSize; i++)
+        {
+            haveEmpty = haveEmpty || (bucket.keys[i] == c_emptyKey);
+        }
+        return haveEmpty;
+    }
+
+    //! Sets all entries in the table to empty
+    void setAllEntriesEmpty()
+    {
+        for (Bucket& bucket : table_)
+        {
+            std::fill(std::begin(bucket.keys), std::end(bucket.keys), c_emptyKey);
+        }
+        numElements_ = 0;
+        numErased_   = 0;
+    }
+
+    /*! \brief Sets the number of entries in the table and clears all entries
+     *
+     * \param[in] tableSize  The number of entries, should be a power of 2 and a multiple of c_bucketSize
+     */
+    void setTableSize(int tableSize)
+    {
+        table_.resize(tableSize / c_bucketSize);
+        setAllEntriesEmpty();
+
+        /* Table size is a power of 2, so a binary mask gives the bucket */
+        bucketMask_ = tableSize / c_bucketSize - 1;
+    }
 
     /*! \brief Resizes the table
      *
@@ -92,24 +175,94 @@ private:
     {
         GMX_RELEASE_ASSERT(numElements_ == 0, "Table needs to be empty for resize");
 
-        /* The fraction of table entries with 0   size lists is e^-f.
-         * The fraction of table entries with >=1 size lists is 1 - e^-f
-         * where f is: the #elements / tableSize
-         * The fraction of elements not in the direct list is: 1 - (1 - e^-f)/f.
-         * Thus the optimal table size is roughly double #elements.
+        /* With buckets of a cache line, nearly all searches end in
+         * the home bucket up to a load of 2/3, so we use at least 1.5
+         * entries per element. Make the hash table a power of 2 and at least 64.
          */
-        /* Make the hash table a power of 2 and at least 1.5 * #elements */
         int tableSize = 64;
         while (tableSize <= INT_MAX / 2
                && static_cast<float>(numElementsEstimate) * c_relTableSizeSetMin > tableSize)
         {
             tableSize *= 2;
         }
-        table_.resize(tableSize);
+        setTableSize(tableSize);
+    }
+
+    /*! \brief Increases the table size when adding an element would exceed the maximum load
+     *
+     * Moves all elements to a new table of double the size, or of
+     * the same size when most of the load consists of erased entries.
+     */
+    void growIfNeeded()
+    {
+        const int tableSize = bucket_count();
+        if (static_cast<float>(numElements_ + numErased_ + 1) <= c_maxLoadFactor * tableSize)
+        {
+            return;
+        }
+
+        std::vector<Bucket, AlignedAllocator<Bucket>> oldTable;
+        oldTable.swap(table_);
+        const int numElements = numElements_;
+
+        if (static_cast<float>(numElements + 1) * 2 <= c_maxLoadFactor * tableSize)
+        {
+            setTableSize(tableSize);
+        }
+        else
+        {
+            GMX_RELEASE_ASSERT(tableSize <= INT_MAX / 2, "The table size should not overflow");
+            setTableSize(2 * tableSize);
+        }
+        for (const Bucket& bucket : oldTable)
+        {
+            for (int i = 0; i < c_bucketSize; i++)
+            {
+                if (!isFree(bucket.keys[i]))
+                {
+                    insertNew(bucket.keys[i], bucket.values[i]);
+                }
+            }
+        }
+        GMX_ASSERT(numElements_ == numElements, "All elements should be moved to the new table");
+    }
+
+    /*! \brief Inserts a key that is not present and a value, the table should have space
+     *
+     * Uses the entry matching the lower bits of the key when free,
+     * so consecutive keys are stored in order, otherwise the first
+     * free entry in the first bucket with free entries.
+     */
+    void insertNew(int key, const T& value)
+    {
+        int bucket = homeBucket(key);
+        int entry  = key & (c_bucketSize - 1);
+        while (true)
+        {
+            Bucket& b = table_[bucket];
+            if (!isFree(b.keys[entry]))
+            {
+                entry = 0;
+                while (entry < c_bucketSize && !isFree(b.keys[entry]))
+                {
+                    entry++;
+                }
+            }
+            if (entry < c_bucketSize)
+            {
+                if (b.keys[entry] == c_erasedKey)
+                {
+                    numErased_ -= 1;
+                }
+                b.keys[entry]   = key;
+                b.values[entry] = value;
+                numElements_ += 1;
 
-        /* Table size is a power of 2, so a binary mask gives the hash */
-        bitMask_                        = tableSize - 1;
-        startIndexForSpaceForListEntry_ = tableSize;
+                return;
+            }
+            bucket = nextBucket(bucket);
+            entry  = 0;
+        }
     }
 
 public:
@@ -126,8 +279,8 @@ public:
     /*! \brief Returns the number of elements */
     int size() const { return numElements_; }
 
-    /*! \brief Returns the number of buckets, i.e. the number of possible hashes */
-    int bucket_count() const { return bitMask_ + 1; }
+    /*! \brief Returns the number of entries in the table, i.e. the number of possible hashes */
+    int bucket_count() const { return static_cast<int>(table_.size()) * c_bucketSize; }
 
 private:
     /*! \brief Inserts or assigns a key and value
@@ -141,67 +294,33 @@ private:
     template<bool allowAssign>
     void insert_assign(int key, const T& value)
     {
-        size_t ind = (key & bitMask_);
+        GMX_ASSERT(!isFree(key), "The two most negative integers can not be used as keys");
 
-        if (table_[ind].key >= 0)
+        /* Searching for a present key is only required for assignment,
+         * for insertion we only check this in debug mode, as it is
+         * performance critical.
+         */
+#ifdef NDEBUG
+        if (allowAssign)
+#endif
         {
-            /* Loop over the entries for this hash.
-             * If we find the matching key, return the value.
-             */
-            int ind_prev = ind;
-            if (table_[ind_prev].key == key)
+            if (T* presentValue = find(key))
             {
                 if (allowAssign)
                 {
-                    table_[ind].value = value;
+                    *presentValue = value;
                     return;
                 }
                 else
                 {
-// Note: This is performance critical, so we only throw in debug mode
-#ifndef NDEBUG
                     GMX_THROW(InvalidInputError("Attempt to insert duplicate key"));
-#endif
-                }
-            }
-            while (table_[ind_prev].next >= 0)
-            {
-                ind_prev = table_[ind_prev].next;
-                if (table_[ind_prev].key == key)
-                {
-                    if (allowAssign)
-                    {
-                        table_[ind_prev].value = value;
-                        return;
-                    }
-                    else
-                    {
-#ifndef NDEBUG
-                        GMX_THROW(InvalidInputError("Attempt to insert duplicate key"));
-#endif
-                    }
                 }
             }
-            /* Search for space in table_ */
-            ind = startIndexForSpaceForListEntry_;
-            while (ind < table_.size() && table_[ind].key >= 0)
-            {
-                ind++;
-            }
-            /* If we are at the end of the list we need to increase the size */
-            if (ind == table_.size())
-            {
-                table_.resize(table_.size() + 1);
-            }
-            table_[ind_prev].next = ind;
-
-            startIndexForSpaceForListEntry_ = ind + 1;
         }
 
-        table_[ind].key   = key;
-        table_[ind].value = value;
+        growIfNeeded();
 
-        numElements_ += 1;
+        insertNew(key, value);
     }
 
 public:
@@ -209,7 +328,8 @@ public:
      *
      * \param[in] key    The key for the entry
      * \param[in] value  The value for the entry
-     * \throws InvalidInputError from a debug build when attempting to inser         */
+     * \throws InvalidInputError from a debug build when attempting to insert a duplicate key
+     */
     void insert(int key, const T& value) { insert_assign<false>(key, value); }
 
     /*! \brief Inserts an entry when the key is not present, otherwise sets the value
@@ -225,34 +345,37 @@ public:
      */
     void erase(int key)
     {
-        int ind_prev = -1;
-        int ind      = (key & bitMask_);
-        do
+        int bucket = homeBucket(key);
+        while (true)
         {
-            if (table_[ind].key == key)
+            Bucket&    b         = table_[bucket];
+            const int  entry     = findInBucket(b, key);
+            const bool haveEmpty = bucketHasEmptyEntry(b);
+            if (entry >= 0)
             {
-                if (ind_prev >= 0)
+                /* When the bucket has an empty entry, no search for
+                 * other keys continues past it and we can mark the entry
+                 * empty, otherwise we need to mark it as erased.
+                 */
+                if (haveEmpty)
                 {
-                    table_[ind_prev].next = table_[ind].next;
-
-                    /* This index is a linked entry, so we free an entry.
-                     * Check if we are creating the first empty space.
-                     */
-                    if (ind < startIndexForSpaceForListEntry_)
-                    {
-                        startIndexForSpaceForListEntry_ = ind;
-                    }
+                    b.keys[entry] = c_emptyKey;
+                }
+                else
+                {
+                    b.keys[entry] = c_erasedKey;
+                    numErased_ += 1;
                 }
-                table_[ind].key  = -1;
-                table_[ind].next = -1;
-
                 numElements_ -= 1;
 
                 return;
             }
-            ind_prev = ind;
-            ind      = table_[ind].next;
-        } while (ind >= 0);
+            if (haveEmpty)
+            {
+                return;
+            }
+            bucket = nextBucket(bucket);
+        }
     }
 
     /*! \brief Returns a pointer to the value for the given key or nullptr when not present
@@ -269,17 +392,40 @@ public:
      */
     const T* find(int key) const
     {
-        int ind = (key & bitMask_);
-        do
+        int bucket = homeBucket(key);
+        while (true)
         {
-            if (table_[ind].key == key)
+            const Bucket& b     = table_[bucket];
+            const int     entry = findInBucket(b, key);
+            if (entry >= 0)
             {
-                return &table_[ind].value;
+                return &b.values[entry];
             }
-            ind = table_[ind].next;
-        } while (ind >= 0);
+            if (bucketHasEmptyEntry(b))
+            {
+                return nullptr;
+            }
+            bucket = nextBucket(bucket);
+        }
+    }
 
-        return nullptr;
+    /*! \brief Prefetches the home bucket of \p key into cache
+     *
+     * Issuing prefetches for all keys of a batch before looking them up
+     * hides the memory latency of the lookups when the table does not
+     * fit in cache.
+     *
+     * \param[in] key  The key
+     */
+    void prefetch(int key) const
+    {
+        const Bucket& b = table_[homeBucket(key)];
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(b.keys);
+        __builtin_prefetch(b.values + (key & (c_bucketSize - 1)));
+#else
+        GMX_UNUSED_VALUE(b);
+#endif
     }
 
     /*! \brief Clear all the entries in the list
@@ -291,14 +437,6 @@ public:
     {
         const int oldNumElements = numElements_;
 
-        for (hashEntry& entry : table_)
-        {
-            entry.key  = -1;
-            entry.next = -1;
-        }
-        startIndexForSpaceForListEntry_ = bucket_count();
-        numElements_                    = 0;
-
         /* Resize the hash table when the occupation is far from optimal.
          * Do not resize with 0 elements to avoid minimal size when clear()
          * is called twice in a row.
@@ -307,19 +445,24 @@ public:
             && (oldNumElements * c_relTableSizeThresholdMax < bucket_count()
                 || oldNumElements * c_relTableSizeThresholdMin > bucket_count()))
         {
+            numElements_ = 0;
             resize(oldNumElements);
         }
+        else
+        {
+            setAllEntriesEmpty();
+        }
     }
 
 private:
-    /*! \brief The hash table list */
-    std::vector<hashEntry> table_;
-    /*! \brief The bit mask for computing the hash of a key */
-    int bitMask_ = 0;
-    /*! \brief Index in table_ at which to start looking for empty space for a new linked list entry */
-    int startIndexForSpaceForListEntry_ = 0;
+    /*! \brief The hash table, aligned to cache lines */
+    std::vector<Bucket, AlignedAllocator<Bucket>> table_;
+    /*! \brief The bit mask for computing the home bucket of a key */
+    int bucketMask_ = 0;
     /*! \brief The number of elements currently stored in the table */
     int numElements_ = 0;
+    /*! \brief The number of erased entries, which do not terminate searches */
+    int numErased_ = 0;
 };
 
 } // namespace gmx
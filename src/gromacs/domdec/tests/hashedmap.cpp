@@ -185,13 +185,23 @@ TEST(HashedMap, ResizesTable)
     // This test assumes the minimum bucket count is 64 or less
     EXPECT_LT(map.bucket_count(), 128);
 
-    for (int i = 0; i < 60; i++)
+    for (int i = 0; i < 40; i++)
     {
         map.insert(2 * i + 3, 'a');
     }
     EXPECT_LT(map.bucket_count(), 128);
 
-    // Check that the table size is double #elements after clear()
+    // Check that the table size is at least 1.5 times #elements after clear()
+    map.clear();
+    EXPECT_EQ(map.bucket_count(), 64);
+
+    for (int i = 0; i < 60; i++)
+    {
+        map.insert(2 * i + 3, 'a');
+    }
+    // Check that the table grows when the load gets too high
+    EXPECT_EQ(map.bucket_count(), 128);
+
     map.clear();
     EXPECT_EQ(map.bucket_count(), 128);
 
@@ -207,4 +217,96 @@ TEST(HashedMap, ResizesTable)
     EXPECT_LT(map.bucket_count(), 128);
 }
 
+// Check that keys overflowing their home bucket are found and erased
+TEST(HashedMap, OverflowsBuckets)
+{
+    gmx::HashedMap<int> map(100);
+
+    // Keys that differ by a multiple of the table size share a home bucket
+    const int largePowerOf2 = 1 << 16;
+    const int numKeys       = 40;
+
+    for (int i = 0; i < numKeys; i++)
+    {
+        map.insert(5 + i * largePowerOf2, i);
+    }
+    EXPECT_EQ(map.size(), numKeys);
+    for (int i = 0; i < numKeys; i++)
+    {
+        const int* value = map.find(5 + i * largePowerOf2);
+        ASSERT_FALSE(value == nullptr);
+        EXPECT_EQ(*value, i);
+    }
+
+    // Erase keys in full buckets, the keys after them should still be found
+    for (int i = 0; i < numKeys; i += 2)
+    {
+        map.erase(5 + i * largePowerOf2);
+    }
+    EXPECT_EQ(map.size(), numKeys / 2);
+    for (int i = 0; i < numKeys; i++)
+    {
+        const int* value = map.find(5 + i * largePowerOf2);
+        EXPECT_EQ(value == nullptr, i % 2 == 0);
+    }
+
+    // Reinsert in the erased entries
+    for (int i = 0; i < numKeys; i += 2)
+    {
+        map.insert(5 + i * largePowerOf2, -i);
+    }
+    for (int i = 0; i < numKeys; i++)
+    {
+        const int* value = map.find(5 + i * largePowerOf2);
+        ASSERT_FALSE(value == nullptr);
+        EXPECT_EQ(*value, i % 2 == 0 ? -i : i);
+    }
+}
+
+// Check that the table grows when inserting more elements than estimated
+TEST(HashedMap, GrowsOnInsert)
+{
+    gmx::HashedMap<int> map(10);
+
+    const int numKeys = 10000;
+    for (int i = 0; i < numKeys; i++)
+    {
+        map.insert(3 * i, i);
+    }
+    EXPECT_EQ(map.size(), numKeys);
+    EXPECT_GE(map.bucket_count(), numKeys);
+    for (int i = 0; i < numKeys; i++)
+    {
+        const int* value = map.find(3 * i);
+        ASSERT_FALSE(value == nullptr);
+        EXPECT_EQ(*value, i);
+        map.prefetch(3 * i + 1);
+        EXPECT_TRUE(map.find(3 * i + 1) == nullptr);
+    }
+}
+
+// Check that repeated insertion and erasing does not fill the table
+TEST(HashedMap, ReusesErasedEntries)
+{
+    gmx::HashedMap<int> map(64);
+
+    const int bucketCount = map.bucket_count();
+    for (int i = 0; i < 100 * bucketCount; i++)
+    {
+        map.insert(i, i);
+        if (i >= 8)
+        {
+            map.erase(i - 8);
+        }
+    }
+    EXPECT_EQ(map.size(), 8);
+    EXPECT_EQ(map.bucket_count(), bucketCount);
+    for (int i = 100 * bucketCount - 8; i < 100 * bucketCount; i++)
+    {
+        const int* value = map.find(i);
+        ASSERT_FALSE(value == nullptr);
+        EXPECT_EQ(*value, i);
+    }
+}
+
 } // namespace
@@ -0,0 +1,232 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Micro-benchmark for the global to local atom index lookup with HashedMap.
+ *
+ * Mimics the use of HashedMap in domain decomposition: a table is filled
+ * with the global indices of the home and communicated atoms, which consist
+ * of contiguous ranges of molecules, after which all atoms of bonded
+ * interactions are looked up. The table is cleared on every repartitioning.
+ * The timings are compared to std::unordered_map.
+ *
+ * \ingroup module_domdec
+ */
+#include "gmxpre.h"
+
+#include <chrono>
+#include <cstdio>
+
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/domdec/hashedmap.h"
+
+namespace
+{
+
+//! The number of atoms in a molecule, typical for a protein residue or lipid
+constexpr int c_numAtomsPerMolecule = 16;
+//! The number of atoms per interaction, as for dihedrals
+constexpr int c_numAtomsPerInteraction = 4;
+//! The number of times we repeat the fill and lookup
+constexpr int c_numRepeats = 20;
+
+//! Clock used for timing
+using Clock = std::chrono::steady_clock;
+
+//! Returns the elapsed time since \p start in milliseconds
+double msSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/*! \brief Returns the global atom indices of a domain
+ *
+ * Picks random molecules from a system of \p numAtomsTotal atoms until
+ * the domain contains \p numAtomsLocal atoms.
+ */
+std::vector<int> makeLocalAtoms(int numAtomsTotal, int numAtomsLocal, std::mt19937* rng)
+{
+    const int                          numMolecules = numAtomsTotal / c_numAtomsPerMolecule;
+    std::uniform_int_distribution<int> moleculeDist(0, numMolecules - 1);
+
+    std::vector<int> molecules;
+    while (static_cast<int>(molecules.size()) * c_numAtomsPerMolecule < numAtomsLocal)
+    {
+        molecules.push_back(moleculeDist(*rng));
+    }
+    std::sort(molecules.begin(), molecules.end());
+    molecules.erase(std::unique(molecules.begin(), molecules.end()), molecules.end());
+
+    std::vector<int> atoms;
+    for (int m : molecules)
+    {
+        for (int a = 0; a < c_numAtomsPerMolecule; a++)
+        {
+            atoms.push_back(m * c_numAtomsPerMolecule + a);
+        }
+    }
+    return atoms;
+}
+
+//! Returns lookups of interactions within molecules, with some atoms outside the domain
+std::vector<int> makeInteractionAtoms(const std::vector<int>& localAtoms, std::mt19937* rng)
+{
+    std::uniform_int_distribution<int> offsetDist(-2, c_numAtomsPerMolecule);
+
+    std::vector<int> atoms;
+    for (int a : localAtoms)
+    {
+        for (int i = 0; i < c_numAtomsPerInteraction; i++)
+        {
+            atoms.push_back(std::max(a + offsetDist(*rng), 0));
+        }
+    }
+    return atoms;
+}
+
+//! Runs the benchmark for HashedMap, returns the number of atoms found
+int benchmarkHashedMap(const std::vector<int>& localAtoms,
+                       const std::vector<int>& interactionAtoms,
+                       bool                    usePrefetch,
+                       double*                 fillTime,
+                       double*                 lookupTime)
+{
+    gmx::HashedMap<int> map(localAtoms.size());
+
+    int numFound = 0;
+    *fillTime    = 0;
+    *lookupTime  = 0;
+    for (int repeat = 0; repeat < c_numRepeats; repeat++)
+    {
+        auto start = Clock::now();
+        map.clear();
+        for (size_t i = 0; i < localAtoms.size(); i++)
+        {
+            map.insert(localAtoms[i], i);
+        }
+        *fillTime += msSince(start);
+
+        start = Clock::now();
+        for (size_t i = 0; i < interactionAtoms.size(); i += c_numAtomsPerInteraction)
+        {
+            if (usePrefetch)
+            {
+                for (int k = 0; k < c_numAtomsPerInteraction; k++)
+                {
+                    map.prefetch(interactionAtoms[i + k]);
+                }
+            }
+            for (int k = 0; k < c_numAtomsPerInteraction; k++)
+            {
+                numFound += (map.find(interactionAtoms[i + k]) != nullptr);
+            }
+        }
+        *lookupTime += msSince(start);
+    }
+    return numFound;
+}
+
+//! Runs the benchmark for std::unordered_map, returns the number of atoms found
+int benchmarkUnorderedMap(const std::vector<int>& localAtoms,
+                          const std::vector<int>& interactionAtoms,
+                          double*                 fillTime,
+                          double*                 lookupTime)
+{
+    std::unordered_map<int, int> map(localAtoms.size());
+
+    int numFound = 0;
+    *fillTime    = 0;
+    *lookupTime  = 0;
+    for (int repeat = 0; repeat < c_numRepeats; repeat++)
+    {
+        auto start = Clock::now();
+        map.clear();
+        for (size_t i = 0; i < localAtoms.size(); i++)
+        {
+            map.emplace(localAtoms[i], i);
+        }
+        *fillTime += msSince(start);
+
+        start = Clock::now();
+        for (int a : interactionAtoms)
+        {
+            numFound += (map.find(a) != map.end());
+        }
+        *lookupTime += msSince(start);
+    }
+    return numFound;
+}
+
+/*! \brief Prints fill and lookup times of HashedMap and std::unordered_map
+ *
+ * Not registered with CTest, run the hashedmap-benchmark executable by hand.
+ */
+TEST(HashedMapBenchmark, ComparesWithUnorderedMap)
+{
+    const int numAtomsTotal = 10000000;
+
+    std::mt19937 rng(1234);
+
+    printf("Global to local atom lookup, %d atoms total, %d repeats, times in ms\n",
+           numAtomsTotal, c_numRepeats);
+    printf("%10s %26s %26s %26s\n", "", "HashedMap", "HashedMap+prefetch", "std::unordered_map");
+    printf("%10s %13s %12s %13s %12s %13s %12s\n", "local", "fill", "lookup", "fill", "lookup",
+           "fill", "lookup");
+    for (int numAtomsLocal : { 1000, 5000, 20000, 100000, 500000 })
+    {
+        const std::vector<int> localAtoms = makeLocalAtoms(numAtomsTotal, numAtomsLocal, &rng);
+        const std::vector<int> interactionAtoms = makeInteractionAtoms(localAtoms, &rng);
+
+        double    fill[3], lookup[3];
+        const int numFound0 =
+                benchmarkHashedMap(localAtoms, interactionAtoms, false, &fill[0], &lookup[0]);
+        const int numFound1 =
+                benchmarkHashedMap(localAtoms, interactionAtoms, true, &fill[1], &lookup[1]);
+        const int numFound2 =
+                benchmarkUnorderedMap(localAtoms, interactionAtoms, &fill[2], &lookup[2]);
+        EXPECT_EQ(numFound2, numFound0);
+        EXPECT_EQ(numFound2, numFound1);
+        printf("%10zu %13.2f %12.2f %13.2f %12.2f %13.2f %12.2f\n", localAtoms.size(), fill[0],
+               lookup[0], fill[1], lookup[1], fill[2], lookup[2]);
+    }
+}
+
+} // namespace
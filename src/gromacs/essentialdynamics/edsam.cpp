@@ -45,6 +45,7 @@
 #include <ctime>
 
 #include <memory>
+#include <vector>
 
 #include "gromacs/commandline/filenm.h"
 #include "gromacs/domdec/domdec_struct.h"
@@ -285,6 +286,10 @@ struct t_do_edsam
     gmx_bool bUpdateShifts;       /* TRUE in NS steps to indicate that the
                                      ED shifts for this ED group need to
                                      be updated */
+    gmx_bool bLocalFit;           /* TRUE if, between NS steps, the fit and
+                                     the projections may be computed from
+                                     the local atoms with reductions instead
+                                     of assembling the collective positions */
 };
 
 
@@ -316,6 +321,13 @@ gmx_edsam* EssentialDynamics::getLegacyED()
 
 /* Function declarations */
 static void fit_to_reference(rvec* xcoll, rvec transvec, matrix rotmat, t_edpar* edi);
+static void fit_and_project_local(const rvec      x[],
+                                  t_eigvec*        vec,
+                                  t_edpar*         edi,
+                                  const matrix     box,
+                                  const t_commrec* cr,
+                                  rvec             transvec,
+                                  matrix           rotmat);
 static void translate_and_rotate(rvec* x, int nat, rvec transvec, matrix rotmat);
 static real rmsd_from_structure(rvec* x, struct gmx_edx* s);
 namespace
@@ -503,12 +515,14 @@ struct t_do_edfit
     double** om;
 };
 
-static void do_edfit(int natoms, rvec* xp, rvec* x, matrix R, t_edpar* edi)
+/* Determines the rotation matrix R from the correlation matrix u between the
+ * reference positions and the centered positions */
+static void do_edfit_from_matrix(const matrix u, matrix R, t_edpar* edi)
 {
     /* this is a copy of do_fit with some modifications */
-    int    c, r, n, j, i, irot;
-    double d[6], xnr, xpc;
-    matrix vh, vk, u;
+    int    c, r, j, i, irot;
+    double d[6];
+    matrix vh, vk;
     int    index;
     real   max_d;
 
@@ -547,21 +561,6 @@ static void do_edfit(int natoms, rvec* xp, rvec* x, matrix R, t_edpar* edi)
         }
     }
 
-    /* calculate the matrix U */
-    clear_mat(u);
-    for (n = 0; (n < natoms); n++)
-    {
-        for (c = 0; (c < DIM); c++)
-        {
-            xpc = xp[n][c];
-            for (r = 0; (r < DIM); r++)
-            {
-                xnr = x[n][r];
-                u[c][r] += xnr * xpc;
-            }
-        }
-    }
-
     /* construct loc->omega */
     /* loc->omega is symmetric -> loc->omega==loc->omega' */
     for (r = 0; (r < 6); r++)
@@ -630,6 +629,30 @@ static void do_edfit(int natoms, rvec* xp, rvec* x, matrix R, t_edpar* edi)
     }
 }
 
+static void do_edfit(int natoms, rvec* xp, rvec* x, matrix R, t_edpar* edi)
+{
+    int    c, r, n;
+    double xnr, xpc;
+    matrix u;
+
+    /* calculate the matrix U */
+    clear_mat(u);
+    for (n = 0; (n < natoms); n++)
+    {
+        for (c = 0; (c < DIM); c++)
+        {
+            xpc = xp[n][c];
+            for (r = 0; (r < DIM); r++)
+            {
+                xnr = x[n][r];
+                u[c][r] += xnr * xpc;
+            }
+        }
+    }
+
+    do_edfit_from_matrix(u, R, edi);
+}
+
 
 static void rmfit(int nat, rvec* xcoll, const rvec transvec, matrix rotmat)
 {
@@ -922,44 +945,55 @@ static void do_single_flood(FILE*            edo,
 
     buf = edi->buf->do_edsam;
 
-
-    /* Broadcast the positions of the AVERAGE structure such that they are known on
-     * every processor. Each node contributes its local positions x and stores them in
-     * the collective ED array buf->xcoll */
-    communicate_group_positions(cr, buf->xcoll, buf->shifts_xcoll, buf->extra_shifts_xcoll, bNS, x,
-                                edi->sav.nr, edi->sav.nr_loc, edi->sav.anrs_loc, edi->sav.c_ind,
-                                edi->sav.x_old, box);
-
-    /* Only assembly REFERENCE positions if their indices differ from the average ones */
-    if (!edi->bRefEqAv)
+    /* Between NS steps the shifts of the group atoms are known, so that the fit
+     * and the projections can be computed from the local atoms alone. The
+     * collective positions are only assembled when the shifts change and
+     * when the rmsd to the reference has to be written */
+    if (buf->bLocalFit && !bNS && !buf->bUpdateShifts && !do_per_step(step, edi->outfrq))
     {
-        communicate_group_positions(cr, buf->xc_ref, buf->shifts_xc_ref, buf->extra_shifts_xc_ref,
-                                    bNS, x, edi->sref.nr, edi->sref.nr_loc, edi->sref.anrs_loc,
-                                    edi->sref.c_ind, edi->sref.x_old, box);
+        fit_and_project_local(x, &edi->flood.vecs, edi, box, cr, transvec, rotmat);
     }
+    else
+    {
+        /* Broadcast the positions of the AVERAGE structure such that they are known on
+         * every processor. Each node contributes its local positions x and stores them in
+         * the collective ED array buf->xcoll */
+        communicate_group_positions(cr, buf->xcoll, buf->shifts_xcoll, buf->extra_shifts_xcoll,
+                                    bNS, x, edi->sav.nr, edi->sav.nr_loc, edi->sav.anrs_loc,
+                                    edi->sav.c_ind, edi->sav.x_old, box);
 
-    /* If bUpdateShifts was TRUE, the shifts have just been updated in get_positions.
-     * We do not need to update the shifts until the next NS step */
-    buf->bUpdateShifts = FALSE;
+        /* Only assembly REFERENCE positions if their indices differ from the average ones */
+        if (!edi->bRefEqAv)
+        {
+            communicate_group_positions(cr, buf->xc_ref, buf->shifts_xc_ref,
+                                        buf->extra_shifts_xc_ref, bNS, x, edi->sref.nr,
+                                        edi->sref.nr_loc, edi->sref.anrs_loc, edi->sref.c_ind,
+                                        edi->sref.x_old, box);
+        }
 
-    /* Now all nodes have all of the ED/flooding positions in edi->sav->xcoll,
-     * as well as the indices in edi->sav.anrs */
+        /* If bUpdateShifts was TRUE, the shifts have just been updated in get_positions.
+         * We do not need to update the shifts until the next NS step */
+        buf->bUpdateShifts = FALSE;
 
-    /* Fit the reference indices to the reference structure */
-    if (edi->bRefEqAv)
-    {
-        fit_to_reference(buf->xcoll, transvec, rotmat, edi);
-    }
-    else
-    {
-        fit_to_reference(buf->xc_ref, transvec, rotmat, edi);
-    }
+        /* Now all nodes have all of the ED/flooding positions in edi->sav->xcoll,
+         * as well as the indices in edi->sav.anrs */
 
-    /* Now apply the translation and rotation to the ED structure */
-    translate_and_rotate(buf->xcoll, edi->sav.nr, transvec, rotmat);
+        /* Fit the reference indices to the reference structure */
+        if (edi->bRefEqAv)
+        {
+            fit_to_reference(buf->xcoll, transvec, rotmat, edi);
+        }
+        else
+        {
+            fit_to_reference(buf->xc_ref, transvec, rotmat, edi);
+        }
 
-    /* Project fitted structure onto supbspace -> store in edi->flood.vecs.xproj */
-    project_to_eigvectors(buf->xcoll, &edi->flood.vecs, *edi);
+        /* Now apply the translation and rotation to the ED structure */
+        translate_and_rotate(buf->xcoll, edi->sav.nr, transvec, rotmat);
+
+        /* Project fitted structure onto supbspace -> store in edi->flood.vecs.xproj */
+        project_to_eigvectors(buf->xcoll, &edi->flood.vecs, *edi);
+    }
 
     if (!edi->flood.bConstForce)
     {
@@ -1998,6 +2032,111 @@ static inline void ed_unshift_single_coord(const matrix box, const rvec x, const
     }
 }
 
+
+/* Makes the local position x whole with the group shift is, i.e. the inverse
+ * of ed_unshift_single_coord */
+static inline void ed_shift_single_coord(const matrix box, const rvec x, const ivec is, rvec xs)
+{
+    const ivec minusShift = { -is[XX], -is[YY], -is[ZZ] };
+
+    ed_unshift_single_coord(box, x, minusShift, xs);
+}
+
+
+/* Determines the fit to the reference structure and the projections of the fitted
+ * positions onto the vectors vec without assembling the collective positions.
+ * Each rank only visits its local ED atoms, which it makes whole with the shifts
+ * that were determined in the last call to communicate_group_positions. The
+ * center, the correlation matrix with the reference structure and the projections
+ * are then obtained from two reductions of 3+3+9 and vec->neig doubles.
+ * The result is the same as from fit_to_reference, translate_and_rotate and
+ * project_to_eigvectors on the collective positions. */
+static void fit_and_project_local(const rvec       x[],
+                                  t_eigvec*        vec,
+                                  t_edpar*         edi,
+                                  const matrix     box,
+                                  const t_commrec* cr,
+                                  rvec             transvec,
+                                  matrix           rotmat)
+{
+    const t_do_edsam* buf = edi->buf->do_edsam;
+
+    /* The reference indices are only stored separately if they differ from the average ones */
+    const gmx_edx& sfit      = edi->bRefEqAv ? edi->sav : edi->sref;
+    const ivec*    fitShifts = edi->bRefEqAv ? buf->shifts_xcoll : buf->shifts_xc_ref;
+
+    /* Mass-weighted sum of the positions, sum of the reference positions and
+     * sum of the products of reference and current positions */
+    const int c_numFitSums          = 2 * DIM + DIM * DIM;
+    double    fitSums[c_numFitSums] = { 0 };
+    for (int i = 0; i < sfit.nr_loc; i++)
+    {
+        const int c = sfit.c_ind[i];
+        rvec      xs;
+        ed_shift_single_coord(box, x[sfit.anrs_loc[i]], fitShifts[c], xs);
+
+        for (int d = 0; d < DIM; d++)
+        {
+            fitSums[d] += edi->sref.m[c] * xs[d];
+            fitSums[DIM + d] += edi->sref.x[c][d];
+            for (int r = 0; r < DIM; r++)
+            {
+                fitSums[2 * DIM + d * DIM + r] += edi->sref.x[c][d] * xs[r];
+            }
+        }
+    }
+    gmx_sumd(c_numFitSums, fitSums, cr);
+
+    for (int d = 0; d < DIM; d++)
+    {
+        transvec[d] = -fitSums[d] / edi->sref.mtot;
+    }
+
+    /* Correlation matrix of the reference with the centered positions, as in do_edfit */
+    matrix u;
+    for (int c = 0; c < DIM; c++)
+    {
+        for (int r = 0; r < DIM; r++)
+        {
+            u[c][r] = fitSums[2 * DIM + c * DIM + r] + transvec[r] * fitSums[DIM + c];
+        }
+    }
+    do_edfit_from_matrix(u, rotmat, edi);
+
+    if (vec->neig == 0)
+    {
+        return;
+    }
+
+    /* Project the fitted local positions, relative to the average structure */
+    std::vector<double> proj(vec->neig, 0.0);
+    for (int i = 0; i < edi->sav.nr_loc; i++)
+    {
+        const int c = edi->sav.c_ind[i];
+        rvec      xs, dx;
+        ed_shift_single_coord(box, x[edi->sav.anrs_loc[i]], buf->shifts_xcoll[c], xs);
+        rvec_inc(xs, transvec);
+
+        /* Rotate like rotate_x does */
+        for (int d = 0; d < DIM; d++)
+        {
+            dx[d] = rotmat[XX][d] * xs[XX] + rotmat[YY][d] * xs[YY] + rotmat[ZZ][d] * xs[ZZ]
+                    - edi->sav.x[c][d];
+        }
+
+        for (int eig = 0; eig < vec->neig; eig++)
+        {
+            proj[eig] += edi->sav.sqrtm[c] * iprod(vec->vec[eig][c], dx);
+        }
+    }
+    gmx_sumd(vec->neig, proj.data(), cr);
+
+    for (int eig = 0; eig < vec->neig; eig++)
+    {
+        vec->xproj[eig] = proj[eig];
+    }
+}
+
 namespace
 {
 /*!\brief Apply fixed linear constraints to essential dynamics variable.
@@ -3031,6 +3170,7 @@ std::unique_ptr<gmx::EssentialDynamics> init_edsam(const gmx::MDLogger&        m
         /* Allocate space for ED buffer variables */
         snew_bc(cr, edi->buf, 1); /* MASTER has already allocated edi->buf in init_edi() */
         snew(edi->buf->do_edsam, 1);
+        edi->buf->do_edsam->bLocalFit = PAR(cr) && (getenv("GMX_NO_LOCAL_EDSAM") == nullptr);
 
         /* Space for collective ED buffer variables */
 
@@ -3097,6 +3237,16 @@ void do_edsam(const t_inputrec* ir, int64_t step, const t_commrec* cr, rvec xs[]
                 buf->oldrad = calc_radius(edi.vecs.radacc);
             }
 
+            /* When the positions are only monitored, nothing needs to be computed between
+             * output steps. The collective positions still need to be assembled after
+             * repartitioning, such that the shifts of the group stay up to date. */
+            if (buf->bLocalFit && !buf->bUpdateShifts && !ed_constraints(ed->eEDtype, edi)
+                && edi.vecs.radfix.neig == 0 && edi.vecs.radacc.neig == 0
+                && !do_per_step(step, edi.outfrq))
+            {
+                continue;
+            }
+
             /* Copy the positions into buf->xc* arrays and after ED
              * feed back corrections to the official positions */
 
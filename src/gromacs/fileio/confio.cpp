@@ -463,18 +463,17 @@ void readConfAndTopology(const char* infile,
     *haveTopology = fn2bTPX(infile);
     if (*haveTopology)
     {
-        TpxFileHeader header = readTpxHeader(infile, true);
+        TprSectionReader reader(infile, true);
         if (x)
         {
-            snew(*x, header.natoms);
+            snew(*x, reader.header().natoms);
         }
         if (v)
         {
-            snew(*v, header.natoms);
+            snew(*v, reader.header().natoms);
         }
-        int     natoms;
-        PbcType pbcType_tmp = read_tpx(infile, nullptr, box, &natoms, (x == nullptr) ? nullptr : *x,
-                                       (v == nullptr) ? nullptr : *v, mtop);
+        PbcType pbcType_tmp = reader.read(nullptr, box, (x == nullptr) ? nullptr : *x,
+                                          (v == nullptr) ? nullptr : *v, mtop);
         if (pbcType != nullptr)
         {
             *pbcType = pbcType_tmp;
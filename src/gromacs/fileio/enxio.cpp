@@ -43,6 +43,7 @@
 #include <cstring>
 
 #include <algorithm>
+#include <vector>
 
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/gmxfio_xdr.h"
@@ -55,6 +56,7 @@
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/trajectory/energyframe.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/compare.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
@@ -90,10 +92,15 @@ typedef struct
 
 struct ener_file
 {
-    ener_old_t eo;
-    t_fileio*  fio;
-    int        framenr;
-    real       frametime;
+    ener_old_t        eo;
+    t_fileio*         fio;
+    int               framenr;
+    real              frametime;
+    bool              selectTerms;  /* Only read the terms set in readTerm */
+    std::vector<bool> readTerm;     /* Which energy terms to read */
+    bool              selectBlocks; /* Only read the blocks in readBlockIds */
+    std::vector<int>  readBlockIds; /* The ids of the blocks to read */
+    gmx_off_t         fileSize;     /* File size at the last check, for skipping data */
 };
 
 static void enxsubblock_init(t_enxsubblock* sb)
@@ -769,7 +776,7 @@ void done_ener_file(ener_file_t ef)
 {
     // Free the contents, then the pointer itself
     close_enx(ef);
-    sfree(ef);
+    delete ef;
 }
 
 /*!\brief Return TRUE if a file exists but is empty, otherwise FALSE.
@@ -808,7 +815,7 @@ ener_file_t open_enx(const char* fn, const char* mode)
     gmx_bool          bWrongPrecision, bOK = TRUE;
     struct ener_file* ef;
 
-    snew(ef, 1);
+    ef = new ener_file();
 
     if (mode[0] == 'r')
     {
@@ -950,12 +957,176 @@ static void convert_full_sums(ener_old_t* ener_old, t_enxframe* fr)
     ener_old->step_prev = fr->step;
 }
 
+/* Returns the number of bytes nr items of type take in an XDR file,
+ * or -1 when this depends on the contents, as for strings */
+static gmx_off_t xdr_data_size(xdr_datatype type, int nr)
+{
+    switch (type)
+    {
+        /* XDR stores each char in 4 bytes */
+        case xdr_datatype_int:
+        case xdr_datatype_float:
+        case xdr_datatype_char: return 4 * static_cast<gmx_off_t>(nr);
+        case xdr_datatype_double:
+        case xdr_datatype_int64: return 8 * static_cast<gmx_off_t>(nr);
+        default: return -1;
+    }
+}
+
+/* Moves the read position of ef nbytes forward. Returns FALSE when
+ * that is past the end of the file, i.e. the frame is incomplete. */
+static gmx_bool enx_skip(ener_file_t ef, gmx_off_t nbytes)
+{
+    gmx_off_t pos;
+
+    if (nbytes == 0)
+    {
+        return TRUE;
+    }
+    pos = gmx_fio_ftell(ef->fio) + nbytes;
+    if (pos > ef->fileSize)
+    {
+        /* The file might have grown since we last checked */
+        FILE* fp = gmx_fio_getfp(ef->fio);
+        gmx_off_t current = gmx_ftell(fp);
+        gmx_fseek(fp, 0, SEEK_END);
+        ef->fileSize = gmx_ftell(fp);
+        gmx_fseek(fp, current, SEEK_SET);
+    }
+
+    return pos <= ef->fileSize && gmx_fio_seek(ef->fio, pos) == 0;
+}
+
+static gmx_bool do_enxsubblock(ener_file_t ef, t_enxsubblock* sub)
+{
+    gmx_bool bOK = TRUE;
+
+    if (gmx_fio_getread(ef->fio))
+    {
+        enxsubblock_alloc(sub);
+    }
+
+    /* read/write data */
+    switch (sub->type)
+    {
+        case xdr_datatype_float: bOK = gmx_fio_ndo_float(ef->fio, sub->fval, sub->nr); break;
+        case xdr_datatype_double: bOK = gmx_fio_ndo_double(ef->fio, sub->dval, sub->nr); break;
+        case xdr_datatype_int: bOK = gmx_fio_ndo_int(ef->fio, sub->ival, sub->nr); break;
+        case xdr_datatype_int64: bOK = gmx_fio_ndo_int64(ef->fio, sub->lval, sub->nr); break;
+        case xdr_datatype_char: bOK = gmx_fio_ndo_uchar(ef->fio, sub->cval, sub->nr); break;
+        case xdr_datatype_string: bOK = gmx_fio_ndo_string(ef->fio, sub->sval, sub->nr); break;
+        default:
+            gmx_incons(
+                    "Reading unknown block data type: this file is corrupted or from the "
+                    "future");
+    }
+
+    return bOK;
+}
+
+/* Returns the number of bytes in the file that the energies of a frame
+ * with header fr take per energy term */
+static gmx_off_t enx_term_size(ener_file_t ef, const t_enxframe* fr, int file_version)
+{
+    int nreal = 1;
+
+    if (file_version == 1)
+    {
+        /* e, eav, esum and an old, unused real */
+        nreal = 4;
+    }
+    else if (fr->nsum > 0)
+    {
+        nreal = 3;
+    }
+
+    return nreal * (gmx_fio_is_double(ef->fio) ? sizeof(double) : sizeof(float));
+}
+
+void enx_select_terms(ener_file_t ef, gmx::ArrayRef<const int> terms)
+{
+    ef->selectTerms = true;
+    ef->readTerm.clear();
+    for (int term : terms)
+    {
+        if (term >= static_cast<int>(ef->readTerm.size()))
+        {
+            ef->readTerm.resize(term + 1, false);
+        }
+        ef->readTerm[term] = true;
+    }
+}
+
+void enx_select_blocks(ener_file_t ef, gmx::ArrayRef<const int> blockIds)
+{
+    ef->selectBlocks = true;
+    ef->readBlockIds.assign(blockIds.begin(), blockIds.end());
+}
+
+std::vector<EnxFrameIndexEntry> enx_frame_index(ener_file_t ef)
+{
+    std::vector<EnxFrameIndexEntry> index;
+    t_enxframe                      fr;
+    int                             file_version = -1;
+    gmx_bool                        bOK          = TRUE;
+    gmx_off_t                       start, offset;
+
+    if (ef->eo.bOldFileOpen)
+    {
+        return index;
+    }
+
+    start  = gmx_fio_ftell(ef->fio);
+    offset = start;
+    init_enxframe(&fr);
+    while (do_eheader(ef, &file_version, &fr, -1, nullptr, &bOK))
+    {
+        bOK = enx_skip(ef, fr.nre * enx_term_size(ef, &fr, file_version));
+        for (int b = 0; b < fr.nblock && bOK; b++)
+        {
+            for (int i = 0; i < fr.block[b].nsub && bOK; i++)
+            {
+                t_enxsubblock* sub      = &(fr.block[b].sub[i]);
+                gmx_off_t      dataSize = xdr_data_size(sub->type, sub->nr);
+                if (dataSize >= 0)
+                {
+                    bOK = enx_skip(ef, dataSize);
+                }
+                else
+                {
+                    bOK = do_enxsubblock(ef, sub);
+                }
+            }
+        }
+        if (!bOK)
+        {
+            break;
+        }
+        index.push_back({ offset, fr.step, fr.t });
+        offset = gmx_fio_ftell(ef->fio);
+    }
+    free_enxframe(&fr);
+    gmx_fio_seek(ef->fio, start);
+
+    return index;
+}
+
+void enx_seek_frame(ener_file_t ef, const EnxFrameIndexEntry& entry)
+{
+    if (gmx_fio_seek(ef->fio, entry.offset) != 0)
+    {
+        gmx_file("Cannot seek to an energy frame; the file might be corrupt");
+    }
+}
+
 gmx_bool do_enx(ener_file_t ef, t_enxframe* fr)
 {
-    int      file_version = -1;
-    int      i, b;
-    gmx_bool bRead, bOK, bOK1, bSane;
-    real     tmp1, tmp2, rdum;
+    int       file_version = -1;
+    int       i, b;
+    gmx_bool  bRead, bOK, bSane, bSelectTerms;
+    real      tmp1, tmp2, rdum;
+    gmx_off_t termSize, skipSize;
+    int       nblockRead;
     /*int       d_size;*/
 
     bOK   = TRUE;
@@ -1021,8 +1192,25 @@ gmx_bool do_enx(ener_file_t ef, t_enxframe* fr)
         fr->e_alloc = fr->nre;
     }
 
+    /* The sums of old files can only be converted with all terms present */
+    bSelectTerms = bRead && ef->selectTerms && !ef->eo.bOldFileOpen;
+    termSize     = enx_term_size(ef, fr, file_version);
+    skipSize     = 0;
     for (i = 0; i < fr->nre; i++)
     {
+        if (bSelectTerms
+            && (i >= static_cast<int>(ef->readTerm.size()) || !ef->readTerm[i]))
+        {
+            /* Skip the data of consecutive unselected terms at once */
+            fr->ener[i].e    = 0;
+            fr->ener[i].eav  = 0;
+            fr->ener[i].esum = 0;
+            skipSize += termSize;
+            continue;
+        }
+        bOK      = bOK && enx_skip(ef, skipSize);
+        skipSize = 0;
+
         bOK = bOK && gmx_fio_do_real(ef->fio, fr->ener[i].e);
 
         /* Do not store sums of length 1,
@@ -1053,6 +1241,7 @@ gmx_bool do_enx(ener_file_t ef, t_enxframe* fr)
             }
         }
     }
+    bOK = bOK && enx_skip(ef, skipSize);
 
     /* Here we can not check for file_version==1, since one could have
      * continued an old format simulation with a new one with mdrun -append.
@@ -1063,48 +1252,48 @@ gmx_bool do_enx(ener_file_t ef, t_enxframe* fr)
         convert_full_sums(&(ef->eo), fr);
     }
     /* read the blocks */
+    nblockRead = 0;
     for (b = 0; b < fr->nblock; b++)
     {
         /* now read the subblocks. */
-        int nsub = fr->block[b].nsub; /* shortcut */
-        int i;
+        int       nsub      = fr->block[b].nsub; /* shortcut */
+        gmx_bool  bUseBlock = TRUE;
+        gmx_off_t blockSize = 0;
 
-        for (i = 0; i < nsub; i++)
+        if (bRead && ef->selectBlocks)
         {
-            t_enxsubblock* sub = &(fr->block[b].sub[i]); /* shortcut */
+            const std::vector<int>& ids = ef->readBlockIds;
+            bUseBlock = (std::find(ids.begin(), ids.end(), fr->block[b].id) != ids.end());
+        }
+        for (i = 0; i < nsub && !bUseBlock && blockSize >= 0; i++)
+        {
+            gmx_off_t subSize = xdr_data_size(fr->block[b].sub[i].type, fr->block[b].sub[i].nr);
+            blockSize         = (subSize >= 0 ? blockSize + subSize : -1);
+        }
 
-            if (bRead)
+        if (!bUseBlock && blockSize >= 0)
+        {
+            bOK = bOK && enx_skip(ef, blockSize);
+        }
+        else
+        {
+            for (i = 0; i < nsub; i++)
             {
-                enxsubblock_alloc(sub);
+                bOK = do_enxsubblock(ef, &(fr->block[b].sub[i])) && bOK;
             }
+        }
 
-            /* read/write data */
-            switch (sub->type)
+        if (bUseBlock)
+        {
+            /* Keep the used blocks at the start of the block list */
+            if (b != nblockRead)
             {
-                case xdr_datatype_float:
-                    bOK1 = gmx_fio_ndo_float(ef->fio, sub->fval, sub->nr);
-                    break;
-                case xdr_datatype_double:
-                    bOK1 = gmx_fio_ndo_double(ef->fio, sub->dval, sub->nr);
-                    break;
-                case xdr_datatype_int: bOK1 = gmx_fio_ndo_int(ef->fio, sub->ival, sub->nr); break;
-                case xdr_datatype_int64:
-                    bOK1 = gmx_fio_ndo_int64(ef->fio, sub->lval, sub->nr);
-                    break;
-                case xdr_datatype_char:
-                    bOK1 = gmx_fio_ndo_uchar(ef->fio, sub->cval, sub->nr);
-                    break;
-                case xdr_datatype_string:
-                    bOK1 = gmx_fio_ndo_string(ef->fio, sub->sval, sub->nr);
-                    break;
-                default:
-                    gmx_incons(
-                            "Reading unknown block data type: this file is corrupted or from the "
-                            "future");
+                std::swap(fr->block[b], fr->block[nblockRead]);
             }
-            bOK = bOK && bOK1;
+            nblockRead++;
         }
     }
+    fr->nblock = nblockRead;
 
     if (!bRead)
     {
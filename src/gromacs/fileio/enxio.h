@@ -38,8 +38,11 @@
 #ifndef GMX_FILEIO_ENXIO_H
 #define GMX_FILEIO_ENXIO_H
 
+#include <vector>
+
 #include "gromacs/fileio/xdr_datatype.h"
 #include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/futil.h"
 #include "gromacs/utility/real.h"
 
 struct SimulationGroups;
@@ -49,6 +52,12 @@ struct t_fileio;
 struct t_inputrec;
 class t_state;
 
+namespace gmx
+{
+template<typename>
+class ArrayRef;
+} // namespace gmx
+
 /**************************************************************
  * These are the base datatypes + functions for reading and
  * writing energy files (.edr). They are either called directly
@@ -178,6 +187,36 @@ void free_enxnms(int n, gmx_enxnm_t* nms);
 gmx_bool do_enx(ener_file_t ef, t_enxframe* fr);
 /* Reads enx_frames, memory in fr is (re)allocated if necessary */
 
+void enx_select_terms(ener_file_t ef, gmx::ArrayRef<const int> terms);
+/* Makes do_enx only read the energy terms with the indices in terms,
+ * the data of the other terms is skipped and set to zero in the frame.
+ * Pre 4.1 files are always read completely, since converting their
+ * energy sums needs all terms.
+ */
+
+void enx_select_blocks(ener_file_t ef, gmx::ArrayRef<const int> blockIds);
+/* Makes do_enx only read the blocks with an id in blockIds, the other
+ * blocks are skipped and are not present in the frame.
+ */
+
+/* The location, step and time of a frame in an energy file */
+struct EnxFrameIndexEntry
+{
+    gmx_off_t offset;
+    int64_t   step;
+    double    t;
+};
+
+std::vector<EnxFrameIndexEntry> enx_frame_index(ener_file_t ef);
+/* Returns the index of the frames from the current position in ef to the
+ * end of the file, reading only the frame headers. The file position is
+ * restored afterwards. Returns an empty index for pre 4.1 files, which
+ * can only be read sequentially.
+ */
+
+void enx_seek_frame(ener_file_t ef, const EnxFrameIndexEntry& entry);
+/* Makes the next do_enx call read the frame of entry */
+
 void get_enx_state(const char* fn, real t, const SimulationGroups& groups, t_inputrec* ir, t_state* state);
 /*
  * Reads state variables from enx file fn at time t.
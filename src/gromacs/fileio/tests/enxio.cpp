@@ -0,0 +1,269 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for selective and indexed reading of energy files.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/enxio.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/trajectory/energyframe.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/futil.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Number of energy terms in the test file
+const int c_numTerms = 4;
+//! Number of frames in the test file
+const int c_numFrames = 5;
+//! Number of values in the histogram block
+const int c_numHistogramValues = 1000;
+
+//! Returns the energy of \p term in \p frame of the test file
+real energyValue(int frame, int term)
+{
+    return 10 * frame + term;
+}
+
+//! Writes an energy file with energy terms and three blocks of different types per frame
+void writeEnergyFile(const std::string& filename)
+{
+    ener_file_t  ef  = open_enx(filename.c_str(), "w");
+    int          nre = c_numTerms;
+    gmx_enxnm_t* names;
+    snew(names, c_numTerms);
+    for (int i = 0; i < c_numTerms; i++)
+    {
+        names[i].name = gmx_strdup(("Term " + std::to_string(i)).c_str());
+        names[i].unit = gmx_strdup("kJ/mol");
+    }
+    do_enxnms(ef, &nre, &names);
+
+    std::vector<float>  histogram(c_numHistogramValues);
+    std::vector<double> collection = { 298, 0, 0.002, 0.5, 0 };
+    std::vector<int>    ints       = { 1, 2, 3, 4, 5, 6, 7 };
+
+    t_enxframe fr;
+    init_enxframe(&fr);
+    fr.nre     = c_numTerms;
+    fr.e_alloc = c_numTerms;
+    snew(fr.ener, c_numTerms);
+    fr.nsum   = 10;
+    fr.nsteps = 10;
+    fr.dt     = 0.002;
+    add_blocks_enxframe(&fr, 3);
+    const int          blockIds[] = { enxDHHIST, enxDHCOLL, enxDH };
+    const xdr_datatype types[]    = { xdr_datatype_float, xdr_datatype_double, xdr_datatype_int };
+    const int          sizes[]    = { c_numHistogramValues, static_cast<int>(collection.size()),
+                                      static_cast<int>(ints.size()) };
+    for (int b = 0; b < 3; b++)
+    {
+        fr.block[b].id = blockIds[b];
+        add_subblocks_enxblock(&fr.block[b], 1);
+        fr.block[b].sub[0].type = types[b];
+        fr.block[b].sub[0].nr   = sizes[b];
+    }
+    // The frame does not own these, so free_enxframe() leaves them alone
+    fr.block[0].sub[0].fval = histogram.data();
+    fr.block[1].sub[0].dval = collection.data();
+    fr.block[2].sub[0].ival = ints.data();
+
+    for (int f = 0; f < c_numFrames; f++)
+    {
+        fr.step = 10 * f;
+        fr.t    = 0.02 * f;
+        for (int i = 0; i < c_numTerms; i++)
+        {
+            fr.ener[i].e    = energyValue(f, i);
+            fr.ener[i].eav  = 2 * energyValue(f, i);
+            fr.ener[i].esum = 3 * energyValue(f, i);
+        }
+        for (int j = 0; j < c_numHistogramValues; j++)
+        {
+            histogram[j] = f + j;
+        }
+        collection[1] = fr.t;
+        ints.back()   = f;
+        do_enx(ef, &fr);
+    }
+
+    free_enxframe(&fr);
+    free_enxnms(nre, names);
+    done_ener_file(ef);
+}
+
+class EnergyFileReadTest : public ::testing::Test
+{
+public:
+    EnergyFileReadTest() : filename_(fileManager_.getTemporaryFilePath("energy.edr"))
+    {
+        writeEnergyFile(filename_);
+        ef_ = open_enx(filename_.c_str(), "r");
+        int          nre;
+        gmx_enxnm_t* names = nullptr;
+        do_enxnms(ef_, &nre, &names);
+        free_enxnms(nre, names);
+        init_enxframe(&fr_);
+    }
+    ~EnergyFileReadTest() override
+    {
+        free_enxframe(&fr_);
+        done_ener_file(ef_);
+    }
+
+    TestFileManager fileManager_;
+    std::string     filename_;
+    ener_file_t     ef_;
+    t_enxframe      fr_;
+};
+
+TEST_F(EnergyFileReadTest, ReadsAllDataWithoutSelection)
+{
+    for (int f = 0; f < c_numFrames; f++)
+    {
+        ASSERT_TRUE(do_enx(ef_, &fr_));
+        EXPECT_EQ(10 * f, fr_.step);
+        ASSERT_EQ(c_numTerms, fr_.nre);
+        for (int i = 0; i < c_numTerms; i++)
+        {
+            EXPECT_EQ(energyValue(f, i), fr_.ener[i].e);
+            EXPECT_EQ(3 * energyValue(f, i), fr_.ener[i].esum);
+        }
+        ASSERT_EQ(3, fr_.nblock);
+        EXPECT_EQ(enxDHHIST, fr_.block[0].id);
+        EXPECT_EQ(f + c_numHistogramValues - 1, fr_.block[0].sub[0].fval[c_numHistogramValues - 1]);
+        EXPECT_DOUBLE_EQ(0.02 * f, fr_.block[1].sub[0].dval[1]);
+        EXPECT_EQ(f, fr_.block[2].sub[0].ival[6]);
+    }
+    EXPECT_FALSE(do_enx(ef_, &fr_));
+}
+
+TEST_F(EnergyFileReadTest, SkipsUnselectedTermsAndBlocks)
+{
+    const int terms[]    = { 1, 3 };
+    const int blockIds[] = { enxDH };
+    enx_select_terms(ef_, terms);
+    enx_select_blocks(ef_, blockIds);
+    for (int f = 0; f < c_numFrames; f++)
+    {
+        ASSERT_TRUE(do_enx(ef_, &fr_));
+        EXPECT_EQ(10 * f, fr_.step);
+        ASSERT_EQ(c_numTerms, fr_.nre);
+        for (int i = 0; i < c_numTerms; i++)
+        {
+            const real expected = (i == 1 || i == 3) ? energyValue(f, i) : 0;
+            EXPECT_EQ(expected, fr_.ener[i].e);
+            EXPECT_EQ(2 * expected, fr_.ener[i].eav);
+        }
+        ASSERT_EQ(1, fr_.nblock);
+        EXPECT_EQ(enxDH, fr_.block[0].id);
+        ASSERT_EQ(7, fr_.block[0].sub[0].nr);
+        EXPECT_EQ(f, fr_.block[0].sub[0].ival[6]);
+    }
+    EXPECT_FALSE(do_enx(ef_, &fr_));
+}
+
+TEST_F(EnergyFileReadTest, SkipsAllTermsAndBlocks)
+{
+    enx_select_terms(ef_, {});
+    enx_select_blocks(ef_, {});
+    for (int f = 0; f < c_numFrames; f++)
+    {
+        ASSERT_TRUE(do_enx(ef_, &fr_));
+        EXPECT_EQ(10 * f, fr_.step);
+        EXPECT_EQ(0, fr_.nblock);
+    }
+    EXPECT_FALSE(do_enx(ef_, &fr_));
+}
+
+TEST_F(EnergyFileReadTest, IndexesAndSeeksFrames)
+{
+    const std::vector<EnxFrameIndexEntry> index = enx_frame_index(ef_);
+    ASSERT_EQ(c_numFrames, static_cast<int>(index.size()));
+    for (int f = 0; f < c_numFrames; f++)
+    {
+        EXPECT_EQ(10 * f, index[f].step);
+        EXPECT_DOUBLE_EQ(0.02 * f, index[f].t);
+    }
+
+    // The index leaves the file at the first frame
+    ASSERT_TRUE(do_enx(ef_, &fr_));
+    EXPECT_EQ(0, fr_.step);
+
+    enx_seek_frame(ef_, index[3]);
+    ASSERT_TRUE(do_enx(ef_, &fr_));
+    EXPECT_EQ(30, fr_.step);
+    EXPECT_EQ(energyValue(3, 2), fr_.ener[2].e);
+    ASSERT_EQ(3, fr_.nblock);
+    EXPECT_EQ(3, fr_.block[2].sub[0].ival[6]);
+}
+
+TEST_F(EnergyFileReadTest, IndexLeavesOutIncompleteFrame)
+{
+    // Cut the file in the middle of the histogram block of the last frame
+    const std::vector<EnxFrameIndexEntry> index = enx_frame_index(ef_);
+    ASSERT_EQ(c_numFrames, static_cast<int>(index.size()));
+    done_ener_file(ef_);
+    ASSERT_EQ(0, gmx_truncate(filename_, index.back().offset + 1000));
+
+    ef_ = open_enx(filename_.c_str(), "r");
+    int          nre;
+    gmx_enxnm_t* names = nullptr;
+    do_enxnms(ef_, &nre, &names);
+    free_enxnms(nre, names);
+    EXPECT_EQ(c_numFrames - 1, static_cast<int>(enx_frame_index(ef_).size()));
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
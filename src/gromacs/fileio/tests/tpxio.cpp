@@ -0,0 +1,150 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for reading sections of tpr files.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/tpxio.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/state.h"
+#include "gromacs/topology/topology.h"
+
+#include "testutils/testasserts.h"
+#include "testutils/tprfilegenerator.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+class TprSectionReaderTest : public ::testing::Test
+{
+public:
+    TprSectionReaderTest() : tprHandle_("lysozyme")
+    {
+        read_tpx_state(tprHandle_.tprName().c_str(), &ir_, &state_, &mtop_);
+    }
+
+protected:
+    //! The generated tpr file.
+    TprAndFileManager tprHandle_;
+    //! The input record from reading the complete file.
+    t_inputrec ir_;
+    //! The state from reading the complete file.
+    t_state state_;
+    //! The topology from reading the complete file.
+    gmx_mtop_t mtop_;
+};
+
+TEST_F(TprSectionReaderTest, ReadsSectionsLikeCompleteRead)
+{
+    TprSectionReader reader(tprHandle_.tprName().c_str(), false);
+    ASSERT_TRUE(reader.hasSectionOffsets());
+    EXPECT_EQ(state_.natoms, reader.header().natoms);
+
+    matrix            box;
+    t_inputrec        ir;
+    gmx_mtop_t        mtop;
+    std::vector<RVec> x(reader.header().natoms);
+    std::vector<RVec> v(reader.header().natoms);
+    EXPECT_EQ(ir_.pbcType, reader.read(&ir, box, as_rvec_array(x.data()),
+                                       as_rvec_array(v.data()), &mtop));
+
+    for (int d = 0; d < DIM; d++)
+    {
+        for (int e = 0; e < DIM; e++)
+        {
+            EXPECT_EQ(state_.box[d][e], box[d][e]);
+        }
+    }
+    EXPECT_EQ(ir_.nsteps, ir.nsteps);
+    EXPECT_EQ(ir_.rlist, ir.rlist);
+    EXPECT_EQ(mtop_.natoms, mtop.natoms);
+    ASSERT_EQ(mtop_.moltype.size(), mtop.moltype.size());
+    EXPECT_STREQ(*mtop_.moltype[0].name, *mtop.moltype[0].name);
+    for (int i = 0; i < state_.natoms; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_EQ(state_.x[i][d], x[i][d]);
+            EXPECT_EQ(state_.v[i][d], v[i][d]);
+        }
+    }
+}
+
+TEST_F(TprSectionReaderTest, ReadsSingleSections)
+{
+    TprSectionReader reader(tprHandle_.tprName().c_str(), true);
+
+    std::vector<RVec> v(reader.header().natoms);
+    reader.read(nullptr, nullptr, nullptr, as_rvec_array(v.data()), nullptr);
+    EXPECT_EQ(state_.v[state_.natoms - 1][ZZ], v[state_.natoms - 1][ZZ]);
+
+    t_inputrec ir;
+    EXPECT_EQ(ir_.pbcType, reader.read(&ir, nullptr, nullptr, nullptr, nullptr));
+    EXPECT_EQ(ir_.nsteps, ir.nsteps);
+
+    gmx_mtop_t mtop;
+    reader.read(nullptr, nullptr, nullptr, nullptr, &mtop);
+    EXPECT_EQ(mtop_.natoms, mtop.natoms);
+}
+
+TEST_F(TprSectionReaderTest, ReadTpxReadsRequestedSections)
+{
+    matrix            box;
+    int               natoms = 0;
+    std::vector<RVec> x(state_.natoms);
+    gmx_mtop_t        mtop;
+    EXPECT_EQ(ir_.pbcType, read_tpx(tprHandle_.tprName().c_str(), nullptr, box, &natoms,
+                                    as_rvec_array(x.data()), nullptr, &mtop));
+    EXPECT_EQ(state_.natoms, natoms);
+    EXPECT_EQ(state_.box[XX][XX], box[XX][XX]);
+    EXPECT_EQ(state_.x[0][XX], x[0][XX]);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -131,6 +131,7 @@ enum tpxv
     tpxv_VSite2FD,                  /**< Added 2FD type virtual site */
     tpxv_AddSizeField, /**< Added field with information about the size of the serialized tpr file in bytes, excluding the header */
     tpxv_StoreNonBondedInteractionExclusionGroup, /**< Store the non bonded interaction exclusion group in the topology */
+    tpxv_AddBodySectionOffsets, /**< Added a trailer with the offsets of the sections to the tpr body */
     tpxv_Count                                    /**< the total number of tpxv versions */
 };
 
@@ -3164,6 +3165,84 @@ static void doTpxBodyBuffer(gmx::ISerializer* serializer, gmx::ArrayRef<char> bu
     serializer->doOpaque(buffer.data(), buffer.size());
 }
 
+//! The size in bytes of the trailer with the section offsets at the end of the TPR body.
+static constexpr int64_t c_sizeOfTpxBodySectionOffsets = 3 * sizeof(int64_t);
+
+/*! \brief
+ * Processes the trailer with the offsets of the sections of the TPR body.
+ *
+ * The trailer follows the input record, so readers that do not know
+ * about it, i.e. of an older tpx version of the same generation, can
+ * still read the body and ignore it.
+ *
+ * \param[in] serializer The serializer to use.
+ * \param[in,out] tpx The file header holding the offsets.
+ */
+static void doTpxBodySectionOffsets(gmx::ISerializer* serializer, TpxFileHeader* tpx)
+{
+    serializer->doInt64(&tpx->topologyOffset);
+    serializer->doInt64(&tpx->coordinatesOffset);
+    serializer->doInt64(&tpx->inputrecOffset);
+}
+
+/*! \brief
+ * Serializes the TPR body for writing and sets the section offsets in the header.
+ *
+ * Produces the same data as do_tpx_body(), but serializes each of its
+ * sections separately, so that the offset of each section in the body
+ * is known and can be stored in a trailer at the end of the body. This
+ * allows reading sections without decoding the whole body, see
+ * TprSectionReader.
+ *
+ * \param[in,out] tpx The file header, whose body size and offsets are set.
+ * \param[in] ir Parameter and system information.
+ * \param[in] state The simulation state.
+ * \param[in] mtop Global topology.
+ * \returns The serialized body.
+ */
+static std::vector<char> serializeTpxBodySections(TpxFileHeader* tpx,
+                                                  t_inputrec*    ir,
+                                                  t_state*       state,
+                                                  gmx_mtop_t*    mtop)
+{
+    std::vector<char> tprBody;
+    // Big endian as for the complete body, see write_tpx_state().
+    const auto appendSection = [&tprBody](gmx::InMemorySerializer* serializer) {
+        const std::vector<char> section = serializer->finishAndGetBuffer();
+        tprBody.insert(tprBody.end(), section.begin(), section.end());
+    };
+    {
+        gmx::InMemorySerializer serializer(gmx::EndianSwapBehavior::SwapIfHostIsLittleEndian);
+        do_tpx_state_first(&serializer, tpx, state);
+        appendSection(&serializer);
+    }
+    tpx->topologyOffset = tprBody.size();
+    {
+        gmx::InMemorySerializer serializer(gmx::EndianSwapBehavior::SwapIfHostIsLittleEndian);
+        do_tpx_mtop(&serializer, tpx, mtop);
+        appendSection(&serializer);
+    }
+    tpx->coordinatesOffset = tprBody.size();
+    {
+        gmx::InMemorySerializer serializer(gmx::EndianSwapBehavior::SwapIfHostIsLittleEndian);
+        do_tpx_state_second(&serializer, tpx, state, nullptr, nullptr);
+        appendSection(&serializer);
+    }
+    tpx->inputrecOffset = tprBody.size();
+    {
+        gmx::InMemorySerializer serializer(gmx::EndianSwapBehavior::SwapIfHostIsLittleEndian);
+        do_tpx_ir(&serializer, tpx, ir);
+        appendSection(&serializer);
+    }
+    {
+        gmx::InMemorySerializer serializer(gmx::EndianSwapBehavior::SwapIfHostIsLittleEndian);
+        doTpxBodySectionOffsets(&serializer, tpx);
+        appendSection(&serializer);
+    }
+    tpx->sizeOfTprBody = tprBody.size();
+    return tprBody;
+}
+
 /*! \brief
  * Populates simulation datastructures.
  *
@@ -3263,14 +3342,10 @@ void write_tpx_state(const char* fn, const t_inputrec* ir, const t_state* state,
     // but since we just used the default XDR format (which is big endian) for the TPR
     // header it would cause third-party libraries reading our raw data to tear their hair
     // if we swap the endian in the middle of the file, so we stick to big endian in the
-    // TPR file for now - and thus we ask the serializer to swap if this host is little endian.
-    gmx::InMemorySerializer tprBodySerializer(gmx::EndianSwapBehavior::SwapIfHostIsLittleEndian);
-
-    do_tpx_body(&tprBodySerializer, &tpx, const_cast<t_inputrec*>(ir), const_cast<t_state*>(state),
-                nullptr, nullptr, const_cast<gmx_mtop_t*>(mtop));
-
-    std::vector<char> tprBody = tprBodySerializer.finishAndGetBuffer();
-    tpx.sizeOfTprBody         = tprBody.size();
+    // TPR file for now - and thus we serialize with swapping if this host is little endian.
+    std::vector<char> tprBody =
+            serializeTpxBodySections(&tpx, const_cast<t_inputrec*>(ir),
+                                     const_cast<t_state*>(state), const_cast<gmx_mtop_t*>(mtop));
 
     fio = open_tpx(fn, "w");
     gmx::FileIOXdrSerializer serializer(fio);
@@ -3320,25 +3395,13 @@ PartialDeserializedTprFile read_tpx_state(const char* fn, t_inputrec* ir, t_stat
 
 PbcType read_tpx(const char* fn, t_inputrec* ir, matrix box, int* natoms, rvec* x, rvec* v, gmx_mtop_t* mtop)
 {
-    t_fileio* fio;
-    t_state   state;
-
-    TpxFileHeader tpx;
-    fio = open_tpx(fn, "r");
-    gmx::FileIOXdrSerializer serializer(fio);
-    do_tpxheader(&serializer, &tpx, fn, fio, ir == nullptr);
-    PartialDeserializedTprFile partialDeserializedTpr =
-            readTpxBody(&tpx, &serializer, ir, &state, x, v, mtop);
-    close_tpx(fio);
+    TprSectionReader reader(fn, ir == nullptr);
+    PbcType          pbcType = reader.read(ir, box, x, v, mtop);
     if (mtop != nullptr && natoms != nullptr)
     {
         *natoms = mtop->natoms;
     }
-    if (box)
-    {
-        copy_mat(state.box, box);
-    }
-    return partialDeserializedTpr.pbcType;
+    return pbcType;
 }
 
 PbcType read_tpx_top(const char* fn, t_inputrec* ir, matrix box, int* natoms, rvec* x, rvec* v, t_topology* top)
@@ -3353,6 +3416,132 @@ PbcType read_tpx_top(const char* fn, t_inputrec* ir, matrix box, int* natoms, rv
     return pbcType;
 }
 
+TprSectionReader::TprSectionReader(const char* fileName, bool canReadTopologyOnly) :
+    fileName_(fileName),
+    fio_(open_tpx(fileName, "r")),
+    bodyFileOffset_(0)
+{
+    gmx::FileIOXdrSerializer serializer(fio_);
+    do_tpxheader(&serializer, &header_, fileName, fio_, canReadTopologyOnly);
+    bodyFileOffset_ = gmx_fio_ftell(fio_);
+    if (hasSectionOffsets())
+    {
+        const std::vector<char> buffer = readBodyBytes(
+                header_.sizeOfTprBody - c_sizeOfTpxBodySectionOffsets, header_.sizeOfTprBody);
+        gmx::InMemoryDeserializer serializer(buffer, header_.isDouble,
+                                             gmx::EndianSwapBehavior::SwapIfHostIsLittleEndian);
+        doTpxBodySectionOffsets(&serializer, &header_);
+    }
+}
+
+TprSectionReader::~TprSectionReader()
+{
+    close_tpx(fio_);
+}
+
+bool TprSectionReader::hasSectionOffsets() const
+{
+    return header_.fileVersion >= tpxv_AddBodySectionOffsets && header_.fileGeneration >= 27;
+}
+
+std::vector<char> TprSectionReader::readBodyBytes(int64_t begin, int64_t end)
+{
+    std::vector<char> buffer(end - begin);
+    FILE*             fp = gmx_fio_getfp(fio_);
+    if (gmx_fseek(fp, bodyFileOffset_ + begin, SEEK_SET) != 0
+        || fread(buffer.data(), 1, buffer.size(), fp) != buffer.size())
+    {
+        gmx_fatal(FARGS, "Could not read the run input file %s, it might be truncated",
+                  fileName_.c_str());
+    }
+    return buffer;
+}
+
+PbcType TprSectionReader::read(t_inputrec* ir, matrix box, rvec* x, rvec* v, gmx_mtop_t* mtop)
+{
+    // The section functions only read from the header, but take a mutable one
+    TpxFileHeader header = header_;
+    t_state       state;
+    if (!hasSectionOffsets())
+    {
+        // Reading velocities requires reading coordinates as well
+        std::vector<gmx::RVec> temporaryX;
+        if (x == nullptr && v != nullptr)
+        {
+            temporaryX.resize(header.natoms);
+            x = as_rvec_array(temporaryX.data());
+        }
+        gmx_fio_seek(fio_, bodyFileOffset_);
+        gmx::FileIOXdrSerializer   serializer(fio_);
+        PartialDeserializedTprFile partialDeserializedTpr =
+                readTpxBody(&header, &serializer, ir, &state, x, v, mtop);
+        if (box)
+        {
+            copy_mat(state.box, box);
+        }
+        return partialDeserializedTpr.pbcType;
+    }
+
+    const gmx::EndianSwapBehavior endianSwap = gmx::EndianSwapBehavior::SwapIfHostIsLittleEndian;
+    if (box)
+    {
+        const std::vector<char>   buffer = readBodyBytes(0, header.topologyOffset);
+        gmx::InMemoryDeserializer serializer(buffer, header.isDouble, endianSwap);
+        do_tpx_state_first(&serializer, &header, &state);
+        copy_mat(state.box, box);
+    }
+    if (mtop)
+    {
+        const std::vector<char> buffer =
+                readBodyBytes(header.topologyOffset, header.coordinatesOffset);
+        gmx::InMemoryDeserializer serializer(buffer, header.isDouble, endianSwap);
+        do_tpx_mtop(&serializer, &header, mtop);
+    }
+
+    // The coordinates and velocities have a fixed size, so they can be located directly
+    const int64_t sizeOfVectors =
+            int64_t(header.natoms) * DIM * (header.isDouble ? sizeof(double) : sizeof(float));
+    const int64_t velocitiesOffset = header.coordinatesOffset + (header.bX ? sizeOfVectors : 0);
+    if (x)
+    {
+        if (!header.bX)
+        {
+            gmx_fatal(FARGS, "No x in input file");
+        }
+        const std::vector<char> buffer =
+                readBodyBytes(header.coordinatesOffset, header.coordinatesOffset + sizeOfVectors);
+        gmx::InMemoryDeserializer serializer(buffer, header.isDouble, endianSwap);
+        serializer.doRvecArray(x, header.natoms);
+    }
+    if (v)
+    {
+        if (!header.bV)
+        {
+            gmx_fatal(FARGS, "No v in input file");
+        }
+        const std::vector<char> buffer =
+                readBodyBytes(velocitiesOffset, velocitiesOffset + sizeOfVectors);
+        gmx::InMemoryDeserializer serializer(buffer, header.isDouble, endianSwap);
+        serializer.doRvecArray(v, header.natoms);
+    }
+
+    // The input record also stores the PBC type, so read it even when ir is not requested
+    PbcType pbcType = PbcType::Unset;
+    if (header.bIr)
+    {
+        const std::vector<char> buffer = readBodyBytes(
+                header.inputrecOffset, header.sizeOfTprBody - c_sizeOfTpxBodySectionOffsets);
+        gmx::InMemoryDeserializer serializer(buffer, header.isDouble, endianSwap);
+        pbcType = do_tpx_ir(&serializer, &header, ir);
+    }
+    else if (ir)
+    {
+        gmx_fatal(FARGS, "No ir in input file");
+    }
+    do_tpx_finalize(&header, ir, nullptr, mtop);
+    return pbcType;
+}
+
 gmx_bool fn2bTPX(const char* file)
 {
     return (efTPR == fn2ftp(file));
@@ -40,17 +40,20 @@
 
 #include <cstdio>
 
+#include <string>
 #include <vector>
 
 #include "gromacs/math/vectypes.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/classhelpers.h"
 #include "gromacs/utility/real.h"
 
 struct gmx_mtop_t;
 struct t_atoms;
 struct t_block;
+struct t_fileio;
 struct t_inputrec;
 class t_state;
 struct t_topology;
@@ -89,6 +92,16 @@ struct TpxFileHeader
        index. Eventually, should probably be a vector. MRS*/
     //! Size of the TPR body in chars (equal to number of bytes) during I/O.
     int64_t sizeOfTprBody = 0;
+    /*! \brief Offset of the topology in the TPR body in bytes.
+     *
+     * This and the following offsets are stored in a trailer at the end
+     * of the TPR body, and are only set by TprSectionReader and when writing.
+     */
+    int64_t topologyOffset = 0;
+    //! Offset of the coordinates, followed by the velocities, in the TPR body in bytes.
+    int64_t coordinatesOffset = 0;
+    //! Offset of the input record in the TPR body in bytes.
+    int64_t inputrecOffset = 0;
     //! File version.
     int fileVersion = 0;
     //! File generation.
@@ -211,6 +224,62 @@ PbcType read_tpx(const char* fn, t_inputrec* ir, matrix box, int* natoms, rvec*
 PbcType read_tpx_top(const char* fn, t_inputrec* ir, matrix box, int* natoms, rvec* x, rvec* v, t_topology* top);
 /* As read_tpx, but for the old t_topology struct */
 
+/*! \libinternal
+ * \brief
+ * Reads only the requested sections of a tpr file.
+ *
+ * Constructing the reader reads the file header and keeps the file open.
+ * Files written since the body ends with the offsets of its sections
+ * (box, topology, coordinates and velocities, input record) are then
+ * read section by section: only the bytes of the requested sections are
+ * read from disk and decoded, so e.g. the topology of a large system can
+ * be read without reading its coordinates. Older files are decoded
+ * completely, as before.
+ */
+class TprSectionReader
+{
+public:
+    /*! \brief
+     * Opens \p fileName and reads its header.
+     *
+     * \param[in] fileName            The name of the input file.
+     * \param[in] canReadTopologyOnly If reading the inputrec can be skipped or not,
+     *                                as for readTpxHeader().
+     */
+    TprSectionReader(const char* fileName, bool canReadTopologyOnly);
+    ~TprSectionReader();
+
+    //! Returns the header of the file.
+    const TpxFileHeader& header() const { return header_; }
+    //! Returns whether sections can be read without decoding the whole file.
+    bool hasSectionOffsets() const;
+
+    /*! \brief
+     * Reads the sections for which a non-null output is passed.
+     *
+     * The arguments behave as for read_tpx(), and it is a fatal error to
+     * request a section that is not present in the file.
+     *
+     * \returns ir->pbcType if it was read from the file.
+     */
+    PbcType read(t_inputrec* ir, matrix box, rvec* x, rvec* v, gmx_mtop_t* mtop);
+
+private:
+    //! Reads bytes [\p begin, \p end) of the body from disk.
+    std::vector<char> readBodyBytes(int64_t begin, int64_t end);
+
+    //! The name of the file.
+    std::string fileName_;
+    //! The open file.
+    t_fileio* fio_;
+    //! The header of the file.
+    TpxFileHeader header_;
+    //! The position of the body in the file in bytes.
+    int64_t bodyFileOffset_;
+
+    GMX_DISALLOW_COPY_AND_ASSIGN(TprSectionReader);
+};
+
 gmx_bool fn2bTPX(const char* file);
 /* return if *file is one of the TPX file types */
 
@@ -351,6 +351,40 @@ gmx_bool gmx_trr_read_frame_data(t_fileio* fio, gmx_trr_header_t* header, rvec*
     return do_trr_frame_data(fio, header, box, x, v, f);
 }
 
+gmx_bool gmx_trr_read_frame_raw(t_fileio*          fio,
+                                gmx_trr_header_t*  header,
+                                std::vector<char>* data,
+                                gmx_bool*          bOK)
+{
+    if (!do_trr_frame_header(fio, true, header, bOK))
+    {
+        return FALSE;
+    }
+    if (header->ir_size || header->e_size || header->top_size || header->sym_size)
+    {
+        gmx_file("Unsupported data in trr file");
+    }
+    data->resize(header->box_size + header->vir_size + header->pres_size + header->x_size
+                 + header->v_size + header->f_size);
+    *bOK = gmx_fio_do_opaque(fio, data->data(), data->size());
+
+    return *bOK;
+}
+
+void gmx_trr_write_frame_raw(t_fileio*                fio,
+                             const gmx_trr_header_t&  header,
+                             const std::vector<char>& data)
+{
+    gmx_trr_header_t sh = header;
+    gmx_bool         bOK;
+
+    if (!do_trr_frame_header(fio, false, &sh, &bOK)
+        || !gmx_fio_do_opaque(fio, const_cast<char*>(data.data()), data.size()))
+    {
+        gmx_file("Cannot write trajectory frame; maybe you are out of disk space?");
+    }
+}
+
 t_fileio* gmx_trr_open(const char* fn, const char* mode)
 {
     return gmx_fio_open(fn, mode);
@@ -38,6 +38,8 @@
 #ifndef GMX_FILEIO_TRRIO_H
 #define GMX_FILEIO_TRRIO_H
 
+#include <vector>
+
 #include "gromacs/math/vectypes.h"
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/real.h"
@@ -111,6 +113,23 @@ gmx_bool gmx_trr_read_frame_data(struct t_fileio* fio, gmx_trr_header_t* sh, rve
  * Return FALSE on error
  */
 
+gmx_bool gmx_trr_read_frame_raw(struct t_fileio*   fio,
+                                gmx_trr_header_t*  header,
+                                std::vector<char>* data,
+                                gmx_bool*          bOK);
+/* Read a frame without decoding its contents. The header is read into
+ * header and the box, x, v and f data are stored in data in their
+ * encoded form, so they can be written again by gmx_trr_write_frame_raw().
+ * Return FALSE if there is no frame, bOK will be FALSE when it is incomplete.
+ */
+
+void gmx_trr_write_frame_raw(struct t_fileio*         fio,
+                             const gmx_trr_header_t&  header,
+                             const std::vector<char>& data);
+/* Write a frame read by gmx_trr_read_frame_raw(), possibly with a changed
+ * step, time or lambda in the header.
+ */
+
 gmx_bool gmx_trr_read_frame(struct t_fileio* fio,
                             int64_t*         step,
                             real*            t,
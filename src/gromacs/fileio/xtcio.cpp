@@ -39,6 +39,7 @@
 
 #include "xtcio.h"
 
+#include <cstdint>
 #include <cstring>
 
 #include "gromacs/fileio/gmxfio.h"
@@ -285,3 +286,96 @@ int read_next_xtc(t_fileio* fio, int natoms, int64_t* step, real* time, matrix b
 
     return static_cast<int>(*bOK);
 }
+
+/* Reads size encoded bytes and appends them to data */
+static int xtc_append_bytes(XDR* xd, std::vector<char>* data, int size)
+{
+    if (size < 0)
+    {
+        return 0;
+    }
+    size_t offset = data->size();
+    data->resize(offset + size);
+    return xdr_opaque(xd, data->data() + offset, size);
+}
+
+/* Decodes the XDR (big-endian) integer stored at the end of data */
+static int xtc_last_int(const std::vector<char>& data)
+{
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data.data() + data.size() - 4);
+    return static_cast<int32_t>((static_cast<uint32_t>(bytes[0]) << 24)
+                                | (static_cast<uint32_t>(bytes[1]) << 16)
+                                | (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3]);
+}
+
+int read_next_xtc_raw(t_fileio*          fio,
+                      int*               natoms,
+                      int64_t*           step,
+                      real*              time,
+                      std::vector<char>* data,
+                      gmx_bool*          bOK)
+{
+    int  magic;
+    int  result;
+    XDR* xd;
+
+    *bOK = TRUE;
+    xd   = gmx_fio_getxdr(fio);
+
+    /* read header */
+    if (!xtc_header(xd, &magic, natoms, step, time, TRUE, bOK))
+    {
+        return 0;
+    }
+
+    /* Check magic number */
+    check_xtc_magic(magic);
+
+    /* The layout follows xdr3dfcoord(): box, number of atoms and then
+     * either uncompressed coordinates for up to 9 atoms, or the
+     * precision, minint[3], maxint[3], smallidx, the byte count and the
+     * compressed bytes padded to a multiple of 4.
+     */
+    data->clear();
+    result = XTC_CHECK("box", xtc_append_bytes(xd, data, (DIM * DIM + 1) * 4));
+    if (result)
+    {
+        int size = xtc_last_int(*data);
+        if (size <= 9)
+        {
+            result = XTC_CHECK("x", xtc_append_bytes(xd, data, size * DIM * 4));
+        }
+        else
+        {
+            result = XTC_CHECK("x", xtc_append_bytes(xd, data, (1 + 2 * DIM + 1 + 1) * 4));
+            if (result)
+            {
+                int numBytes    = xtc_last_int(*data);
+                int paddedBytes = (numBytes < 0) ? -1 : (numBytes + 3) / 4 * 4;
+                result          = XTC_CHECK("x", xtc_append_bytes(xd, data, paddedBytes));
+            }
+        }
+    }
+    *bOK = (result != 0);
+
+    return result;
+}
+
+int write_xtc_raw(t_fileio* fio, int natoms, int64_t step, real time, const std::vector<char>& data)
+{
+    int      magic_number = XTC_MAGIC;
+    XDR*     xd;
+    gmx_bool bDum;
+
+    xd = gmx_fio_getxdr(fio);
+    if (xtc_header(xd, &magic_number, &natoms, &step, &time, FALSE, &bDum) == 0)
+    {
+        return 0;
+    }
+    if (XTC_CHECK("data", xdr_opaque(xd, const_cast<char*>(data.data()), data.size())) == 0)
+    {
+        return 0;
+    }
+
+    return static_cast<int>(gmx_fio_flush(fio) == 0);
+}
@@ -39,6 +39,8 @@
 #ifndef GMX_FILEIO_XTCIO_H
 #define GMX_FILEIO_XTCIO_H
 
+#include <vector>
+
 #include "gromacs/math/vectypes.h"
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/real.h"
@@ -78,4 +80,22 @@ int read_next_xtc(struct t_fileio* fio, int natoms, int64_t* step, real* time, m
 int write_xtc(struct t_fileio* fio, int natoms, int64_t step, real time, const rvec* box, const rvec* x, real prec);
 /* Write a frame to xtc file */
 
+int read_next_xtc_raw(struct t_fileio*   fio,
+                      int*               natoms,
+                      int64_t*           step,
+                      real*              time,
+                      std::vector<char>* data,
+                      gmx_bool*          bOK);
+/* Read the next frame without decompressing the coordinates.
+ * The box and the compressed coordinates are stored in data in their
+ * encoded form, so the frame can be written again with write_xtc_raw().
+ */
+
+int write_xtc_raw(struct t_fileio*         fio,
+                  int                      natoms,
+                  int64_t                  step,
+                  real                     time,
+                  const std::vector<char>& data);
+/* Write a frame read by read_next_xtc_raw(), with a new step and time */
+
 #endif
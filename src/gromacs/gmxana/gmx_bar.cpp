@@ -53,6 +53,7 @@
 #include "gromacs/mdlib/energyoutput.h"
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/trajectory/energyframe.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/dir_separator.h"
@@ -3052,6 +3053,10 @@ static void read_barsim_edr(const char* fn, real* temp, sim_data_t* sd)
 
     fp = open_enx(fn, "r");
     do_enxnms(fp, &nre, &enm);
+    /* We only need the free-energy blocks, not the energy terms */
+    const int dhBlockIds[] = { enxDHCOLL, enxDH, enxDHHIST };
+    enx_select_terms(fp, {});
+    enx_select_blocks(fp, dhBlockIds);
     snew(fr, 1);
 
     snew(native_lambda, 1);
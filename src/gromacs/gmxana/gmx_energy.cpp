@@ -48,6 +48,7 @@
 #include "gromacs/correlationfunctions/autocorr.h"
 #include "gromacs/fileio/enxio.h"
 #include "gromacs/fileio/gmxfio.h"
+#include "gromacs/fileio/timecontrol.h"
 #include "gromacs/fileio/tpxio.h"
 #include "gromacs/fileio/trxio.h"
 #include "gromacs/fileio/xvgr.h"
@@ -64,6 +65,7 @@
 #include "gromacs/topology/mtop_util.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/trajectory/energyframe.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/fatalerror.h"
@@ -1247,6 +1249,8 @@ static void fec(const char*             ene2fn,
     enm = nullptr;
     enx = open_enx(ene2fn, "r");
     do_enxnms(enx, &(fr->nre), &enm);
+    enx_select_terms(enx, gmx::arrayRefFromArray(set, nset));
+    enx_select_blocks(enx, {});
 
     snew(eneset2, nset + 1);
     nenergy2  = 0;
@@ -1884,6 +1888,31 @@ int gmx_energy(int argc, char* argv[])
         get_dhdl_parms(ftp2fn(efTPR, NFILE, fnm), ir);
     }
 
+    /* Only read the energy terms and blocks we analyse from the file */
+    if (bDHDL)
+    {
+        const int dhBlockIds[] = { enxDHCOLL, enxDH, enxDHHIST };
+        enx_select_terms(fp, {});
+        enx_select_blocks(fp, dhBlockIds);
+    }
+    else
+    {
+        enx_select_terms(fp, gmx::arrayRefFromArray(set, nset));
+        enx_select_blocks(fp, {});
+    }
+    if (bTimeSet(TBEGIN))
+    {
+        /* Jump directly to the first frame at or after the start time */
+        for (const EnxFrameIndexEntry& entry : enx_frame_index(fp))
+        {
+            if (check_times(entry.t) >= 0)
+            {
+                enx_seek_frame(fp, entry);
+                break;
+            }
+        }
+    }
+
     /* Initiate energies and set them to zero */
     edat.nsteps    = 0;
     edat.npoints   = 0;
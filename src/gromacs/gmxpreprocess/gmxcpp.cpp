@@ -41,24 +41,35 @@
 
 #include <cctype>
 #include <cerrno>
+#include <cinttypes>
 #include <climits>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
 
 #include <algorithm>
+#include <array>
 #include <memory>
+#include <string>
 
+#include <unordered_map>
 #include <unordered_set>
+#include <sys/stat.h>
 #include <sys/types.h>
 
+#include "gromacs/fileio/md5.h"
 #include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/datafilefinder.h"
 #include "gromacs/utility/dir_separator.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/path.h"
+#include "gromacs/utility/stringutil.h"
+#include "gromacs/utility/sysinfo.h"
 
 struct t_define
 {
@@ -75,6 +86,71 @@ enum
     eifNR
 };
 
+//! Version of the binary layout of preprocessor cache files
+static const int64_t c_cacheFormatVersion = 2;
+
+//! Identifies preprocessor cache files
+static const char c_cacheMagic[] = "GMXCPPCACHE";
+
+//! A line of preprocessor output, as stored in the cache
+struct CachedLine
+{
+    //! Index of the file the line originates from in CppCache::fileNames
+    int fileIndex;
+    //! Line number in that file
+    int lineNr;
+    //! The line after preprocessing
+    std::string text;
+};
+
+//! A file read by the preprocessor, with what is needed to detect changes to it
+struct CacheSource
+{
+    //! Absolute path of the file
+    std::string fileName;
+    //! Size of the file in bytes
+    int64_t size;
+    //! Modification time of the file in seconds
+    int64_t modificationTime;
+    //! Checksum of the contents of the file
+    std::array<unsigned char, 16> checksum;
+};
+
+/*! \brief The preprocessor output of a topology, as stored on disk
+ *
+ * The output only depends on the contents of the files read, the
+ * options given to the preprocessor and the files that can be found
+ * in the include paths. The cache file name is a checksum of the
+ * options and the include search path, while the size, modification
+ * time and checksum of all files read are stored in the cache and
+ * verified before the cache is used.
+ */
+struct CppCache
+{
+    //! Full path of the cache file
+    std::string fileName;
+    //! Description of the options, stored to guard against checksum collisions
+    std::string key;
+    //! Time the files were examined, later modification times are not trusted
+    int64_t recordingTime;
+    //! Each file read
+    std::vector<CacheSource> sources;
+    //! Names of the files lines originate from, as returned by cpp_cur_file()
+    std::vector<std::string> fileNames;
+    //! Lookup of indices into fileNames while recording
+    std::unordered_map<std::string, int> fileNameIndex;
+    //! The preprocessor output
+    std::vector<CachedLine> lines;
+    //! Whether lines are returned from the cache instead of the files
+    bool bReplay = false;
+    //! Whether the output is still being recorded
+    bool bRecording = true;
+    //! The next line to return when replaying
+    size_t nextLine = 0;
+    //! Index in fileNames of the file of the last line returned when replaying
+    int currentFileIndex = -1;
+};
+
 struct gmx_cpp
 {
     std::shared_ptr<std::vector<t_define>>    defines;
@@ -89,6 +165,7 @@ struct gmx_cpp
     std::vector<int>                          ifdefs;
     struct gmx_cpp*                           child  = nullptr;
     struct gmx_cpp*                           parent = nullptr;
+    std::shared_ptr<CppCache>                 cache;
 };
 
 static bool is_word_end(char c)
@@ -208,6 +285,288 @@ static void add_define(std::vector<t_define>* defines, const std::string& name,
     defines->push_back({ name, value });
 }
 
+/* Computes the checksum of the contents of a file, returns false when it can not be read */
+static bool fileChecksum(const std::string& fileName, std::array<unsigned char, 16>* checksum)
+{
+    FILE* fp = fopen(fileName.c_str(), "rb");
+    if (fp == nullptr)
+    {
+        return false;
+    }
+    md5_state_t                  state;
+    std::array<md5_byte_t, 4096> buf;
+    size_t                       numRead;
+    gmx_md5_init(&state);
+    while ((numRead = fread(buf.data(), 1, buf.size(), fp)) > 0)
+    {
+        gmx_md5_append(&state, buf.data(), numRead);
+    }
+    bool bOK = (ferror(fp) == 0);
+    fclose(fp);
+    *checksum = gmx_md5_finish(&state);
+
+    return bOK;
+}
+
+/* Gets the size and modification time of a file, returns false when it does not exist */
+static bool fileStatus(const std::string& fileName, int64_t* size, int64_t* modificationTime)
+{
+    struct stat status;
+    if (stat(fileName.c_str(), &status) != 0)
+    {
+        return false;
+    }
+    *size             = status.st_size;
+    *modificationTime = status.st_mtime;
+
+    return true;
+}
+
+/* Checks whether a source of the cache is unchanged. The checksum is only
+ * computed when the size and modification time can not tell. That is the case
+ * when the modification time differs, as files are also touched without
+ * changing them, or when the file was modified within the second the cache
+ * was recorded in, since a later change in that second keeps the time.
+ * Sets *bModified when the recorded status of the source is out of date.
+ */
+static bool isSourceUnchanged(CacheSource* source, int64_t recordingTime, bool* bModified)
+{
+    int64_t size, modificationTime;
+    if (!fileStatus(source->fileName, &size, &modificationTime) || size != source->size)
+    {
+        return false;
+    }
+    if (modificationTime == source->modificationTime && modificationTime < recordingTime)
+    {
+        return true;
+    }
+    std::array<unsigned char, 16> checksum;
+    if (!fileChecksum(source->fileName, &checksum) || checksum != source->checksum)
+    {
+        return false;
+    }
+    if (modificationTime != source->modificationTime)
+    {
+        source->modificationTime = modificationTime;
+        *bModified               = true;
+    }
+    return true;
+}
+
+/* Adds the file that was just opened by cpp to the sources of the cache.
+ * Must be called directly after opening, as it relies on the working directory.
+ */
+static void addCacheSource(CppCache* cache, const gmx_cpp& cpp)
+{
+    char buf[STRLEN];
+    gmx_getcwd(buf, STRLEN);
+    CacheSource source;
+    source.fileName = gmx::Path::join(buf, cpp.fn);
+    if (!fileStatus(source.fileName, &source.size, &source.modificationTime)
+        || !fileChecksum(source.fileName, &source.checksum))
+    {
+        cache->bRecording = false;
+    }
+    cache->sources.push_back(source);
+}
+
+/* Sets up a cache for processing filenm with cppopts in cacheDirectory */
+static std::shared_ptr<CppCache> initCache(const char* filenm,
+                                           char**      cppopts,
+                                           const char* cacheDirectory)
+{
+    char cwd[STRLEN];
+    gmx_getcwd(cwd, STRLEN);
+
+    /* Everything apart from the file contents that affects the output */
+    auto cache           = std::make_shared<CppCache>();
+    cache->recordingTime = std::time(nullptr);
+    cache->key           = gmx::formatString("version %" PRId64 "\nfile %s\ncwd %s\n",
+                                             c_cacheFormatVersion, filenm, cwd);
+    for (int i = 0; cppopts != nullptr && cppopts[i] != nullptr; i++)
+    {
+        cache->key += gmx::formatString("option %s\n", cppopts[i]);
+    }
+    /* Files not found through -I are searched in GMXLIB and the default library */
+    for (const std::string& path : gmx::getLibraryFileFinder().searchPath())
+    {
+        cache->key += gmx::formatString("library %s\n", path.c_str());
+    }
+
+    md5_state_t state;
+    gmx_md5_init(&state);
+    gmx_md5_append(&state, reinterpret_cast<const md5_byte_t*>(cache->key.data()),
+                   cache->key.size());
+    std::string name;
+    for (unsigned char c : gmx_md5_finish(&state))
+    {
+        name += gmx::formatString("%02x", c);
+    }
+    /* The working directory changes while processing, so store an absolute path */
+    std::string directory = cacheDirectory;
+    if (!gmx::Path::isAbsolute(directory))
+    {
+        directory = gmx::Path::join(cwd, directory);
+    }
+    cache->fileName = gmx::Path::join(directory, name + ".cppcache");
+
+    return cache;
+}
+
+static void writeCacheInt(FILE* fp, int64_t value)
+{
+    fwrite(&value, sizeof(value), 1, fp);
+}
+
+static void writeCacheString(FILE* fp, const std::string& str)
+{
+    writeCacheInt(fp, str.size());
+    fwrite(str.data(), 1, str.size(), fp);
+}
+
+static bool readCacheInt(FILE* fp, int64_t* value)
+{
+    return fread(value, sizeof(*value), 1, fp) == 1;
+}
+
+static bool readCacheString(FILE* fp, std::string* str)
+{
+    int64_t size;
+    if (!readCacheInt(fp, &size) || size < 0 || size > INT_MAX)
+    {
+        return false;
+    }
+    str->resize(size);
+    return size == 0 || fread(&(*str)[0], 1, size, fp) == static_cast<size_t>(size);
+}
+
+/* Writes the recorded output of the whole topology, together with the final
+ * state of the defines, to the cache file. A temporary file is renamed into
+ * place, so concurrent grompp runs never see a partially written cache.
+ * Failure to write the cache is not an error.
+ */
+static void writeCache(const CppCache&                        cache,
+                       gmx::ArrayRef<const t_define>          defines,
+                       const std::unordered_set<std::string>& unmatchedDefines)
+{
+    std::string tmpFileName = gmx::formatString("%s.%d.tmp", cache.fileName.c_str(), gmx_getpid());
+    FILE*       fp          = fopen(tmpFileName.c_str(), "wb");
+    if (fp == nullptr)
+    {
+        return;
+    }
+    writeCacheString(fp, c_cacheMagic);
+    writeCacheInt(fp, c_cacheFormatVersion);
+    writeCacheString(fp, cache.key);
+    writeCacheInt(fp, cache.recordingTime);
+    writeCacheInt(fp, cache.sources.size());
+    for (const CacheSource& source : cache.sources)
+    {
+        writeCacheString(fp, source.fileName);
+        writeCacheInt(fp, source.size);
+        writeCacheInt(fp, source.modificationTime);
+        fwrite(source.checksum.data(), 1, source.checksum.size(), fp);
+    }
+    writeCacheInt(fp, cache.fileNames.size());
+    for (const std::string& fileName : cache.fileNames)
+    {
+        writeCacheString(fp, fileName);
+    }
+    writeCacheInt(fp, cache.lines.size());
+    for (const CachedLine& line : cache.lines)
+    {
+        writeCacheInt(fp, line.fileIndex);
+        writeCacheInt(fp, line.lineNr);
+        writeCacheString(fp, line.text);
+    }
+    writeCacheInt(fp, defines.size());
+    for (const t_define& define : defines)
+    {
+        writeCacheString(fp, define.name);
+        writeCacheString(fp, define.def);
+    }
+    writeCacheInt(fp, unmatchedDefines.size());
+    for (const std::string& name : unmatchedDefines)
+    {
+        writeCacheString(fp, name);
+    }
+    bool bOK = (ferror(fp) == 0);
+    bOK      = (fclose(fp) == 0) && bOK;
+    if (!bOK || gmx_file_rename(tmpFileName.c_str(), cache.fileName.c_str()) != 0)
+    {
+        remove(tmpFileName.c_str());
+    }
+}
+
+/* Reads the cache file, returns false when it does not exist, is corrupt,
+ * was written for different options or when any file read changed since.
+ * Sets *bSourcesModified when files were touched without changing them.
+ */
+static bool readCache(CppCache*                        cache,
+                      std::vector<t_define>*           defines,
+                      std::unordered_set<std::string>* unmatchedDefines,
+                      bool*                            bSourcesModified)
+{
+    FILE* fp = fopen(cache->fileName.c_str(), "rb");
+    if (fp == nullptr)
+    {
+        return false;
+    }
+    std::string str;
+    int64_t     value, count;
+    bool        bOK = (readCacheString(fp, &str) && str == c_cacheMagic && readCacheInt(fp, &value)
+                && value == c_cacheFormatVersion && readCacheString(fp, &str) && str == cache->key
+                && readCacheInt(fp, &value) && readCacheInt(fp, &count));
+    const int64_t recordingTime = value;
+    for (int64_t i = 0; bOK && i < count; i++)
+    {
+        CacheSource source;
+        bOK = (readCacheString(fp, &source.fileName) && readCacheInt(fp, &source.size)
+               && readCacheInt(fp, &source.modificationTime)
+               && fread(source.checksum.data(), 1, source.checksum.size(), fp)
+                          == source.checksum.size()
+               && isSourceUnchanged(&source, recordingTime, bSourcesModified));
+        if (bOK)
+        {
+            cache->sources.push_back(source);
+        }
+    }
+    bOK = bOK && readCacheInt(fp, &count);
+    for (int64_t i = 0; bOK && i < count; i++)
+    {
+        bOK = readCacheString(fp, &str);
+        cache->fileNames.push_back(str);
+    }
+    bOK = bOK && readCacheInt(fp, &count);
+    for (int64_t i = 0; bOK && i < count; i++)
+    {
+        int64_t fileIndex, lineNr;
+        bOK = (readCacheInt(fp, &fileIndex) && fileIndex >= 0
+               && fileIndex < gmx::ssize(cache->fileNames) && readCacheInt(fp, &lineNr)
+               && readCacheString(fp, &str));
+        if (bOK)
+        {
+            cache->lines.push_back({ static_cast<int>(fileIndex), static_cast<int>(lineNr), str });
+        }
+    }
+    bOK = bOK && readCacheInt(fp, &count);
+    for (int64_t i = 0; bOK && i < count; i++)
+    {
+        t_define define;
+        bOK = (readCacheString(fp, &define.name) && readCacheString(fp, &define.def));
+        defines->push_back(define);
+    }
+    bOK = bOK && readCacheInt(fp, &count);
+    for (int64_t i = 0; bOK && i < count; i++)
+    {
+        bOK = readCacheString(fp, &str);
+        unmatchedDefines->insert(str);
+    }
+    fclose(fp);
+
+    return bOK;
+}
+
 /* Open the file to be processed. The handle variable holds internal
    info for the cpp emulator. Return integer status */
 static int cpp_open_file(const char*                                filenm,
@@ -347,6 +706,54 @@ int cpp_open_file(const char* filenm, gmx_cpp_t* handle, char** cppopts)
     return cpp_open_file(filenm, handle, cppopts, nullptr, nullptr);
 }
 
+int cpp_open_file(const char* filenm, gmx_cpp_t* handle, char** cppopts, const char* cacheDirectory)
+{
+    if (cacheDirectory == nullptr)
+    {
+        return cpp_open_file(filenm, handle, cppopts);
+    }
+
+    std::shared_ptr<CppCache>       cache = initCache(filenm, cppopts, cacheDirectory);
+    std::vector<t_define>           defines;
+    std::unordered_set<std::string> unmatchedDefines;
+    bool                            bSourcesModified = false;
+    if (readCache(cache.get(), &defines, &unmatchedDefines, &bSourcesModified))
+    {
+        if (bSourcesModified)
+        {
+            /* Store the new modification times, so the next run does not need the checksums */
+            writeCache(*cache, defines, unmatchedDefines);
+        }
+
+        gmx_cpp* cpp           = new gmx_cpp;
+        *handle                = cpp;
+        cpp->defines           = std::make_shared<std::vector<t_define>>(std::move(defines));
+        cpp->includes          = std::make_shared<std::vector<std::string>>();
+        cpp->unmatched_defines = std::move(unmatchedDefines);
+        cpp->line_nr           = 0;
+        cpp->cache             = cache;
+        cache->bReplay         = true;
+        cache->bRecording      = false;
+
+        return eCPP_OK;
+    }
+
+    /* Start over with a fresh cache, that records while processing */
+    cache      = initCache(filenm, cppopts, cacheDirectory);
+    int status = cpp_open_file(filenm, handle, cppopts);
+    if (status == eCPP_OK)
+    {
+        (*handle)->cache = cache;
+        addCacheSource(cache.get(), **handle);
+    }
+    return status;
+}
+
+bool cpp_is_replaying_cache(const gmx_cpp_t* handlep)
+{
+    return (*handlep)->cache && (*handlep)->cache->bReplay;
+}
+
 /* Note that dval might be null, e.g. when handling a line like '#define */
 static int process_directive(gmx_cpp_t* handlep, const std::string& dname, const std::string& dval)
 {
@@ -484,6 +891,11 @@ static int process_directive(gmx_cpp_t* handlep, const std::string& dname, const
             handle->child = nullptr;
             return status;
         }
+        if (handle->cache)
+        {
+            handle->child->cache = handle->cache;
+            addCacheSource(handle->cache.get(), *handle->child);
+        }
         /* Make a linked list of open files and move on to the include file */
         handle->child->parent = handle;
         *handlep              = handle->child;
@@ -545,7 +957,7 @@ static int process_directive(gmx_cpp_t* handlep, const std::string& dname, const
    routine also does all the "intelligent" work like processing cpp
    directives and so on. Note that often the routine is called
    recursively and no cpp directives are printed. */
-int cpp_read_line(gmx_cpp_t* handlep, int n, char buf[])
+static int cpp_read_raw_line(gmx_cpp_t* handlep, int n, char buf[])
 {
     gmx_cpp_t handle = *handlep;
     int       status;
@@ -589,7 +1001,7 @@ int cpp_read_line(gmx_cpp_t* handlep, int n, char buf[])
         cpp_close_file(handlep);
         *handlep = handle->parent;
         delete handle;
-        return cpp_read_line(handlep, n, buf);
+        return cpp_read_raw_line(handlep, n, buf);
     }
     else
     {
@@ -608,7 +1020,7 @@ int cpp_read_line(gmx_cpp_t* handlep, int n, char buf[])
             return status;
         }
         /* Don't print lines with directives, go on to the next */
-        return cpp_read_line(handlep, n, buf);
+        return cpp_read_raw_line(handlep, n, buf);
     }
 
     /* Check whether we're not ifdeffed out. The order of this statement
@@ -616,7 +1028,7 @@ int cpp_read_line(gmx_cpp_t* handlep, int n, char buf[])
        anything else should be ignored. */
     if (is_ifdeffed_out(handle->ifdefs))
     {
-        return cpp_read_line(handlep, n, buf);
+        return cpp_read_raw_line(handlep, n, buf);
     }
 
     /* Check whether we have any defines that need to be replaced. Note
@@ -664,6 +1076,61 @@ int cpp_read_line(gmx_cpp_t* handlep, int n, char buf[])
     return eCPP_OK;
 }
 
+/* Returns the next line of the cache in buf */
+static int cpp_replay_line(gmx_cpp_t handle, int n, char buf[])
+{
+    CppCache* cache = handle->cache.get();
+    if (cache->nextLine == cache->lines.size())
+    {
+        return eCPP_EOF;
+    }
+    const CachedLine& line = cache->lines[cache->nextLine++];
+    GMX_RELEASE_ASSERT(line.text.size() < static_cast<size_t>(n), "The line should fit in buf");
+    strcpy(buf, line.text.c_str());
+    if (line.fileIndex != cache->currentFileIndex)
+    {
+        handle->fn              = cache->fileNames[line.fileIndex];
+        cache->currentFileIndex = line.fileIndex;
+    }
+    handle->line    = line.text;
+    handle->line_nr = line.lineNr;
+
+    return eCPP_OK;
+}
+
+int cpp_read_line(gmx_cpp_t* handlep, int n, char buf[])
+{
+    if (*handlep && (*handlep)->cache)
+    {
+        CppCache* cache = (*handlep)->cache.get();
+        if (cache->bReplay)
+        {
+            return cpp_replay_line(*handlep, n, buf);
+        }
+        int status = cpp_read_raw_line(handlep, n, buf);
+        if (status == eCPP_OK && cache->bRecording)
+        {
+            const std::string& fileName = (*handlep)->fn;
+            auto               found    = cache->fileNameIndex.find(fileName);
+            if (found == cache->fileNameIndex.end())
+            {
+                found = cache->fileNameIndex.emplace(fileName, cache->fileNames.size()).first;
+                cache->fileNames.push_back(fileName);
+            }
+            cache->lines.push_back({ found->second, (*handlep)->line_nr, buf });
+        }
+        else if (status == eCPP_EOF && cache->bRecording)
+        {
+            /* At the end of the input we are back at the top level file */
+            writeCache(*cache, *(*handlep)->defines, (*handlep)->unmatched_defines);
+            cache->bRecording = false;
+        }
+        return status;
+    }
+
+    return cpp_read_raw_line(handlep, n, buf);
+}
+
 const char* cpp_cur_file(const gmx_cpp_t* handlep)
 {
     return (*handlep)->fn.c_str();
@@ -683,6 +1150,10 @@ int cpp_close_file(gmx_cpp_t* handlep)
     {
         return eCPP_INVALID_HANDLE;
     }
+    if (handle->cache && handle->cache->bReplay)
+    {
+        return eCPP_OK;
+    }
     if (!handle->fp)
     {
         return eCPP_FILE_NOT_OPEN;
@@ -63,6 +63,19 @@ enum
  */
 int cpp_open_file(const char* filenm, gmx_cpp_t* handlep, char** cppopts);
 
+/* As cpp_open_file above, but with a cache of the preprocessed output in
+   cacheDirectory, which is used when the same file is processed with the
+   same options and none of the files read has changed. Otherwise the
+   output is written to the cache when the end of the input is reached.
+   Without cacheDirectory no cache is used.
+ */
+int cpp_open_file(const char* filenm, gmx_cpp_t* handlep, char** cppopts,
+                  const char* cacheDirectory);
+
+/* Return whether the lines are read from the cache instead of the files.
+ */
+bool cpp_is_replaying_cache(const gmx_cpp_t* handlep);
+
 /* Return one whole line from the file into buf which holds at most n
    characters, for subsequent processing. Returns integer status.
  */
@@ -235,6 +235,59 @@ void InteractionOfType::setForceParameter(int pos, real value)
     forceParam_[pos] = value;
 }
 
+InteractionTypeIndex::Key InteractionTypeIndex::makeKey(gmx::ArrayRef<const int> atoms)
+{
+    GMX_ASSERT(atoms.size() <= MAXATOMLIST, "Interaction types have at most MAXATOMLIST atoms");
+    Key key;
+    key.atoms.fill(NOTSET);
+    std::copy(atoms.begin(), atoms.end(), key.atoms.begin());
+    key.numAtoms = atoms.ssize();
+    return key;
+}
+
+size_t InteractionTypeIndex::KeyHash::operator()(const Key& key) const
+{
+    size_t hash = key.numAtoms;
+    for (int i = 0; i < key.numAtoms; i++)
+    {
+        hash = hash * 1000003 + static_cast<size_t>(key.atoms[i] + 1);
+    }
+    return hash;
+}
+
+void InteractionTypeIndex::clear()
+{
+    firstIndex_.clear();
+    indexedData_ = nullptr;
+    numIndexed_  = 0;
+}
+
+int InteractionTypeIndex::find(const std::vector<InteractionOfType>& interactionTypes,
+                               gmx::ArrayRef<const int>              atoms)
+{
+    /* Entries are only ever appended while the index is in use, so we only
+     * need to add the new ones, unless the storage has been replaced.
+     */
+    if (interactionTypes.data() != indexedData_ || interactionTypes.size() < numIndexed_)
+    {
+        clear();
+        indexedData_ = interactionTypes.data();
+    }
+    for (; numIndexed_ < interactionTypes.size(); numIndexed_++)
+    {
+        /* emplace does not replace, so earlier entries take precedence */
+        firstIndex_.emplace(makeKey(interactionTypes[numIndexed_].atoms()),
+                            static_cast<int>(numIndexed_));
+    }
+
+    if (atoms.size() > MAXATOMLIST)
+    {
+        return -1;
+    }
+    const auto found = firstIndex_.find(makeKey(atoms));
+    return (found != firstIndex_.end()) ? found->second : -1;
+}
+
 void MoleculeInformation::initMolInfo()
 {
     init_block(&mols);
@@ -1794,6 +1847,7 @@ int gmx_grompp(int argc, char* argv[])
     gmx_bool bRenum   = TRUE;
     gmx_bool bRmVSBds = TRUE, bZero = FALSE;
     int      i, maxwarn             = 0;
+    int      numThreads             = 1;
     real     fr_time = -1;
     t_pargs  pa[]    = {
         { "-v", FALSE, etBOOL, { &bVerbose }, "Be loud and noisy" },
@@ -1819,7 +1873,12 @@ int gmx_grompp(int argc, char* argv[])
           FALSE,
           etBOOL,
           { &bRenum },
-          "Renumber atomtypes and minimize number of atomtypes" }
+          "Renumber atomtypes and minimize number of atomtypes" },
+        { "-nt",
+          FALSE,
+          etINT,
+          { &numThreads },
+          "Number of OpenMP threads for generating the exclusions of the molecule types" }
     };
 
     /* Parse the command line */
@@ -1835,6 +1894,7 @@ int gmx_grompp(int argc, char* argv[])
     snew(opts, 1);
     snew(opts->include, STRLEN);
     snew(opts->define, STRLEN);
+    opts->numThreads = numThreads;
 
     gmx::LoggerBuilder builder;
     builder.addTargetStream(gmx::MDLogger::LogLevel::Info, &gmx::TextOutputFile::standardOutput());
@@ -39,7 +39,10 @@
 #ifndef GMX_GMXPREPROCESS_GROMPP_IMPL_H
 #define GMX_GMXPREPROCESS_GROMPP_IMPL_H
 
+#include <array>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "gromacs/gmxpreprocess/notset.h"
 #include "gromacs/topology/atoms.h"
@@ -123,6 +126,56 @@ private:
     std::string interactionTypeName_;
 };
 
+/*! \libinternal \brief
+ * Hashed index from the atoms of interaction types to the first entry with those atoms.
+ *
+ * The atoms of an interaction type are (bond) atom types, with -1 for
+ * wildcards, which are indexed like any other value. The index is filled
+ * on the first lookup and updated when the indexed list has changed since,
+ * so it only needs to be cleared explicitly when the list is refilled.
+ */
+class InteractionTypeIndex
+{
+public:
+    /*! \brief Returns the position of the first entry of \p interactionTypes
+     * whose atoms are exactly \p atoms, or -1 when there is no such entry.
+     */
+    int find(const std::vector<InteractionOfType>& interactionTypes,
+             gmx::ArrayRef<const int>              atoms);
+    //! Forgets all entries, needed when the indexed list was cleared and refilled.
+    void clear();
+
+private:
+    //! The atoms of an interaction type, padded to a fixed size.
+    struct Key
+    {
+        //! The atoms, unused elements are NOTSET.
+        std::array<int, MAXATOMLIST> atoms;
+        //! The number of atoms.
+        int numAtoms;
+        //! Returns whether the keys are identical.
+        bool operator==(const Key& other) const
+        {
+            return numAtoms == other.numAtoms && atoms == other.atoms;
+        }
+    };
+    //! Hash function for Key.
+    struct KeyHash
+    {
+        //! Returns the hash of \p key.
+        size_t operator()(const Key& key) const;
+    };
+    //! Returns the key for \p atoms.
+    static Key makeKey(gmx::ArrayRef<const int> atoms);
+
+    //! First position in the indexed list for each distinct set of atoms.
+    std::unordered_map<Key, int, KeyHash> firstIndex_;
+    //! Storage of the indexed list when it was last indexed.
+    const InteractionOfType* indexedData_ = nullptr;
+    //! Number of entries of the indexed list that have been indexed.
+    size_t numIndexed_ = 0;
+};
+
 /*! \libinternal \brief
  * A set of interactions of a given type
  * (found in the enumeration in ifunc.h), complete with
@@ -144,6 +197,8 @@ struct InteractionsOfType
     std::vector<real> cmap;
     //! The five atomtypes followed by a number that identifies the type.
     std::vector<int> cmapAtomTypes;
+    //! Index for looking up entries of interactionTypes by their atoms.
+    InteractionTypeIndex typeIndex;
 
     //! Number of parameters.
     size_t size() const { return interactionTypes.size(); }
@@ -75,6 +75,7 @@
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 using gmx::RVec;
@@ -164,8 +165,163 @@ static bool isInsertionAllowed(gmx::AnalysisNeighborhoodSearch* search,
     return true;
 }
 
+/*! \brief
+ * Checks whether a trial configuration can be inserted, without modifying any state.
+ *
+ * Works like isInsertionAllowed(), but instead of marking overlapping
+ * removable atoms, collects them in \p replacedAtoms, so that trial
+ * configurations can be checked concurrently.
+ */
+static bool isBatchInsertionAllowed(const gmx::AnalysisNeighborhoodSearch& search,
+                                    const std::vector<real>&               exclusionDistances,
+                                    const std::vector<RVec>&               x,
+                                    const std::vector<real>&               exclusionDistances_insrt,
+                                    const std::set<int>&                   removableAtoms,
+                                    std::vector<int>*                      replacedAtoms)
+{
+    replacedAtoms->clear();
+    gmx::AnalysisNeighborhoodPositions  pos(x);
+    gmx::AnalysisNeighborhoodPairSearch pairSearch = search.startPairSearch(pos);
+    gmx::AnalysisNeighborhoodPair       pair;
+    while (pairSearch.findNextPair(&pair))
+    {
+        const real r1 = exclusionDistances[pair.refIndex()];
+        const real r2 = exclusionDistances_insrt[pair.testIndex()];
+        if (pair.distance2() < gmx::square(r1 + r2))
+        {
+            if (removableAtoms.count(pair.refIndex()) == 0)
+            {
+                return false;
+            }
+            replacedAtoms->push_back(pair.refIndex());
+        }
+    }
+    return true;
+}
+
+/*! \brief
+ * Returns whether a trial configuration overlaps with atoms starting from \p firstAtom.
+ *
+ * Used for checking a trial configuration against the molecules that were
+ * inserted earlier in the same batch, which are not part of the search.
+ */
+static bool overlapsWithInsertedAtoms(const t_pbc&             pbc,
+                                      const std::vector<RVec>& xTrial,
+                                      const std::vector<real>& exclusionDistances_insrt,
+                                      const std::vector<RVec>& x,
+                                      const std::vector<real>& exclusionDistances,
+                                      int                      firstAtom)
+{
+    for (size_t i = 0; i < xTrial.size(); ++i)
+    {
+        for (size_t j = firstAtom; j < x.size(); ++j)
+        {
+            rvec dx;
+            pbc_dx_aiuc(&pbc, xTrial[i], x[j], dx);
+            if (norm2(dx) < gmx::square(exclusionDistances_insrt[i] + exclusionDistances[j]))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/*! \brief
+ * Inserts molecules at random positions, checking batches of trials concurrently.
+ *
+ * For each batch, \p batchSize trial configurations are generated and the
+ * neighborhood search is built once over the current configuration. The
+ * trials are checked against it in parallel. The allowed trials are then
+ * accepted in order, unless they overlap with a molecule accepted earlier
+ * in the same batch. The result only depends on the random seed and the
+ * batch size, not on the number of threads.
+ *
+ * \returns The number of inserted molecules.
+ */
+static int insertMoleculesInBatches(int                        nmol_insrt,
+                                    int                        maxTrials,
+                                    int                        batchSize,
+                                    gmx::AnalysisNeighborhood* nb,
+                                    const t_pbc&               pbc,
+                                    const matrix               box,
+                                    RotationType               enum_rot,
+                                    gmx::DefaultRandomEngine*  rng,
+                                    const t_atoms&             atoms_insrt,
+                                    gmx::ArrayRef<RVec>        x_insrt,
+                                    const std::vector<real>&   exclusionDistances_insrt,
+                                    const std::set<int>&       removableAtoms,
+                                    t_atoms*                   atoms,
+                                    std::vector<RVec>*         x,
+                                    std::vector<real>*         exclusionDistances,
+                                    gmx::AtomsBuilder*         builder,
+                                    gmx::AtomsRemover*         remover)
+{
+    std::vector<std::vector<RVec>>     trialX(batchSize);
+    std::vector<std::vector<int>>      replacedAtoms(batchSize);
+    std::vector<char>                  isAllowed(batchSize);
+    gmx::UniformRealDistribution<real> dist;
+
+    int mol   = 0;
+    int trial = 0;
+    while (mol < nmol_insrt && trial < maxTrials)
+    {
+        const int numTrials = std::min(batchSize, maxTrials - trial);
+        for (int t = 0; t < numTrials; ++t)
+        {
+            rvec offset_x;
+            offset_x[XX] = box[XX][XX] * dist(*rng);
+            offset_x[YY] = box[YY][YY] * dist(*rng);
+            offset_x[ZZ] = box[ZZ][ZZ] * dist(*rng);
+            generate_trial_conf(x_insrt, offset_x, enum_rot, rng, &trialX[t]);
+        }
+
+        gmx::AnalysisNeighborhoodPositions pos(*x);
+        gmx::AnalysisNeighborhoodSearch    search = nb->initSearch(&pbc, pos);
+#pragma omp parallel for num_threads(gmx_omp_get_max_threads()) schedule(dynamic)
+        for (int t = 0; t < numTrials; ++t)
+        {
+            try
+            {
+                isAllowed[t] = isBatchInsertionAllowed(search, *exclusionDistances, trialX[t],
+                                                       exclusionDistances_insrt, removableAtoms,
+                                                       &replacedAtoms[t]);
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
+
+        const int firstAtomInBatch = x->size();
+        for (int t = 0; t < numTrials && mol < nmol_insrt; ++t)
+        {
+            ++trial;
+            if (!isAllowed[t]
+                || overlapsWithInsertedAtoms(pbc, trialX[t], exclusionDistances_insrt, *x,
+                                             *exclusionDistances, firstAtomInBatch))
+            {
+                continue;
+            }
+            for (int atomIndex : replacedAtoms[t])
+            {
+                // TODO: If molecule information is available, this should ideally
+                // use it to remove whole molecules.
+                remover->markResidue(*atoms, atomIndex, true);
+            }
+            x->insert(x->end(), trialX[t].begin(), trialX[t].end());
+            exclusionDistances->insert(exclusionDistances->end(), exclusionDistances_insrt.begin(),
+                                       exclusionDistances_insrt.end());
+            builder->mergeAtoms(atoms_insrt);
+            ++mol;
+        }
+        fprintf(stderr, "\rTry %d, inserted %d molecules (now %d atoms)", trial, mol,
+                builder->currentAtomCount());
+        fflush(stderr);
+    }
+    return mol;
+}
+
 static void insert_mols(int                  nmol_insrt,
                         int                  ntry,
+                        int                  batchSize,
                         int                  seed,
                         real                 defaultDistance,
                         real                 scaleFactor,
@@ -245,49 +401,60 @@ static void insert_mols(int                  nmol_insrt,
     int                                failed     = 0;
     gmx::UniformRealDistribution<real> dist;
 
-    while (mol < nmol_insrt && trial < ntry * nmol_insrt)
+    if (batchSize > 1)
     {
-        rvec offset_x;
-        if (!insertAtPositions)
-        {
-            // Insert at random positions.
-            offset_x[XX] = box[XX][XX] * dist(rng);
-            offset_x[YY] = box[YY][YY] * dist(rng);
-            offset_x[ZZ] = box[ZZ][ZZ] * dist(rng);
-        }
-        else
+        mol = insertMoleculesInBatches(nmol_insrt, ntry * nmol_insrt, batchSize, &nb, pbc, box,
+                                       enum_rot, &rng, atoms_insrt, x_insrt,
+                                       exclusionDistances_insrt, removableAtoms, atoms, x,
+                                       &exclusionDistances, &builder, &remover);
+    }
+    else
+    {
+        while (mol < nmol_insrt && trial < ntry * nmol_insrt)
         {
-            // Skip a position if ntry trials were not successful.
-            if (trial >= firstTrial + ntry)
+            rvec offset_x;
+            if (!insertAtPositions)
+            {
+                // Insert at random positions.
+                offset_x[XX] = box[XX][XX] * dist(rng);
+                offset_x[YY] = box[YY][YY] * dist(rng);
+                offset_x[ZZ] = box[ZZ][ZZ] * dist(rng);
+            }
+            else
             {
-                fprintf(stderr, " skipped position (%.3f, %.3f, %.3f)\n", rpos[XX][mol],
-                        rpos[YY][mol], rpos[ZZ][mol]);
+                // Skip a position if ntry trials were not successful.
+                if (trial >= firstTrial + ntry)
+                {
+                    fprintf(stderr, " skipped position (%.3f, %.3f, %.3f)\n", rpos[XX][mol],
+                            rpos[YY][mol], rpos[ZZ][mol]);
+                    ++mol;
+                    ++failed;
+                    firstTrial = trial;
+                    continue;
+                }
+                // Insert at positions taken from option -ip file.
+                offset_x[XX] = rpos[XX][mol] + deltaR[XX] * (2 * dist(rng) - 1);
+                offset_x[YY] = rpos[YY][mol] + deltaR[YY] * (2 * dist(rng) - 1);
+                offset_x[ZZ] = rpos[ZZ][mol] + deltaR[ZZ] * (2 * dist(rng) - 1);
+            }
+            fprintf(stderr, "\rTry %d", ++trial);
+            fflush(stderr);
+
+            generate_trial_conf(x_insrt, offset_x, enum_rot, &rng, &x_n);
+            gmx::AnalysisNeighborhoodPositions pos(*x);
+            gmx::AnalysisNeighborhoodSearch    search = nb.initSearch(&pbc, pos);
+            if (isInsertionAllowed(&search, exclusionDistances, x_n, exclusionDistances_insrt,
+                                   *atoms, removableAtoms, &remover))
+            {
+                x->insert(x->end(), x_n.begin(), x_n.end());
+                exclusionDistances.insert(exclusionDistances.end(),
+                                          exclusionDistances_insrt.begin(),
+                                          exclusionDistances_insrt.end());
+                builder.mergeAtoms(atoms_insrt);
                 ++mol;
-                ++failed;
                 firstTrial = trial;
-                continue;
+                fprintf(stderr, " success (now %d atoms)!\n", builder.currentAtomCount());
             }
-            // Insert at positions taken from option -ip file.
-            offset_x[XX] = rpos[XX][mol] + deltaR[XX] * (2 * dist(rng) - 1);
-            offset_x[YY] = rpos[YY][mol] + deltaR[YY] * (2 * dist(rng) - 1);
-            offset_x[ZZ] = rpos[ZZ][mol] + deltaR[ZZ] * (2 * dist(rng) - 1);
-        }
-        fprintf(stderr, "\rTry %d", ++trial);
-        fflush(stderr);
-
-        generate_trial_conf(x_insrt, offset_x, enum_rot, &rng, &x_n);
-        gmx::AnalysisNeighborhoodPositions pos(*x);
-        gmx::AnalysisNeighborhoodSearch    search = nb.initSearch(&pbc, pos);
-        if (isInsertionAllowed(&search, exclusionDistances, x_n, exclusionDistances_insrt, *atoms,
-                               removableAtoms, &remover))
-        {
-            x->insert(x->end(), x_n.begin(), x_n.end());
-            exclusionDistances.insert(exclusionDistances.end(), exclusionDistances_insrt.begin(),
-                                      exclusionDistances_insrt.end());
-            builder.mergeAtoms(atoms_insrt);
-            ++mol;
-            firstTrial = trial;
-            fprintf(stderr, " success (now %d atoms)!\n", builder.currentAtomCount());
         }
     }
 
@@ -329,6 +496,7 @@ public:
         bBox_(false),
         nmolIns_(0),
         nmolTry_(10),
+        batchSize_(1),
         seed_(0),
         defaultDistance_(0.105),
         scaleFactor_(0.57),
@@ -360,6 +528,7 @@ private:
     bool         bBox_;
     int          nmolIns_;
     int          nmolTry_;
+    int          batchSize_;
     int          seed_;
     real         defaultDistance_;
     real         scaleFactor_;
@@ -409,6 +578,13 @@ void InsertMolecules::initOptions(IOptionsContainer* options, ICommandLineOption
         "holes to fill. Option [TT]-rot[tt] specifies whether the insertion",
         "molecules are randomly oriented before insertion attempts.",
         "",
+        "When inserting many molecules at random positions, [TT]-batch[tt]",
+        "can be used to generate that many trial insertions at a time and",
+        "check them for overlap in parallel. The trials of a batch are then",
+        "accepted in order, unless they overlap with a molecule accepted",
+        "earlier in the same batch. The result depends on the batch size,",
+        "but not on the number of threads.",
+        "",
         "Alternatively, the molecules can be inserted only at positions defined in",
         "positions.dat ([TT]-ip[tt]). That file should have 3 columns (x,y,z),",
         "that give the displacements compared to the input molecule position",
@@ -464,6 +640,8 @@ void InsertMolecules::initOptions(IOptionsContainer* options, ICommandLineOption
             "Number of extra molecules to insert"));
     options->addOption(IntegerOption("try").store(&nmolTry_).description(
             "Try inserting [TT]-nmol[tt] times [TT]-try[tt] times"));
+    options->addOption(IntegerOption("batch").store(&batchSize_).description(
+            "Number of trial insertions to check in parallel"));
     options->addOption(IntegerOption("seed").store(&seed_).description(
             "Random generator seed (0 means generate)"));
     options->addOption(
@@ -492,6 +670,16 @@ void InsertMolecules::optionsFinished()
                 InconsistentInputError("When no solute (-f) is specified, "
                                        "a box size (-box) must be specified."));
     }
+    if (batchSize_ < 1)
+    {
+        GMX_THROW(InconsistentInputError("The batch size (-batch) must be at least 1."));
+    }
+    if (batchSize_ > 1 && !positionFile_.empty())
+    {
+        GMX_THROW(
+                InconsistentInputError("Batched insertion (-batch) is not supported "
+                                       "together with insertion positions (-ip)."));
+    }
     if (replaceSel_.isValid() && inputConfFile_.empty())
     {
         GMX_THROW(
@@ -582,8 +770,8 @@ int InsertMolecules::run()
 
     /* add nmol_ins molecules of atoms_ins
        in random orientation at random place */
-    insert_mols(nmolIns_, nmolTry_, seed_, defaultDistance_, scaleFactor_, &atoms, &top_.symtab,
-                &x_, removableAtoms, atomsInserted, xInserted, pbcTypeForOutput, box_,
+    insert_mols(nmolIns_, nmolTry_, batchSize_, seed_, defaultDistance_, scaleFactor_, &atoms,
+                &top_.symtab, &x_, removableAtoms, atomsInserted, xInserted, pbcTypeForOutput, box_,
                 positionFile_, deltaR_, enumRot_);
 
     /* write new configuration to file confout */
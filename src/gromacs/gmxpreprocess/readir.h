@@ -97,6 +97,7 @@ struct t_gromppopts
     int   couple_lam0;
     int   couple_lam1;
     bool  bCoupleIntra;
+    int   numThreads;
 };
 
 /*! \brief Initialise object to hold strings parsed from an .mdp file */
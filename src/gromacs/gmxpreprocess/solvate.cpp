@@ -61,11 +61,14 @@
 #include "gromacs/topology/atomsbuilder.h"
 #include "gromacs/topology/mtop_util.h"
 #include "gromacs/topology/topology.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 using gmx::RVec;
@@ -239,6 +242,27 @@ static void rm_res_pbc(const t_atoms* atoms, std::vector<RVec>* x, matrix box)
     }
 }
 
+/*! \brief
+ * Returns the index of the first atom of each residue in \p atoms.
+ *
+ * The returned vector has one extra element at the end that equals the
+ * number of atoms, so that residue \c i spans atoms
+ * [result[i], result[i + 1]).
+ */
+static std::vector<int> residueAtomStarts(const t_atoms& atoms)
+{
+    std::vector<int> starts;
+    for (int i = 0; i < atoms.nr; ++i)
+    {
+        if (i == 0 || atoms.atom[i].resind != atoms.atom[i - 1].resind)
+        {
+            starts.push_back(i);
+        }
+    }
+    starts.push_back(atoms.nr);
+    return starts;
+}
+
 /*! \brief
  * Generates a solvent configuration of desired size by stacking solvent boxes.
  *
@@ -252,6 +276,8 @@ static void rm_res_pbc(const t_atoms* atoms, std::vector<RVec>* x, matrix box)
  * The solvent box of desired size is created by stacking the initial box in
  * the smallest k*l*m array that covers the box, and then removing any residue
  * where all atoms are outside the target box (with a small margin).
+ * The residues to keep are determined before anything is copied, so only
+ * the kept residues are stored in the new configuration.
  * This function does not remove overlap between solvent atoms across the
  * edges.
  *
@@ -267,7 +293,6 @@ static void replicateSolventBox(t_atoms*           atoms,
 {
     // Calculate the box multiplication factors.
     ivec n_box;
-    int  nmol = 1;
     for (int i = 0; i < DIM; ++i)
     {
         n_box[i] = 1;
@@ -275,22 +300,10 @@ static void replicateSolventBox(t_atoms*           atoms,
         {
             n_box[i]++;
         }
-        nmol *= n_box[i];
     }
     fprintf(stderr, "Will generate new solvent configuration of %dx%dx%d boxes\n", n_box[XX],
             n_box[YY], n_box[ZZ]);
 
-    // Create arrays for storing the generated system (cannot be done in-place
-    // in case the target box is smaller than the original in one dimension,
-    // but not in all).
-    t_atoms newAtoms;
-    init_t_atoms(&newAtoms, 0, FALSE);
-    gmx::AtomsBuilder builder(&newAtoms, nullptr);
-    builder.reserve(atoms->nr * nmol, atoms->nres * nmol);
-    std::vector<RVec> newX(atoms->nr * nmol);
-    std::vector<RVec> newV(!v->empty() ? atoms->nr * nmol : 0);
-    std::vector<real> newR(atoms->nr * nmol);
-
     const real maxRadius = *std::max_element(r->begin(), r->end());
     rvec       boxWithMargin;
     for (int i = 0; i < DIM; ++i)
@@ -299,49 +312,82 @@ static void replicateSolventBox(t_atoms*           atoms,
         boxWithMargin[i] = boxTarget[i][i] + 3 * maxRadius;
     }
 
+    std::vector<RVec> deltas;
     for (int ix = 0; ix < n_box[XX]; ++ix)
     {
-        rvec delta;
-        delta[XX] = ix * box[XX][XX];
         for (int iy = 0; iy < n_box[YY]; ++iy)
         {
-            delta[YY] = iy * box[YY][YY];
             for (int iz = 0; iz < n_box[ZZ]; ++iz)
             {
-                delta[ZZ]         = iz * box[ZZ][ZZ];
-                bool bKeepResidue = false;
-                for (int i = 0; i < atoms->nr; ++i)
+                deltas.emplace_back(ix * box[XX][XX], iy * box[YY][YY], iz * box[ZZ][ZZ]);
+            }
+        }
+    }
+
+    // Keep a residue copy when any of its atoms is inside the box with margin.
+    const std::vector<int> residueStarts = residueAtomStarts(*atoms);
+    const int              numResidues   = residueStarts.size() - 1;
+    std::vector<char>      keepResidue(deltas.size() * numResidues, 0);
+    int                    numKeptAtoms    = 0;
+    int                    numKeptResidues = 0;
+    for (size_t copy = 0; copy < deltas.size(); ++copy)
+    {
+        const RVec& delta = deltas[copy];
+        for (int res = 0; res < numResidues; ++res)
+        {
+            bool bKeepResidue = false;
+            for (int i = residueStarts[res]; i < residueStarts[res + 1] && !bKeepResidue; ++i)
+            {
+                bool bKeepAtom = true;
+                for (int m = 0; m < DIM; ++m)
                 {
-                    const int newIndex  = builder.currentAtomCount();
-                    bool      bKeepAtom = true;
-                    for (int m = 0; m < DIM; ++m)
-                    {
-                        const real newCoord = delta[m] + (*x)[i][m];
-                        bKeepAtom           = bKeepAtom && (newCoord < boxWithMargin[m]);
-                        newX[newIndex][m]   = newCoord;
-                    }
-                    bKeepResidue = bKeepResidue || bKeepAtom;
-                    if (!v->empty())
-                    {
-                        copy_rvec((*v)[i], newV[newIndex]);
-                    }
-                    newR[newIndex] = (*r)[i];
-                    builder.addAtom(*atoms, i);
-                    if (i == atoms->nr - 1 || atoms->atom[i + 1].resind != atoms->atom[i].resind)
-                    {
-                        if (bKeepResidue)
-                        {
-                            builder.finishResidue(atoms->resinfo[atoms->atom[i].resind]);
-                        }
-                        else
-                        {
-                            builder.discardCurrentResidue();
-                        }
-                        // Reset state for the next residue.
-                        bKeepResidue = false;
-                    }
+                    bKeepAtom = bKeepAtom && (delta[m] + (*x)[i][m] < boxWithMargin[m]);
+                }
+                bKeepResidue = bKeepAtom;
+            }
+            if (bKeepResidue)
+            {
+                keepResidue[copy * numResidues + res] = 1;
+                numKeptAtoms += residueStarts[res + 1] - residueStarts[res];
+                numKeptResidues++;
+            }
+        }
+    }
+
+    // Create arrays for storing the generated system (cannot be done in-place
+    // in case the target box is smaller than the original in one dimension,
+    // but not in all).
+    t_atoms newAtoms;
+    init_t_atoms(&newAtoms, 0, FALSE);
+    gmx::AtomsBuilder builder(&newAtoms, nullptr);
+    builder.reserve(numKeptAtoms, numKeptResidues);
+    std::vector<RVec> newX;
+    std::vector<RVec> newV;
+    std::vector<real> newR;
+    newX.reserve(numKeptAtoms);
+    newV.reserve(!v->empty() ? numKeptAtoms : 0);
+    newR.reserve(numKeptAtoms);
+    for (size_t copy = 0; copy < deltas.size(); ++copy)
+    {
+        const RVec& delta = deltas[copy];
+        for (int res = 0; res < numResidues; ++res)
+        {
+            if (!keepResidue[copy * numResidues + res])
+            {
+                continue;
+            }
+            for (int i = residueStarts[res]; i < residueStarts[res + 1]; ++i)
+            {
+                newX.emplace_back(delta[XX] + (*x)[i][XX], delta[YY] + (*x)[i][YY],
+                                  delta[ZZ] + (*x)[i][ZZ]);
+                if (!v->empty())
+                {
+                    newV.push_back((*v)[i]);
                 }
+                newR.push_back((*r)[i]);
+                builder.addAtom(*atoms, i);
             }
+            builder.finishResidue(atoms->resinfo[atoms->atom[residueStarts[res]].resind]);
         }
     }
     sfree(atoms->atom);
@@ -353,27 +399,38 @@ static void replicateSolventBox(t_atoms*           atoms,
     atoms->atomname = newAtoms.atomname;
     atoms->resinfo  = newAtoms.resinfo;
 
-    newX.resize(atoms->nr);
     std::swap(*x, newX);
     if (!v->empty())
     {
-        newV.resize(atoms->nr);
         std::swap(*v, newV);
     }
-    newR.resize(atoms->nr);
     std::swap(*r, newR);
 
     fprintf(stderr, "Solvent box contains %d atoms in %d residues\n", atoms->nr, atoms->nres);
 }
 
+//! Returns the number of atoms marked for removal in \p remover.
+static int countMarkedAtoms(const gmx::AtomsRemover& remover, int numAtoms)
+{
+    int count = 0;
+    for (int i = 0; i < numAtoms; ++i)
+    {
+        if (remover.isMarked(i))
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
 /*! \brief
- * Removes overlap of solvent atoms across the edges.
+ * Marks overlap of solvent atoms across the edges for removal.
  *
- * \param[in,out] atoms      Solvent atoms.
- * \param[in,out] x          Solvent positions.
- * \param[in,out] v          Solvent velocities (can be empty).
- * \param[in,out] r          Solvent exclusion radii.
+ * \param[in]     atoms      Solvent atoms.
+ * \param[in]     x          Solvent positions.
+ * \param[in]     r          Solvent exclusion radii.
  * \param[in]     pbc        PBC information.
+ * \param[in,out] remover    Solvent atoms marked for removal.
  *
  * Solvent residues that lay on the edges that do not touch the origin are
  * removed if they overlap with other solvent atoms across the PBC.
@@ -384,22 +441,25 @@ static void replicateSolventBox(t_atoms*           atoms,
  * solvent outside those box edges; these atoms can then overlap with those on
  * the opposite box edge in a way that is not part of the pre-equilibrated
  * configuration.
+ *
+ * Which residue of an overlapping pair is removed depends on the earlier
+ * removals, so this search is done serially.
  */
-static void removeSolventBoxOverlap(t_atoms*           atoms,
-                                    std::vector<RVec>* x,
-                                    std::vector<RVec>* v,
-                                    std::vector<real>* r,
-                                    const t_pbc&       pbc)
+static void removeSolventBoxOverlap(const t_atoms&           atoms,
+                                    const std::vector<RVec>& x,
+                                    const std::vector<real>& r,
+                                    const t_pbc&             pbc,
+                                    gmx::AtomsRemover*       remover)
 {
-    gmx::AtomsRemover remover(*atoms);
+    const int numMarkedBefore = countMarkedAtoms(*remover, atoms.nr);
 
     // TODO: We could limit the amount of pairs searched significantly,
     // since we are only interested in pairs where the positions are on
     // opposite edges.
-    const real                maxRadius = *std::max_element(r->begin(), r->end());
+    const real                maxRadius = *std::max_element(r.begin(), r.end());
     gmx::AnalysisNeighborhood nb;
     nb.setCutoff(2 * maxRadius);
-    gmx::AnalysisNeighborhoodPositions  pos(*x);
+    gmx::AnalysisNeighborhoodPositions  pos(x);
     gmx::AnalysisNeighborhoodSearch     search     = nb.initSearch(&pbc, pos);
     gmx::AnalysisNeighborhoodPairSearch pairSearch = search.startPairSearch(pos);
     gmx::AnalysisNeighborhoodPair       pair;
@@ -407,19 +467,19 @@ static void removeSolventBoxOverlap(t_atoms*           atoms,
     {
         const int i1 = pair.refIndex();
         const int i2 = pair.testIndex();
-        if (remover.isMarked(i2))
+        if (remover->isMarked(i2))
         {
             pairSearch.skipRemainingPairsForTestPosition();
             continue;
         }
-        if (remover.isMarked(i1) || atoms->atom[i1].resind == atoms->atom[i2].resind)
+        if (remover->isMarked(i1) || atoms.atom[i1].resind == atoms.atom[i2].resind)
         {
             continue;
         }
-        if (pair.distance2() < gmx::square((*r)[i1] + (*r)[i2]))
+        if (pair.distance2() < gmx::square(r[i1] + r[i2]))
         {
             rvec dx;
-            rvec_sub((*x)[i2], (*x)[i1], dx);
+            rvec_sub(x[i2], x[i1], dx);
             bool bCandidate1 = false, bCandidate2 = false;
             // To satisfy Clang static analyzer.
             GMX_ASSERT(pbc.ndim_ePBC <= DIM, "Too many periodic dimensions");
@@ -442,130 +502,171 @@ static void removeSolventBoxOverlap(t_atoms*           atoms,
             // candidates.
             if (bCandidate2 && (!bCandidate1 || i2 > i1))
             {
-                remover.markResidue(*atoms, i2, true);
+                remover->markResidue(atoms, i2, true);
                 pairSearch.skipRemainingPairsForTestPosition();
             }
             else if (bCandidate1)
             {
-                remover.markResidue(*atoms, i1, true);
+                remover->markResidue(atoms, i1, true);
             }
         }
     }
 
-    remover.removeMarkedElements(x);
-    if (!v->empty())
+    fprintf(stderr, "Removed %d solvent atoms due to solvent-solvent overlap\n",
+            countMarkedAtoms(*remover, atoms.nr) - numMarkedBefore);
+}
+
+/*! \brief
+ * Finds the solvent atoms that have a solute atom within a distance.
+ *
+ * \param[in] search    Neighborhood search over the solute positions.
+ * \param[in] x         Solvent positions.
+ * \param[in] remover   Solvent atoms marked for removal, which are not searched.
+ * \param[in] isWithin  Returns whether a pair found by \p search, given the
+ *     pair and the solvent atom index, is close enough.
+ * \returns   For each solvent atom, whether any solute atom is close enough.
+ *
+ * The result of each solvent atom is independent of all other solvent
+ * atoms, so the solvent is split into blocks that are searched in
+ * parallel.
+ */
+template<typename PairCriterion>
+static std::vector<char> findSolventNearSolute(const gmx::AnalysisNeighborhoodSearch& search,
+                                               const std::vector<RVec>&               x,
+                                               const gmx::AtomsRemover&               remover,
+                                               PairCriterion                          isWithin)
+{
+    std::vector<int> solventToSearch;
+    solventToSearch.reserve(x.size());
+    for (int i = 0; i < gmx::ssize(x); ++i)
     {
-        remover.removeMarkedElements(v);
+        if (!remover.isMarked(i))
+        {
+            solventToSearch.push_back(i);
+        }
     }
-    remover.removeMarkedElements(r);
-    const int originalAtomCount = atoms->nr;
-    remover.removeMarkedAtoms(atoms);
-    fprintf(stderr, "Removed %d solvent atoms due to solvent-solvent overlap\n",
-            originalAtomCount - atoms->nr);
+
+    std::vector<char> isNear(x.size(), 0);
+    const int         numBlocks = gmx_omp_get_max_threads();
+#pragma omp parallel for num_threads(numBlocks) schedule(static)
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        try
+        {
+            const size_t begin = solventToSearch.size() * block / numBlocks;
+            const size_t end   = solventToSearch.size() * (block + 1) / numBlocks;
+            gmx::ArrayRef<const int> indices =
+                    gmx::constArrayRefFromArray(solventToSearch.data() + begin, end - begin);
+            if (!indices.empty())
+            {
+                gmx::AnalysisNeighborhoodPositions pos(x);
+                pos.indexed(indices);
+                gmx::AnalysisNeighborhoodPairSearch pairSearch = search.startPairSearch(pos);
+                gmx::AnalysisNeighborhoodPair       pair;
+                while (pairSearch.findNextPair(&pair))
+                {
+                    const int solventIndex = indices[pair.testIndex()];
+                    if (isWithin(pair, solventIndex))
+                    {
+                        isNear[solventIndex] = 1;
+                        pairSearch.skipRemainingPairsForTestPosition();
+                    }
+                }
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+    return isNear;
 }
 
 /*! \brief
- * Remove all solvent molecules outside a give radius from the solute.
+ * Marks all solvent molecules outside a give radius from the solute for removal.
  *
- * \param[in,out] atoms     Solvent atoms.
- * \param[in,out] x_solvent Solvent positions.
- * \param[in,out] v_solvent Solvent velocities.
- * \param[in,out] r         Atomic exclusion radii.
+ * \param[in]     atoms     Solvent atoms.
+ * \param[in]     x_solvent Solvent positions.
  * \param[in]     pbc       PBC information.
  * \param[in]     x_solute  Solute positions.
  * \param[in]     rshell    The radius outside the solute molecule.
+ * \param[in,out] remover   Solvent atoms marked for removal.
  */
-static void removeSolventOutsideShell(t_atoms*                 atoms,
-                                      std::vector<RVec>*       x_solvent,
-                                      std::vector<RVec>*       v_solvent,
-                                      std::vector<real>*       r,
+static void removeSolventOutsideShell(const t_atoms&           atoms,
+                                      const std::vector<RVec>& x_solvent,
                                       const t_pbc&             pbc,
                                       const std::vector<RVec>& x_solute,
-                                      real                     rshell)
+                                      real                     rshell,
+                                      gmx::AtomsRemover*       remover)
 {
-    gmx::AtomsRemover         remover(*atoms);
+    const int                 numMarkedBefore = countMarkedAtoms(*remover, atoms.nr);
     gmx::AnalysisNeighborhood nb;
     nb.setCutoff(rshell);
-    gmx::AnalysisNeighborhoodPositions  posSolute(x_solute);
-    gmx::AnalysisNeighborhoodSearch     search = nb.initSearch(&pbc, posSolute);
-    gmx::AnalysisNeighborhoodPositions  pos(*x_solvent);
-    gmx::AnalysisNeighborhoodPairSearch pairSearch = search.startPairSearch(pos);
-    gmx::AnalysisNeighborhoodPair       pair;
+    gmx::AnalysisNeighborhoodPositions posSolute(x_solute);
+    gmx::AnalysisNeighborhoodSearch    search = nb.initSearch(&pbc, posSolute);
 
-    // Remove everything
-    remover.markAll();
-    // Now put back those within the shell without checking for overlap
-    while (pairSearch.findNextPair(&pair))
-    {
-        remover.markResidue(*atoms, pair.testIndex(), false);
-        pairSearch.skipRemainingPairsForTestPosition();
-    }
-    remover.removeMarkedElements(x_solvent);
-    if (!v_solvent->empty())
+    // Keep the residues with any atom within the shell without checking for overlap
+    const auto isAnyPair = [](const gmx::AnalysisNeighborhoodPair& /*pair*/, int /*solventIndex*/) {
+        return true;
+    };
+    const std::vector<char> isInShell =
+            findSolventNearSolute(search, x_solvent, *remover, isAnyPair);
+    const std::vector<int> residueStarts = residueAtomStarts(atoms);
+    for (size_t res = 0; res + 1 < residueStarts.size(); ++res)
     {
-        remover.removeMarkedElements(v_solvent);
+        const auto residueBegin = isInShell.begin() + residueStarts[res];
+        const auto residueEnd   = isInShell.begin() + residueStarts[res + 1];
+        if (std::find(residueBegin, residueEnd, 1) == residueEnd)
+        {
+            remover->markResidue(atoms, residueStarts[res], true);
+        }
     }
-    remover.removeMarkedElements(r);
-    const int originalAtomCount = atoms->nr;
-    remover.removeMarkedAtoms(atoms);
+
     fprintf(stderr, "Removed %d solvent atoms more than %f nm from solute.\n",
-            originalAtomCount - atoms->nr, rshell);
+            countMarkedAtoms(*remover, atoms.nr) - numMarkedBefore, rshell);
 }
 
 /*! \brief
- * Removes solvent molecules that overlap with the solute.
+ * Marks solvent molecules that overlap with the solute for removal.
  *
- * \param[in,out] atoms    Solvent atoms.
- * \param[in,out] x        Solvent positions.
- * \param[in,out] v        Solvent velocities (can be empty).
- * \param[in,out] r        Solvent exclusion radii.
+ * \param[in]     atoms    Solvent atoms.
+ * \param[in]     x        Solvent positions.
+ * \param[in]     r        Solvent exclusion radii.
  * \param[in]     pbc      PBC information.
  * \param[in]     x_solute Solute positions.
  * \param[in]     r_solute Solute exclusion radii.
+ * \param[in,out] remover  Solvent atoms marked for removal.
  */
-static void removeSolventOverlappingWithSolute(t_atoms*                 atoms,
-                                               std::vector<RVec>*       x,
-                                               std::vector<RVec>*       v,
-                                               std::vector<real>*       r,
+static void removeSolventOverlappingWithSolute(const t_atoms&           atoms,
+                                               const std::vector<RVec>& x,
+                                               const std::vector<real>& r,
                                                const t_pbc&             pbc,
                                                const std::vector<RVec>& x_solute,
-                                               const std::vector<real>& r_solute)
+                                               const std::vector<real>& r_solute,
+                                               gmx::AtomsRemover*       remover)
 {
-    gmx::AtomsRemover remover(*atoms);
-    const real        maxRadius1 = *std::max_element(r->begin(), r->end());
-    const real        maxRadius2 = *std::max_element(r_solute.begin(), r_solute.end());
+    const int  numMarkedBefore = countMarkedAtoms(*remover, atoms.nr);
+    const real maxRadius1      = *std::max_element(r.begin(), r.end());
+    const real maxRadius2      = *std::max_element(r_solute.begin(), r_solute.end());
 
     // Now check for overlap.
-    gmx::AnalysisNeighborhood     nb;
-    gmx::AnalysisNeighborhoodPair pair;
+    gmx::AnalysisNeighborhood nb;
     nb.setCutoff(maxRadius1 + maxRadius2);
-    gmx::AnalysisNeighborhoodPositions  posSolute(x_solute);
-    gmx::AnalysisNeighborhoodSearch     search = nb.initSearch(&pbc, posSolute);
-    gmx::AnalysisNeighborhoodPositions  pos(*x);
-    gmx::AnalysisNeighborhoodPairSearch pairSearch = search.startPairSearch(pos);
-    while (pairSearch.findNextPair(&pair))
+    gmx::AnalysisNeighborhoodPositions posSolute(x_solute);
+    gmx::AnalysisNeighborhoodSearch    search = nb.initSearch(&pbc, posSolute);
+
+    const auto isOverlap = [&r, &r_solute](const gmx::AnalysisNeighborhoodPair& pair,
+                                           int solventIndex) {
+        return pair.distance2() < gmx::square(r_solute[pair.refIndex()] + r[solventIndex]);
+    };
+    const std::vector<char> isOverlapping = findSolventNearSolute(search, x, *remover, isOverlap);
+    for (int i = 0; i < atoms.nr; ++i)
     {
-        if (remover.isMarked(pair.testIndex()))
+        if (isOverlapping[i])
         {
-            pairSearch.skipRemainingPairsForTestPosition();
-            continue;
+            remover->markResidue(atoms, i, true);
         }
-        const real r1      = r_solute[pair.refIndex()];
-        const real r2      = (*r)[pair.testIndex()];
-        const bool bRemove = (pair.distance2() < gmx::square(r1 + r2));
-        remover.markResidue(*atoms, pair.testIndex(), bRemove);
     }
 
-    remover.removeMarkedElements(x);
-    if (!v->empty())
-    {
-        remover.removeMarkedElements(v);
-    }
-    remover.removeMarkedElements(r);
-    const int originalAtomCount = atoms->nr;
-    remover.removeMarkedAtoms(atoms);
     fprintf(stderr, "Removed %d solvent atoms due to solute-solvent overlap\n",
-            originalAtomCount - atoms->nr);
+            countMarkedAtoms(*remover, atoms.nr) - numMarkedBefore);
 }
 
 /*! \brief
@@ -656,7 +757,8 @@ static void add_solv(const char*        filename,
     fprintf(stderr, "Generating solvent configuration\n");
     t_pbc pbc;
     set_pbc(&pbc, pbcType, box);
-    if (!gmx::boxesAreEqual(boxSolvent, box))
+    const bool bReplicateSolvent = !gmx::boxesAreEqual(boxSolvent, box);
+    if (bReplicateSolvent)
     {
         if (TRICLINIC(boxSolvent))
         {
@@ -667,21 +769,29 @@ static void add_solv(const char*        filename,
         /* apply pbc for solvent configuration for whole molecules */
         rm_res_pbc(atomsSolvent, &xSolvent, boxSolvent);
         replicateSolventBox(atomsSolvent, &xSolvent, &vSolvent, &exclusionDistances_solvt, boxSolvent, box);
-        if (pbcType != PbcType::No)
-        {
-            removeSolventBoxOverlap(atomsSolvent, &xSolvent, &vSolvent, &exclusionDistances_solvt, pbc);
-        }
+    }
+    // All removals are only marked, so that the solvent is compacted once.
+    gmx::AtomsRemover remover(*atomsSolvent);
+    if (bReplicateSolvent && pbcType != PbcType::No)
+    {
+        removeSolventBoxOverlap(*atomsSolvent, xSolvent, exclusionDistances_solvt, pbc, &remover);
     }
     if (atoms->nr > 0)
     {
         if (rshell > 0.0)
         {
-            removeSolventOutsideShell(atomsSolvent, &xSolvent, &vSolvent, &exclusionDistances_solvt,
-                                      pbc, *x, rshell);
+            removeSolventOutsideShell(*atomsSolvent, xSolvent, pbc, *x, rshell, &remover);
         }
-        removeSolventOverlappingWithSolute(atomsSolvent, &xSolvent, &vSolvent,
-                                           &exclusionDistances_solvt, pbc, *x, exclusionDistances);
+        removeSolventOverlappingWithSolute(*atomsSolvent, xSolvent, exclusionDistances_solvt, pbc,
+                                           *x, exclusionDistances, &remover);
+    }
+    remover.removeMarkedElements(&xSolvent);
+    if (!vSolvent.empty())
+    {
+        remover.removeMarkedElements(&vSolvent);
     }
+    remover.removeMarkedElements(&exclusionDistances_solvt);
+    remover.removeMarkedAtoms(atomsSolvent);
 
     if (max_sol > 0 && atomsSolvent->nres > max_sol)
     {
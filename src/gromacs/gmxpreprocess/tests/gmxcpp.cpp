@@ -0,0 +1,193 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the cache of the topology preprocessor output.
+ *
+ * \ingroup module_gmxpreprocess
+ */
+#include "gmxpre.h"
+
+#include "gromacs/gmxpreprocess/gmxcpp.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/path.h"
+#include "gromacs/utility/smalloc.h"
+#include "gromacs/utility/stringutil.h"
+#include "gromacs/utility/textwriter.h"
+
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The output of the preprocessor for a topology
+struct PreprocessedTopology
+{
+    //! Output lines, prefixed by file name and line number
+    std::vector<std::string> lines;
+    //! Value of the define CHARGE at the end of the input
+    std::string charge;
+    //! Warning about unused defines
+    std::string unusedDefineWarning;
+    //! Whether the output was read from the cache
+    bool replayedCache;
+};
+
+class GmxCppCacheTest : public ::testing::Test
+{
+public:
+    GmxCppCacheTest() :
+        topologyFileName_(fileManager_.getTemporaryFilePath("topol.top")),
+        includeFileName_(fileManager_.getTemporaryFilePath("included.itp"))
+    {
+        const std::string topology = formatString(
+                "[ moleculetype ]\n#include \"%s\"\n"
+                "#ifdef FLEXIBLE\nflexible CHARGE\n#else\nrigid\n#endif\n",
+                Path::getFilename(includeFileName_).c_str());
+        TextWriter::writeFileFromString(topologyFileName_, topology);
+        TextWriter::writeFileFromString(includeFileName_, "#define CHARGE 0.5\natom CHARGE\n");
+    }
+
+    //! Preprocesses the topology, with the cache when \p cacheDirectory is not null
+    PreprocessedTopology preprocess(const char* cacheDirectory)
+    {
+        std::vector<char*> cppopts = { gmx_strdup("-DFLEXIBLE"), gmx_strdup("-DUNUSED"), nullptr };
+
+        PreprocessedTopology result;
+        gmx_cpp_t            handle;
+        EXPECT_EQ(eCPP_OK, cpp_open_file(topologyFileName_.c_str(), &handle, cppopts.data(),
+                                         cacheDirectory));
+        result.replayedCache = cpp_is_replaying_cache(&handle);
+        char line[STRLEN];
+        int  status;
+        while ((status = cpp_read_line(&handle, STRLEN, line)) == eCPP_OK)
+        {
+            result.lines.push_back(formatString("%s:%d:%s", cpp_cur_file(&handle),
+                                                cpp_cur_linenr(&handle), line));
+        }
+        EXPECT_EQ(eCPP_EOF, status);
+        const std::string* charge  = cpp_find_define(&handle, "CHARGE");
+        result.charge              = (charge != nullptr) ? *charge : "";
+        result.unusedDefineWarning = checkAndWarnForUnusedDefines(*handle);
+        cpp_done(handle);
+
+        for (char* opt : cppopts)
+        {
+            sfree(opt);
+        }
+        return result;
+    }
+
+    //! Compares the output, apart from whether it came from the cache
+    static void compare(const PreprocessedTopology& reference, const PreprocessedTopology& test)
+    {
+        EXPECT_EQ(reference.lines, test.lines);
+        EXPECT_EQ(reference.charge, test.charge);
+        EXPECT_EQ(reference.unusedDefineWarning, test.unusedDefineWarning);
+    }
+
+    TestFileManager fileManager_;
+    std::string     topologyFileName_;
+    std::string     includeFileName_;
+};
+
+TEST_F(GmxCppCacheTest, ReplaysIdenticalOutput)
+{
+    PreprocessedTopology reference = preprocess(nullptr);
+    EXPECT_FALSE(reference.replayedCache);
+    ASSERT_EQ(3U, reference.lines.size());
+    EXPECT_NE(std::string::npos, reference.lines[2].find("flexible 0.5"));
+    EXPECT_FALSE(reference.unusedDefineWarning.empty());
+
+    const char* cacheDirectory = fileManager_.getOutputTempDirectory();
+    compare(reference, preprocess(cacheDirectory));
+
+    PreprocessedTopology cached = preprocess(cacheDirectory);
+    EXPECT_TRUE(cached.replayedCache);
+    compare(reference, cached);
+}
+
+TEST_F(GmxCppCacheTest, IgnoresCacheWhenIncludedFileChanges)
+{
+    const char* cacheDirectory = fileManager_.getOutputTempDirectory();
+    preprocess(cacheDirectory);
+    EXPECT_TRUE(preprocess(cacheDirectory).replayedCache);
+
+    TextWriter::writeFileFromString(includeFileName_, "#define CHARGE -0.5\natom CHARGE\n");
+    PreprocessedTopology reference = preprocess(nullptr);
+    PreprocessedTopology changed   = preprocess(cacheDirectory);
+    EXPECT_FALSE(changed.replayedCache);
+    compare(reference, changed);
+    EXPECT_EQ("-0.5", changed.charge);
+    EXPECT_TRUE(preprocess(cacheDirectory).replayedCache);
+}
+
+TEST_F(GmxCppCacheTest, IgnoresCacheWhenIncludedFileChangesWithSameSize)
+{
+    const char* cacheDirectory = fileManager_.getOutputTempDirectory();
+    preprocess(cacheDirectory);
+    EXPECT_TRUE(preprocess(cacheDirectory).replayedCache);
+
+    // The modification time can stay the same within a second
+    TextWriter::writeFileFromString(includeFileName_, "#define CHARGE 0.7\natom CHARGE\n");
+    PreprocessedTopology changed = preprocess(cacheDirectory);
+    EXPECT_FALSE(changed.replayedCache);
+    EXPECT_EQ("0.7", changed.charge);
+}
+
+TEST_F(GmxCppCacheTest, ReplaysCacheWhenIncludedFileIsRewrittenUnchanged)
+{
+    const char*          cacheDirectory = fileManager_.getOutputTempDirectory();
+    PreprocessedTopology reference      = preprocess(cacheDirectory);
+
+    TextWriter::writeFileFromString(includeFileName_, "#define CHARGE 0.5\natom CHARGE\n");
+    PreprocessedTopology cached = preprocess(cacheDirectory);
+    EXPECT_TRUE(cached.replayedCache);
+    compare(reference, cached);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -88,6 +88,23 @@ TEST_F(InsertMoleculesTest, InsertsMoleculesIntoEmptyBox)
     runTest(CommandLine(cmdline));
 }
 
+TEST_F(InsertMoleculesTest, InsertsMoleculesIntoEmptyBoxInBatches)
+{
+    const char* const cmdline[] = { "insert-molecules", "-box", "4", "-nmol", "5",
+                                    "-batch", "4",      "-seed", "1997" };
+    setInputFile("-ci", "x2.gro");
+    runTest(CommandLine(cmdline));
+}
+
+TEST_F(InsertMoleculesTest, InsertsMoleculesWithReplacementInBatches)
+{
+    const char* const cmdline[] = { "insert-molecules", "-nmol", "4", "-replace", "all",
+                                    "-batch",           "3",     "-seed", "1997" };
+    setInputFile("-f", "spc216.gro");
+    setInputFile("-ci", "x.gro");
+    runTest(CommandLine(cmdline));
+}
+
 TEST_F(InsertMoleculesTest, InsertsMoleculesIntoEnlargedBox)
 {
     const char* const cmdline[] = { "insert-molecules", "-box", "4", "-nmol", "2", "-seed", "1997" };
@@ -0,0 +1,122 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the hashed lookup of interaction types by their atoms.
+ *
+ * \ingroup module_gmxpreprocess
+ */
+#include "gmxpre.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/gmxpreprocess/grompp_impl.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Returns an interaction type on \p atoms without parameters.
+InteractionOfType makeType(std::vector<int> atoms)
+{
+    return InteractionOfType(atoms, {});
+}
+
+TEST(InteractionTypeIndexTest, FindsNothingInEmptyList)
+{
+    std::vector<InteractionOfType> types;
+    InteractionTypeIndex           index;
+    EXPECT_EQ(index.find(types, std::vector<int>{ 0, 1 }), -1);
+}
+
+TEST(InteractionTypeIndexTest, FindsFirstOfDuplicateEntries)
+{
+    std::vector<InteractionOfType> types = { makeType({ 0, 1 }), makeType({ 1, 0 }),
+                                             makeType({ 0, 1 }) };
+    InteractionTypeIndex           index;
+    EXPECT_EQ(index.find(types, std::vector<int>{ 0, 1 }), 0);
+    EXPECT_EQ(index.find(types, std::vector<int>{ 1, 0 }), 1);
+    EXPECT_EQ(index.find(types, std::vector<int>{ 1, 1 }), -1);
+}
+
+TEST(InteractionTypeIndexTest, DistinguishesNumberOfAtoms)
+{
+    std::vector<InteractionOfType> types = { makeType({ 0, 1 }), makeType({ 0, 1, 2 }) };
+    InteractionTypeIndex           index;
+    EXPECT_EQ(index.find(types, std::vector<int>{ 0, 1, 2 }), 1);
+    EXPECT_EQ(index.find(types, std::vector<int>{ 0, 1 }), 0);
+}
+
+TEST(InteractionTypeIndexTest, MatchesWildcardsLiterally)
+{
+    std::vector<InteractionOfType> types = { makeType({ -1, 1, 2, -1 }), makeType({ 0, 1, 2, 3 }) };
+    InteractionTypeIndex           index;
+    EXPECT_EQ(index.find(types, std::vector<int>{ -1, 1, 2, -1 }), 0);
+    EXPECT_EQ(index.find(types, std::vector<int>{ 0, 1, 2, 3 }), 1);
+    EXPECT_EQ(index.find(types, std::vector<int>{ 0, 1, 2, -1 }), -1);
+}
+
+TEST(InteractionTypeIndexTest, SeesAppendedEntries)
+{
+    std::vector<InteractionOfType> types = { makeType({ 0, 1 }) };
+    InteractionTypeIndex           index;
+    EXPECT_EQ(index.find(types, std::vector<int>{ 2, 3 }), -1);
+    types.push_back(makeType({ 2, 3 }));
+    types.push_back(makeType({ 0, 1 }));
+    EXPECT_EQ(index.find(types, std::vector<int>{ 2, 3 }), 1);
+    EXPECT_EQ(index.find(types, std::vector<int>{ 0, 1 }), 0);
+}
+
+TEST(InteractionTypeIndexTest, ClearForgetsRefilledList)
+{
+    std::vector<InteractionOfType> types = { makeType({ 0, 1 }), makeType({ 2, 3 }) };
+    types.reserve(4);
+    InteractionTypeIndex index;
+    EXPECT_EQ(index.find(types, std::vector<int>{ 2, 3 }), 1);
+    types.clear();
+    types.push_back(makeType({ 2, 3 }));
+    types.push_back(makeType({ 0, 1 }));
+    index.clear();
+    EXPECT_EQ(index.find(types, std::vector<int>{ 2, 3 }), 0);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
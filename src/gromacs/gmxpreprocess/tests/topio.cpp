@@ -0,0 +1,238 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for processing the molecule types of a topology.
+ *
+ * \ingroup module_gmxpreprocess
+ */
+#include "gmxpre.h"
+
+#include "gromacs/gmxpreprocess/topio.h"
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/warninp.h"
+#include "gromacs/gmxpreprocess/gpp_atomtype.h"
+#include "gromacs/gmxpreprocess/grompp_impl.h"
+#include "gromacs/gmxpreprocess/readir.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/topology/symtab.h"
+#include "gromacs/topology/topology.h"
+#include "gromacs/utility/logger.h"
+#include "gromacs/utility/textwriter.h"
+
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Topology with several molecule types, explicit exclusions and warnings
+const char* const c_topology =
+        "[ defaults ]\n"
+        "1 2 yes 0.5 0.8333\n"
+        "\n"
+        "[ atomtypes ]\n"
+        "C 12.011 0.0 A 0.34 0.36\n"
+        "; Defining a type again gives a warning\n"
+        "C 12.011 0.0 A 0.34 0.36\n"
+        "\n"
+        "[ moleculetype ]\n"
+        "Chain 3\n"
+        "[ atoms ]\n"
+        "1 C 1 CHN C1 1 0.0 12.011\n"
+        "2 C 1 CHN C2 1 0.0 12.011\n"
+        "3 C 1 CHN C3 1 0.0 12.011\n"
+        "4 C 1 CHN C4 1 0.0 12.011\n"
+        "5 C 1 CHN C5 1 0.0 12.011\n"
+        "[ bonds ]\n"
+        "1 2 1 0.15 200000\n"
+        "2 3 1 0.15 200000\n"
+        "3 4 1 0.15 200000\n"
+        "4 5 1 0.15 200000\n"
+        "[ exclusions ]\n"
+        "1 5\n"
+        "\n"
+        "[ moleculetype ]\n"
+        "Ion 1\n"
+        "[ atoms ]\n"
+        "1 C 1 ION C1 1 1.0 12.011\n"
+        "2 C 1 ION C2 1 0.0 12.011\n"
+        "3 C 1 ION C3 1 0.0 12.011\n"
+        "[ bonds ]\n"
+        "1 2 1 0.15 200000\n"
+        "2 3 1 0.15 200000\n"
+        "\n"
+        "[ moleculetype ]\n"
+        "Ring 2\n"
+        "[ atoms ]\n"
+        "1 C 1 RNG C1 1 0.0 12.011\n"
+        "2 C 1 RNG C2 1 0.0 12.011\n"
+        "3 C 1 RNG C3 1 0.0 12.011\n"
+        "4 C 1 RNG C4 1 0.0 12.011\n"
+        "5 C 1 RNG C5 1 0.0 12.011\n"
+        "6 C 1 RNG C6 1 0.0 12.011\n"
+        "[ bonds ]\n"
+        "1 2 1 0.15 200000\n"
+        "2 3 1 0.15 200000\n"
+        "3 4 1 0.15 200000\n"
+        "4 5 1 0.15 200000\n"
+        "5 6 1 0.15 200000\n"
+        "6 1 1 0.15 200000\n"
+        "[ exclusions ]\n"
+        "2 5\n"
+        "\n"
+        "[ moleculetype ]\n"
+        "Pair 0\n"
+        "[ atoms ]\n"
+        "1 C 1 PAI C1 1 0.0 12.011\n"
+        "2 C 1 PAI C2 1 0.0 12.011\n"
+        "[ bonds ]\n"
+        "1 2 1 0.15 200000\n"
+        "\n"
+        "[ system ]\n"
+        "Several molecule types\n"
+        "\n"
+        "[ molecules ]\n"
+        "Chain 2\n"
+        "Ion 3\n"
+        "Ring 1\n"
+        "Chain 1\n"
+        "Pair 2\n";
+
+//! The exclusions and warnings of a processed topology
+struct ProcessedTopology
+{
+    //! The excluded atoms of each atom of each molecule type
+    std::vector<std::vector<std::vector<int>>> exclusions;
+    //! Warnings and notes issued while processing the topology
+    std::string warnings;
+};
+
+class TopologyProcessingTest : public ::testing::Test
+{
+public:
+    TopologyProcessingTest() : topologyFileName_(fileManager_.getTemporaryFilePath("topol.top"))
+    {
+        TextWriter::writeFileFromString(topologyFileName_, c_topology);
+    }
+
+    //! Processes the topology with exclusions generated by \p numThreads threads
+    ProcessedTopology processTopology(int numThreads)
+    {
+        char         emptyString[] = "";
+        t_gromppopts opts          = {};
+        opts.include               = emptyString;
+        opts.define                = emptyString;
+        opts.numThreads            = numThreads;
+        t_inputrec ir;
+        // Ewald electrostatics give an additional warning for the net charge
+        ir.coulombtype = eelPME;
+
+        t_symtab symtab;
+        open_symtab(&symtab);
+        std::array<InteractionsOfType, F_NRE> interactions;
+        int                                   combinationRule;
+        double                                repulsionPower;
+        real                                  fudgeQQ;
+        PreprocessingAtomTypes                atomTypes;
+        std::vector<MoleculeInformation>      molinfo;
+        std::unique_ptr<MoleculeInformation>  intermolecularInteractions;
+        std::vector<gmx_molblock_t>           molblock;
+        bool                                  ffParametrizedWithHBondConstraints;
+        warninp*                              wi = init_warning(TRUE, 0);
+        MDLogger                              logger;
+
+        ProcessedTopology result;
+        ::testing::internal::CaptureStderr();
+        do_top(false, topologyFileName_.c_str(), nullptr, &opts, false, &symtab, interactions,
+               &combinationRule, &repulsionPower, &fudgeQQ, &atomTypes, &molinfo,
+               &intermolecularInteractions, &ir, &molblock, &ffParametrizedWithHBondConstraints,
+               wi, logger);
+        result.warnings = ::testing::internal::GetCapturedStderr();
+
+        for (MoleculeInformation& mi : molinfo)
+        {
+            std::vector<std::vector<int>> exclusions;
+            for (gmx::index i = 0; i < mi.excls.ssize(); i++)
+            {
+                exclusions.emplace_back(mi.excls[i].begin(), mi.excls[i].end());
+            }
+            result.exclusions.push_back(exclusions);
+            mi.fullCleanUp();
+        }
+        free_warning(wi);
+        done_symtab(&symtab);
+
+        return result;
+    }
+
+private:
+    //! Provides the topology file
+    TestFileManager fileManager_;
+    //! Name of the topology file
+    std::string topologyFileName_;
+};
+
+TEST_F(TopologyProcessingTest, ParallelExclusionGenerationMatchesSerial)
+{
+    const ProcessedTopology serial   = processTopology(1);
+    const ProcessedTopology parallel = processTopology(4);
+
+    ASSERT_EQ(4U, serial.exclusions.size());
+    // The explicit exclusion of the chain ends is merged with the generated ones
+    EXPECT_EQ((std::vector<int>{ 0, 1, 2, 3, 4 }), serial.exclusions[0][0]);
+    EXPECT_EQ((std::vector<int>{ 0 }), serial.exclusions[3][0]);
+    EXPECT_NE(std::string::npos, serial.warnings.find("Atomtype C was defined previously"));
+    EXPECT_NE(std::string::npos, serial.warnings.find("non-zero total charge"));
+
+    EXPECT_EQ(serial.exclusions, parallel.exclusions);
+    EXPECT_EQ(serial.warnings, parallel.warnings);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
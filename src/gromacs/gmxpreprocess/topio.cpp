@@ -51,6 +51,7 @@
 #include <memory>
 
 #include <unordered_set>
+#include <vector>
 #include <sys/types.h>
 
 #include "gromacs/fileio/gmxfio.h"
@@ -77,6 +78,7 @@
 #include "gromacs/topology/symtab.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
@@ -105,6 +107,8 @@ static void gen_pairs(const InteractionsOfType& nbs, InteractionsOfType* pairs,
 
     fprintf(stderr, "Generating 1-4 interactions: fudge = %g\n", fudge);
     pairs->interactionTypes.clear();
+    pairs->typeIndex.clear();
+    pairs->interactionTypes.reserve(ntp);
     int                             i = 0;
     std::array<int, 2>              atomNumbers;
     std::array<real, MAXFORCEPARAM> forceParam = { NOTSET };
@@ -365,6 +369,120 @@ static void make_atoms_sys(gmx::ArrayRef<const gmx_molblock_t>      molblock,
 }
 
 
+//! Returns whether the molecule type should be (de)coupled for free-energy calculations
+static bool isCoupledMoleculeType(const MoleculeInformation& molType, const t_gromppopts& opts)
+{
+    return (opts.couple_moltype != nullptr
+            && (gmx_strcasecmp("system", opts.couple_moltype) == 0
+                || strcmp(*(molType.name), opts.couple_moltype) == 0));
+}
+
+//! The input file and line of a [ molecules ] entry, for warnings about its block
+struct MolblockLocation
+{
+    //! The input file
+    std::string file;
+    //! The line in the input file
+    int line;
+};
+
+//! Generates the exclusions of a molecule type and merges in the explicit exclusions
+static void generateMoleculeTypeExclusions(MoleculeInformation*                 mi,
+                                           gmx::ArrayRef<gmx::ExclusionBlock> exclusionBlocks)
+{
+    generate_excl(mi->nrexcl, mi->atoms.nr, mi->interactions, &(mi->excls));
+    gmx::mergeExclusions(&(mi->excls), exclusionBlocks);
+}
+
+/*! \brief Processes the molecule types used in \p molblock and sums the charges
+ *
+ * Exclusion generation only touches the molecule type itself, so when more
+ * than one thread is requested in \p opts, it is done concurrently for all
+ * types that have not been processed yet. This is off by default, since
+ * OpenMP cannot be used in a process that was forked from a parent that had
+ * already started OpenMP threads, as happens when grompp is called as a
+ * library. Constraint conversion and decoupling log, warn and modify the
+ * non-bonded parameters, so these are applied afterwards in the order of the
+ * [ molecules ] entries. This keeps the output independent of the number of
+ * threads. Warnings refer to the [ molecules ] entry of the block, given by
+ * \p locations.
+ */
+static void processMoleculeBlocks(gmx::ArrayRef<const gmx_molblock_t>             molblock,
+                                  gmx::ArrayRef<const MolblockLocation>           locations,
+                                  gmx::ArrayRef<MoleculeInformation>              molinfo,
+                                  gmx::ArrayRef<std::vector<gmx::ExclusionBlock>> exclusionBlocks,
+                                  const t_gromppopts&                             opts,
+                                  int                                             dcatt,
+                                  real                                            fudgeQQ,
+                                  int                                             nb_funct,
+                                  InteractionsOfType*                             nbInteractions,
+                                  double*                                         qTotA,
+                                  double*                                         qTotB,
+                                  warninp*                                        wi,
+                                  const gmx::MDLogger&                            logger)
+{
+    std::vector<int>  typesToProcess;
+    std::vector<bool> isQueued(molinfo.size(), false);
+    for (const gmx_molblock_t& molb : molblock)
+    {
+        if (!molinfo[molb.type].bProcessed && !isQueued[molb.type])
+        {
+            typesToProcess.push_back(molb.type);
+            isQueued[molb.type] = true;
+        }
+    }
+
+    const int numTypesToProcess = gmx::ssize(typesToProcess);
+    if (numTypesToProcess > 1 && opts.numThreads > 1)
+    {
+#pragma omp parallel for num_threads(opts.numThreads) schedule(dynamic)
+        for (int i = 0; i < numTypesToProcess; i++)
+        {
+            try
+            {
+                generateMoleculeTypeExclusions(&molinfo[typesToProcess[i]],
+                                               exclusionBlocks[typesToProcess[i]]);
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
+    }
+    else
+    {
+        for (int type : typesToProcess)
+        {
+            generateMoleculeTypeExclusions(&molinfo[type], exclusionBlocks[type]);
+        }
+    }
+
+    const std::string currentFile = get_warning_file(wi);
+    const int         currentLine = get_warning_line(wi);
+    for (gmx::index b = 0; b < molblock.ssize(); b++)
+    {
+        const gmx_molblock_t& molb = molblock[b];
+        MoleculeInformation*  mi   = &molinfo[molb.type];
+        set_warning_line(wi, locations[b].file.c_str(), locations[b].line);
+        GMX_LOG(logger.info)
+                .asParagraph()
+                .appendTextFormatted("Excluding %d bonded neighbours molecule type '%s'",
+                                     mi->nrexcl, *mi->name);
+        sum_q(&mi->atoms, molb.nmol, qTotA, qTotB);
+        if (!mi->bProcessed)
+        {
+            make_shake(mi->interactions, &mi->atoms, opts.nshake, logger);
+
+            if (isCoupledMoleculeType(*mi, opts))
+            {
+                convert_moltype_couple(mi, dcatt, fudgeQQ, opts.couple_lam0, opts.couple_lam1,
+                                       opts.bCoupleIntra, nb_funct, nbInteractions, wi);
+            }
+            stupid_fill_block(&mi->mols, mi->atoms.nr, TRUE);
+            mi->bProcessed = TRUE;
+        }
+    }
+    set_warning_line(wi, currentFile.c_str(), currentLine);
+}
+
+
 static char** read_topol(const char*                           infile,
                          const char*                           outfile,
                          const char*                           define,
@@ -424,13 +542,20 @@ static char** read_topol(const char*                           infile,
         out = nullptr;
     }
 
-    /* open input file */
-    auto cpp_opts_return = cpp_opts(define, include, wi);
-    status               = cpp_open_file(infile, &handle, cpp_opts_return);
+    /* open input file, using the preprocessor output cache when requested */
+    const char* cacheDirectory  = getenv("GMX_GROMPP_CACHE_DIR");
+    auto        cpp_opts_return = cpp_opts(define, include, wi);
+    status                      = cpp_open_file(infile, &handle, cpp_opts_return, cacheDirectory);
     if (status != 0)
     {
         gmx_fatal(FARGS, "%s", cpp_error(&handle, status));
     }
+    if (cpp_is_replaying_cache(&handle))
+    {
+        GMX_LOG(logger.info)
+                .asParagraph()
+                .appendTextFormatted("Using the cached preprocessed topology of %s", infile);
+    }
 
     /* some local variables */
     DS_Init(&DS);                   /* directive stack	*/
@@ -438,7 +563,11 @@ static char** read_topol(const char*                           infile,
     nbparam = nullptr;              /* The temporary non-bonded matrix */
     pair    = nullptr;              /* The temporary pair interaction matrix */
     std::vector<std::vector<gmx::ExclusionBlock>> exclusionBlocks;
-    nb_funct = F_LJ;
+    /* Molecule blocks whose molecule types have been processed */
+    size_t numProcessedMolblocks = 0;
+    /* Where each molecule block was listed in the input */
+    std::vector<MolblockLocation> molblockLocations;
+    nb_funct                     = F_LJ;
 
     *reppow = 12.0; /* Default value for repulsion power     */
 
@@ -569,6 +698,16 @@ static char** read_topol(const char*                           infile,
                                 *intermolecular_interactions = std::make_unique<MoleculeInformation>();
                                 mi0                          = intermolecular_interactions->get();
                                 mi0->initMolInfo();
+                                processMoleculeBlocks(
+                                        gmx::constArrayRefFromArray(
+                                                molblock->data() + numProcessedMolblocks,
+                                                molblock->size() - numProcessedMolblocks),
+                                        gmx::constArrayRefFromArray(
+                                                molblockLocations.data() + numProcessedMolblocks,
+                                                molblockLocations.size() - numProcessedMolblocks),
+                                        *molinfo, exclusionBlocks, *opts, dcatt, *fudgeQQ,
+                                        nb_funct, &(interactions[nb_funct]), &qt, &qBt, wi, logger);
+                                numProcessedMolblocks = molblock->size();
                                 make_atoms_sys(*molblock, *molinfo, &mi0->atoms);
                             }
                         }
@@ -805,19 +944,17 @@ static char** read_topol(const char*                           infile,
                             break;
                         case Directive::d_molecules:
                         {
-                            int  whichmol;
-                            bool bCouple;
+                            int whichmol;
 
                             push_mol(*molinfo, pline, &whichmol, &nrcopies, wi);
                             mi0 = &((*molinfo)[whichmol]);
                             molblock->resize(molblock->size() + 1);
                             molblock->back().type = whichmol;
                             molblock->back().nmol = nrcopies;
+                            molblockLocations.push_back(
+                                    { get_warning_file(wi), get_warning_line(wi) });
 
-                            bCouple = (opts->couple_moltype != nullptr
-                                       && (gmx_strcasecmp("system", opts->couple_moltype) == 0
-                                           || strcmp(*(mi0->name), opts->couple_moltype) == 0));
-                            if (bCouple)
+                            if (isCoupledMoleculeType(*mi0, *opts))
                             {
                                 nmol_couple += nrcopies;
                             }
@@ -826,27 +963,6 @@ static char** read_topol(const char*                           infile,
                             {
                                 gmx_fatal(FARGS, "Molecule type '%s' contains no atoms", *mi0->name);
                             }
-                            GMX_LOG(logger.info)
-                                    .asParagraph()
-                                    .appendTextFormatted(
-                                            "Excluding %d bonded neighbours molecule type '%s'",
-                                            mi0->nrexcl, *mi0->name);
-                            sum_q(&mi0->atoms, nrcopies, &qt, &qBt);
-                            if (!mi0->bProcessed)
-                            {
-                                generate_excl(mi0->nrexcl, mi0->atoms.nr, mi0->interactions, &(mi0->excls));
-                                gmx::mergeExclusions(&(mi0->excls), exclusionBlocks[whichmol]);
-                                make_shake(mi0->interactions, &mi0->atoms, opts->nshake, logger);
-
-                                if (bCouple)
-                                {
-                                    convert_moltype_couple(mi0, dcatt, *fudgeQQ, opts->couple_lam0,
-                                                           opts->couple_lam1, opts->bCoupleIntra,
-                                                           nb_funct, &(interactions[nb_funct]), wi);
-                                }
-                                stupid_fill_block(&mi0->mols, mi0->atoms.nr, TRUE);
-                                mi0->bProcessed = TRUE;
-                            }
                             break;
                         }
                         default:
@@ -862,6 +978,14 @@ static char** read_topol(const char*                           infile,
         }
     } while (!done);
 
+    processMoleculeBlocks(
+            gmx::constArrayRefFromArray(molblock->data() + numProcessedMolblocks,
+                                        molblock->size() - numProcessedMolblocks),
+            gmx::constArrayRefFromArray(molblockLocations.data() + numProcessedMolblocks,
+                                        molblockLocations.size() - numProcessedMolblocks),
+            *molinfo, exclusionBlocks, *opts, dcatt, *fudgeQQ, nb_funct, &(interactions[nb_funct]),
+            &qt, &qBt, wi, logger);
+
     // Check that all strings defined with -D were used when processing topology
     std::string unusedDefineWarning = checkAndWarnForUnusedDefines(*handle);
     if (!unusedDefineWarning.empty())
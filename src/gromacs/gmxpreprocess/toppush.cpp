@@ -45,7 +45,9 @@
 #include <cstring>
 
 #include <algorithm>
+#include <array>
 #include <string>
+#include <vector>
 
 #include "gromacs/fileio/warninp.h"
 #include "gromacs/gmxpreprocess/gpp_atomtype.h"
@@ -80,6 +82,8 @@ void generate_nbparams(int                     comb,
     nr   = atypes->size();
     nrfp = NRFP(ftype);
     interactions->interactionTypes.clear();
+    interactions->typeIndex.clear();
+    interactions->interactionTypes.reserve(nr * nr);
 
     std::array<real, MAXFORCEPARAM> forceParam = { NOTSET };
     /* Fill the matrix with force parameters */
@@ -1484,37 +1488,23 @@ void push_molt(t_symtab* symtab, std::vector<MoleculeInformation>* mol, char* li
     mol->back().excl_set = false;
 }
 
-static bool findIfAllNBAtomsMatch(gmx::ArrayRef<const int> atomsFromParameterArray,
-                                  gmx::ArrayRef<const int> atomsFromCurrentParameter,
-                                  const t_atoms*           at,
-                                  bool                     bB)
+/*! \brief Returns the atom types, or with \p bB the B-state atom types, of \p atoms.
+ *
+ * When \p atypes is passed, the bond atom types of those are returned instead.
+ */
+static std::vector<int> typesOfAtoms(gmx::ArrayRef<const int>      atoms,
+                                     const t_atoms*                at,
+                                     const PreprocessingAtomTypes* atypes,
+                                     bool                          bB)
 {
-    if (atomsFromParameterArray.size() != atomsFromCurrentParameter.size())
-    {
-        return false;
-    }
-    else if (bB)
+    std::vector<int> types;
+    types.reserve(atoms.size());
+    for (const int atom : atoms)
     {
-        for (gmx::index i = 0; i < atomsFromCurrentParameter.ssize(); i++)
-        {
-            if (at->atom[atomsFromCurrentParameter[i]].typeB != atomsFromParameterArray[i])
-            {
-                return false;
-            }
-        }
-        return true;
-    }
-    else
-    {
-        for (gmx::index i = 0; i < atomsFromCurrentParameter.ssize(); i++)
-        {
-            if (at->atom[atomsFromCurrentParameter[i]].type != atomsFromParameterArray[i])
-            {
-                return false;
-            }
-        }
-        return true;
+        const int type = bB ? at->atom[atom].typeB : at->atom[atom].type;
+        types.push_back(atypes ? atypes->bondAtomTypeFromAtomType(type) : type);
     }
+    return types;
 }
 
 static bool default_nb_params(int                               ftype,
@@ -1569,19 +1559,15 @@ static bool default_nb_params(int                               ftype,
         }
     }
 
-    gmx::ArrayRef<const int> paramAtoms = p->atoms();
-    /* Search explicitly if we didnt find it */
+    /* Look it up explicitly if we didnt find it */
     if (!bFound)
     {
-        auto foundParameter =
-                std::find_if(bt[ftype].interactionTypes.begin(), bt[ftype].interactionTypes.end(),
-                             [&paramAtoms, &at, &bB](const auto& param) {
-                                 return findIfAllNBAtomsMatch(param.atoms(), paramAtoms, at, bB);
-                             });
-        if (foundParameter != bt[ftype].interactionTypes.end())
+        const int index = bt[ftype].typeIndex.find(bt[ftype].interactionTypes,
+                                                   typesOfAtoms(p->atoms(), at, nullptr, bB));
+        if (index >= 0)
         {
             bFound = true;
-            pi     = &(*foundParameter);
+            pi     = &(bt[ftype].interactionTypes[index]);
         }
     }
 
@@ -1634,25 +1620,17 @@ static bool default_cmap_params(gmx::ArrayRef<InteractionsOfType> bondtype,
     ct           = 0;
 
     /* Match the current cmap angle against the list of cmap_types */
-    for (int i = 0; i < bondtype[F_CMAP].nct() && !bFound; i += 6)
+    if (!bB)
     {
-        if (bB) {}
-        else
+        const std::vector<int>   types         = typesOfAtoms(p->atoms(), at, atypes, bB);
+        gmx::ArrayRef<const int> cmapAtomTypes = bondtype[F_CMAP].cmapAtomTypes;
+        for (int i = 0; i < bondtype[F_CMAP].nct() && !bFound; i += 6)
         {
-            if ((atypes->bondAtomTypeFromAtomType(at->atom[p->ai()].type)
-                 == bondtype[F_CMAP].cmapAtomTypes[i])
-                && (atypes->bondAtomTypeFromAtomType(at->atom[p->aj()].type)
-                    == bondtype[F_CMAP].cmapAtomTypes[i + 1])
-                && (atypes->bondAtomTypeFromAtomType(at->atom[p->ak()].type)
-                    == bondtype[F_CMAP].cmapAtomTypes[i + 2])
-                && (atypes->bondAtomTypeFromAtomType(at->atom[p->al()].type)
-                    == bondtype[F_CMAP].cmapAtomTypes[i + 3])
-                && (atypes->bondAtomTypeFromAtomType(at->atom[p->am()].type)
-                    == bondtype[F_CMAP].cmapAtomTypes[i + 4]))
+            if (std::equal(types.begin(), types.end(), cmapAtomTypes.begin() + i))
             {
                 /* Found cmap torsion */
                 bFound       = true;
-                ct           = bondtype[F_CMAP].cmapAtomTypes[i + 5];
+                ct           = cmapAtomTypes[i + 5];
                 nparam_found = 1;
             }
         }
@@ -1672,86 +1650,6 @@ static bool default_cmap_params(gmx::ArrayRef<InteractionsOfType> bondtype,
     return bFound;
 }
 
-/* Returns the number of exact atom type matches, i.e. non wild-card matches,
- * returns -1 when there are no matches at all.
- */
-static int natom_match(const InteractionOfType&      pi,
-                       int                           type_i,
-                       int                           type_j,
-                       int                           type_k,
-                       int                           type_l,
-                       const PreprocessingAtomTypes* atypes)
-{
-    if ((pi.ai() == -1 || atypes->bondAtomTypeFromAtomType(type_i) == pi.ai())
-        && (pi.aj() == -1 || atypes->bondAtomTypeFromAtomType(type_j) == pi.aj())
-        && (pi.ak() == -1 || atypes->bondAtomTypeFromAtomType(type_k) == pi.ak())
-        && (pi.al() == -1 || atypes->bondAtomTypeFromAtomType(type_l) == pi.al()))
-    {
-        return (pi.ai() == -1 ? 0 : 1) + (pi.aj() == -1 ? 0 : 1) + (pi.ak() == -1 ? 0 : 1)
-               + (pi.al() == -1 ? 0 : 1);
-    }
-    else
-    {
-        return -1;
-    }
-}
-
-static int findNumberOfDihedralAtomMatches(const InteractionOfType& currentParamFromParameterArray,
-                                           const InteractionOfType& parameterToAdd,
-                                           const t_atoms*           at,
-                                           const PreprocessingAtomTypes* atypes,
-                                           bool                          bB)
-{
-    if (bB)
-    {
-        return natom_match(currentParamFromParameterArray, at->atom[parameterToAdd.ai()].typeB,
-                           at->atom[parameterToAdd.aj()].typeB, at->atom[parameterToAdd.ak()].typeB,
-                           at->atom[parameterToAdd.al()].typeB, atypes);
-    }
-    else
-    {
-        return natom_match(currentParamFromParameterArray, at->atom[parameterToAdd.ai()].type,
-                           at->atom[parameterToAdd.aj()].type, at->atom[parameterToAdd.ak()].type,
-                           at->atom[parameterToAdd.al()].type, atypes);
-    }
-}
-
-static bool findIfAllParameterAtomsMatch(gmx::ArrayRef<const int>      atomsFromParameterArray,
-                                         gmx::ArrayRef<const int>      atomsFromCurrentParameter,
-                                         const t_atoms*                at,
-                                         const PreprocessingAtomTypes* atypes,
-                                         bool                          bB)
-{
-    if (atomsFromParameterArray.size() != atomsFromCurrentParameter.size())
-    {
-        return false;
-    }
-    else if (bB)
-    {
-        for (gmx::index i = 0; i < atomsFromCurrentParameter.ssize(); i++)
-        {
-            if (atypes->bondAtomTypeFromAtomType(at->atom[atomsFromCurrentParameter[i]].typeB)
-                != atomsFromParameterArray[i])
-            {
-                return false;
-            }
-        }
-        return true;
-    }
-    else
-    {
-        for (gmx::index i = 0; i < atomsFromCurrentParameter.ssize(); i++)
-        {
-            if (atypes->bondAtomTypeFromAtomType(at->atom[atomsFromCurrentParameter[i]].type)
-                != atomsFromParameterArray[i])
-            {
-                return false;
-            }
-        }
-        return true;
-    }
-}
-
 static std::vector<InteractionOfType>::iterator defaultInteractionsOfType(int ftype,
                                                                           gmx::ArrayRef<InteractionsOfType> bt,
                                                                           t_atoms* at,
@@ -1773,26 +1671,34 @@ static std::vector<InteractionOfType>::iterator defaultInteractionsOfType(int ft
     nparam_found = 0;
     if (ftype == F_PDIHS || ftype == F_RBDIHS || ftype == F_IDIHS || ftype == F_PIDIHS)
     {
-        int nmatch_max = -1;
-
         /* For dihedrals we allow wildcards. We choose the first type
          * that has the most real matches, i.e. non-wildcard matches.
+         * A matching type has either a wildcard or the type of the atom
+         * at each position, so we look up all these combinations.
          */
-        auto prevPos = bt[ftype].interactionTypes.end();
-        auto pos     = bt[ftype].interactionTypes.begin();
-        while (pos != bt[ftype].interactionTypes.end() && nmatch_max < 4)
-        {
-            pos = std::find_if(bt[ftype].interactionTypes.begin(), bt[ftype].interactionTypes.end(),
-                               [&p, &at, &atypes, &bB, &nmatch_max](const auto& param) {
-                                   return (findNumberOfDihedralAtomMatches(param, p, at, atypes, bB)
-                                           > nmatch_max);
-                               });
-            if (pos != bt[ftype].interactionTypes.end())
+        const std::vector<int> types = typesOfAtoms(p.atoms(), at, atypes, bB);
+        GMX_RELEASE_ASSERT(types.size() == 4, "Dihedrals have four atoms");
+        std::array<int, 4> typesOrWildcards;
+        int                nmatch_max = -1;
+        int                bestIndex  = -1;
+        for (int mask = 0; mask < (1 << 4); mask++)
+        {
+            int nmatch = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                typesOrWildcards[i] = (mask & (1 << i)) ? types[i] : -1;
+                nmatch += (typesOrWildcards[i] == -1) ? 0 : 1;
+            }
+            const int index =
+                    bt[ftype].typeIndex.find(bt[ftype].interactionTypes, typesOrWildcards);
+            if (index >= 0 && (nmatch > nmatch_max || (nmatch == nmatch_max && index < bestIndex)))
             {
-                prevPos    = pos;
-                nmatch_max = findNumberOfDihedralAtomMatches(*pos, p, at, atypes, bB);
+                nmatch_max = nmatch;
+                bestIndex  = index;
             }
         }
+        auto prevPos = (bestIndex >= 0) ? bt[ftype].interactionTypes.begin() + bestIndex
+                                        : bt[ftype].interactionTypes.end();
 
         if (prevPos != bt[ftype].interactionTypes.end())
         {
@@ -1828,12 +1734,10 @@ static std::vector<InteractionOfType>::iterator defaultInteractionsOfType(int ft
     }
     else /* Not a dihedral */
     {
-        gmx::ArrayRef<const int> atomParam = p.atoms();
-        auto                     found     = std::find_if(
-                bt[ftype].interactionTypes.begin(), bt[ftype].interactionTypes.end(),
-                [&atomParam, &at, &atypes, &bB](const auto& param) {
-                    return findIfAllParameterAtomsMatch(param.atoms(), atomParam, at, atypes, bB);
-                });
+        const int index = bt[ftype].typeIndex.find(bt[ftype].interactionTypes,
+                                                   typesOfAtoms(p.atoms(), at, atypes, bB));
+        auto      found = (index >= 0) ? bt[ftype].interactionTypes.begin() + index
+                                       : bt[ftype].interactionTypes.end();
         if (found != bt[ftype].interactionTypes.end())
         {
             nparam_found = 1;
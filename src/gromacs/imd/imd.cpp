@@ -53,8 +53,16 @@
 #include "config.h"
 
 #include <cerrno>
+#include <cinttypes>
+#include <cstdlib>
 #include <cstring>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "gromacs/commandline/filenm.h"
 #include "gromacs/domdec/domdec_struct.h"
 #include "gromacs/domdec/ga2la.h"
@@ -101,6 +109,9 @@ constexpr int c_headerSize = 8;
 /*! \brief IMD Protocol Version. */
 constexpr int c_protocolVersion = 2;
 
+/*! \brief Number of frames the sender thread can lag behind before the oldest one is dropped. */
+constexpr int c_sendRingSize = 2;
+
 /*! \internal
  * \brief
  * IMD (interactive molecular dynamics) energy record.
@@ -205,6 +216,20 @@ public:
     void prepareForPositionAssembly(const t_commrec* cr, const rvec x[]);
     /*! \brief Interact with any connected VMD session */
     bool run(int64_t step, bool bNS, const matrix box, const rvec x[], double t);
+    /*! \brief Starts the thread that sends frames to the freshly connected client. */
+    void startSender();
+    /*! \brief Stops and joins the sender thread.
+     *
+     * With \p flush the frames still in the send ring are written first,
+     * otherwise they are discarded.
+     */
+    void stopSender(bool flush);
+    /*! \brief Sends frames from the send ring until told to stop, runs on the sender thread. */
+    void senderLoop(IMDSocket* client);
+    /*! \brief Disconnects the client if the sender thread failed to write a frame. */
+    void checkSender();
+    /*! \brief Serializes the energies and positions and sends or queues them for the client. */
+    void sendFrame();
 
     // TODO rename all the data members to have underscore suffixes
 
@@ -281,10 +306,8 @@ public:
 
     //! Buffer for force sending.
     char* forcesendbuf = nullptr;
-    //! Buffer for coordinate sending.
-    char* coordsendbuf = nullptr;
-    //! Send buffer for energies.
-    char* energysendbuf = nullptr;
+    //! Serialized energy and position messages of the current frame.
+    std::vector<char> frameBuffer_;
     //! Buffer to make molecules whole before sending.
     rvec* sendxbuf = nullptr;
 
@@ -309,6 +332,30 @@ public:
     gmx_wallcycle* wcycle = nullptr;
     //! Energy output handler
     gmx_enerdata_t* enerd = nullptr;
+
+    /* The next block is used on the master node only, to send frames to
+     * the client from a background thread so that a slow client or
+     * network does not stall the simulation */
+    //! Whether frames are sent by the sender thread instead of the simulation thread.
+    bool bThreadedSend_ = false;
+    //! Thread writing queued frames to the client socket.
+    std::thread senderThread_;
+    //! Protects the send ring and stopSender_.
+    std::mutex ringMutex_;
+    //! Signals the sender thread that a frame was queued or that it should stop.
+    std::condition_variable ringCondition_;
+    //! Ring of serialized frames waiting to be sent.
+    std::vector<std::vector<char>> sendRing_ = std::vector<std::vector<char>>(c_sendRingSize);
+    //! Index of the oldest queued frame in sendRing_.
+    int ringFirst_ = 0;
+    //! Number of queued frames.
+    int ringCount_ = 0;
+    //! Set to ask the sender thread to exit once the ring is empty.
+    bool stopSender_ = false;
+    //! Set by the sender thread when writing to the client failed.
+    std::atomic<bool> sendFailed_{ false };
+    //! Number of frames dropped since connecting because the client fell behind.
+    int64_t numDroppedFrames_ = 0;
 };
 
 /*! \internal
@@ -460,17 +507,17 @@ static int imd_handshake(IMDSocket* socket)
 }
 
 
-/*! \brief Send energies using the energy block and the send buffer. */
-static int imd_send_energies(IMDSocket* socket, const IMDEnergyBlock* energies, char* buffer)
+/*! \brief Append the energy message built from the energy block to the frame buffer. */
+static void imd_append_energies(std::vector<char>* frame, const IMDEnergyBlock* energies)
 {
-    int32_t recsize;
-
+    IMDHeader header;
 
-    recsize = c_headerSize + sizeof(IMDEnergyBlock);
-    fill_header(reinterpret_cast<IMDHeader*>(buffer), IMD_ENERGIES, 1);
-    memcpy(buffer + c_headerSize, energies, sizeof(IMDEnergyBlock));
 
-    return static_cast<int>(imd_write_multiple(socket, buffer, recsize) != recsize);
+    fill_header(&header, IMD_ENERGIES, 1);
+    const char* headerBytes = reinterpret_cast<const char*>(&header);
+    const char* energyBytes = reinterpret_cast<const char*>(energies);
+    frame->insert(frame->end(), headerBytes, headerBytes + c_headerSize);
+    frame->insert(frame->end(), energyBytes, energyBytes + sizeof(IMDEnergyBlock));
 }
 
 
@@ -544,32 +591,30 @@ void ImdSession::dd_make_local_IMD_atoms(const gmx_domdec_t* dd)
 }
 
 
-/*! \brief Send positions from rvec.
+/*! \brief Append the position message built from rvec to the frame buffer.
  *
- * We need a separate send buffer and conversion to Angstrom.
+ * Positions are converted to float and to Angstrom.
  */
-static int imd_send_rvecs(IMDSocket* socket, int nat, rvec* x, char* buffer)
+static void imd_append_rvecs(std::vector<char>* frame, int nat, const rvec* x)
 {
-    int32_t size;
-    int     i;
-    float   sendx[3];
-    int     tuplesize = 3 * sizeof(float);
+    int   tuplesize = 3 * sizeof(float);
+    float sendx[3];
 
 
-    /* Required size for the send buffer */
-    size = c_headerSize + 3 * sizeof(float) * nat;
+    /* Make room for the header and all positions in one go */
+    size_t offset = frame->size();
+    frame->resize(offset + c_headerSize + tuplesize * nat);
+    char* buffer = frame->data() + offset;
 
     /* Prepare header */
     fill_header(reinterpret_cast<IMDHeader*>(buffer), IMD_FCOORDS, static_cast<int32_t>(nat));
-    for (i = 0; i < nat; i++)
+    for (int i = 0; i < nat; i++)
     {
         sendx[0] = static_cast<float>(x[i][0]) * NM2A;
         sendx[1] = static_cast<float>(x[i][1]) * NM2A;
         sendx[2] = static_cast<float>(x[i][2]) * NM2A;
         memcpy(buffer + c_headerSize + i * tuplesize, sendx, tuplesize);
     }
-
-    return static_cast<int>(imd_write_multiple(socket, buffer, size) != size);
 }
 
 
@@ -611,6 +656,11 @@ void ImdSession::Impl::prepareMasterSocket()
 
 void ImdSession::Impl::disconnectClient()
 {
+    /* Frames still queued for this client can no longer be delivered */
+    stopSender(false);
+    /* A failed send refers to this client only, so it should not be reported again */
+    sendFailed_ = false;
+
     /* Write out any buffered pulling data */
     fflush(outf);
 
@@ -636,6 +686,117 @@ void ImdSession::Impl::issueFatalError(const char* msg)
 }
 
 
+void ImdSession::Impl::startSender()
+{
+    ringFirst_        = 0;
+    ringCount_        = 0;
+    stopSender_       = false;
+    sendFailed_       = false;
+    numDroppedFrames_ = 0;
+    senderThread_     = std::thread([this, client = clientsocket] { senderLoop(client); });
+}
+
+
+void ImdSession::Impl::stopSender(bool flush)
+{
+    if (!senderThread_.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(ringMutex_);
+        if (!flush)
+        {
+            ringCount_ = 0;
+        }
+        stopSender_ = true;
+    }
+    ringCondition_.notify_one();
+    senderThread_.join();
+
+    if (numDroppedFrames_ > 0)
+    {
+        GMX_LOG(mdlog.warning)
+                .appendTextFormatted(
+                        "%s Skipped %" PRId64 " frames because the client could not keep up.",
+                        IMDstr, numDroppedFrames_);
+    }
+}
+
+
+void ImdSession::Impl::senderLoop(IMDSocket* client)
+{
+    std::vector<char> frame;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(ringMutex_);
+            ringCondition_.wait(lock, [this] { return ringCount_ > 0 || stopSender_; });
+            if (ringCount_ == 0)
+            {
+                /* Asked to stop and nothing left to send */
+                return;
+            }
+            /* Take the oldest frame, leaving our previous buffer for reuse in its slot */
+            std::swap(frame, sendRing_[ringFirst_]);
+            ringFirst_ = (ringFirst_ + 1) % c_sendRingSize;
+            ringCount_--;
+        }
+
+        int32_t size = static_cast<int32_t>(frame.size());
+        if (imd_write_multiple(client, frame.data(), size) != size)
+        {
+            /* The simulation thread notices this and disconnects the client */
+            sendFailed_ = true;
+            return;
+        }
+    }
+}
+
+
+void ImdSession::Impl::checkSender()
+{
+    if (clientsocket && sendFailed_)
+    {
+        issueFatalError("Error sending updated positions and energies. Disconnecting client.");
+    }
+}
+
+
+void ImdSession::Impl::sendFrame()
+{
+    frameBuffer_.clear();
+    imd_append_energies(&frameBuffer_, energies);
+    imd_append_rvecs(&frameBuffer_, nat, xa);
+
+    if (!senderThread_.joinable())
+    {
+        int32_t size = static_cast<int32_t>(frameBuffer_.size());
+        if (imd_write_multiple(clientsocket, frameBuffer_.data(), size) != size)
+        {
+            issueFatalError("Error sending updated positions and energies. Disconnecting client.");
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(ringMutex_);
+        /* Never wait for a slow client, rather drop the oldest frame it has not seen yet */
+        if (ringCount_ == c_sendRingSize)
+        {
+            ringFirst_ = (ringFirst_ + 1) % c_sendRingSize;
+            ringCount_--;
+            numDroppedFrames_++;
+        }
+        std::swap(frameBuffer_, sendRing_[(ringFirst_ + ringCount_) % c_sendRingSize]);
+        ringCount_++;
+    }
+    ringCondition_.notify_one();
+}
+
+
 bool ImdSession::Impl::tryConnect()
 {
     if (imdsock_tryread(socket, 0, 0) > 0)
@@ -669,6 +830,11 @@ bool ImdSession::Impl::tryConnect()
         /* IMD connected */
         bConnected = true;
 
+        if (clientsocket && bThreadedSend_)
+        {
+            startSender();
+        }
+
         return true;
     }
 
@@ -1064,6 +1230,8 @@ ImdSession::Impl::Impl(const MDLogger& mdlog) : mdlog(mdlog)
 
 ImdSession::Impl::~Impl()
 {
+    /* Let the client see the last frames of the run */
+    stopSender(true);
     if (outf)
     {
         gmx_fio_fclose(outf);
@@ -1432,9 +1600,8 @@ std::unique_ptr<ImdSession> makeImdSession(const t_inputrec*           ir,
     /* read environment on master and prepare socket for incoming connections */
     if (MASTER(cr))
     {
-        /* we allocate memory for our IMD energy structure */
-        int32_t recsize = c_headerSize + sizeof(IMDEnergyBlock);
-        snew(impl->energysendbuf, recsize);
+        /* Send frames from a background thread unless the user wants every frame delivered */
+        impl->bThreadedSend_ = (getenv("GMX_IMD_SYNCHRONOUS_SEND") == nullptr);
 
         /* Shall we wait for a connection? */
         if (options.wait)
@@ -1465,8 +1632,8 @@ std::unique_ptr<ImdSession> makeImdSession(const t_inputrec*           ir,
         /* Initialize send buffers with constant size */
         snew(impl->sendxbuf, impl->nat);
         snew(impl->energies, 1);
-        int32_t bufxsize = c_headerSize + 3 * sizeof(float) * impl->nat;
-        snew(impl->coordsendbuf, bufxsize);
+        impl->frameBuffer_.reserve(c_headerSize + sizeof(IMDEnergyBlock) + c_headerSize
+                                   + 3 * sizeof(float) * impl->nat);
     }
 
     /* do we allow interactive pulling? If so let the other nodes know. */
@@ -1519,6 +1686,9 @@ bool ImdSession::Impl::run(int64_t step, bool bNS, const matrix box, const rvec
     /* read command from client and check if new incoming connection */
     if (MASTER(cr))
     {
+        /* Drop the client if the sender thread could not reach it */
+        checkSender();
+
         /* If not already connected, check for new connections */
         if (!clientsocket)
         {
@@ -1611,14 +1781,10 @@ void ImdSession::sendPositionsAndEnergies()
         return;
     }
 
-    if (imd_send_energies(impl_->clientsocket, impl_->energies, impl_->energysendbuf))
-    {
-        impl_->issueFatalError("Error sending updated energies. Disconnecting client.");
-    }
-
-    if (imd_send_rvecs(impl_->clientsocket, impl_->nat, impl_->xa, impl_->coordsendbuf))
+    impl_->checkSender();
+    if (impl_->clientsocket)
     {
-        impl_->issueFatalError("Error sending updated positions. Disconnecting client.");
+        impl_->sendFrame();
     }
 }
 
@@ -0,0 +1,417 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for sending frames to an IMD client.
+ *
+ * A plain socket takes the place of the visualization program, so that
+ * both the threaded send path and the handling of a client that
+ * vanishes can be checked without an external client.
+ *
+ * \ingroup module_imd
+ */
+#include "gmxpre.h"
+
+#include "gromacs/imd/imd.h"
+
+#include "config.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if GMX_IMD
+#    include <arpa/inet.h>
+#    include <netinet/in.h>
+#    include <sys/socket.h>
+#    include <unistd.h>
+#endif
+
+#include <gtest/gtest.h>
+
+#include "gromacs/commandline/filenm.h"
+#include "gromacs/fileio/filetypes.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdrunutility/handlerestart.h"
+#include "gromacs/mdtypes/commrec.h"
+#include "gromacs/mdtypes/enerdata.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/mdtypes/mdrunoptions.h"
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/topology/topology.h"
+#include "gromacs/utility/logger.h"
+
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+#if GMX_IMD
+
+//! IMD message types used by the tests, in the order of the IMD protocol
+enum
+{
+    c_imdEnergies  = 1,
+    c_imdPositions = 2,
+    c_imdGo        = 3,
+    c_imdHandshake = 4
+};
+
+//! Size of the energy block that precedes the positions in each frame.
+constexpr int c_energyBlockSize = sizeof(int32_t) + 9 * sizeof(float);
+
+//! Log target that keeps the text of all entries written to it.
+class RecordingLogTarget : public ILogTarget
+{
+public:
+    void writeEntry(const LogEntry& entry) override { entries_.push_back(entry.text); }
+
+    //! Returns the number of entries that contain \p text.
+    int count(const std::string& text) const
+    {
+        int n = 0;
+        for (const auto& entry : entries_)
+        {
+            if (entry.find(text) != std::string::npos)
+            {
+                n++;
+            }
+        }
+        return n;
+    }
+
+    //! Returns the first entry that contains \p text, or an empty string.
+    std::string find(const std::string& text) const
+    {
+        for (const auto& entry : entries_)
+        {
+            if (entry.find(text) != std::string::npos)
+            {
+                return entry;
+            }
+        }
+        return std::string();
+    }
+
+private:
+    std::vector<std::string> entries_;
+};
+
+//! Stand-in for an IMD client such as VMD, connected over the loopback device.
+class ImdClient
+{
+public:
+    //! Connects to the IMD session listening on \p port.
+    explicit ImdClient(int port)
+    {
+        socket_ = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family      = AF_INET;
+        address.sin_port        = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (connect(socket_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            close(socket_);
+            socket_ = -1;
+        }
+    }
+    ~ImdClient()
+    {
+        if (socket_ >= 0)
+        {
+            close(socket_);
+        }
+    }
+
+    //! Whether the connection to the session was established.
+    bool isConnected() const { return socket_ >= 0; }
+
+    //! Sends an IMD header of \p type with \p length.
+    bool sendHeader(int32_t type, int32_t length)
+    {
+        int32_t header[2] = { static_cast<int32_t>(htonl(type)),
+                              static_cast<int32_t>(htonl(length)) };
+        return write(socket_, header, sizeof(header)) == sizeof(header);
+    }
+
+    //! Reads \p size bytes into \p buffer, returns whether all of them arrived.
+    bool receive(void* buffer, size_t size)
+    {
+        char*  bytes = static_cast<char*>(buffer);
+        size_t done  = 0;
+        while (done < size)
+        {
+            ssize_t n = read(socket_, bytes + done, size - done);
+            if (n <= 0)
+            {
+                return false;
+            }
+            done += n;
+        }
+        return true;
+    }
+
+    //! Reads an IMD header, the length is returned as sent.
+    bool receiveHeader(int32_t* type, int32_t* length)
+    {
+        int32_t header[2];
+        if (!receive(header, sizeof(header)))
+        {
+            return false;
+        }
+        *type   = ntohl(header[0]);
+        *length = header[1];
+        return true;
+    }
+
+    //! Drops the connection with a reset, as a crashing client would.
+    void resetConnection()
+    {
+        linger abort = { 1, 0 };
+        setsockopt(socket_, SOL_SOCKET, SO_LINGER, &abort, sizeof(abort));
+        close(socket_);
+        socket_ = -1;
+    }
+
+private:
+    //! The connected socket, or -1.
+    int socket_ = -1;
+};
+
+//! Number of atoms in the test system, all of which are in the IMD group.
+constexpr int c_numAtoms = 2;
+
+class ImdSessionTest : public ::testing::Test
+{
+public:
+    ImdSessionTest() : enerd_(1, 0)
+    {
+        // Writing to a client that has gone away raises SIGPIPE
+        previousSigPipeHandler_ = std::signal(SIGPIPE, SIG_IGN);
+
+        logger_.warning = LogLevelHelper(&logTarget_);
+
+        imdGroup_.nat     = c_numAtoms;
+        imdGroup_.ind     = imdIndices_;
+        ir_.eI            = eiMD;
+        ir_.nstcalcenergy = 1;
+        ir_.bIMD          = TRUE;
+        ir_.imd           = &imdGroup_;
+        cr_.nnodes        = 1;
+        cr_.dd            = nullptr;
+        mtop_.moltype.resize(1);
+        mtop_.moltype[0].atoms.nr = c_numAtoms;
+        mtop_.molblock.resize(1);
+        mtop_.molblock[0].type = 0;
+        mtop_.molblock[0].nmol = 1;
+        mtop_.natoms           = c_numAtoms;
+
+        clear_mat(box_);
+        box_[XX][XX] = box_[YY][YY] = box_[ZZ][ZZ] = 3;
+        fnm_.push_back({ efXVG, "-if", "imdforces", ffOPTWR, {} });
+        fnm_[0].filenames.push_back(fileManager_.getTemporaryFilePath("imdforces.xvg"));
+    }
+    ~ImdSessionTest() override
+    {
+        ir_.imd = nullptr;
+        std::signal(SIGPIPE, previousSigPipeHandler_);
+    }
+
+    //! Starts a session listening on a free port.
+    std::unique_ptr<ImdSession> makeSession()
+    {
+        ImdOptions options;
+        options.port         = 0;
+        options.terminatable = true;
+        return makeImdSession(&ir_, &cr_, nullptr, &enerd_, nullptr, &mtop_, logger_, x_,
+                              fnm_.size(), fnm_.data(), nullptr, options,
+                              StartingBehavior::NewSimulation);
+    }
+
+    //! Returns the port the session reported listening on, or -1.
+    int listeningPort() const
+    {
+        const std::string prefix = "Listening for IMD connection on port ";
+        const std::string entry  = logTarget_.find(prefix);
+        if (entry.empty())
+        {
+            return -1;
+        }
+        return std::stoi(entry.substr(entry.find(prefix) + prefix.size()));
+    }
+
+    //! Lets \p client connect to \p session and checks the handshake.
+    void connect(ImdSession* session, ImdClient* client)
+    {
+        ASSERT_TRUE(client->isConnected());
+        // The session expects the go-ahead right after accepting
+        ASSERT_TRUE(client->sendHeader(c_imdGo, 0));
+        session->run(0, false, box_, x_, 0);
+        ASSERT_EQ(1, logTarget_.count("Connection established"));
+
+        int32_t type, length;
+        ASSERT_TRUE(client->receiveHeader(&type, &length));
+        EXPECT_EQ(c_imdHandshake, type);
+        EXPECT_EQ(2, length);
+    }
+
+    //! Runs the IMD part of \p step and sends the frame of that step.
+    void doStep(ImdSession* session, int step)
+    {
+        enerd_.term[F_EPOT] = step;
+        bool bIMDstep       = session->run(step, false, box_, x_, step);
+        session->updateEnergyRecordAndSendPositionsAndEnergies(bIMDstep, step, true);
+    }
+
+    //! Reads the frame of \p step from \p client and checks its contents.
+    void checkFrame(ImdClient* client, int step)
+    {
+        int32_t type, length;
+        ASSERT_TRUE(client->receiveHeader(&type, &length));
+        EXPECT_EQ(c_imdEnergies, type);
+        EXPECT_EQ(1, static_cast<int32_t>(ntohl(length)));
+        char energies[c_energyBlockSize];
+        ASSERT_TRUE(client->receive(energies, sizeof(energies)));
+        int32_t tstep;
+        float   epot;
+        std::memcpy(&tstep, energies, sizeof(tstep));
+        std::memcpy(&epot, energies + sizeof(tstep) + 2 * sizeof(float), sizeof(epot));
+        EXPECT_EQ(step, tstep);
+        EXPECT_FLOAT_EQ(step, epot);
+
+        ASSERT_TRUE(client->receiveHeader(&type, &length));
+        EXPECT_EQ(c_imdPositions, type);
+        EXPECT_EQ(c_numAtoms, static_cast<int32_t>(ntohl(length)));
+        float positions[c_numAtoms][DIM];
+        ASSERT_TRUE(client->receive(positions, sizeof(positions)));
+        for (int i = 0; i < c_numAtoms; i++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                // Positions are sent in Angstrom
+                EXPECT_FLOAT_EQ(10 * x_[i][d], positions[i][d]);
+            }
+        }
+    }
+
+    //! Collects the messages of the session
+    RecordingLogTarget logTarget_;
+    //! Logger writing to logTarget_
+    MDLogger logger_;
+    //! Provides the name of the IMD force output file
+    TestFileManager fileManager_;
+    //! Input record with IMD enabled
+    t_inputrec ir_;
+    //! Communication record of a single rank
+    t_commrec cr_;
+    //! Topology with a single molecule
+    gmx_mtop_t mtop_;
+    //! Energies that are sent to the client
+    gmx_enerdata_t enerd_;
+    //! Indices of the atoms in the IMD group
+    int imdIndices_[c_numAtoms] = { 0, 1 };
+    //! The IMD group
+    t_IMD imdGroup_;
+    //! Atom positions
+    rvec x_[c_numAtoms] = { { 1, 1, 1 }, { 1.1, 1.2, 1.3 } };
+    //! Simulation box
+    matrix box_;
+    //! File names for the session
+    std::vector<t_filenm> fnm_;
+    //! SIGPIPE handler to restore after the test
+    void (*previousSigPipeHandler_)(int) = nullptr;
+};
+
+TEST_F(ImdSessionTest, SendsFramesFromSenderThread)
+{
+    auto session = makeSession();
+    int  port    = listeningPort();
+    ASSERT_GT(port, 0);
+
+    ImdClient client(port);
+    connect(session.get(), &client);
+
+    for (int step = 1; step <= 3; step++)
+    {
+        doStep(session.get(), step);
+        checkFrame(&client, step);
+    }
+}
+
+TEST_F(ImdSessionTest, ReportsFailedSendOnceAndDisconnects)
+{
+    auto session = makeSession();
+    int  port    = listeningPort();
+    ASSERT_GT(port, 0);
+
+    ImdClient client(port);
+    connect(session.get(), &client);
+    doStep(session.get(), 1);
+    checkFrame(&client, 1);
+
+    client.resetConnection();
+
+    // The failure is noticed by the sender thread and reported on a later step
+    int step = 2;
+    for (; step < 1000 && logTarget_.count("Error sending") == 0; step++)
+    {
+        session->updateEnergyRecordAndSendPositionsAndEnergies(true, step, true);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(1, logTarget_.count("Error sending"));
+    EXPECT_EQ(1, logTarget_.count("disconnected."));
+
+    // Later steps must neither report the failure again nor try to send
+    for (int i = 0; i < 3; i++, step++)
+    {
+        doStep(session.get(), step);
+    }
+    EXPECT_EQ(1, logTarget_.count("Error sending"));
+    EXPECT_EQ(1, logTarget_.count("disconnected."));
+}
+
+#endif
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -46,6 +46,7 @@
 #include <algorithm>
 #include <numeric>
 
+#include "gromacs/math/gausstransform.h"
 #include "gromacs/math/multidimarray.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/utility/exceptions.h"
@@ -61,6 +62,8 @@ public:
     using density = DensitySimilarityMeasure::density;
     //! \copydoc DensitySimilarityMeasure::gradient(DensitySimilarityMeasure::density comparedDensity)
     virtual density gradient(density comparedDensity) = 0;
+    //! \copydoc DensitySimilarityMeasure::gradient(DensitySimilarityMeasure::density comparedDensity, const IntegerBox& region)
+    virtual density gradient(density comparedDensity, const IntegerBox& region) = 0;
     //! \copydoc DensitySimilarityMeasure::similarity(density comparedDensity)
     virtual real similarity(density comparedDensity) = 0;
     //! clone to allow copy operations
@@ -71,6 +74,44 @@ DensitySimilarityMeasureImpl::~DensitySimilarityMeasureImpl() = default;
 namespace
 {
 
+/*! \brief Evaluate a voxel-wise gradient only at the voxels within a region.
+ *
+ * \param[in] reference the reference density
+ * \param[in] compared the compared density
+ * \param[in] region the voxels to evaluate
+ * \param[in] gradientAtVoxel function of reference and compared voxel value
+ * \param[out] gradient the gradient, only written to within region
+ */
+template<typename GradientAtVoxel>
+void gradientWithinRegion(DensitySimilarityMeasure::density                    reference,
+                          DensitySimilarityMeasure::density                    compared,
+                          const IntegerBox&                                    region,
+                          GradientAtVoxel                                      gradientAtVoxel,
+                          MultiDimArray<std::vector<float>, dynamicExtents3D>* gradient)
+{
+    if (compared.extents() != reference.extents())
+    {
+        GMX_THROW(RangeError("Reference density and compared density need to have same extents."));
+    }
+    if (region.empty())
+    {
+        return;
+    }
+    // The x-dimension is contiguous in memory, so only the rows are sliced
+    const int numXValues = region.end()[XX] - region.begin()[XX];
+    for (int z = region.begin()[ZZ]; z < region.end()[ZZ]; ++z)
+    {
+        for (int y = region.begin()[YY]; y < region.end()[YY]; ++y)
+        {
+            const float* referenceRow = &reference(z, y, region.begin()[XX]);
+            const float* comparedRow  = &compared(z, y, region.begin()[XX]);
+            float*       gradientRow  = &gradient->asView()(z, y, region.begin()[XX]);
+            std::transform(referenceRow, referenceRow + numXValues, comparedRow, gradientRow,
+                           gradientAtVoxel);
+        }
+    }
+}
+
 /****************** Inner Product *********************************************/
 
 /*! \internal
@@ -85,6 +126,8 @@ public:
     DensitySimilarityInnerProduct(density referenceDensity);
     //! The gradient for the inner product similarity measure is the reference density divided by the number of voxels
     density gradient(density comparedDensity) override;
+    //! The gradient is pre-computed at all voxels, so the region does not matter
+    density gradient(density comparedDensity, const IntegerBox& region) override;
     //! Clone this
     std::unique_ptr<DensitySimilarityMeasureImpl> clone() override;
     //! The similarity between reference density and compared density
@@ -131,6 +174,12 @@ DensitySimilarityMeasure::density DensitySimilarityInnerProduct::gradient(densit
     return gradient_.asConstView();
 }
 
+DensitySimilarityMeasure::density
+DensitySimilarityInnerProduct::gradient(density comparedDensity, const IntegerBox& /*region*/)
+{
+    return gradient(comparedDensity);
+}
+
 std::unique_ptr<DensitySimilarityMeasureImpl> DensitySimilarityInnerProduct::clone()
 {
     return std::make_unique<DensitySimilarityInnerProduct>(referenceDensity_);
@@ -170,6 +219,8 @@ public:
     DensitySimilarityRelativeEntropy(density referenceDensity);
     //! The gradient for the relative entropy similarity measure
     density gradient(density comparedDensity) override;
+    //! The gradient for the relative entropy similarity measure within a region
+    density gradient(density comparedDensity, const IntegerBox& region) override;
     //! Clone this
     std::unique_ptr<DensitySimilarityMeasureImpl> clone() override;
     //! The similarity between reference density and compared density
@@ -209,6 +260,14 @@ DensitySimilarityMeasure::density DensitySimilarityRelativeEntropy::gradient(den
     return gradient_.asConstView();
 }
 
+DensitySimilarityMeasure::density
+DensitySimilarityRelativeEntropy::gradient(density comparedDensity, const IntegerBox& region)
+{
+    gradientWithinRegion(referenceDensity_, comparedDensity, region,
+                         relativeEntropyGradientAtVoxel, &gradient_);
+    return gradient_.asConstView();
+}
+
 std::unique_ptr<DensitySimilarityMeasureImpl> DensitySimilarityRelativeEntropy::clone()
 {
     return std::make_unique<DensitySimilarityRelativeEntropy>(referenceDensity_);
@@ -309,6 +368,8 @@ public:
     DensitySimilarityCrossCorrelation(density referenceDensity);
     //! The gradient for the cross correlation similarity measure
     density gradient(density comparedDensity) override;
+    //! The gradient for the cross correlation similarity measure within a region
+    density gradient(density comparedDensity, const IntegerBox& region) override;
     //! Clone this
     std::unique_ptr<DensitySimilarityMeasureImpl> clone() override;
     //! The similarity between reference density and compared density
@@ -367,6 +428,24 @@ DensitySimilarityMeasure::density DensitySimilarityCrossCorrelation::gradient(de
     return gradient_.asConstView();
 }
 
+DensitySimilarityMeasure::density
+DensitySimilarityCrossCorrelation::gradient(density comparedDensity, const IntegerBox& region)
+{
+    if (comparedDensity.extents() != referenceDensity_.extents())
+    {
+        GMX_THROW(RangeError("Reference density and compared density need to have same extents."));
+    }
+
+    // The means and sums of squares still require a pass over the whole densities
+    CrossCorrelationEvaluationHelperValues helperValues =
+            evaluateHelperValues(referenceDensity_, comparedDensity);
+
+    gradientWithinRegion(referenceDensity_, comparedDensity, region,
+                         CrossCorrelationGradientAtVoxel(helperValues), &gradient_);
+
+    return gradient_.asConstView();
+}
+
 std::unique_ptr<DensitySimilarityMeasureImpl> DensitySimilarityCrossCorrelation::clone()
 {
     return std::make_unique<DensitySimilarityCrossCorrelation>(referenceDensity_);
@@ -401,6 +480,12 @@ DensitySimilarityMeasure::density DensitySimilarityMeasure::gradient(density com
     return impl_->gradient(comparedDensity);
 }
 
+DensitySimilarityMeasure::density DensitySimilarityMeasure::gradient(density comparedDensity,
+                                                                     const IntegerBox& region)
+{
+    return impl_->gradient(comparedDensity, region);
+}
+
 real DensitySimilarityMeasure::similarity(density comparedDensity)
 {
     return impl_->similarity(comparedDensity);
@@ -97,6 +97,7 @@ const EnumerationArray<DensitySimilarityMeasureMethod, const char* const> c_dens
 /* Forward declaration of implementation class outside class to allow
  * choose implementation class during construction of the DensitySimilarityMeasure*/
 class DensitySimilarityMeasureImpl;
+class IntegerBox;
 
 /*! \libinternal \brief
  *  Measure similarity and gradient between densities.
@@ -127,6 +128,16 @@ public:
      * \returns density similarity measure derivative
      */
     density gradient(density comparedDensity);
+    /*! \brief Derivative of the density similarity measure within a region of voxels.
+     *
+     * Only the voxels within region are evaluated, e.g., those that are reached
+     * by the Gaussians of the local atoms. Voxels outside the region keep values
+     * from earlier evaluations and must not be used.
+     * \param[in] comparedDensity the variable density
+     * \param[in] region the voxels at which the derivative is required
+     * \returns density similarity measure derivative, valid within region
+     */
+    density gradient(density comparedDensity, const IntegerBox& region);
     /*! \brief Similarity between reference and compared density.
      * \param[in] comparedDensity the variable density
      * \returns density similarity
@@ -52,6 +52,10 @@
 #include "gromacs/math/functions.h"
 #include "gromacs/math/multidimarray.h"
 #include "gromacs/math/utilities.h"
+#include "gromacs/simd/simd.h"
+#include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxassert.h"
 
 namespace gmx
 {
@@ -240,6 +244,51 @@ IVec rangeEndWithinLattice(const IVec& index, const dynamicExtents3D& extents, c
     return elementWiseMin(extentAsIvec, index + range);
 }
 
+/*! \brief Adds a scaled row of values to a contiguous range of lattice values.
+ *
+ * Uses SIMD where available; the spread ranges are short, so unaligned
+ * loads and stores are used and the remainder is handled serially.
+ */
+void addScaledRow(float* gmx_restrict latticeRow,
+                  const float* gmx_restrict values,
+                  float                     scale,
+                  int                       numValues)
+{
+    int i = 0;
+#if GMX_SIMD_HAVE_FLOAT && GMX_SIMD_HAVE_LOADU && GMX_SIMD_HAVE_STOREU
+    const SimdFloat scaleSimd(scale);
+    for (; i + GMX_SIMD_FLOAT_WIDTH <= numValues; i += GMX_SIMD_FLOAT_WIDTH)
+    {
+        storeU(latticeRow + i, fma(scaleSimd, loadU<SimdFloat>(values + i),
+                                   loadU<SimdFloat>(latticeRow + i)));
+    }
+#endif
+    for (; i < numValues; ++i)
+    {
+        latticeRow[i] += scale * values[i];
+    }
+}
+
+//! Stores a row of values multiplied with a scale factor, using SIMD where available
+void scaleRow(float* gmx_restrict result,
+              const float* gmx_restrict values,
+              float                     scale,
+              int                       numValues)
+{
+    int i = 0;
+#if GMX_SIMD_HAVE_FLOAT && GMX_SIMD_HAVE_LOADU && GMX_SIMD_HAVE_STOREU
+    const SimdFloat scaleSimd(scale);
+    for (; i + GMX_SIMD_FLOAT_WIDTH <= numValues; i += GMX_SIMD_FLOAT_WIDTH)
+    {
+        storeU(result + i, scaleSimd * loadU<SimdFloat>(values + i));
+    }
+#endif
+    for (; i < numValues; ++i)
+    {
+        result[i] = scale * values[i];
+    }
+}
+
 
 } // namespace
 
@@ -253,9 +302,7 @@ mdspan<const float, dynamic_extent, dynamic_extent> OuterProductEvaluator::
     data_.resize(ssize(x), ssize(y));
     for (gmx::index xIndex = 0; xIndex < ssize(x); ++xIndex)
     {
-        const auto xValue = x[xIndex];
-        std::transform(std::begin(y), std::end(y), begin(data_.asView()[xIndex]),
-                       [xValue](float yValue) { return xValue * yValue; });
+        scaleRow(&data_.asView()[xIndex][0], y.data(), x[xIndex], ssize(y));
     }
     return data_.asConstView();
 }
@@ -317,71 +364,139 @@ public:
     Impl& operator=(const Impl& other) = default;
     //! Add another gaussian
     void add(const GaussianSpreadKernelParameters::PositionAndAmplitude& localParamters);
+    //! Add many Gaussians, using numThreads threads that each own a range of z-planes
+    void add(ArrayRef<const RVec> coordinates, ArrayRef<const real> amplitudes, int numThreads);
     //! The width of the Gaussian in lattice spacing units
     BasicVector<double> sigma_;
     //! The spread range in lattice points
     IVec spreadRange_;
     //! The result of the Gauss transform
     MultiDimArray<std::vector<float>, dynamicExtents3D> data_;
-    //! The outer product of a Gaussian along the z and y dimension
-    OuterProductEvaluator outerProductZY_;
-    //! The three one-dimensional Gaussians, whose outer product is added to the Gauss transform
-    std::array<GaussianOn1DLattice, DIM> gauss1d_;
+
+private:
+    //! Per-thread working data for evaluating a single Gaussian
+    struct SpreadWorkData
+    {
+        //! Construct the one-dimensional Gaussians
+        SpreadWorkData(const IVec& spreadRange, const BasicVector<double>& sigma);
+        //! The outer product of a Gaussian along the z and y dimension
+        OuterProductEvaluator outerProductZY_;
+        //! The three one-dimensional Gaussians, whose outer product is added to the Gauss transform
+        std::array<GaussianOn1DLattice, DIM> gauss1d_;
+    };
+    /*! \brief Add a Gaussian to the lattice planes in [zBegin, zEnd) only
+     *
+     * Threads that own disjoint ranges of z-planes can thus spread
+     * concurrently without reduction or locking.
+     */
+    void addToZPlanes(const GaussianSpreadKernelParameters::PositionAndAmplitude& localParameters,
+                      int                                                         zBegin,
+                      int                                                         zEnd,
+                      SpreadWorkData*                                             workData);
+    //! Working data, one entry per thread
+    std::vector<SpreadWorkData> workData_;
 };
 
+GaussTransform3D::Impl::SpreadWorkData::SpreadWorkData(const IVec&                spreadRange,
+                                                       const BasicVector<double>& sigma) :
+    gauss1d_({ GaussianOn1DLattice(spreadRange[XX], sigma[XX]),
+               GaussianOn1DLattice(spreadRange[YY], sigma[YY]),
+               GaussianOn1DLattice(spreadRange[ZZ], sigma[ZZ]) })
+{
+}
+
 GaussTransform3D::Impl::Impl(const dynamicExtents3D&                      extent,
                              const GaussianSpreadKernelParameters::Shape& kernelShapeParameters) :
     sigma_{ kernelShapeParameters.sigma_ },
     spreadRange_{ kernelShapeParameters.latticeSpreadRange() },
     data_{ extent },
-    gauss1d_({ GaussianOn1DLattice(spreadRange_[XX], sigma_[XX]),
-               GaussianOn1DLattice(spreadRange_[YY], sigma_[YY]),
-               GaussianOn1DLattice(spreadRange_[ZZ], sigma_[ZZ]) })
+    workData_(1, SpreadWorkData(spreadRange_, sigma_))
 {
 }
 
 void GaussTransform3D::Impl::add(const GaussianSpreadKernelParameters::PositionAndAmplitude& localParameters)
+{
+    addToZPlanes(localParameters, 0, data_.asView().extent(0), &workData_[0]);
+}
+
+void GaussTransform3D::Impl::add(ArrayRef<const RVec> coordinates,
+                                 ArrayRef<const real> amplitudes,
+                                 int                  numThreads)
+{
+    GMX_ASSERT(coordinates.size() == amplitudes.size(),
+               "Need as many amplitudes as coordinates for spreading.");
+
+    const int numZPlanes = data_.asView().extent(0);
+    // Each thread needs at least one plane to work on
+    numThreads = std::max(1, std::min(numThreads, numZPlanes));
+    if (ssize(workData_) < numThreads)
+    {
+        workData_.resize(numThreads, workData_[0]);
+    }
+
+    /* Each thread owns a slab of z-planes and spreads all Gaussians that
+     * reach into it. Gaussians spanning two slabs are evaluated by both
+     * threads, but the values on any lattice point are summed in the same
+     * order as in serial spreading. */
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int thread = 0; thread < numThreads; thread++)
+    {
+        try
+        {
+            const int zBegin = (numZPlanes * thread) / numThreads;
+            const int zEnd   = (numZPlanes * (thread + 1)) / numThreads;
+            for (index i = 0; i < ssize(coordinates); i++)
+            {
+                addToZPlanes({ coordinates[i], amplitudes[i] }, zBegin, zEnd, &workData_[thread]);
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+}
+
+void GaussTransform3D::Impl::addToZPlanes(const GaussianSpreadKernelParameters::PositionAndAmplitude& localParameters,
+                                          int             zBegin,
+                                          int             zEnd,
+                                          SpreadWorkData* workData)
 {
     const IVec closestLatticePoint = closestIntegerPoint(localParameters.coordinate_);
     const auto spreadRange =
             spreadRangeWithinLattice(closestLatticePoint, data_.asView().extents(), spreadRange_);
 
-    // do nothing if the added Gaussian will never reach the lattice
-    if (spreadRange.empty())
+    const int zSpreadBegin = std::max(zBegin, spreadRange.begin()[ZZ]);
+    const int zSpreadEnd   = std::min(zEnd, spreadRange.end()[ZZ]);
+
+    // do nothing if the added Gaussian will never reach the lattice planes
+    if (spreadRange.empty() || zSpreadBegin >= zSpreadEnd)
     {
         return;
     }
 
+    auto& gauss1d = workData->gauss1d_;
     for (int dimension = XX; dimension <= ZZ; ++dimension)
     {
         // multiply with amplitude so that Gauss3D = (amplitude * Gauss_x) * Gauss_y * Gauss_z
         const float gauss1DAmplitude = dimension > XX ? 1.0 : localParameters.amplitude_;
-        gauss1d_[dimension].spread(gauss1DAmplitude, localParameters.coordinate_[dimension]
-                                                             - closestLatticePoint[dimension]);
+        gauss1d[dimension].spread(gauss1DAmplitude, localParameters.coordinate_[dimension]
+                                                            - closestLatticePoint[dimension]);
     }
 
-    const auto spreadZY         = outerProductZY_(gauss1d_[ZZ].view(), gauss1d_[YY].view());
-    const auto spreadX          = gauss1d_[XX].view();
+    const auto spreadZY = workData->outerProductZY_(gauss1d[ZZ].view(), gauss1d[YY].view());
     const IVec spreadGridOffset = spreadRange_ - closestLatticePoint;
+    const int  xBegin           = spreadRange.begin()[XX];
+    const int  numXValues       = spreadRange.end()[XX] - xBegin;
+    const float* spreadX        = gauss1d[XX].view().data() + xBegin + spreadGridOffset[XX];
 
-    // \todo optimize these loops if performance critical
     // The looping strategy uses that the last, x-dimension is contiguous in the memory layout
-    for (int zLatticeIndex = spreadRange.begin()[ZZ]; zLatticeIndex < spreadRange.end()[ZZ]; ++zLatticeIndex)
+    for (int zLatticeIndex = zSpreadBegin; zLatticeIndex < zSpreadEnd; ++zLatticeIndex)
     {
         const auto zSlice = data_.asView()[zLatticeIndex];
 
         for (int yLatticeIndex = spreadRange.begin()[YY]; yLatticeIndex < spreadRange.end()[YY]; ++yLatticeIndex)
         {
-            const auto  ySlice      = zSlice[yLatticeIndex];
             const float zyPrefactor = spreadZY(zLatticeIndex + spreadGridOffset[ZZ],
                                                yLatticeIndex + spreadGridOffset[YY]);
-
-            for (int xLatticeIndex = spreadRange.begin()[XX]; xLatticeIndex < spreadRange.end()[XX];
-                 ++xLatticeIndex)
-            {
-                const float xPrefactor = spreadX[xLatticeIndex + spreadGridOffset[XX]];
-                ySlice[xLatticeIndex] += zyPrefactor * xPrefactor;
-            }
+            addScaledRow(&zSlice[yLatticeIndex][xBegin], spreadX, zyPrefactor, numXValues);
         }
     }
 }
@@ -401,6 +516,13 @@ void GaussTransform3D::add(const GaussianSpreadKernelParameters::PositionAndAmpl
     impl_->add(localParameters);
 }
 
+void GaussTransform3D::add(ArrayRef<const RVec> coordinates,
+                           ArrayRef<const real> amplitudes,
+                           int                  numThreads)
+{
+    impl_->add(coordinates, amplitudes, numThreads);
+}
+
 void GaussTransform3D::setZero()
 {
     std::fill(begin(impl_->data_), end(impl_->data_), 0.);
@@ -193,6 +193,18 @@ public:
      */
     void add(const GaussianSpreadKernelParameters::PositionAndAmplitude& localParameters);
 
+    /*! \brief Add three dimensional Gaussians with given amplitudes at many coordinates.
+     *
+     * The lattice is split into slabs of z-planes, one per thread, so that
+     * threads never write to the same lattice point. The result is the same
+     * as from adding the Gaussians one by one.
+     *
+     * \param[in] coordinates of the Gaussian centers in lattice coordinates
+     * \param[in] amplitudes of the Gaussians, one per coordinate
+     * \param[in] numThreads the number of OpenMP threads to use for spreading
+     */
+    void add(ArrayRef<const RVec> coordinates, ArrayRef<const real> amplitudes, int numThreads);
+
     //! \brief Set all values on the lattice to zero.
     void setZero();
 
@@ -43,10 +43,13 @@
 
 #include "gromacs/math/densityfit.h"
 
+#include <algorithm>
+#include <cmath>
 #include <numeric>
 
 #include <gtest/gtest.h>
 
+#include "gromacs/math/gausstransform.h"
 #include "gromacs/math/multidimarray.h"
 
 #include "testutils/refdata.h"
@@ -198,6 +201,34 @@ TEST(DensitySimilarityTest, RelativeEntropyGradientIsCorrect)
     checker.checkSequence(gradientView.begin(), gradientView.end(), "relative-entropy-gradient");
 }
 
+TEST(DensitySimilarityTest, RelativeEntropyGradientWithinRegionIsCorrect)
+{
+    MultiDimArray<std::vector<float>, dynamicExtents3D> referenceDensity(3, 3, 3);
+    std::iota(begin(referenceDensity), end(referenceDensity), -1);
+
+    DensitySimilarityMeasure measure(DensitySimilarityMeasureMethod::relativeEntropy,
+                                     referenceDensity.asConstView());
+    DensitySimilarityMeasure regionMeasure(measure);
+
+    MultiDimArray<std::vector<float>, dynamicExtents3D> comparedDensity(3, 3, 3);
+    std::iota(begin(comparedDensity), end(comparedDensity), -2);
+
+    const auto       gradient = measure.gradient(comparedDensity.asConstView());
+    const IntegerBox region({ 1, 0, 1 }, { 3, 2, 3 });
+    const auto regionGradient = regionMeasure.gradient(comparedDensity.asConstView(), region);
+
+    for (int z = region.begin()[ZZ]; z < region.end()[ZZ]; ++z)
+    {
+        for (int y = region.begin()[YY]; y < region.end()[YY]; ++y)
+        {
+            for (int x = region.begin()[XX]; x < region.end()[XX]; ++x)
+            {
+                EXPECT_FLOAT_EQ(gradient(z, y, x), regionGradient(z, y, x));
+            }
+        }
+    }
+}
+
 TEST(DensitySimilarityTest, CrossCorrelationIsOne)
 {
     MultiDimArray<std::vector<float>, dynamicExtents3D> referenceDensity(100, 100, 100);
@@ -287,6 +318,68 @@ TEST(DensitySimilarityTest, CrossCorrelationGradientIsCorrect)
     checker.checkSequence(gradientView.begin(), gradientView.end(), "cross-correlation-gradient");
 }
 
+TEST(DensitySimilarityTest, CrossCorrelationGradientWithinRegionMatchesFiniteDifferences)
+{
+    MultiDimArray<std::vector<float>, dynamicExtents3D> referenceDensity(3, 3, 3);
+    std::iota(begin(referenceDensity), end(referenceDensity), -1);
+
+    DensitySimilarityMeasure measure(DensitySimilarityMeasureMethod::crossCorrelation,
+                                     referenceDensity.asConstView());
+
+    MultiDimArray<std::vector<float>, dynamicExtents3D> comparedDensity(3, 3, 3);
+    std::iota(begin(comparedDensity), end(comparedDensity), -2);
+
+    // some non-linear transformation, so that we break the correlation
+    for (float& valueToCompare : comparedDensity)
+    {
+        valueToCompare *= valueToCompare;
+    }
+
+    const IntegerBox region({ 1, 0, 1 }, { 3, 2, 3 });
+    // Copy the gradient, because the measure re-uses its memory
+    MultiDimArray<std::vector<float>, dynamicExtents3D> regionGradient(3, 3, 3);
+    const auto gradient = measure.gradient(comparedDensity.asConstView(), region);
+    std::copy(begin(gradient), end(gradient), begin(regionGradient));
+
+    // The finite differences are limited by the precision of the similarity,
+    // so the tolerance is relative to the largest gradient entry in the region
+    float gradientMagnitude = 0;
+    for (int z = region.begin()[ZZ]; z < region.end()[ZZ]; ++z)
+    {
+        for (int y = region.begin()[YY]; y < region.end()[YY]; ++y)
+        {
+            for (int x = region.begin()[XX]; x < region.end()[XX]; ++x)
+            {
+                gradientMagnitude = std::max(gradientMagnitude, std::abs(regionGradient(z, y, x)));
+            }
+        }
+    }
+    const FloatingPointTolerance tolerance =
+            relativeToleranceAsFloatingPoint(gradientMagnitude, 1e-2);
+
+    // Central finite differences of the similarity at each voxel in the region
+    const float stepSize = 0.5;
+    for (int z = region.begin()[ZZ]; z < region.end()[ZZ]; ++z)
+    {
+        for (int y = region.begin()[YY]; y < region.end()[YY]; ++y)
+        {
+            for (int x = region.begin()[XX]; x < region.end()[XX]; ++x)
+            {
+                const float value             = comparedDensity(z, y, x);
+                comparedDensity(z, y, x)      = value + stepSize;
+                const real forwardSimilarity  = measure.similarity(comparedDensity.asConstView());
+                comparedDensity(z, y, x)      = value - stepSize;
+                const real backwardSimilarity = measure.similarity(comparedDensity.asConstView());
+                comparedDensity(z, y, x)      = value;
+
+                const real finiteDifferenceGradient =
+                        (forwardSimilarity - backwardSimilarity) / (2 * stepSize);
+                EXPECT_REAL_EQ_TOL(finiteDifferenceGradient, regionGradient(z, y, x), tolerance);
+            }
+        }
+    }
+}
+
 } // namespace test
 
 } // namespace gmx
@@ -279,6 +279,35 @@ TEST_F(GaussTransformTest, view)
     EXPECT_THAT(expectedValues, testing::Pointwise(FloatEq(tolerance_), gaussTransformVector));
 }
 
+TEST(GaussTransform3DThreaded, isSameAsAddingOneByOne)
+{
+    const extents<dynamic_extent, dynamic_extent, dynamic_extent> latticeExtent = { 7, 6, 5 };
+    const GaussianSpreadKernelParameters::Shape kernelShape   = { { 1., 1.5, 0.8 }, 3 };
+    GaussTransform3D                            serial        = { latticeExtent, kernelShape };
+    GaussTransform3D                            threaded      = { latticeExtent, kernelShape };
+    const std::vector<RVec>                     coordinates   = { { 0.3, 1.2, 2.7 },
+                                                  { 4.1, 3.9, 0.2 },
+                                                  { 2.5, 5.8, 6.4 },
+                                                  { -0.6, 2.2, 3.3 },
+                                                  { 3.0, 3.0, 3.0 } };
+    const std::vector<real>                     amplitudes    = { 1.0, 0.5, -0.7, 2.0, 0.1 };
+
+    for (size_t i = 0; i < coordinates.size(); i++)
+    {
+        serial.add({ coordinates[i], amplitudes[i] });
+    }
+    // More threads than lattice planes, to also cover threads without planes
+    threaded.add(coordinates, amplitudes, 9);
+
+    const auto         serialView   = serial.constView();
+    const auto         threadedView = threaded.constView();
+    std::vector<float> serialValues(serialView.data(),
+                                    serialView.data() + serialView.mapping().required_span_size());
+    std::vector<float> threadedValues(
+            threadedView.data(), threadedView.data() + threadedView.mapping().required_span_size());
+    EXPECT_THAT(serialValues, testing::Pointwise(FloatEq(defaultFloatTolerance()), threadedValues));
+}
+
 } // namespace
 
 } // namespace test
@@ -160,6 +160,19 @@ void do_force_lowlevel(t_forcerec*                          fr,
                         DOMAINDECOMP(cr) ? cr->dd->globalAtomIndices.data() : nullptr, stepWork);
     }
 
+    if (stepWork.useCpuHaloExchangeOverlap && stepWork.computeForces)
+    {
+        /* All force contributions to non-local atoms have now been computed,
+         * the long-range work below only acts on home atoms. So we can
+         * overlap the communication of the non-local forces with that work.
+         * We are called within the force counter, which should not count
+         * the communication as well.
+         */
+        wallcycle_stop(wcycle, ewcFORCE);
+        dd_move_f_start(cr->dd, &forceOutputs->forceWithShiftForces(), wcycle);
+        wallcycle_start_nocount(wcycle, ewcFORCE);
+    }
+
     const bool computePmeOnCpu = (EEL_PME(fr->ic->eeltype) || EVDW_PME(fr->ic->vdwtype))
                                  && thisRankHasDuty(cr, DUTY_PME)
                                  && (pme_run_mode(fr->pmedata) == PmeRunMode::CPU);
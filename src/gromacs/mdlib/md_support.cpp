@@ -152,6 +152,32 @@ int multisim_min(const gmx_multisim_t* ms, int nmin, int n)
     return nmin;
 }
 
+/*! \brief Sum the kinetic energies of the groups and compute the temperature */
+static void sumKineticEnergies(const t_inputrec* ir,
+                               gmx_ekindata_t*   ekind,
+                               gmx_enerdata_t*   enerd,
+                               bool              bEkinAveVel,
+                               bool              bScaleEkin)
+{
+    real dvdl_ekin;
+
+    /* compute full step kinetic energies if vv, or if vv-avek and we are computing the pressure with inputrecNptTrotter */
+    /* three maincase:  VV with AveVel (md-vv), vv with AveEkin (md-vv-avek), leap with AveEkin (md).
+       Leap with AveVel is not supported; it's not clear that it will actually work.
+       bEkinAveVel: If TRUE, we simply multiply ekin by ekinscale to get a full step kinetic energy.
+       If FALSE, we average ekinh_old and ekinh*ekinscale_nhc to get an averaged half step kinetic energy.
+     */
+    enerd->term[F_TEMP]       = sum_ekin(&(ir->opts), ekind, &dvdl_ekin, bEkinAveVel, bScaleEkin);
+    enerd->dvdl_lin[efptMASS] = static_cast<double>(dvdl_ekin);
+
+    enerd->term[F_EKIN] = trace(ekind->ekin);
+
+    for (auto& dhdl : enerd->dhdlLambda)
+    {
+        dhdl += enerd->dvdl_lin[efptMASS];
+    }
+}
+
 /* TODO Specialize this routine into init-time and loop-time versions?
    e.g. bReadEkin is only true when restoring from checkpoint */
 void compute_globals(gmx_global_stat*               gstat,
@@ -182,7 +208,6 @@ void compute_globals(gmx_global_stat*               gstat,
     gmx_bool bEner, bPres, bTemp;
     gmx_bool bStopCM, bGStat, bReadEkin, bEkinAveVel, bScaleEkin, bConstrain;
     gmx_bool bCheckNumberOfBondedInteractions;
-    real     dvdl_ekin;
 
     /* translate CGLO flags to gmx_booleans */
     bStopCM                          = ((flags & CGLO_STOPCM) != 0);
@@ -194,6 +219,12 @@ void compute_globals(gmx_global_stat*               gstat,
     bPres                            = ((flags & CGLO_PRESSURE) != 0);
     bConstrain                       = ((flags & CGLO_CONSTRAINT) != 0);
     bCheckNumberOfBondedInteractions = ((flags & CGLO_CHECK_NUMBER_OF_BONDED_INTERACTIONS) != 0);
+    const bool haveComputedEkinh     = ((flags & CGLO_EKINH_COMPUTED) != 0);
+    const bool nonBlocking           = ((flags & CGLO_NONBLOCKING) != 0);
+
+    GMX_RELEASE_ASSERT(
+            !nonBlocking || (bGStat && !(bStopCM || bEner || bPres || bConstrain || bReadEkin)),
+            "A non-blocking reduction is only supported for the kinetic energy");
 
     /* we calculate a full state kinetic energy either with full-step velocity verlet
        or half step where we need the pressure */
@@ -215,7 +246,7 @@ void compute_globals(gmx_global_stat*               gstat,
         {
             accumulate_u(cr, &(ir->opts), ekind);
         }
-        if (!bReadEkin)
+        if (!bReadEkin && !haveComputedEkinh)
         {
             calc_ke_part(x, v, box, &(ir->opts), mdatoms, ekind, nrnb, bEkinAveVel);
         }
@@ -242,11 +273,21 @@ void compute_globals(gmx_global_stat*               gstat,
             if (PAR(cr))
             {
                 wallcycle_start(wcycle, ewcMoveE);
-                global_stat(gstat, cr, enerd, force_vir, shake_vir, ir, ekind, constr,
-                            bStopCM ? vcm : nullptr, signalBuffer.size(), signalBuffer.data(),
-                            totalNumberOfBondedInteractions, *bSumEkinhOld, flags);
+                global_stat_start(gstat, cr, enerd, force_vir, shake_vir, ir, ekind, constr,
+                                  bStopCM ? vcm : nullptr, signalBuffer.size(), signalBuffer.data(),
+                                  totalNumberOfBondedInteractions, *bSumEkinhOld, flags,
+                                  nonBlocking);
+                if (!nonBlocking)
+                {
+                    global_stat_finish(gstat);
+                }
                 wallcycle_stop(wcycle, ewcMoveE);
             }
+            if (nonBlocking)
+            {
+                /* The rest is done in compute_globals_finish() */
+                return;
+            }
             signalCoordinator->finalizeSignals();
             *bSumEkinhOld = FALSE;
         }
@@ -260,22 +301,7 @@ void compute_globals(gmx_global_stat*               gstat,
 
     if (bTemp)
     {
-        /* Sum the kinetic energies of the groups & calc temp */
-        /* compute full step kinetic energies if vv, or if vv-avek and we are computing the pressure with inputrecNptTrotter */
-        /* three maincase:  VV with AveVel (md-vv), vv with AveEkin (md-vv-avek), leap with AveEkin (md).
-           Leap with AveVel is not supported; it's not clear that it will actually work.
-           bEkinAveVel: If TRUE, we simply multiply ekin by ekinscale to get a full step kinetic energy.
-           If FALSE, we average ekinh_old and ekinh*ekinscale_nhc to get an averaged half step kinetic energy.
-         */
-        enerd->term[F_TEMP] = sum_ekin(&(ir->opts), ekind, &dvdl_ekin, bEkinAveVel, bScaleEkin);
-        enerd->dvdl_lin[efptMASS] = static_cast<double>(dvdl_ekin);
-
-        enerd->term[F_EKIN] = trace(ekind->ekin);
-
-        for (auto& dhdl : enerd->dhdlLambda)
-        {
-            dhdl += enerd->dvdl_lin[efptMASS];
-        }
+        sumKineticEnergies(ir, ekind, enerd, bEkinAveVel, bScaleEkin);
     }
 
     /* ########## Now pressure ############## */
@@ -318,6 +344,36 @@ void compute_globals(gmx_global_stat*               gstat,
     }
 }
 
+void compute_globals_finish(gmx_global_stat*          gstat,
+                            const t_commrec*          cr,
+                            const t_inputrec*         ir,
+                            gmx_ekindata_t*           ekind,
+                            gmx_wallcycle_t           wcycle,
+                            gmx_enerdata_t*           enerd,
+                            gmx::SimulationSignaller* signalCoordinator,
+                            gmx_bool*                 bSumEkinhOld,
+                            const int                 flags)
+{
+    GMX_RELEASE_ASSERT(
+            (flags & CGLO_NONBLOCKING) != 0,
+            "compute_globals_finish() should only be called for non-blocking reductions");
+
+    if (PAR(cr))
+    {
+        wallcycle_start(wcycle, ewcMoveE);
+        global_stat_finish(gstat);
+        wallcycle_stop(wcycle, ewcMoveE);
+    }
+    signalCoordinator->finalizeSignals();
+    *bSumEkinhOld = FALSE;
+
+    if ((flags & CGLO_TEMPERATURE) != 0)
+    {
+        const bool bEkinAveVel = (ir->eI == eiVV);
+        sumKineticEnergies(ir, ekind, enerd, bEkinAveVel, (flags & CGLO_SCALEEKIN) != 0);
+    }
+}
+
 void setCurrentLambdasRerun(int64_t           step,
                             const t_lambda*   fepvals,
                             const t_trxframe* rerun_fr,
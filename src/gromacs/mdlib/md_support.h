@@ -90,6 +90,12 @@ class SimulationSignaller;
  * global reduction of the total number of bonded interactions that
  * will be computed, to check none are missing. */
 #define CGLO_CHECK_NUMBER_OF_BONDED_INTERACTIONS (1u << 12u)
+/* The half step kinetic energy has already been computed during the update */
+#define CGLO_EKINH_COMPUTED (1u << 13u)
+/* Only start the global reduction, compute_globals_finish() completes it.
+ * Can only be combined with CGLO_GSTAT, CGLO_TEMPERATURE, CGLO_EKINH_COMPUTED
+ * and CGLO_CHECK_NUMBER_OF_BONDED_INTERACTIONS. */
+#define CGLO_NONBLOCKING (1u << 14u)
 
 
 /*! \brief Return the number of steps that will take place between
@@ -156,4 +162,21 @@ void compute_globals(gmx_global_stat*               gstat,
                      gmx_bool*                      bSumEkinhOld,
                      int                            flags);
 
+/*! \brief Complete a call to compute_globals() that passed CGLO_NONBLOCKING
+ *
+ * Waits for the global reduction, propagates the signals and computes
+ * the temperature. The same \p flags, \p signalCoordinator and
+ * \p bSumEkinhOld as passed to compute_globals() should be passed here.
+ * The kinetic energy data in \p ekind should not be modified in between.
+ */
+void compute_globals_finish(gmx_global_stat*          gstat,
+                            const t_commrec*          cr,
+                            const t_inputrec*         ir,
+                            gmx_ekindata_t*           ekind,
+                            gmx_wallcycle_t           wcycle,
+                            gmx_enerdata_t*           enerd,
+                            gmx::SimulationSignaller* signalCoordinator,
+                            gmx_bool*                 bSumEkinhOld,
+                            int                       flags);
+
 #endif
@@ -808,7 +808,9 @@ static DomainLifetimeWorkload setupDomainLifetimeWorkload(const t_inputrec&
 static StepWorkload setupStepWorkload(const int                 legacyFlags,
                                       const bool                isNonbondedOn,
                                       const SimulationWorkload& simulationWork,
-                                      const bool                rankHasPmeDuty)
+                                      const bool                rankHasPmeDuty,
+                                      const t_commrec&          cr,
+                                      const bool                emulateGpuNonbonded)
 {
     StepWorkload flags;
     flags.stateChanged           = ((legacyFlags & GMX_FORCE_STATECHANGED) != 0);
@@ -832,6 +834,12 @@ static StepWorkload setupStepWorkload(const int                 legacyFlags,
     flags.useGpuPmeFReduction = flags.useGpuFBufferOps
                                 && (simulationWork.useGpuPme
                                     && (rankHasPmeDuty || simulationWork.useGpuPmePpCommunication));
+    // With the nonbonded work on the CPU, we can hide the CPU halo exchange
+    // behind the local nonbonded and the long-range work
+    flags.useCpuHaloExchangeOverlap =
+            havePPDomainDecomposition(&cr) && !simulationWork.useGpuHaloExchange
+            && simulationWork.useCpuNonbonded && !emulateGpuNonbonded
+            && ddUsesHaloExchangeOverlap(*cr.dd);
 
     return flags;
 }
@@ -967,8 +975,9 @@ void do_force(FILE*                               fplog,
     const SimulationWorkload& simulationWork = runScheduleWork->simulationWork;
 
 
-    runScheduleWork->stepWork    = setupStepWorkload(legacyFlags, fr->bNonbonded, simulationWork,
-                                                  thisRankHasDuty(cr, DUTY_PME));
+    runScheduleWork->stepWork =
+            setupStepWorkload(legacyFlags, fr->bNonbonded, simulationWork,
+                              thisRankHasDuty(cr, DUTY_PME), *cr, fr->nbv->emulateGpu());
     const StepWorkload& stepWork = runScheduleWork->stepWork;
 
 
@@ -1317,7 +1326,15 @@ void do_force(FILE*                               fplog,
                 // a waitCoordinatesReadyOnHost() should be issued if it will be.
                 GMX_ASSERT(!simulationWork.useGpuUpdate,
                            "GPU update is not supported with CPU halo exchange");
-                dd_move_x(cr->dd, box, x.unpaddedArrayRef(), wcycle);
+                if (stepWork.useCpuHaloExchangeOverlap)
+                {
+                    // The exchange is finished after the local nonbonded work
+                    dd_move_x_start(cr->dd, box, x.unpaddedArrayRef(), wcycle);
+                }
+                else
+                {
+                    dd_move_x(cr->dd, box, x.unpaddedArrayRef(), wcycle);
+                }
             }
 
             if (stepWork.useGpuXBufferOps)
@@ -1330,8 +1347,9 @@ void do_force(FILE*                               fplog,
                                            stateGpu->getCoordinatesReadyOnDeviceEvent(
                                                    AtomLocality::NonLocal, simulationWork, stepWork));
             }
-            else
+            else if (!stepWork.useCpuHaloExchangeOverlap)
             {
+                // With overlap, the non-local coordinates are converted after their arrival
                 nbv->convertCoordinates(AtomLocality::NonLocal, false, x.unpaddedArrayRef());
             }
         }
@@ -1463,6 +1481,17 @@ void do_force(FILE*                               fplog,
         do_nb_verlet(fr, ic, enerd, stepWork, InteractionLocality::Local, enbvClearFYes, step, nrnb, wcycle);
     }
 
+    if (stepWork.useCpuHaloExchangeOverlap && !stepWork.doNeighborSearch)
+    {
+        /* Receive the non-local coordinates, which were communicated
+         * while we computed the local nonbonded interactions.
+         */
+        wallcycle_stop(wcycle, ewcFORCE);
+        dd_move_x_finish(cr->dd, x.unpaddedArrayRef(), wcycle);
+        nbv->convertCoordinates(AtomLocality::NonLocal, false, x.unpaddedArrayRef());
+        wallcycle_start_nocount(wcycle, ewcFORCE);
+    }
+
     if (fr->efep != efepNO)
     {
         /* Calculate the local and non-local free energy interactions here.
@@ -1620,7 +1649,15 @@ void do_force(FILE*                               fplog,
                 {
                     stateGpu->waitForcesReadyOnHost(AtomLocality::NonLocal);
                 }
-                dd_move_f(cr->dd, &forceOut.forceWithShiftForces(), wcycle);
+                if (stepWork.useCpuHaloExchangeOverlap)
+                {
+                    // The exchange was started in do_force_lowlevel()
+                    dd_move_f_finish(cr->dd, &forceOut.forceWithShiftForces(), wcycle);
+                }
+                else
+                {
+                    dd_move_f(cr->dd, &forceOut.forceWithShiftForces(), wcycle);
+                }
             }
         }
     }
@@ -77,7 +77,8 @@ SimulationSignaller::SimulationSignaller(SimulationSignals*    signals,
     ms_(ms),
     doInterSim_(doInterSim),
     doIntraSim_(doInterSim || doIntraSim),
-    mpiBuffer_{}
+    mpiBuffer_{},
+    sentSignals_{}
 {
 }
 
@@ -87,6 +88,8 @@ gmx::ArrayRef<real> SimulationSignaller::getCommunicationBuffer()
     {
         std::transform(std::begin(*signals_), std::end(*signals_), std::begin(mpiBuffer_),
                        [](const SimulationSignals::value_type& s) { return s.sig; });
+        std::transform(std::begin(*signals_), std::end(*signals_), std::begin(sentSignals_),
+                       [](const SimulationSignals::value_type& s) { return s.sig; });
 
         return mpiBuffer_;
     }
@@ -139,8 +142,14 @@ void SimulationSignaller::setSignals()
             {
                 s[i].set = gsi;
             }
-            // Turn off any local signal now that it has been processed.
-            s[i].sig = 0;
+            /* Turn off any local signal now that it has been processed.
+             * When the communication was non-blocking, a signal can have
+             * been raised after the buffer was filled. Such a signal
+             * has not been communicated yet, so we keep it. */
+            if (s[i].sig == sentSignals_[i])
+            {
+                s[i].sig = 0;
+            }
         }
     }
 }
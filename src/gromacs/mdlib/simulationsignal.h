@@ -163,6 +163,8 @@ private:
     bool doIntraSim_;
     //! Buffer for MPI communication.
     std::array<real, eglsNR> mpiBuffer_;
+    //! The local signal values that were put in the communication buffer.
+    std::array<signed char, eglsNR> sentSignals_;
 };
 
 } // namespace gmx
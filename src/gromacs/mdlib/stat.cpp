@@ -61,20 +61,61 @@
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxmpi.h"
 #include "gromacs/utility/smalloc.h"
 
+/*! \brief Where the quantities passed to global_stat_start() are stored
+ * in the reduction buffer and where they are extracted to afterwards */
+struct GlobalStatReduction
+{
+    //! Whether a reduction was started and not yet finished
+    bool inFlight = false;
+    //! The CGLO flags the reduction was started with
+    int flags = 0;
+    //! Whether ekinh_old is summed
+    bool bSumEkinhOld = false;
+    //! Destinations of the reduced quantities
+    gmx_enerdata_t*     enerd                           = nullptr;
+    rvec*               fvir                            = nullptr;
+    rvec*               svir                            = nullptr;
+    const t_inputrec*   inputrec                        = nullptr;
+    gmx_ekindata_t*     ekind                           = nullptr;
+    t_vcm*              vcm                             = nullptr;
+    int                 nsig                            = 0;
+    real*               sig                             = nullptr;
+    int*                totalNumberOfBondedInteractions = nullptr;
+    gmx::ArrayRef<real> rmsdData;
+    //! Indices of the quantities in the reduction buffer
+    int ie = 0, ifv = 0, isv = 0, irmsd = 0;
+    int idedl = 0, idedlo = 0, idvdll = 0, idvdlnl = 0, iepl = 0;
+    int icm = 0, imass = 0, ica = 0, inb = 0;
+    int isig = -1;
+    int icj = -1, ici = -1, icx = -1;
+    int inn[egNR];
+    //! Copy of the energy terms that are summed
+    real copyenerd[F_NRE];
+    //! The number of energy terms in copyenerd
+    int nener = 0;
+    //! The local, later total, number of bonded interactions
+    double nb = 0;
+#if GMX_LIB_MPI && MPI_IN_PLACE_EXISTS && MPI_VERSION >= 3
+    //! The request of the non-blocking reduction
+    MPI_Request request = MPI_REQUEST_NULL;
+#endif
+};
+
 typedef struct gmx_global_stat
 {
-    t_bin* rb;
-    int*   itc0;
-    int*   itc1;
+    t_bin*              rb;
+    int*                itc0;
+    int*                itc1;
+    GlobalStatReduction reduction;
 } t_gmx_global_stat;
 
 gmx_global_stat_t global_stat_init(const t_inputrec* ir)
 {
-    gmx_global_stat_t gs;
-
-    snew(gs, 1);
+    gmx_global_stat_t gs = new gmx_global_stat;
 
     gs->rb = mk_bin();
     snew(gs->itc0, ir->opts.ngtc);
@@ -85,10 +126,12 @@ gmx_global_stat_t global_stat_init(const t_inputrec* ir)
 
 void global_stat_destroy(gmx_global_stat_t gs)
 {
+    GMX_RELEASE_ASSERT(!gs->reduction.inFlight,
+                       "A non-blocking global reduction should be finished before destruction");
     destroy_bin(gs->rb);
     sfree(gs->itc0);
     sfree(gs->itc1);
-    sfree(gs);
+    delete gs;
 }
 
 static int filter_enerdterm(const real* afrom, gmx_bool bToBuffer, real* ato, gmx_bool bTemp, gmx_bool bPres, gmx_bool bEner)
@@ -136,35 +179,32 @@ static int filter_enerdterm(const real* afrom, gmx_bool bToBuffer, real* ato, gm
     return to;
 }
 
-void global_stat(const gmx_global_stat*  gs,
-                 const t_commrec*        cr,
-                 gmx_enerdata_t*         enerd,
-                 tensor                  fvir,
-                 tensor                  svir,
-                 const t_inputrec*       inputrec,
-                 gmx_ekindata_t*         ekind,
-                 const gmx::Constraints* constr,
-                 t_vcm*                  vcm,
-                 int                     nsig,
-                 real*                   sig,
-                 int*                    totalNumberOfBondedInteractions,
-                 gmx_bool                bSumEkinhOld,
-                 int                     flags)
+void global_stat_start(gmx_global_stat*        gs,
+                       const t_commrec*        cr,
+                       gmx_enerdata_t*         enerd,
+                       tensor                  fvir,
+                       tensor                  svir,
+                       const t_inputrec*       inputrec,
+                       gmx_ekindata_t*         ekind,
+                       const gmx::Constraints* constr,
+                       t_vcm*                  vcm,
+                       int                     nsig,
+                       real*                   sig,
+                       int*                    totalNumberOfBondedInteractions,
+                       gmx_bool                bSumEkinhOld,
+                       int                     flags,
+                       bool                    nonBlocking)
 /* instead of current system, gmx_booleans for summing virial, kinetic energy, and other terms */
 {
-    t_bin* rb;
-    int *  itc0, *itc1;
-    int    ie = 0, ifv = 0, isv = 0, irmsd = 0;
-    int idedl = 0, idedlo = 0, idvdll = 0, idvdlnl = 0, iepl = 0, icm = 0, imass = 0, ica = 0, inb = 0;
-    int      isig = -1;
-    int      icj = -1, ici = -1, icx = -1;
-    int      inn[egNR];
-    real     copyenerd[F_NRE];
-    int      nener, j;
-    double   nb;
-    gmx_bool bVV, bTemp, bEner, bPres, bConstrVir, bEkinAveVel, bReadEkin;
+    t_bin*               rb;
+    int *                itc0, *itc1;
+    int                  j;
+    gmx_bool             bVV, bTemp, bEner, bPres, bConstrVir, bEkinAveVel, bReadEkin;
+    GlobalStatReduction& red = gs->reduction;
     bool checkNumberOfBondedInteractions = (flags & CGLO_CHECK_NUMBER_OF_BONDED_INTERACTIONS) != 0;
 
+    GMX_RELEASE_ASSERT(!red.inFlight, "Only one global reduction can be in flight");
+
     bVV         = EI_VV(inputrec->eI);
     bTemp       = ((flags & CGLO_TEMPERATURE) != 0);
     bEner       = ((flags & CGLO_ENERGY) != 0);
@@ -177,6 +217,18 @@ void global_stat(const gmx_global_stat*  gs,
     itc0 = gs->itc0;
     itc1 = gs->itc1;
 
+    red.flags                           = flags;
+    red.bSumEkinhOld                    = bSumEkinhOld;
+    red.enerd                           = enerd;
+    red.fvir                            = fvir;
+    red.svir                            = svir;
+    red.inputrec                        = inputrec;
+    red.ekind                           = ekind;
+    red.rmsdData                        = {};
+    red.vcm                             = vcm;
+    red.nsig                            = nsig;
+    red.sig                             = sig;
+    red.totalNumberOfBondedInteractions = totalNumberOfBondedInteractions;
 
     reset_bin(rb);
     /* This routine copies all the data to be summed to one big buffer
@@ -188,13 +240,13 @@ void global_stat(const gmx_global_stat*  gs,
        communicated and summed when they need to be, to avoid repeating
        the sums and overcounting. */
 
-    nener = filter_enerdterm(enerd->term, TRUE, copyenerd, bTemp, bPres, bEner);
+    red.nener = filter_enerdterm(enerd->term, TRUE, red.copyenerd, bTemp, bPres, bEner);
 
     /* First, the data that needs to be communicated with velocity verlet every time
        This is just the constraint virial.*/
     if (bConstrVir)
     {
-        isv = add_binr(rb, DIM * DIM, svir[0]);
+        red.isv = add_binr(rb, DIM * DIM, svir[0]);
     }
 
     /* We need the force virial and the kinetic energy for the first time through with velocity verlet */
@@ -218,71 +270,71 @@ void global_stat(const gmx_global_stat*  gs,
                 }
             }
             /* these probably need to be put into one of these categories */
-            idedl = add_binr(rb, 1, &(ekind->dekindl));
+            red.idedl = add_binr(rb, 1, &(ekind->dekindl));
             if (bSumEkinhOld)
             {
-                idedlo = add_binr(rb, 1, &(ekind->dekindl_old));
+                red.idedlo = add_binr(rb, 1, &(ekind->dekindl_old));
             }
             if (ekind->cosacc.cos_accel != 0)
             {
-                ica = add_binr(rb, 1, &(ekind->cosacc.mvcos));
+                red.ica = add_binr(rb, 1, &(ekind->cosacc.mvcos));
             }
         }
     }
 
     if (bPres)
     {
-        ifv = add_binr(rb, DIM * DIM, fvir[0]);
+        red.ifv = add_binr(rb, DIM * DIM, fvir[0]);
     }
 
-    gmx::ArrayRef<real> rmsdData;
     if (bEner)
     {
-        ie = add_binr(rb, nener, copyenerd);
+        red.ie = add_binr(rb, red.nener, red.copyenerd);
         if (constr)
         {
-            rmsdData = constr->rmsdData();
-            if (!rmsdData.empty())
+            red.rmsdData = constr->rmsdData();
+            if (!red.rmsdData.empty())
             {
-                irmsd = add_binr(rb, 2, rmsdData.data());
+                red.irmsd = add_binr(rb, 2, red.rmsdData.data());
             }
         }
 
         for (j = 0; (j < egNR); j++)
         {
-            inn[j] = add_binr(rb, enerd->grpp.nener, enerd->grpp.ener[j].data());
+            red.inn[j] = add_binr(rb, enerd->grpp.nener, enerd->grpp.ener[j].data());
         }
         if (inputrec->efep != efepNO)
         {
-            idvdll  = add_bind(rb, efptNR, enerd->dvdl_lin);
-            idvdlnl = add_bind(rb, efptNR, enerd->dvdl_nonlin);
+            red.idvdll  = add_bind(rb, efptNR, enerd->dvdl_lin);
+            red.idvdlnl = add_bind(rb, efptNR, enerd->dvdl_nonlin);
             if (!enerd->enerpart_lambda.empty())
             {
-                iepl = add_bind(rb, enerd->enerpart_lambda.size(), enerd->enerpart_lambda.data());
+                red.iepl = add_bind(rb, enerd->enerpart_lambda.size(),
+                                    enerd->enerpart_lambda.data());
             }
         }
     }
 
     if (vcm)
     {
-        icm   = add_binr(rb, DIM * vcm->nr, vcm->group_p[0]);
-        imass = add_binr(rb, vcm->nr, vcm->group_mass.data());
+        red.icm   = add_binr(rb, DIM * vcm->nr, vcm->group_p[0]);
+        red.imass = add_binr(rb, vcm->nr, vcm->group_mass.data());
         if (vcm->mode == ecmANGULAR)
         {
-            icj = add_binr(rb, DIM * vcm->nr, vcm->group_j[0]);
-            icx = add_binr(rb, DIM * vcm->nr, vcm->group_x[0]);
-            ici = add_binr(rb, DIM * DIM * vcm->nr, vcm->group_i[0][0]);
+            red.icj = add_binr(rb, DIM * vcm->nr, vcm->group_j[0]);
+            red.icx = add_binr(rb, DIM * vcm->nr, vcm->group_x[0]);
+            red.ici = add_binr(rb, DIM * DIM * vcm->nr, vcm->group_i[0][0]);
         }
     }
 
     if (checkNumberOfBondedInteractions)
     {
-        nb  = cr->dd->nbonded_local;
-        inb = add_bind(rb, 1, &nb);
+        red.nb  = cr->dd->nbonded_local;
+        red.inb = add_bind(rb, 1, &red.nb);
     }
     if (nsig > 0)
     {
-        isig = add_binr(rb, nsig, sig);
+        red.isig = add_binr(rb, nsig, sig);
     }
 
     /* Global sum it all */
@@ -290,13 +342,69 @@ void global_stat(const gmx_global_stat*  gs,
     {
         fprintf(debug, "Summing %d energies\n", rb->maxreal);
     }
+    red.inFlight = true;
+#if GMX_LIB_MPI && MPI_IN_PLACE_EXISTS && MPI_VERSION >= 3
+    /* With two-step summing over the nodes we have no non-blocking
+     * equivalent, so then we fall back to the blocking sum.
+     */
+    if (nonBlocking && !cr->nc.bUse)
+    {
+        for (int i = rb->nreal; i < rb->maxreal; i++)
+        {
+            rb->rbuf[i] = 0;
+        }
+        MPI_Iallreduce(MPI_IN_PLACE, rb->rbuf, rb->maxreal, MPI_DOUBLE, MPI_SUM,
+                       cr->mpi_comm_mygroup, &red.request);
+        return;
+    }
+#else
+    GMX_UNUSED_VALUE(nonBlocking);
+#endif
     sum_bin(rb, cr);
+}
+
+void global_stat_finish(gmx_global_stat* gs)
+{
+    t_bin*               rb;
+    int *                itc0, *itc1;
+    int                  j;
+    gmx_bool             bVV, bTemp, bEner, bPres, bConstrVir, bEkinAveVel, bReadEkin;
+    GlobalStatReduction& red = gs->reduction;
+
+    GMX_RELEASE_ASSERT(red.inFlight, "global_stat_finish() needs a started global reduction");
+
+    const int         flags    = red.flags;
+    gmx_enerdata_t*   enerd    = red.enerd;
+    const t_inputrec* inputrec = red.inputrec;
+    gmx_ekindata_t*   ekind    = red.ekind;
+    t_vcm*            vcm      = red.vcm;
+    bool checkNumberOfBondedInteractions = (flags & CGLO_CHECK_NUMBER_OF_BONDED_INTERACTIONS) != 0;
+
+    bVV         = EI_VV(inputrec->eI);
+    bTemp       = ((flags & CGLO_TEMPERATURE) != 0);
+    bEner       = ((flags & CGLO_ENERGY) != 0);
+    bPres       = ((flags & CGLO_PRESSURE) != 0);
+    bConstrVir  = ((flags & CGLO_CONSTRAINT) != 0);
+    bEkinAveVel = (inputrec->eI == eiVV || (inputrec->eI == eiVVAK && bPres));
+    bReadEkin   = ((flags & CGLO_READEKIN) != 0);
+
+    rb   = gs->rb;
+    itc0 = gs->itc0;
+    itc1 = gs->itc1;
+
+#if GMX_LIB_MPI && MPI_IN_PLACE_EXISTS && MPI_VERSION >= 3
+    if (red.request != MPI_REQUEST_NULL)
+    {
+        MPI_Wait(&red.request, MPI_STATUS_IGNORE);
+    }
+#endif
+    red.inFlight = false;
 
     /* Extract all the data locally */
 
     if (bConstrVir)
     {
-        extract_binr(rb, isv, DIM * DIM, svir[0]);
+        extract_binr(rb, red.isv, DIM * DIM, red.svir[0]);
     }
 
     /* We need the force virial and the kinetic energy for the first time through with velocity verlet */
@@ -306,7 +414,7 @@ void global_stat(const gmx_global_stat*  gs,
         {
             for (j = 0; (j < inputrec->opts.ngtc); j++)
             {
-                if (bSumEkinhOld)
+                if (red.bSumEkinhOld)
                 {
                     extract_binr(rb, itc0[j], DIM * DIM, ekind->tcstat[j].ekinh_old[0]);
                 }
@@ -319,67 +427,88 @@ void global_stat(const gmx_global_stat*  gs,
                     extract_binr(rb, itc1[j], DIM * DIM, ekind->tcstat[j].ekinh[0]);
                 }
             }
-            extract_binr(rb, idedl, 1, &(ekind->dekindl));
-            if (bSumEkinhOld)
+            extract_binr(rb, red.idedl, 1, &(ekind->dekindl));
+            if (red.bSumEkinhOld)
             {
-                extract_binr(rb, idedlo, 1, &(ekind->dekindl_old));
+                extract_binr(rb, red.idedlo, 1, &(ekind->dekindl_old));
             }
             if (ekind->cosacc.cos_accel != 0)
             {
-                extract_binr(rb, ica, 1, &(ekind->cosacc.mvcos));
+                extract_binr(rb, red.ica, 1, &(ekind->cosacc.mvcos));
             }
         }
     }
     if (bPres)
     {
-        extract_binr(rb, ifv, DIM * DIM, fvir[0]);
+        extract_binr(rb, red.ifv, DIM * DIM, red.fvir[0]);
     }
 
     if (bEner)
     {
-        extract_binr(rb, ie, nener, copyenerd);
-        if (!rmsdData.empty())
+        extract_binr(rb, red.ie, red.nener, red.copyenerd);
+        if (!red.rmsdData.empty())
         {
-            extract_binr(rb, irmsd, rmsdData);
+            extract_binr(rb, red.irmsd, red.rmsdData);
         }
 
         for (j = 0; (j < egNR); j++)
         {
-            extract_binr(rb, inn[j], enerd->grpp.nener, enerd->grpp.ener[j].data());
+            extract_binr(rb, red.inn[j], enerd->grpp.nener, enerd->grpp.ener[j].data());
         }
         if (inputrec->efep != efepNO)
         {
-            extract_bind(rb, idvdll, efptNR, enerd->dvdl_lin);
-            extract_bind(rb, idvdlnl, efptNR, enerd->dvdl_nonlin);
+            extract_bind(rb, red.idvdll, efptNR, enerd->dvdl_lin);
+            extract_bind(rb, red.idvdlnl, efptNR, enerd->dvdl_nonlin);
             if (!enerd->enerpart_lambda.empty())
             {
-                extract_bind(rb, iepl, enerd->enerpart_lambda.size(), enerd->enerpart_lambda.data());
+                extract_bind(rb, red.iepl, enerd->enerpart_lambda.size(),
+                             enerd->enerpart_lambda.data());
             }
         }
 
-        filter_enerdterm(copyenerd, FALSE, enerd->term, bTemp, bPres, bEner);
+        filter_enerdterm(red.copyenerd, FALSE, enerd->term, bTemp, bPres, bEner);
     }
 
     if (vcm)
     {
-        extract_binr(rb, icm, DIM * vcm->nr, vcm->group_p[0]);
-        extract_binr(rb, imass, vcm->nr, vcm->group_mass.data());
+        extract_binr(rb, red.icm, DIM * vcm->nr, vcm->group_p[0]);
+        extract_binr(rb, red.imass, vcm->nr, vcm->group_mass.data());
         if (vcm->mode == ecmANGULAR)
         {
-            extract_binr(rb, icj, DIM * vcm->nr, vcm->group_j[0]);
-            extract_binr(rb, icx, DIM * vcm->nr, vcm->group_x[0]);
-            extract_binr(rb, ici, DIM * DIM * vcm->nr, vcm->group_i[0][0]);
+            extract_binr(rb, red.icj, DIM * vcm->nr, vcm->group_j[0]);
+            extract_binr(rb, red.icx, DIM * vcm->nr, vcm->group_x[0]);
+            extract_binr(rb, red.ici, DIM * DIM * vcm->nr, vcm->group_i[0][0]);
         }
     }
 
     if (checkNumberOfBondedInteractions)
     {
-        extract_bind(rb, inb, 1, &nb);
-        *totalNumberOfBondedInteractions = gmx::roundToInt(nb);
+        extract_bind(rb, red.inb, 1, &red.nb);
+        *red.totalNumberOfBondedInteractions = gmx::roundToInt(red.nb);
     }
 
-    if (nsig > 0)
+    if (red.nsig > 0)
     {
-        extract_binr(rb, isig, nsig, sig);
+        extract_binr(rb, red.isig, red.nsig, red.sig);
     }
 }
+
+void global_stat(gmx_global_stat*        gs,
+                 const t_commrec*        cr,
+                 gmx_enerdata_t*         enerd,
+                 tensor                  fvir,
+                 tensor                  svir,
+                 const t_inputrec*       inputrec,
+                 gmx_ekindata_t*         ekind,
+                 const gmx::Constraints* constr,
+                 t_vcm*                  vcm,
+                 int                     nsig,
+                 real*                   sig,
+                 int*                    totalNumberOfBondedInteractions,
+                 gmx_bool                bSumEkinhOld,
+                 int                     flags)
+{
+    global_stat_start(gs, cr, enerd, fvir, svir, inputrec, ekind, constr, vcm, nsig, sig,
+                      totalNumberOfBondedInteractions, bSumEkinhOld, flags, false);
+    global_stat_finish(gs);
+}
@@ -59,7 +59,7 @@ gmx_global_stat_t global_stat_init(const t_inputrec* ir);
 void global_stat_destroy(gmx_global_stat_t gs);
 
 /*! \brief All-reduce energy-like quantities over cr->mpi_comm_mysim  */
-void global_stat(const gmx_global_stat*  gs,
+void global_stat(gmx_global_stat*        gs,
                  const t_commrec*        cr,
                  gmx_enerdata_t*         enerd,
                  tensor                  fvir,
@@ -74,6 +74,34 @@ void global_stat(const gmx_global_stat*  gs,
                  gmx_bool                bSumEkinhOld,
                  int                     flags);
 
+/*! \brief Pack energy-like quantities and start their all-reduce
+ *
+ * Takes the same arguments as global_stat(). When \p nonBlocking is true
+ * and the MPI library supports it, the reduction is started with
+ * MPI_Iallreduce and the call returns without waiting for it. The buffers
+ * passed in are only written to in global_stat_finish(), which needs to be
+ * called before the reduced quantities are used. With thread-MPI the
+ * reduction is always blocking.
+ */
+void global_stat_start(gmx_global_stat*        gs,
+                       const t_commrec*        cr,
+                       gmx_enerdata_t*         enerd,
+                       tensor                  fvir,
+                       tensor                  svir,
+                       const t_inputrec*       inputrec,
+                       gmx_ekindata_t*         ekind,
+                       const gmx::Constraints* constr,
+                       t_vcm*                  vcm,
+                       int                     nsig,
+                       real*                   sig,
+                       int*                    totalNumberOfBondedInteractions,
+                       gmx_bool                bSumEkinhOld,
+                       int                     flags,
+                       bool                    nonBlocking);
+
+/*! \brief Wait for the reduction started by global_stat_start() and extract the results */
+void global_stat_finish(gmx_global_stat* gs);
+
 /*! \brief Returns TRUE if io should be done */
 inline bool do_per_step(int64_t step, int64_t nstep)
 {
@@ -58,15 +58,22 @@
 #include <cmath>
 
 #include <algorithm>
+#include <array>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
 #include <gtest/gtest.h>
 
+#include "gromacs/gmxlib/nrnb.h"
 #include "gromacs/gpu_utils/gpu_testutils.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/math/vectypes.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
+#include "gromacs/mdlib/update.h"
+#include "gromacs/mdtypes/group.h"
 #include "gromacs/mdtypes/mdatom.h"
+#include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/stringutil.h"
 
 #include "testutils/refdata.h"
@@ -268,6 +275,108 @@ TEST_P(LeapFrogTest, SimpleIntegration)
 
 INSTANTIATE_TEST_CASE_P(WithParameters, LeapFrogTest, ::testing::ValuesIn(parametersSets));
 
+/*! \brief Makes one leap-frog step and computes the half-step kinetic energy
+ *
+ * \param[in,out] testData        Test data object, needs masses and kinetic energy buffers
+ * \param[in]     fuseWithUpdate  Whether to compute the kinetic energy during the update
+ */
+void integrateLeapFrogStepAndComputeKineticEnergy(LeapFrogTestData* testData, bool fuseWithUpdate)
+{
+    testData->state_.x.resizeWithPadding(testData->numAtoms_);
+    testData->state_.v.resizeWithPadding(testData->numAtoms_);
+    for (int i = 0; i < testData->numAtoms_; i++)
+    {
+        testData->state_.x[i] = testData->x_[i];
+        testData->state_.v[i] = testData->v_[i];
+    }
+
+    gmx_omp_nthreads_set(emntUpdate, 1);
+
+    update_coords(0, &testData->inputRecord_, &testData->mdAtoms_, &testData->state_, testData->f_,
+                  &testData->forceCalculationData_, &testData->kineticEnergyData_,
+                  testData->velocityScalingMatrix_, testData->update_.get(), etrtNONE, nullptr,
+                  nullptr);
+
+    t_nrnb nrnb;
+    if (fuseWithUpdate)
+    {
+        finishUpdateAndComputeKineticEnergy(&testData->inputRecord_, &testData->mdAtoms_,
+                                            &testData->state_, nullptr, testData->update_.get(),
+                                            nullptr, &testData->kineticEnergyData_, &nrnb);
+    }
+    else
+    {
+        finish_update(&testData->inputRecord_, &testData->mdAtoms_, &testData->state_, nullptr,
+                      testData->update_.get(), nullptr);
+        calc_ke_part(makeConstArrayRef(testData->state_.x), makeConstArrayRef(testData->state_.v),
+                     testData->state_.box, &testData->inputRecord_.opts, &testData->mdAtoms_,
+                     &testData->kineticEnergyData_, &nrnb, FALSE);
+    }
+}
+
+TEST(LeapFrogKineticEnergyTest, ComputingDuringUpdateMatchesComputingAfterUpdate)
+{
+    const int  numAtoms         = 100;
+    const int  numTCoupleGroups = 2;
+    const rvec v0               = { 1.0, -2.0, 3.0 };
+    const rvec f0               = { -3.0, 2.0, -1.0 };
+
+    std::vector<real> masses(numAtoms);
+
+    std::array<std::unique_ptr<LeapFrogTestData>, 2> testData;
+    std::array<std::array<matrix, numTCoupleGroups>, 2> ekinWork;
+    std::array<real, 2>                                 dekindlWork;
+    for (int fused = 0; fused < 2; fused++)
+    {
+        testData[fused] =
+                std::make_unique<LeapFrogTestData>(numAtoms, 0.001, v0, f0, numTCoupleGroups, 0);
+
+        LeapFrogTestData* data = testData[fused].get();
+        for (int i = 0; i < numAtoms; i++)
+        {
+            masses[i] = 1.0 / data->inverseMasses_[i];
+        }
+        data->mdAtoms_.massT          = masses.data();
+        data->mdAtoms_.cACC           = nullptr;
+        data->mdAtoms_.nMassPerturbed = 0;
+        data->inputRecord_.opts.ngtc  = numTCoupleGroups;
+        // done_inputrec() frees the annealing data of each temperature-coupling group
+        snew(data->inputRecord_.opts.anneal_time, numTCoupleGroups);
+        snew(data->inputRecord_.opts.anneal_temp, numTCoupleGroups);
+
+        gmx_ekindata_t& ekind = data->kineticEnergyData_;
+        ekind.grpstat.resize(1);
+        ekind.ekin_work[0]    = ekinWork[fused].data();
+        ekind.dekindl_work[0] = &dekindlWork[fused];
+
+        ASSERT_TRUE(canComputeKineticEnergyInFinishUpdate(data->inputRecord_, ekind));
+
+        integrateLeapFrogStepAndComputeKineticEnergy(data, fused == 1);
+    }
+
+    const FloatingPointTolerance tolerance = relativeToleranceAsFloatingPoint(1.0, 1e-6);
+    for (int i = 0; i < numAtoms; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_REAL_EQ_TOL(testData[0]->state_.x[i][d], testData[1]->state_.x[i][d], tolerance);
+        }
+    }
+    for (int g = 0; g < numTCoupleGroups; g++)
+    {
+        const t_grp_tcstat& tcstatSeparate = testData[0]->kineticEnergyData_.tcstat[g];
+        const t_grp_tcstat& tcstatFused    = testData[1]->kineticEnergyData_.tcstat[g];
+        for (int d = 0; d < DIM; d++)
+        {
+            for (int m = 0; m < DIM; m++)
+            {
+                EXPECT_REAL_EQ_TOL(tcstatSeparate.ekinh[d][m], tcstatFused.ekinh[d][m], tolerance);
+            }
+        }
+        EXPECT_GT(tcstatFused.ekinh[XX][XX], 0);
+    }
+}
+
 } // namespace
 } // namespace test
 } // namespace gmx
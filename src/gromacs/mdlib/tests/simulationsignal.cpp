@@ -128,6 +128,22 @@ TEST_F(SignalTest, LocalIntraSimSignalPropagatesWhenBothTakePlace)
     EXPECT_EQ(0, signals_[2].set);
 }
 
+TEST_F(SignalTest, SignalRaisedDuringCommunicationIsKept)
+{
+    SimulationSignaller signaller(&signals_, nullptr, nullptr, false, true);
+    EXPECT_NE(0, signaller.getCommunicationBuffer().size());
+    // With non-blocking communication a signal can be raised before
+    // the communication has finished
+    signals_[2].sig = 1;
+    signaller.finalizeSignals();
+    EXPECT_EQ(0, signals_[0].sig);
+    EXPECT_EQ(0, signals_[1].sig);
+    EXPECT_EQ(1, signals_[2].sig);
+    EXPECT_EQ(1, signals_[0].set);
+    EXPECT_EQ(-1, signals_[1].set);
+    EXPECT_EQ(0, signals_[2].set);
+}
+
 TEST_F(SignalTest, NonLocalSignalDoesntPropagateWhenIntraSimSignalTakesPlace)
 {
     signals_[0].isLocal = false;
@@ -1042,27 +1042,17 @@ static void do_update_bd(int                  start,
     }
 }
 
-static void calc_ke_part_normal(ArrayRef<const RVec> v,
-                                const t_grpopts*     opts,
-                                const t_mdatoms*     md,
-                                gmx_ekindata_t*      ekind,
-                                t_nrnb*              nrnb,
-                                gmx_bool             bEkinAveVel)
+/*! \brief Stores the current half-step kinetic energies as old and clears the accumulation buffers
+ *
+ * bEkinAveVel: If TRUE, we sum into ekin, if FALSE, into ekinh.
+ */
+static void initKineticEnergyAccumulation(const t_grpopts* opts,
+                                          gmx_ekindata_t*  ekind,
+                                          gmx_bool         bEkinAveVel)
 {
-    int                         g;
-    gmx::ArrayRef<t_grp_tcstat> tcstat  = ekind->tcstat;
-    gmx::ArrayRef<t_grp_acc>    grpstat = ekind->grpstat;
-
-    /* three main: VV with AveVel, vv with AveEkin, leap with AveEkin.  Leap with AveVel is also
-       an option, but not supported now.
-       bEkinAveVel: If TRUE, we sum into ekin, if FALSE, into ekinh.
-     */
+    gmx::ArrayRef<t_grp_tcstat> tcstat = ekind->tcstat;
 
-    /* group velocities are calculated in update_ekindata and
-     * accumulated in acumulate_groups.
-     * Now the partial global and groups ekin.
-     */
-    for (g = 0; (g < opts->ngtc); g++)
+    for (int g = 0; (g < opts->ngtc); g++)
     {
         copy_mat(tcstat[g].ekinh, tcstat[g].ekinh_old);
         if (bEkinAveVel)
@@ -1076,71 +1066,100 @@ static void calc_ke_part_normal(ArrayRef<const RVec> v,
         }
     }
     ekind->dekindl_old = ekind->dekindl;
-    int nthread        = gmx_omp_nthreads_get(emntUpdate);
+}
 
-#pragma omp parallel for num_threads(nthread) schedule(static)
-    for (int thread = 0; thread < nthread; thread++)
-    {
-        // This OpenMP only loops over arrays and does not call any functions
-        // or memory allocation. It should not be able to throw, so for now
-        // we do not need a try/catch wrapper.
-        int     start_t, end_t, n;
-        int     ga, gt;
-        rvec    v_corrt;
-        real    hm;
-        int     d, m;
-        matrix* ekin_sum;
-        real*   dekindl_sum;
+/*! \brief Returns the range of home atoms for which \p thread computes the kinetic energy
+ *
+ * Note that we use a different range than getThreadAtomRange(), which
+ * rounds to SIMD width, to keep the summation order of the kinetic
+ * energy independent of the SIMD width.
+ */
+static void
+getKineticEnergyThreadAtomRange(int numThreads, int thread, int homenr, int* start, int* end)
+{
+    *start = ((thread + 0) * homenr) / numThreads;
+    *end   = ((thread + 1) * homenr) / numThreads;
+}
+
+/*! \brief Accumulates the kinetic energy of atoms \p start to \p end in the buffers of \p thread
+ *
+ * When \p copyUpdatedCoordinates is true, also copies the updated
+ * coordinates \p xprime to \p x, so each atom is only loaded once.
+ */
+template<bool copyUpdatedCoordinates>
+static void accumulateKineticEnergy(ArrayRef<const RVec> xprime,
+                                    ArrayRef<RVec>       x,
+                                    ArrayRef<const RVec> v,
+                                    const t_grpopts*     opts,
+                                    const t_mdatoms*     md,
+                                    gmx_ekindata_t*      ekind,
+                                    int                  thread,
+                                    int                  start,
+                                    int                  end)
+{
+    gmx::ArrayRef<const t_grp_acc> grpstat = ekind->grpstat;
 
-        start_t = ((thread + 0) * md->homenr) / nthread;
-        end_t   = ((thread + 1) * md->homenr) / nthread;
+    matrix* ekin_sum    = ekind->ekin_work[thread];
+    real*   dekindl_sum = ekind->dekindl_work[thread];
 
-        ekin_sum    = ekind->ekin_work[thread];
-        dekindl_sum = ekind->dekindl_work[thread];
+    for (int gt = 0; gt < opts->ngtc; gt++)
+    {
+        clear_mat(ekin_sum[gt]);
+    }
+    *dekindl_sum = 0.0;
 
-        for (gt = 0; gt < opts->ngtc; gt++)
+    int ga = 0;
+    int gt = 0;
+    for (int n = start; n < end; n++)
+    {
+        if (copyUpdatedCoordinates)
         {
-            clear_mat(ekin_sum[gt]);
+            x[n] = xprime[n];
         }
-        *dekindl_sum = 0.0;
 
-        ga = 0;
-        gt = 0;
-        for (n = start_t; n < end_t; n++)
+        if (md->cACC)
         {
-            if (md->cACC)
-            {
-                ga = md->cACC[n];
-            }
-            if (md->cTC)
-            {
-                gt = md->cTC[n];
-            }
-            hm = 0.5 * md->massT[n];
+            ga = md->cACC[n];
+        }
+        if (md->cTC)
+        {
+            gt = md->cTC[n];
+        }
+        real hm = 0.5 * md->massT[n];
 
-            for (d = 0; (d < DIM); d++)
-            {
-                v_corrt[d] = v[n][d] - grpstat[ga].u[d];
-            }
-            for (d = 0; (d < DIM); d++)
-            {
-                for (m = 0; (m < DIM); m++)
-                {
-                    /* if we're computing a full step velocity, v_corrt[d] has v(t).  Otherwise, v(t+dt/2) */
-                    ekin_sum[gt][m][d] += hm * v_corrt[m] * v_corrt[d];
-                }
-            }
-            if (md->nMassPerturbed && md->bPerturbed[n])
+        rvec v_corrt;
+        for (int d = 0; (d < DIM); d++)
+        {
+            v_corrt[d] = v[n][d] - grpstat[ga].u[d];
+        }
+        for (int d = 0; (d < DIM); d++)
+        {
+            for (int m = 0; (m < DIM); m++)
             {
-                *dekindl_sum += 0.5 * (md->massB[n] - md->massA[n]) * iprod(v_corrt, v_corrt);
+                /* if we're computing a full step velocity, v_corrt[d] has v(t).
+                 * Otherwise, v(t+dt/2) */
+                ekin_sum[gt][m][d] += hm * v_corrt[m] * v_corrt[d];
             }
         }
+        if (md->nMassPerturbed && md->bPerturbed[n])
+        {
+            *dekindl_sum += 0.5 * (md->massB[n] - md->massA[n]) * iprod(v_corrt, v_corrt);
+        }
     }
+}
+
+//! Reduces the kinetic energy work buffers of \p numThreads threads into \p ekind
+static void reduceKineticEnergy(const t_grpopts* opts,
+                                gmx_ekindata_t*  ekind,
+                                int              numThreads,
+                                gmx_bool         bEkinAveVel)
+{
+    gmx::ArrayRef<t_grp_tcstat> tcstat = ekind->tcstat;
 
     ekind->dekindl = 0;
-    for (int thread = 0; thread < nthread; thread++)
+    for (int thread = 0; thread < numThreads; thread++)
     {
-        for (g = 0; g < opts->ngtc; g++)
+        for (int g = 0; g < opts->ngtc; g++)
         {
             if (bEkinAveVel)
             {
@@ -1154,6 +1173,41 @@ static void calc_ke_part_normal(ArrayRef<const RVec> v,
 
         ekind->dekindl += *ekind->dekindl_work[thread];
     }
+}
+
+static void calc_ke_part_normal(ArrayRef<const RVec> v,
+                                const t_grpopts*     opts,
+                                const t_mdatoms*     md,
+                                gmx_ekindata_t*      ekind,
+                                t_nrnb*              nrnb,
+                                gmx_bool             bEkinAveVel)
+{
+    /* three main: VV with AveVel, vv with AveEkin, leap with AveEkin.  Leap with AveVel is also
+       an option, but not supported now.
+       bEkinAveVel: If TRUE, we sum into ekin, if FALSE, into ekinh.
+     */
+
+    /* group velocities are calculated in update_ekindata and
+     * accumulated in acumulate_groups.
+     * Now the partial global and groups ekin.
+     */
+    initKineticEnergyAccumulation(opts, ekind, bEkinAveVel);
+
+    int nthread = gmx_omp_nthreads_get(emntUpdate);
+
+#pragma omp parallel for num_threads(nthread) schedule(static)
+    for (int thread = 0; thread < nthread; thread++)
+    {
+        // This OpenMP only loops over arrays and does not do any memory
+        // allocation. It should not be able to throw, so for now
+        // we do not need a try/catch wrapper.
+        int start_t, end_t;
+        getKineticEnergyThreadAtomRange(nthread, thread, md->homenr, &start_t, &end_t);
+
+        accumulateKineticEnergy<false>({}, {}, v, opts, md, ekind, thread, start_t, end_t);
+    }
+
+    reduceKineticEnergy(opts, ekind, nthread, bEkinAveVel);
 
     inc_nrnb(nrnb, eNR_EKIN, md->homenr);
 }
@@ -1572,12 +1626,17 @@ void update_sd_second_half(int64_t step,
     }
 }
 
-void finish_update(const t_inputrec*       inputrec, /* input record and box stuff	*/
-                   const t_mdatoms*        md,
-                   t_state*                state,
-                   gmx_wallcycle_t         wcycle,
-                   Update*                 upd,
-                   const gmx::Constraints* constr)
+/*! \brief Copies the updated coordinates to the state, when \p ekind != nullptr also
+ * computes the half-step kinetic energy in the same pass over the atoms
+ */
+static void finishUpdate(const t_inputrec*       inputrec,
+                         const t_mdatoms*        md,
+                         t_state*                state,
+                         gmx_wallcycle_t         wcycle,
+                         Update*                 upd,
+                         const gmx::Constraints* constr,
+                         gmx_ekindata_t*         ekind,
+                         t_nrnb*                 nrnb)
 {
     int homenr = md->homenr;
 
@@ -1636,11 +1695,36 @@ void finish_update(const t_inputrec*       inputrec, /* input record and box stu
 
 
             int gmx_unused nth = gmx_omp_nthreads_get(emntUpdate);
+            if (ekind == nullptr)
+            {
 #pragma omp parallel for num_threads(nth) schedule(static)
-            for (int i = 0; i < homenr; i++)
+                for (int i = 0; i < homenr; i++)
+                {
+                    // Trivial statement, does not throw
+                    x[i] = xp[i];
+                }
+            }
+            else
             {
-                // Trivial statement, does not throw
-                x[i] = xp[i];
+                /* We compute the kinetic energy while we pass over the atoms
+                 * for the copy, which saves a pass over the velocities and masses.
+                 */
+                initKineticEnergyAccumulation(&inputrec->opts, ekind, FALSE);
+
+#pragma omp parallel for num_threads(nth) schedule(static)
+                for (int th = 0; th < nth; th++)
+                {
+                    // Only loops over arrays, does not throw
+                    int start_th, end_th;
+                    getKineticEnergyThreadAtomRange(nth, th, homenr, &start_th, &end_th);
+
+                    accumulateKineticEnergy<true>(xp, x, makeConstArrayRef(state->v),
+                                                  &inputrec->opts, md, ekind, th, start_th, end_th);
+                }
+
+                reduceKineticEnergy(&inputrec->opts, ekind, nth, FALSE);
+
+                inc_nrnb(nrnb, eNR_EKIN, homenr);
             }
         }
         wallcycle_stop(wcycle, ewcUPDATE);
@@ -1648,6 +1732,40 @@ void finish_update(const t_inputrec*       inputrec, /* input record and box stu
     /* ############# END the update of velocities and positions ######### */
 }
 
+void finish_update(const t_inputrec*       inputrec, /* input record and box stuff	*/
+                   const t_mdatoms*        md,
+                   t_state*                state,
+                   gmx_wallcycle_t         wcycle,
+                   Update*                 upd,
+                   const gmx::Constraints* constr)
+{
+    finishUpdate(inputrec, md, state, wcycle, upd, constr, nullptr, nullptr);
+}
+
+bool canComputeKineticEnergyInFinishUpdate(const t_inputrec& inputrec, const gmx_ekindata_t& ekind)
+{
+    /* With the cosine acceleration the kinetic energy depends on
+     * the velocity profile, with NEMD on the group velocities,
+     * which are both only known after global communication.
+     */
+    return (inputrec.eI == eiMD && ekind.cosacc.cos_accel == 0 && !ekind.bNEMD);
+}
+
+void finishUpdateAndComputeKineticEnergy(const t_inputrec*       inputrec,
+                                         const t_mdatoms*        md,
+                                         t_state*                state,
+                                         gmx_wallcycle_t         wcycle,
+                                         Update*                 upd,
+                                         const gmx::Constraints* constr,
+                                         gmx_ekindata_t*         ekind,
+                                         t_nrnb*                 nrnb)
+{
+    GMX_ASSERT(canComputeKineticEnergyInFinishUpdate(*inputrec, *ekind),
+               "Can only compute the kinetic energy here when supported");
+
+    finishUpdate(inputrec, md, state, wcycle, upd, constr, ekind, nrnb);
+}
+
 void update_pcouple_after_coordinates(FILE*             fplog,
                                       int64_t           step,
                                       const t_inputrec* inputrec,
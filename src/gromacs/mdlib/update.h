@@ -152,6 +152,28 @@ void update_coords(int64_t           step,
                    const t_commrec* cr, /* these shouldn't be here -- need to think about it */
                    const gmx::Constraints* constr);
 
+/*! \brief Returns whether finishUpdateAndComputeKineticEnergy() can be used
+ *
+ * This is the case for leap-frog without cosine acceleration
+ * and without non-equilibrium group acceleration.
+ */
+bool canComputeKineticEnergyInFinishUpdate(const t_inputrec& inputrec, const gmx_ekindata_t& ekind);
+
+/*! \brief Does the same as finish_update() followed by calc_ke_part() for leap-frog
+ *
+ * The half-step kinetic energy is computed in the same pass over
+ * the atoms as the copy of the updated coordinates, which saves
+ * a pass over the velocities and masses.
+ */
+void finishUpdateAndComputeKineticEnergy(const t_inputrec*       inputrec,
+                                         const t_mdatoms*        md,
+                                         t_state*                state,
+                                         gmx_wallcycle_t         wcycle,
+                                         gmx::Update*            upd,
+                                         const gmx::Constraints* constr,
+                                         gmx_ekindata_t*         ekind,
+                                         t_nrnb*                 nrnb);
+
 /* Return TRUE if OK, FALSE in case of Shake Error */
 
 extern gmx_bool update_randomize_velocities(const t_inputrec*        ir,
@@ -201,8 +223,6 @@ void finish_update(const t_inputrec*       inputrec,
                    gmx::Update*            upd,
                    const gmx::Constraints* constr);
 
-/* Return TRUE if OK, FALSE in case of Shake Error */
-
 void calc_ke_part(gmx::ArrayRef<const gmx::RVec> x,
                   gmx::ArrayRef<const gmx::RVec> v,
                   const matrix                   box,
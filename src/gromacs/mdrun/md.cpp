@@ -211,6 +211,14 @@ void gmx::LegacySimulator::do_md()
     // signals, and will use this object to achieve that.
     SimulationSignaller nullSignaller(nullptr, nullptr, nullptr, false, false);
 
+    // With leap-frog, steps that only need the kinetic energy for
+    // T-coupling can let the global reduction overlap with the next
+    // neighbour search and force calculation. Such a reduction is
+    // pending when this signaller is set. The bonded interaction
+    // count is then only checked at the next blocking reduction.
+    std::unique_ptr<SimulationSignaller> pendingGlobalsSignaller;
+    int                                  pendingGlobalsFlags = 0;
+
     if (!mdrunOptions.writeConfout)
     {
         // This is on by default, and the main known use case for
@@ -252,6 +260,9 @@ void gmx::LegacySimulator::do_md()
                   "Either specify the -ei option to mdrun, or do not use this checkpoint file.");
     }
 
+    // With replica exchange of parameters, the lambda state from the
+    // checkpoint tells which parameter set this replica holds.
+    const int fepStateFromCheckpoint = MASTER(cr) ? state_global->fep_state : -1;
     initialize_lambdas(fplog, *ir, MASTER(cr), &state_global->fep_state, state_global->lambda, lam0);
     Update     upd(ir, deform);
     const bool doSimulatedAnnealing = initSimulatedAnnealing(ir, &upd);
@@ -279,8 +290,17 @@ void gmx::LegacySimulator::do_md()
             // Inter-simulation signal communication does not need to happen
             // often, so we use a minimum of 200 steps to reduce overhead.
             const int c_minimumInterSimulationSignallingInterval = 200;
-            nstSignalComm = ((c_minimumInterSimulationSignallingInterval + nstglobalcomm - 1) / nstglobalcomm)
-                            * nstglobalcomm;
+            // Replicas wait for each other at exchange steps anyhow, so
+            // signalling only at exchange steps avoids extra waiting.
+            int period = nstglobalcomm;
+            if (useReplicaExchange)
+            {
+                const int exchangeInterval = replExParams.exchangeInterval;
+                const int divisor = gmx_greatest_common_divisor(nstglobalcomm, exchangeInterval);
+                period            = (nstglobalcomm / divisor) * exchangeInterval;
+            }
+            nstSignalComm =
+                    ((c_minimumInterSimulationSignallingInterval + period - 1) / period) * period;
         }
     }
 
@@ -350,6 +370,11 @@ void gmx::LegacySimulator::do_md()
     const bool  useGpuForNonbonded = simulationWork.useGpuNonbonded;
     const bool  useGpuForBufferOps = simulationWork.useGpuBufferOps;
     const bool  useGpuForUpdate    = simulationWork.useGpuUpdate;
+    /* Non-blocking collectives need a real MPI library, with thread-MPI the
+     * reduction would block anyhow. */
+    const bool useNonBlockingGlobalReduction =
+            (GMX_LIB_MPI && PAR(cr) && !EI_VV(ir->eI) && ir->efep == efepNO
+             && std::getenv("GMX_NO_NONBLOCKING_GLOBAL_REDUCTION") == nullptr);
 
     StatePropagatorDataGpu* stateGpu = fr->stateGpu;
 
@@ -455,7 +480,12 @@ void gmx::LegacySimulator::do_md()
 
     if (useReplicaExchange && MASTER(cr))
     {
-        repl_ex = init_replica_exchange(fplog, ms, top_global->natoms, ir, replExParams);
+        repl_ex = init_replica_exchange(fplog, ms, top_global->natoms, ir, replExParams,
+                                        fepStateFromCheckpoint);
+    }
+    if (useReplicaExchange)
+    {
+        replica_exchange_setup_parameters(cr, repl_ex, ir, &upd, state_global, state);
     }
     /* PME tuning is only supported in the Verlet scheme, with PME for
      * Coulomb. It is not supported with only LJ PME. */
@@ -982,6 +1012,16 @@ void gmx::LegacySimulator::do_md()
                      (bNS ? GMX_FORCE_NS : 0) | force_flags, ddBalanceRegionHandler);
         }
 
+        if (pendingGlobalsSignaller)
+        {
+            /* Complete the reduction of the previous step before
+             * the kinetic energy and signals are used */
+            compute_globals_finish(gstat, cr, ir, ekind, wcycle, enerd,
+                                   pendingGlobalsSignaller.get(), &bSumEkinhOld,
+                                   pendingGlobalsFlags);
+            pendingGlobalsSignaller.reset();
+        }
+
         // VV integrators do not need the following velocity half step
         // if it is the first step after starting from a checkpoint.
         // That is, the half step is needed on all other steps, and
@@ -1289,6 +1329,11 @@ void gmx::LegacySimulator::do_md()
         const bool doParrinelloRahman = (ir->epc == epcPARRINELLORAHMAN
                                          && do_per_step(step + ir->nstpcouple - 1, ir->nstpcouple));
 
+        // With leap-frog on the CPU we compute the half step kinetic energy, when needed,
+        // in the same pass over the atoms as the last part of the update
+        const bool computeEkinhInUpdate = (!useGpuForUpdate && (bGStat || needHalfStepKineticEnergy)
+                                           && canComputeKineticEnergyInFinishUpdate(*ir, *ekind));
+
         if (useGpuForUpdate)
         {
             if (bNS && (bFirstStep || DOMAINDECOMP(cr)))
@@ -1337,7 +1382,15 @@ void gmx::LegacySimulator::do_md()
 
             update_sd_second_half(step, &dvdl_constr, ir, mdatoms, state, cr, nrnb, wcycle, &upd,
                                   constr, do_log, do_ene);
-            finish_update(ir, mdatoms, state, wcycle, &upd, constr);
+            if (computeEkinhInUpdate)
+            {
+                finishUpdateAndComputeKineticEnergy(ir, mdatoms, state, wcycle, &upd, constr,
+                                                    ekind, nrnb);
+            }
+            else
+            {
+                finish_update(ir, mdatoms, state, wcycle, &upd, constr);
+            }
         }
 
         if (ir->bPull && ir->pull->bSetPbcRefToPrevStepCOM)
@@ -1426,23 +1479,52 @@ void gmx::LegacySimulator::do_md()
                 // bGStat becomes true, so we can't get into a
                 // situation where e.g. checkpointing can't be
                 // signalled.
-                bool                doIntraSimSignal = true;
-                SimulationSignaller signaller(&signals, cr, ms, doInterSimSignal, doIntraSimSignal);
-
-                compute_globals(
-                        gstat, cr, ir, fr, ekind, makeConstArrayRef(state->x),
-                        makeConstArrayRef(state->v), state->box, state->lambda[efptVDW], mdatoms,
-                        nrnb, &vcm, wcycle, enerd, force_vir, shake_vir, total_vir, pres, constr,
-                        &signaller, lastbox, &totalNumberOfBondedInteractions, &bSumEkinhOld,
-                        (bGStat ? CGLO_GSTAT : 0) | (!EI_VV(ir->eI) && bCalcEner ? CGLO_ENERGY : 0)
-                                | (!EI_VV(ir->eI) && bStopCM ? CGLO_STOPCM : 0)
-                                | (!EI_VV(ir->eI) ? CGLO_TEMPERATURE : 0)
-                                | (!EI_VV(ir->eI) ? CGLO_PRESSURE : 0) | CGLO_CONSTRAINT
-                                | (shouldCheckNumberOfBondedInteractions ? CGLO_CHECK_NUMBER_OF_BONDED_INTERACTIONS
-                                                                         : 0));
-                checkNumberOfBondedInteractions(mdlog, cr, totalNumberOfBondedInteractions,
-                                                top_global, &top, makeConstArrayRef(state->x),
-                                                state->box, &shouldCheckNumberOfBondedInteractions);
+                bool doIntraSimSignal = true;
+                auto signaller        = std::make_unique<SimulationSignaller>(
+                        &signals, cr, ms, doInterSimSignal, doIntraSimSignal);
+
+                // When only the kinetic energy is needed, which is used
+                // at the earliest after the next force calculation, we
+                // do not need to wait for the reduction to finish.
+                const bool deferGlobalReduction =
+                        (useNonBlockingGlobalReduction && bGStat && !bCalcEner && !bCalcVir
+                         && !bStopCM && !doInterSimSignal && !bLastStep && !useGpuForUpdate);
+                // The bonded interaction count can only be checked after
+                // a blocking reduction, which batches the checks of all
+                // partitionings since the last such reduction.
+                const bool checkBondedInteractions =
+                        (shouldCheckNumberOfBondedInteractions && bGStat && !deferGlobalReduction);
+
+                const int cgloFlags =
+                        deferGlobalReduction
+                                ? (CGLO_GSTAT | CGLO_TEMPERATURE | CGLO_NONBLOCKING
+                                   | (computeEkinhInUpdate ? CGLO_EKINH_COMPUTED : 0))
+                                : ((bGStat ? CGLO_GSTAT : 0)
+                                   | (!EI_VV(ir->eI) && bCalcEner ? CGLO_ENERGY : 0)
+                                   | (!EI_VV(ir->eI) && bStopCM ? CGLO_STOPCM : 0)
+                                   | (!EI_VV(ir->eI) ? CGLO_TEMPERATURE : 0)
+                                   | (!EI_VV(ir->eI) ? CGLO_PRESSURE : 0) | CGLO_CONSTRAINT
+                                   | (computeEkinhInUpdate ? CGLO_EKINH_COMPUTED : 0)
+                                   | (checkBondedInteractions
+                                              ? CGLO_CHECK_NUMBER_OF_BONDED_INTERACTIONS
+                                              : 0));
+                compute_globals(gstat, cr, ir, fr, ekind, makeConstArrayRef(state->x),
+                                makeConstArrayRef(state->v), state->box, state->lambda[efptVDW],
+                                mdatoms, nrnb, &vcm, wcycle, enerd, force_vir, shake_vir, total_vir,
+                                pres, constr, signaller.get(), lastbox,
+                                &totalNumberOfBondedInteractions, &bSumEkinhOld, cgloFlags);
+                if (deferGlobalReduction)
+                {
+                    pendingGlobalsSignaller = std::move(signaller);
+                    pendingGlobalsFlags     = cgloFlags;
+                }
+                if (checkBondedInteractions)
+                {
+                    checkNumberOfBondedInteractions(
+                            mdlog, cr, totalNumberOfBondedInteractions, top_global, &top,
+                            makeConstArrayRef(state->x), state->box,
+                            &shouldCheckNumberOfBondedInteractions);
+                }
                 if (!EI_VV(ir->eI) && bStopCM)
                 {
                     process_and_stopcm_grp(fplog, &vcm, *mdatoms, makeArrayRef(state->x),
@@ -1487,6 +1569,13 @@ void gmx::LegacySimulator::do_md()
             integrator->setPbc(PbcType::Xyz, state->box);
         }
 
+        if (bDoReplEx && MASTER(cr))
+        {
+            /* Let gathering the energies of the other replicas overlap
+             * with the energy and trajectory output below */
+            replica_exchange_start_gathering(ms, repl_ex, enerd, det(state->box), step);
+        }
+
         /* ################# END UPDATE STEP 2 ################# */
         /* #### We now have r(t+dt) and v(t+dt/2)  ############# */
 
@@ -1607,10 +1696,13 @@ void gmx::LegacySimulator::do_md()
         bExchanged = FALSE;
         if (bDoReplEx)
         {
-            bExchanged = replica_exchange(fplog, cr, ms, repl_ex, state_global, enerd, state, step, t);
+            bExchanged = replica_exchange(fplog, cr, ms, repl_ex, state_global, enerd, state, step,
+                                          t, ir, &upd);
         }
 
-        if ((bExchanged || bNeedRepartition) && DOMAINDECOMP(cr))
+        // Exchanging parameters leaves the state in place
+        const bool stateWasExchanged = (bExchanged && !replExParams.exchangeParameters);
+        if ((stateWasExchanged || bNeedRepartition) && DOMAINDECOMP(cr))
         {
             dd_partition_system(fplog, mdlog, step, cr, TRUE, 1, state_global, *top_global, ir,
                                 imdSession, pull_work, state, &f, mdAtoms, &top, fr, vsite, constr,
@@ -1660,6 +1752,12 @@ void gmx::LegacySimulator::do_md()
     }
     /* End of main MD loop */
 
+    if (pendingGlobalsSignaller)
+    {
+        compute_globals_finish(gstat, cr, ir, ekind, wcycle, enerd, pendingGlobalsSignaller.get(),
+                               &bSumEkinhOld, pendingGlobalsFlags);
+    }
+
     /* Closing TNG files can include compressing data. Therefore it is good to do that
      * before stopping the time measurements. */
     mdoutf_tng_close(outf);
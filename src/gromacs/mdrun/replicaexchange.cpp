@@ -57,6 +57,7 @@
 #include "gromacs/gmxlib/network.h"
 #include "gromacs/math/units.h"
 #include "gromacs/math/vec.h"
+#include "gromacs/mdlib/update.h"
 #include "gromacs/mdrunutility/multisim.h"
 #include "gromacs/mdtypes/commrec.h"
 #include "gromacs/mdtypes/enerdata.h"
@@ -66,7 +67,9 @@
 #include "gromacs/random/threefry.h"
 #include "gromacs/random/uniformintdistribution.h"
 #include "gromacs/random/uniformrealdistribution.h"
+#include "gromacs/timing/walltime_accounting.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxmpi.h"
 #include "gromacs/utility/pleasecite.h"
 #include "gromacs/utility/smalloc.h"
 
@@ -155,6 +158,30 @@ struct gmx_repl_ex
     real*  Vol;
     real** de;
     //! \}
+
+    //! Whether the lambda state and temperature are exchanged instead of the coordinates
+    bool bExchangeParameters;
+    //! The index of the parameter set this replica holds, equal to repl with state exchange
+    int slot;
+
+    //! Buffer for gathering the volumes, potential energies and lambda energy differences
+    real* gatherBuffer;
+    //! The step for which the gathering was started, -1 when not started
+    int64_t gatherStep;
+#if GMX_LIB_MPI
+    //! The request of the non-blocking gathering
+    MPI_Request gatherRequest;
+#endif
+
+    //! Exchange latency accounting, times are in seconds
+    //! \{
+    double gatherTime;
+    double waitTimeSum;
+    double waitTimeMax;
+    int    numGathers;
+    double exchangeTimeSum;
+    int    numStateExchanges;
+    //! \}
 };
 
 // TODO We should add Doxygen here some time.
@@ -194,11 +221,158 @@ static gmx_bool repl_quantity(const gmx_multisim_t* ms, struct gmx_repl_ex* re,
     return bDiff;
 }
 
+static void scale_velocities(gmx::ArrayRef<gmx::RVec> velocities, real fac)
+{
+    for (auto& v : velocities)
+    {
+        v *= fac;
+    }
+}
+
+static void check_parameter_exchange(FILE*               fplog,
+                                     struct gmx_repl_ex* re,
+                                     const t_inputrec*   ir,
+                                     int                 fepState)
+{
+    if (re->type != ereLAMBDA && re->type != ereTL)
+    {
+        /* The temperature is not stored in the checkpoint, so then we
+         * could not determine the parameter set after a restart.
+         */
+        gmx_fatal(FARGS,
+                  "Exchanging parameters requires replicas that differ in lambda state, "
+                  "since the lambda state is used to identify the parameter set");
+    }
+    for (int i = 0; i < re->nrepl; i++)
+    {
+        for (int j = i + 1; j < re->nrepl; j++)
+        {
+            if (re->q[ereLAMBDA][i] == re->q[ereLAMBDA][j])
+            {
+                gmx_fatal(FARGS,
+                          "Exchanging parameters requires all replicas to have different lambda "
+                          "states");
+            }
+        }
+    }
+    if (re->type == ereTL)
+    {
+        if (!(ir->etc == etcVRESCALE || (ir->etc == etcNO && (ir->eI == eiSD1 || ir->eI == eiBD))))
+        {
+            gmx_fatal(FARGS,
+                      "Exchanging temperatures as parameters is only supported with the %s "
+                      "thermostat or with the %s and %s integrators",
+                      ETCOUPLTYPE(etcVRESCALE), EI(eiSD1), EI(eiBD));
+        }
+        if (ir->opts.annealing != nullptr)
+        {
+            for (int i = 0; i < ir->opts.ngtc; i++)
+            {
+                if (ir->opts.annealing[i] != eannNO)
+                {
+                    gmx_fatal(FARGS,
+                              "Exchanging temperatures as parameters is not supported with "
+                              "simulated annealing");
+                }
+            }
+        }
+    }
+    if (re->bNPT)
+    {
+        for (int i = 1; i < re->nrepl; i++)
+        {
+            if (re->pres[i] != re->pres[0])
+            {
+                gmx_fatal(FARGS,
+                          "Exchanging parameters requires the same reference pressure in all "
+                          "replicas");
+            }
+        }
+    }
+
+    /* With a continuation, the lambda state from the checkpoint tells us
+     * which parameter set this replica holds.
+     */
+    re->slot = -1;
+    for (int i = 0; i < re->nrepl; i++)
+    {
+        if (static_cast<int>(re->q[ereLAMBDA][i]) == fepState)
+        {
+            re->slot = i;
+        }
+    }
+    if (re->slot < 0)
+    {
+        gmx_fatal(FARGS, "Lambda state %d does not match any of the replicas", fepState);
+    }
+    fprintf(fplog, "\nReplica exchange exchanges the parameters instead of the coordinates\n");
+    fprintf(fplog, "Repl  This replica holds parameter set %d\n", re->slot);
+}
+
+/*! \brief Changes the temperature and lambda state of this replica
+ * from those of parameter set \p fromSlot to those of \p toSlot
+ *
+ * Should be called on all ranks, \p re, \p fromSlot and \p toSlot
+ * are only used on the master rank. */
+static void apply_parameter_set(const t_commrec*          cr,
+                                const struct gmx_repl_ex* re,
+                                int                       fromSlot,
+                                int                       toSlot,
+                                t_inputrec*               ir,
+                                gmx::Update*              upd,
+                                t_state*                  state,
+                                t_state*                  state_local,
+                                gmx_bool                  bScaleVelocities)
+{
+    /* The ratio of the new over the old temperature and the new lambda state */
+    real parameters[2] = { 1, -1 };
+
+    if (MASTER(cr))
+    {
+        if (re->type == ereTEMP || re->type == ereTL)
+        {
+            parameters[0] = re->q[ereTEMP][toSlot] / re->q[ereTEMP][fromSlot];
+        }
+        if (re->type == ereLAMBDA || re->type == ereTL)
+        {
+            parameters[1] = re->q[ereLAMBDA][toSlot];
+        }
+    }
+    if (DOMAINDECOMP(cr))
+    {
+#if GMX_MPI
+        MPI_Bcast(parameters, sizeof(parameters), MPI_BYTE, MASTERRANK(cr), cr->mpi_comm_mygroup);
+#endif
+    }
+
+    if (parameters[0] != 1)
+    {
+        for (int i = 0; i < ir->opts.ngtc; i++)
+        {
+            ir->opts.ref_t[i] *= parameters[0];
+        }
+        update_temperature_constants(upd->sd(), ir);
+        if (bScaleVelocities)
+        {
+            scale_velocities(state_local->v, std::sqrt(parameters[0]));
+        }
+    }
+    if (parameters[1] >= 0)
+    {
+        state_local->fep_state = static_cast<int>(parameters[1]);
+        if (state != nullptr)
+        {
+            state->fep_state = state_local->fep_state;
+        }
+    }
+}
+
 gmx_repl_ex_t init_replica_exchange(FILE*                            fplog,
                                     const gmx_multisim_t*            ms,
                                     int                              numAtomsInSystem,
                                     const t_inputrec*                ir,
-                                    const ReplicaExchangeParameters& replExParams)
+                                    const ReplicaExchangeParameters& replExParams,
+                                    int                              fepState)
 {
     real                pres;
     int                 i, j;
@@ -492,9 +666,47 @@ gmx_repl_ex_t init_replica_exchange(FILE*                            fplog,
         snew(re->de[i], re->nrepl);
     }
     re->nex = replExParams.numExchanges;
+
+    re->bExchangeParameters = replExParams.exchangeParameters;
+    re->slot                = re->repl;
+    if (re->bExchangeParameters)
+    {
+        check_parameter_exchange(fplog, re, ir, fepState);
+    }
+
+    snew(re->gatherBuffer, re->nrepl * (re->nrepl + 2));
+    re->gatherStep = -1;
+#if GMX_LIB_MPI
+    re->gatherRequest = MPI_REQUEST_NULL;
+#endif
+
     return re;
 }
 
+void replica_exchange_setup_parameters(const t_commrec* cr,
+                                       gmx_repl_ex_t    re,
+                                       t_inputrec*      ir,
+                                       gmx::Update*     upd,
+                                       t_state*         state,
+                                       t_state*         state_local)
+{
+    /* Only a continuation with exchanged parameters needs changes, but all
+     * ranks need to take part in the broadcast.
+     */
+    int slot = (MASTER(cr) && re->bExchangeParameters) ? re->slot : -1;
+    if (DOMAINDECOMP(cr))
+    {
+#if GMX_MPI
+        MPI_Bcast(&slot, 1, MPI_INT, MASTERRANK(cr), cr->mpi_comm_mygroup);
+#endif
+    }
+    if (slot >= 0)
+    {
+        apply_parameter_set(cr, re, MASTER(cr) ? re->repl : -1, slot, ir, upd, state, state_local,
+                            FALSE);
+    }
+}
+
 static void exchange_reals(const gmx_multisim_t gmx_unused* ms, int gmx_unused b, real* v, int n)
 {
     real* buf;
@@ -625,14 +837,6 @@ static void copy_state_serial(const t_state* src, t_state* dest)
     }
 }
 
-static void scale_velocities(gmx::ArrayRef<gmx::RVec> velocities, real fac)
-{
-    for (auto& v : velocities)
-    {
-        v *= fac;
-    }
-}
-
 static void print_transition_matrix(FILE* fplog, int n, int** nmoves, const int* nattempt)
 {
     int   i, j, ntot;
@@ -851,6 +1055,84 @@ static real calc_delta(FILE* fplog, gmx_bool bPrint, struct gmx_repl_ex* re, int
     return delta;
 }
 
+void replica_exchange_start_gathering(const gmx_multisim_t* ms,
+                                      gmx_repl_ex_t         re,
+                                      const gmx_enerdata_t* enerd,
+                                      real                  volume,
+                                      int64_t               step)
+{
+    const int n       = re->nrepl;
+    const int nGather = n * (n + 2);
+    real*     vol     = re->gatherBuffer;
+    real*     epot    = re->gatherBuffer + n;
+    real*     de      = re->gatherBuffer + 2 * n;
+
+    GMX_RELEASE_ASSERT(re->gatherStep < 0, "Only one energy gathering can be in flight");
+
+    for (int i = 0; i < nGather; i++)
+    {
+        re->gatherBuffer[i] = 0;
+    }
+    /* All data is stored at the index of the parameter set this replica holds */
+    if (re->bNPT)
+    {
+        vol[re->slot] = volume;
+    }
+    if (re->type == ereTEMP || re->type == ereTL)
+    {
+        epot[re->slot] = enerd->term[F_EPOT];
+    }
+    if (re->type == ereLAMBDA || re->type == ereTL)
+    {
+        /* de[i][j] is the energy of the jth simulation in the ith Hamiltonian
+           minus the energy of the jth simulation in the jth Hamiltonian */
+        for (int i = 0; i < n; i++)
+        {
+            const int lambdaIndex = static_cast<int>(re->q[ereLAMBDA][i]) + 1;
+            de[i * n + re->slot] =
+                    enerd->enerpart_lambda[lambdaIndex] - enerd->enerpart_lambda[0];
+        }
+    }
+
+    re->gatherStep = step;
+
+    /* Communicate all quantities at once */
+    const double startTime = gmx_gettime();
+#if GMX_LIB_MPI && MPI_IN_PLACE_EXISTS && MPI_VERSION >= 3
+    MPI_Iallreduce(MPI_IN_PLACE, re->gatherBuffer, nGather, GMX_MPI_REAL, MPI_SUM,
+                   ms->mpi_comm_masters, &re->gatherRequest);
+#else
+    gmx_sum_sim(nGather, re->gatherBuffer, ms);
+#endif
+    re->gatherTime = gmx_gettime() - startTime;
+}
+
+//! Completes the gathering started by replica_exchange_start_gathering()
+static void finish_gathering(struct gmx_repl_ex* re)
+{
+    const int n = re->nrepl;
+
+    const double startTime = gmx_gettime();
+#if GMX_LIB_MPI && MPI_IN_PLACE_EXISTS && MPI_VERSION >= 3
+    MPI_Wait(&re->gatherRequest, MPI_STATUS_IGNORE);
+#endif
+    const double waitTime = re->gatherTime + gmx_gettime() - startTime;
+    re->waitTimeSum += waitTime;
+    re->waitTimeMax = std::max(re->waitTimeMax, waitTime);
+    re->numGathers++;
+    re->gatherStep = -1;
+
+    for (int i = 0; i < n; i++)
+    {
+        re->Vol[i]  = re->gatherBuffer[i];
+        re->Epot[i] = re->gatherBuffer[n + i];
+        for (int j = 0; j < n; j++)
+        {
+            re->de[i][j] = re->gatherBuffer[2 * n + i * n + j];
+        }
+    }
+}
+
 static void test_for_replica_exchange(FILE*                 fplog,
                                       const gmx_multisim_t* ms,
                                       struct gmx_repl_ex*   re,
@@ -859,15 +1141,12 @@ static void test_for_replica_exchange(FILE*                 fplog,
                                       int64_t               step,
                                       real                  time)
 {
-    int                                m, i, j, a, b, ap, bp, i0, i1, tmp;
+    int                                m, i, a, b, ap, bp, i0, i1, tmp;
     real                               delta = 0;
     gmx_bool                           bPrint, bMultiEx;
-    gmx_bool*                          bEx      = re->bEx;
-    real*                              prob     = re->prob;
-    int*                               pind     = re->destinations; /* permuted index */
-    gmx_bool                           bEpot    = FALSE;
-    gmx_bool                           bDLambda = FALSE;
-    gmx_bool                           bVol     = FALSE;
+    gmx_bool*                          bEx  = re->bEx;
+    real*                              prob = re->prob;
+    int*                               pind = re->destinations; /* permuted index */
     gmx::ThreeFry2x64<64>              rng(re->seed, gmx::RandomDomain::ReplicaExchange);
     gmx::UniformRealDistribution<real> uniformRealDist;
     gmx::UniformIntDistribution<int>   uniformNreplDist(0, re->nrepl - 1);
@@ -875,23 +1154,14 @@ static void test_for_replica_exchange(FILE*                 fplog,
     bMultiEx = (re->nex > 1); /* multiple exchanges at each state */
     fprintf(fplog, "Replica exchange at step %" PRId64 " time %.5f\n", step, time);
 
-    if (re->bNPT)
+    if (re->gatherStep != step)
     {
-        for (i = 0; i < re->nrepl; i++)
-        {
-            re->Vol[i] = 0;
-        }
-        bVol              = TRUE;
-        re->Vol[re->repl] = vol;
+        replica_exchange_start_gathering(ms, re, enerd, vol, step);
     }
-    if ((re->type == ereTEMP || re->type == ereTL))
+    finish_gathering(re);
+
+    if (re->type == ereTEMP || re->type == ereTL)
     {
-        for (i = 0; i < re->nrepl; i++)
-        {
-            re->Epot[i] = 0;
-        }
-        bEpot              = TRUE;
-        re->Epot[re->repl] = enerd->term[F_EPOT];
         /* temperatures of different states*/
         for (i = 0; i < re->nrepl; i++)
         {
@@ -905,43 +1175,6 @@ static void test_for_replica_exchange(FILE*                 fplog,
             re->beta[i] = 1.0 / (re->temp * BOLTZ); /* we have a single temperature */
         }
     }
-    if (re->type == ereLAMBDA || re->type == ereTL)
-    {
-        bDLambda = TRUE;
-        /* lambda differences. */
-        /* de[i][j] is the energy of the jth simulation in the ith Hamiltonian
-           minus the energy of the jth simulation in the jth Hamiltonian */
-        for (i = 0; i < re->nrepl; i++)
-        {
-            for (j = 0; j < re->nrepl; j++)
-            {
-                re->de[i][j] = 0;
-            }
-        }
-        for (i = 0; i < re->nrepl; i++)
-        {
-            re->de[i][re->repl] = (enerd->enerpart_lambda[static_cast<int>(re->q[ereLAMBDA][i]) + 1]
-                                   - enerd->enerpart_lambda[0]);
-        }
-    }
-
-    /* now actually do the communication */
-    if (bVol)
-    {
-        gmx_sum_sim(re->nrepl, re->Vol, ms);
-    }
-    if (bEpot)
-    {
-        gmx_sum_sim(re->nrepl, re->Epot, ms);
-    }
-    if (bDLambda)
-    {
-        for (i = 0; i < re->nrepl; i++)
-        {
-            gmx_sum_sim(re->nrepl, re->de[i], ms);
-        }
-    }
-
     /* make a duplicate set of indices for shuffling */
     for (i = 0; i < re->nrepl; i++)
     {
@@ -1035,7 +1268,7 @@ static void test_for_replica_exchange(FILE*                 fplog,
             a = re->ind[i - 1];
             b = re->ind[i];
 
-            bPrint = (re->repl == a || re->repl == b);
+            bPrint = (re->slot == a || re->slot == b);
             if (i % 2 == m)
             {
                 delta = calc_delta(fplog, bPrint, re, a, b, a, b);
@@ -1255,7 +1488,9 @@ gmx_bool replica_exchange(FILE*                 fplog,
                           const gmx_enerdata_t* enerd,
                           t_state*              state_local,
                           int64_t               step,
-                          real                  time)
+                          real                  time,
+                          t_inputrec*           ir,
+                          gmx::Update*          upd)
 {
     int j;
     int replica_id = 0;
@@ -1266,12 +1501,33 @@ gmx_bool replica_exchange(FILE*                 fplog,
     /* Where each replica ends up after the exchange attempt(s). */
     /* The order in which multiple exchanges will occur. */
     gmx_bool bThisReplicaExchanged = FALSE;
+    /* Whether we exchange the parameters, only set on the master rank */
+    gmx_bool bExchangeParameters = FALSE;
+    int      newSlot             = -1;
 
     if (MASTER(cr))
     {
-        replica_id = re->repl;
+        replica_id          = re->repl;
+        bExchangeParameters = re->bExchangeParameters;
         test_for_replica_exchange(fplog, ms, re, enerd, det(state_local->box), step, time);
-        prepare_to_do_exchange(re, replica_id, &maxswap, &bThisReplicaExchanged);
+        if (bExchangeParameters)
+        {
+            /* The configuration of parameter set destinations[i] moves to
+             * parameter set i, so instead we move our parameters.
+             */
+            for (int i = 0; i < re->nrepl; i++)
+            {
+                if (re->destinations[i] == re->slot)
+                {
+                    newSlot = i;
+                }
+            }
+            bThisReplicaExchanged = (newSlot != re->slot);
+        }
+        else
+        {
+            prepare_to_do_exchange(re, replica_id, &maxswap, &bThisReplicaExchanged);
+        }
     }
     /* Do intra-simulation broadcast so all processors belonging to
      * each simulation know whether they need to participate in
@@ -1280,12 +1536,28 @@ gmx_bool replica_exchange(FILE*                 fplog,
     if (DOMAINDECOMP(cr))
     {
 #if GMX_MPI
-        MPI_Bcast(&bThisReplicaExchanged, sizeof(gmx_bool), MPI_BYTE, MASTERRANK(cr), cr->mpi_comm_mygroup);
+        gmx_bool flags[2] = { bThisReplicaExchanged, bExchangeParameters };
+        MPI_Bcast(flags, sizeof(flags), MPI_BYTE, MASTERRANK(cr), cr->mpi_comm_mygroup);
+        bThisReplicaExchanged = flags[0];
+        bExchangeParameters   = flags[1];
 #endif
     }
 
-    if (bThisReplicaExchanged)
+    if (bThisReplicaExchanged && bExchangeParameters)
     {
+        /* The state stays in place, only the parameters change */
+        apply_parameter_set(cr, re, MASTER(cr) ? re->slot : -1, newSlot, ir, upd, state,
+                            state_local, TRUE);
+        if (MASTER(cr))
+        {
+            fprintf(fplog, "Repl  This replica now holds parameter set %d\n", newSlot);
+            re->slot = newSlot;
+        }
+    }
+    else if (bThisReplicaExchanged)
+    {
+        const double startTime = gmx_gettime();
+
         /* Exchange the states */
         /* Collect the global state on the master node */
         if (DOMAINDECOMP(cr))
@@ -1324,6 +1596,9 @@ gmx_bool replica_exchange(FILE*                 fplog,
                 scale_velocities(state->v, std::sqrt(re->q[ereTEMP][replica_id]
                                                      / re->q[ereTEMP][re->destinations[replica_id]]));
             }
+
+            re->exchangeTimeSum += gmx_gettime() - startTime;
+            re->numStateExchanges++;
         }
 
         /* With domain decomposition the global state is distributed later */
@@ -1386,6 +1661,20 @@ void print_replica_exchange_statistics(FILE* fplog, struct gmx_repl_ex* re)
     }
     /* print the transition matrix */
     print_transition_matrix(fplog, re->nrepl, re->nmoves, re->nattempt);
+
+    /* Time spent waiting for the slowest replica and moving states around */
+    if (re->numGathers > 0)
+    {
+        fprintf(fplog,
+                "Repl  time waiting for the energies of the other replicas: average %.3f ms, "
+                "maximum %.3f ms\n",
+                1000 * re->waitTimeSum / re->numGathers, 1000 * re->waitTimeMax);
+    }
+    if (re->numStateExchanges > 0)
+    {
+        fprintf(fplog, "Repl  average time for exchanging the state: %.3f ms\n",
+                1000 * re->exchangeTimeSum / re->numStateExchanges);
+    }
 }
 
 //! \endcond
@@ -58,6 +58,11 @@ struct t_commrec;
 struct t_inputrec;
 class t_state;
 
+namespace gmx
+{
+class Update;
+}
+
 /*! \libinternal
  * \brief The parameters for the replica exchange algorithm. */
 struct ReplicaExchangeParameters
@@ -68,19 +73,52 @@ struct ReplicaExchangeParameters
     int numExchanges = 0;
     //! The random seed, -1 means generate a seed.
     int randomSeed = -1;
+    //! Whether to exchange the lambda state and temperature instead of the coordinates.
+    bool exchangeParameters = false;
 };
 
 //! Abstract type for replica exchange
 typedef struct gmx_repl_ex* gmx_repl_ex_t;
 
 /*! \brief Setup function.
+ *
+ * When exchanging parameters, \p fepState, the lambda state read from
+ * the checkpoint, determines which parameter set this replica holds.
  *
  * Should only be called on the master ranks */
 gmx_repl_ex_t init_replica_exchange(FILE*                            fplog,
                                     const gmx_multisim_t*            ms,
                                     int                              numAtomsInSystem,
                                     const t_inputrec*                ir,
-                                    const ReplicaExchangeParameters& replExParams);
+                                    const ReplicaExchangeParameters& replExParams,
+                                    int                              fepState);
+
+/*! \brief Sets the temperature and lambda state of the parameter set this replica holds.
+ *
+ * Only does something when exchanging parameters, where a continued
+ * replica can hold a different parameter set than its run input file.
+ * Should be called on all ranks after init_replica_exchange(), \p re
+ * is only used on the master rank.
+ */
+void replica_exchange_setup_parameters(const t_commrec* cr,
+                                       gmx_repl_ex_t    re,
+                                       t_inputrec*      ir,
+                                       gmx::Update*     upd,
+                                       t_state*         state,
+                                       t_state*         state_local);
+
+/*! \brief Starts gathering the energies of all replicas for an exchange attempt.
+ *
+ * With an MPI library the gathering is non-blocking, so the master
+ * rank can continue, e.g. with writing output, until replica_exchange()
+ * is called for the same step. Calling this is optional.
+ *
+ * Should only be called on the master ranks */
+void replica_exchange_start_gathering(const gmx_multisim_t* ms,
+                                      gmx_repl_ex_t         re,
+                                      const gmx_enerdata_t* enerd,
+                                      real                  volume,
+                                      int64_t               step);
 
 /*! \brief Attempts replica exchange.
  *
@@ -90,7 +128,11 @@ gmx_repl_ex_t init_replica_exchange(FILE*                            fplog,
  * exchange is stored in state and still needs to be redistributed
  * over the ranks.
  *
- * \returns TRUE if the state has been exchanged.
+ * When exchanging parameters, the state stays in place. Instead the
+ * lambda state and the reference temperatures in \p ir are changed
+ * and the local velocities are scaled.
+ *
+ * \returns TRUE if the state or the parameters have been exchanged.
  */
 gmx_bool replica_exchange(FILE*                 fplog,
                           const t_commrec*      cr,
@@ -100,7 +142,9 @@ gmx_bool replica_exchange(FILE*                 fplog,
                           const gmx_enerdata_t* enerd,
                           t_state*              state_local,
                           int64_t               step,
-                          real                  time);
+                          real                  time,
+                          t_inputrec*           ir,
+                          gmx::Update*          upd);
 
 /*! \brief Prints replica exchange statistics to the log file.
  *
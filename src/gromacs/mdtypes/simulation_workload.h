@@ -91,6 +91,12 @@ public:
     bool useGpuFBufferOps = false;
     //! Whether PME forces are reduced with other contributions on the GPU this step
     bool useGpuPmeFReduction = false; // TODO: add this flag to the internal PME GPU data structures too
+    /*! \brief Whether the CPU halo exchange overlaps with local computation this step
+     *
+     * Coordinates are exchanged during the local nonbonded kernel
+     * and forces are exchanged during the long-range force computation.
+     */
+    bool useCpuHaloExchangeOverlap = false;
 };
 
 /*! \libinternal
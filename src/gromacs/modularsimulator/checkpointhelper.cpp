@@ -118,6 +118,18 @@ void CheckpointHelper::scheduleTask(Step step, Time time, const RegisterRunFunct
             [this, step, time]() { writeCheckpoint(step, time); }));
 }
 
+std::string CheckpointHelper::name() const
+{
+    return "Checkpointing";
+}
+
+SimulationDataAccess CheckpointHelper::dataAccess() const
+{
+    return { { SimulationData::Positions, SimulationData::Velocities, SimulationData::Box,
+               SimulationData::Energies },
+             {} };
+}
+
 void CheckpointHelper::writeCheckpoint(Step step, Time time)
 {
     localStateInstance_->flags = 0;
@@ -126,6 +126,10 @@ public:
      * @param registerRunFunction  Function allowing to register a run function
      */
     void scheduleTask(Step step, Time time, const RegisterRunFunctionPtr& registerRunFunction) override;
+    //! The name of the element, used to report the time spent in it
+    std::string name() const override;
+    //! The simulation data read and written by the run functions of the element
+    SimulationDataAccess dataAccess() const override;
 
     //! No element setup needed
     void elementSetup() override {}
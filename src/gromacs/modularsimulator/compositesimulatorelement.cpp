@@ -43,13 +43,17 @@
 
 #include "compositesimulatorelement.h"
 
+#include "elementtimings.h"
+
 namespace gmx
 {
 CompositeSimulatorElement::CompositeSimulatorElement(
         std::vector<compat::not_null<ISimulatorElement*>>    elementCallList,
-        std::vector<std::unique_ptr<gmx::ISimulatorElement>> elements) :
+        std::vector<std::unique_ptr<gmx::ISimulatorElement>> elements,
+        ElementTimings*                                      elementTimings) :
     elementCallList_(std::move(elementCallList)),
-    elementOwnershipList_(std::move(elements))
+    elementOwnershipList_(std::move(elements)),
+    elementTimings_(elementTimings)
 {
 }
 
@@ -57,8 +61,30 @@ void CompositeSimulatorElement::scheduleTask(Step step, Time time, const Registe
 {
     for (auto& element : elementCallList_)
     {
-        element->scheduleTask(step, time, registerRunFunction);
+        if (elementTimings_)
+        {
+            elementTimings_->scheduleTimedTask(element, step, time, registerRunFunction);
+        }
+        else
+        {
+            element->scheduleTask(step, time, registerRunFunction);
+        }
+    }
+}
+
+std::string CompositeSimulatorElement::name() const
+{
+    return "Composite element";
+}
+
+SimulationDataAccess CompositeSimulatorElement::dataAccess() const
+{
+    SimulationDataAccess access;
+    for (const auto& element : elementCallList_)
+    {
+        access |= element->dataAccess();
     }
+    return access;
 }
 
 void CompositeSimulatorElement::elementSetup()
@@ -49,6 +49,7 @@
 
 namespace gmx
 {
+class ElementTimings;
 
 /*! \libinternal
  * \ingroup module_modularsimulator
@@ -71,9 +72,14 @@ namespace gmx
 class CompositeSimulatorElement final : public ISimulatorElement
 {
 public:
-    //! Constructor
+    /*! \brief Constructor
+     *
+     * When \p elementTimings is not null, the elements are scheduled
+     * through it, so that the time spent in each of them is measured.
+     */
     explicit CompositeSimulatorElement(std::vector<compat::not_null<ISimulatorElement*>> elementCallList,
-                                       std::vector<std::unique_ptr<ISimulatorElement>> elements);
+                                       std::vector<std::unique_ptr<ISimulatorElement>> elements,
+                                       ElementTimings* elementTimings = nullptr);
 
     /*! \brief Register run function for step / time
      *
@@ -85,6 +91,10 @@ public:
      * @param registerRunFunction  Function allowing to register a run function
      */
     void scheduleTask(Step step, Time time, const RegisterRunFunctionPtr& registerRunFunction) override;
+    //! The name of the element, used to report the time spent in it
+    std::string name() const override;
+    //! The simulation data read and written by the run functions of the element
+    SimulationDataAccess dataAccess() const override;
 
     /*! \brief Element setup
      *
@@ -103,6 +113,8 @@ private:
     std::vector<compat::not_null<ISimulatorElement*>> elementCallList_;
     //! List of elements owned by composite element
     std::vector<std::unique_ptr<ISimulatorElement>> elementOwnershipList_;
+    //! Measures the time spent in the elements, can be null
+    ElementTimings* elementTimings_;
 };
 
 } // namespace gmx
@@ -276,6 +276,20 @@ void ComputeGlobalsElement<algorithm>::scheduleTask(Step step,
     }
 }
 
+template<ComputeGlobalsAlgorithm algorithm>
+std::string ComputeGlobalsElement<algorithm>::name() const
+{
+    return "Compute globals";
+}
+
+template<ComputeGlobalsAlgorithm algorithm>
+SimulationDataAccess ComputeGlobalsElement<algorithm>::dataAccess() const
+{
+    // Removing the center of mass motion changes velocities and positions
+    return { { SimulationData::Positions, SimulationData::Velocities, SimulationData::Box },
+             { SimulationData::Positions, SimulationData::Velocities, SimulationData::Energies } };
+}
+
 template<ComputeGlobalsAlgorithm algorithm>
 void ComputeGlobalsElement<algorithm>::compute(gmx::Step            step,
                                                unsigned int         flags,
@@ -299,8 +313,14 @@ void ComputeGlobalsElement<algorithm>::compute(gmx::Step            step,
                     energyElement_->constraintVirial(step), energyElement_->totalVirial(step),
                     energyElement_->pressure(step), constr_, signaller, lastbox,
                     &totalNumberOfBondedInteractions_, energyElement_->needToSumEkinhOld(), flags);
-    checkNumberOfBondedInteractions(mdlog_, cr_, totalNumberOfBondedInteractions_, top_global_,
-                                    localTopology_, x, box, &shouldCheckNumberOfBondedInteractions_);
+    // The total is only computed when requested, e.g. not for the
+    // initial COM motion removal, so only check it then
+    if (flags & CGLO_CHECK_NUMBER_OF_BONDED_INTERACTIONS)
+    {
+        checkNumberOfBondedInteractions(mdlog_, cr_, totalNumberOfBondedInteractions_, top_global_,
+                                        localTopology_, x, box,
+                                        &shouldCheckNumberOfBondedInteractions_);
+    }
     if (flags & CGLO_STOPCM && !isInit)
     {
         process_and_stopcm_grp(fplog_, &vcm_, *mdAtoms_->mdatoms(), x, v);
@@ -121,6 +121,27 @@ void ConstraintsElement<variable>::scheduleTask(Step step,
             }));
 }
 
+template<ConstraintVariable variable>
+std::string ConstraintsElement<variable>::name() const
+{
+    return variable == ConstraintVariable::Positions ? "Constraints (positions)"
+                                                     : "Constraints (velocities)";
+}
+
+template<ConstraintVariable variable>
+SimulationDataAccess ConstraintsElement<variable>::dataAccess() const
+{
+    if (variable == ConstraintVariable::Positions)
+    {
+        // Constraining positions also corrects the velocities
+        return { { SimulationData::Positions, SimulationData::Box },
+                 { SimulationData::Positions, SimulationData::Velocities,
+                   SimulationData::Energies } };
+    }
+    return { { SimulationData::Positions, SimulationData::Velocities, SimulationData::Box },
+             { SimulationData::Velocities, SimulationData::Energies } };
+}
+
 template<ConstraintVariable variable>
 void ConstraintsElement<variable>::apply(Step step, bool calculateVirial, bool writeLog, bool writeEnergy)
 {
@@ -0,0 +1,135 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Defines the timing of the elements of the modular simulator
+ *
+ * \ingroup module_modularsimulator
+ */
+
+#include "gmxpre.h"
+
+#include "elementtimings.h"
+
+#include <cinttypes>
+
+#include <memory>
+
+#include "gromacs/timing/walltime_accounting.h"
+
+namespace gmx
+{
+
+void ElementTimings::scheduleTimedTask(ISimulatorElement*            element,
+                                       Step                          step,
+                                       Time                          time,
+                                       const RegisterRunFunctionPtr& registerRunFunction)
+{
+    auto found = timingIndex_.find(element);
+    if (found == timingIndex_.end())
+    {
+        found = timingIndex_.emplace(element, timings_.size()).first;
+        timings_.push_back({ element->name(), element->dataAccess() });
+    }
+    const int index = found->second;
+
+    auto registerTimedRunFunction = std::make_unique<RegisterRunFunction>(
+            [this, index, &registerRunFunction](SimulatorRunFunctionPtr runFunction) {
+                if (registeringTimedFunction_)
+                {
+                    // Registered by an element scheduled from within this one, which times it
+                    (*registerRunFunction)(std::move(runFunction));
+                    return;
+                }
+                // std::function needs a target that can be copied
+                std::shared_ptr<SimulatorRunFunction> function(std::move(runFunction));
+                auto timedFunction =
+                        std::make_unique<SimulatorRunFunction>([this, index, function]() {
+                            const double start = gmx_gettime();
+                            (*function)();
+                            timings_[index].seconds += gmx_gettime() - start;
+                            timings_[index].numCalls++;
+                        });
+                registeringTimedFunction_ = true;
+                (*registerRunFunction)(std::move(timedFunction));
+                registeringTimedFunction_ = false;
+            });
+    element->scheduleTask(step, time, registerTimedRunFunction);
+}
+
+//! Returns the names of the data for which \p accessed is true
+static std::string dataNames(const EnumerationArray<SimulationData, bool>& accessed)
+{
+    std::string names;
+    for (auto data : keysOf(accessed))
+    {
+        if (accessed[data])
+        {
+            names += (names.empty() ? "" : " ");
+            names += c_simulationDataNames[data];
+        }
+    }
+    return names.empty() ? "-" : names;
+}
+
+void ElementTimings::print(FILE* fplog) const
+{
+    if (fplog == nullptr)
+    {
+        return;
+    }
+    fprintf(fplog, "\nTime spent in the elements of the modular simulator on this rank:\n\n");
+    fprintf(fplog, " %-32s %10s %12s  %-12s %-12s %s\n", "Element", "Calls", "Wall t (s)",
+            "Reads", "Writes", "Depends on previous");
+    const ElementTiming* previous = nullptr;
+    for (const ElementTiming& timing : timings_)
+    {
+        if (timing.numCalls == 0)
+        {
+            continue;
+        }
+        const char* dependsOnPrevious = "-";
+        if (previous != nullptr)
+        {
+            dependsOnPrevious = timing.dataAccess.dependsOn(previous->dataAccess) ? "yes" : "no";
+        }
+        fprintf(fplog, " %-32s %10" PRId64 " %12.3f  %-12s %-12s %s\n", timing.name.c_str(),
+                timing.numCalls, timing.seconds, dataNames(timing.dataAccess.reads).c_str(),
+                dataNames(timing.dataAccess.writes).c_str(), dependsOnPrevious);
+        previous = &timing;
+    }
+    fprintf(fplog, "\n");
+}
+
+} // namespace gmx
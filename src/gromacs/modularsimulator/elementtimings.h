@@ -0,0 +1,110 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief Declares the timing of the elements of the modular simulator
+ *
+ * \ingroup module_modularsimulator
+ */
+#ifndef GROMACS_MODULARSIMULATOR_ELEMENTTIMINGS_H
+#define GROMACS_MODULARSIMULATOR_ELEMENTTIMINGS_H
+
+#include <cstdio>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "modularsimulatorinterfaces.h"
+
+namespace gmx
+{
+
+/*! \libinternal
+ * \ingroup module_modularsimulator
+ * \brief Accumulates the time spent in the run functions of each element
+ *
+ * Elements are scheduled through this object, which wraps the run
+ * functions they register in a timer. Composite elements schedule the
+ * elements they contain through the same object, so that each element
+ * is reported on its own rather than as part of the composite.
+ */
+class ElementTimings
+{
+public:
+    /*! \brief Lets \p element register its run functions for the step, timing each of them
+     *
+     * @param element              The element to schedule
+     * @param step                 The step number
+     * @param time                 The time
+     * @param registerRunFunction  Function allowing to register a run function
+     */
+    void scheduleTimedTask(ISimulatorElement*            element,
+                           Step                          step,
+                           Time                          time,
+                           const RegisterRunFunctionPtr& registerRunFunction);
+
+    /*! \brief Writes the time spent in each element and its data accesses to \p fplog
+     *
+     * Elements that never ran are left out. Whether an element depends on
+     * the element listed before it shows where running elements
+     * concurrently would be possible.
+     */
+    void print(FILE* fplog) const;
+
+private:
+    //! The time spent in the run functions of an element
+    struct ElementTiming
+    {
+        //! The name of the element
+        std::string name;
+        //! The simulation data the element reads and writes
+        SimulationDataAccess dataAccess;
+        //! Wall time spent in the run functions in seconds
+        double seconds = 0;
+        //! Number of run functions that ran
+        int64_t numCalls = 0;
+    };
+
+    //! The timings, in the order the elements were first scheduled
+    std::vector<ElementTiming> timings_;
+    //! The index in timings_ of each element
+    std::unordered_map<const ISimulatorElement*, int> timingIndex_;
+    //! Whether a run function that is timed already is being registered
+    bool registeringTimedFunction_ = false;
+};
+
+} // namespace gmx
+
+#endif // GROMACS_MODULARSIMULATOR_ELEMENTTIMINGS_H
@@ -59,6 +59,7 @@
 #include "gromacs/mdtypes/observableshistory.h"
 #include "gromacs/mdtypes/pullhistory.h"
 #include "gromacs/mdtypes/state.h"
+#include "gromacs/timing/wallcycle.h"
 #include "gromacs/topology/topology.h"
 
 #include "freeenergyperturbationelement.h"
@@ -148,6 +149,16 @@ void EnergyElement::scheduleTask(Step step, Time time, const RegisterRunFunction
     }
 }
 
+std::string EnergyElement::name() const
+{
+    return "Energy output";
+}
+
+SimulationDataAccess EnergyElement::dataAccess() const
+{
+    return { { SimulationData::Box, SimulationData::Energies }, { SimulationData::Energies } };
+}
+
 void EnergyElement::elementTeardown()
 {
     if (inputrec_->nstcalcenergy > 0 && isMasterRank_)
@@ -259,6 +270,7 @@ void EnergyElement::doStep(Time time, bool isEnergyCalculationStep, bool isFreeE
 
 void EnergyElement::write(gmx_mdoutf* outf, Step step, Time time, bool writeTrajectory, bool writeLog)
 {
+    wallcycle_start(mdoutf_get_wcycle(outf), ewcTRAJ);
     if (writeLog)
     {
         energyOutput_->printHeader(fplog_, step, time);
@@ -271,6 +283,7 @@ void EnergyElement::write(gmx_mdoutf* outf, Step step, Time time, bool writeTraj
     Awh* awh = nullptr;
     energyOutput_->printStepToEnergyFile(mdoutf_get_fp_ene(outf), writeTrajectory, do_dr, do_or,
                                          writeLog ? fplog_ : nullptr, step, time, fcd_, awh);
+    wallcycle_stop(mdoutf_get_wcycle(outf), ewcTRAJ);
 }
 
 void EnergyElement::addToForceVirial(const tensor virial, Step step)
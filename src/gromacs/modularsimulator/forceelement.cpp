@@ -120,6 +120,17 @@ void ForceElement::scheduleTask(Step step, Time time, const RegisterRunFunctionP
             [this, step, time, flags]() { run(step, time, flags); }));
 }
 
+std::string ForceElement::name() const
+{
+    return "Force";
+}
+
+SimulationDataAccess ForceElement::dataAccess() const
+{
+    return { { SimulationData::Positions, SimulationData::Box },
+             { SimulationData::Forces, SimulationData::Energies } };
+}
+
 void ForceElement::elementSetup()
 {
     GMX_ASSERT(localTopology_, "Setup called before local topology was set.");
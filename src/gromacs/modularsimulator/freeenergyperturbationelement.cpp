@@ -80,6 +80,17 @@ void FreeEnergyPerturbationElement::scheduleTask(Step step,
     }
 }
 
+std::string FreeEnergyPerturbationElement::name() const
+{
+    return "Free-energy lambdas";
+}
+
+SimulationDataAccess FreeEnergyPerturbationElement::dataAccess() const
+{
+    // Only the lambdas and the atom parameters depending on them change
+    return {};
+}
+
 void FreeEnergyPerturbationElement::updateLambdas(Step step)
 {
     // at beginning of step (if lambdas change...)
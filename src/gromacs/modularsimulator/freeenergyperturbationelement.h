@@ -80,6 +80,10 @@ public:
 
     //! Update lambda and mdatoms
     void scheduleTask(Step step, Time time, const RegisterRunFunctionPtr& registerRunFunction) override;
+    //! The name of the element, used to report the time spent in it
+    std::string name() const override;
+    //! The simulation data read and written by the run functions of the element
+    SimulationDataAccess dataAccess() const override;
 
     //! No setup needed
     void elementSetup() override{};
@@ -269,6 +269,8 @@ void ModularSimulator::simulatorTeardown()
     }
 
     walltime_accounting_set_nsteps_done(walltime_accounting, step_ - inputrec->init_step);
+
+    elementTimings_.print(fplog);
 }
 
 void ModularSimulator::populateTaskQueue()
@@ -312,7 +314,7 @@ void ModularSimulator::populateTaskQueue()
         // register elements for step
         for (auto& element : elementCallList_)
         {
-            element->scheduleTask(step_, time, registerRunFunction);
+            elementTimings_.scheduleTimedTask(element, step_, time, registerRunFunction);
         }
         // register post-step
         (*registerRunFunction)(
@@ -624,7 +626,8 @@ std::unique_ptr<ISimulatorElement> ModularSimulator::buildIntegrator(
                     inputrec->nsttcouple, -1, false, inputrec->ld_seed, inputrec->opts.ngtc,
                     inputrec->delta_t * inputrec->nsttcouple, inputrec->opts.ref_t, inputrec->opts.tau_t,
                     inputrec->opts.nrdf, energyElementPtr, propagator->viewOnVelocityScaling(),
-                    propagator->velocityScalingCallback(), state_global, cr, inputrec->bContinuation);
+                    propagator->velocityScalingCallback(), state_global, cr,
+                    inputrec->bContinuation, wcycle);
             checkpointClients->emplace_back(thermostat.get());
             energyElementPtr->setVRescaleThermostat(thermostat.get());
             addToCallListAndMove(std::move(thermostat), elementCallList, elementsOwnershipList);
@@ -639,7 +642,7 @@ std::unique_ptr<ISimulatorElement> ModularSimulator::buildIntegrator(
                     inputrec->nstpcouple, -1, inputrec->delta_t * inputrec->nstpcouple,
                     inputrec->init_step, propagator->viewOnPRScalingMatrix(),
                     propagator->prScalingCallback(), statePropagatorDataPtr, energyElementPtr,
-                    fplog, inputrec, mdAtoms, state_global, cr, inputrec->bContinuation);
+                    fplog, inputrec, mdAtoms, state_global, cr, inputrec->bContinuation, wcycle);
             energyElementPtr->setParrinelloRahamnBarostat(prBarostat.get());
             checkpointClients->emplace_back(prBarostat.get());
         }
@@ -696,7 +699,7 @@ std::unique_ptr<ISimulatorElement> ModularSimulator::buildIntegrator(
                     inputrec->nstpcouple, -1, inputrec->delta_t * inputrec->nstpcouple,
                     inputrec->init_step, propagatorVelocities->viewOnPRScalingMatrix(),
                     propagatorVelocities->prScalingCallback(), statePropagatorDataPtr, energyElementPtr,
-                    fplog, inputrec, mdAtoms, state_global, cr, inputrec->bContinuation);
+                    fplog, inputrec, mdAtoms, state_global, cr, inputrec->bContinuation, wcycle);
             energyElementPtr->setParrinelloRahamnBarostat(prBarostat.get());
             checkpointClients->emplace_back(prBarostat.get());
         }
@@ -727,7 +730,7 @@ std::unique_ptr<ISimulatorElement> ModularSimulator::buildIntegrator(
                     inputrec->opts.tau_t, inputrec->opts.nrdf, energyElementPtr,
                     propagatorVelocitiesAndPositions->viewOnVelocityScaling(),
                     propagatorVelocitiesAndPositions->velocityScalingCallback(), state_global, cr,
-                    inputrec->bContinuation);
+                    inputrec->bContinuation, wcycle);
             checkpointClients->emplace_back(thermostat.get());
             energyElementPtr->setVRescaleThermostat(thermostat.get());
             addToCallListAndMove(std::move(thermostat), elementCallList, elementsOwnershipList);
@@ -759,8 +762,8 @@ std::unique_ptr<ISimulatorElement> ModularSimulator::buildIntegrator(
         gmx_fatal(FARGS, "Integrator not implemented for the modular simulator.");
     }
 
-    auto integrator = std::make_unique<CompositeSimulatorElement>(std::move(elementCallList),
-                                                                  std::move(elementsOwnershipList));
+    auto integrator = std::make_unique<CompositeSimulatorElement>(
+            std::move(elementCallList), std::move(elementsOwnershipList), &elementTimings_);
     // std::move *should* not be needed with c++-14, but clang-3.6 still requires it
     return std::move(integrator);
 }
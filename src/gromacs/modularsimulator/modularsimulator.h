@@ -44,6 +44,7 @@
 #ifndef GROMACS_MODULARSIMULATOR_MODULARSIMULATOR_H
 #define GROMACS_MODULARSIMULATOR_MODULARSIMULATOR_H
 
+#include <limits>
 #include <queue>
 
 #include "gromacs/mdlib/md_support.h"
@@ -52,6 +53,7 @@
 
 #include "checkpointhelper.h"
 #include "domdechelper.h"
+#include "elementtimings.h"
 #include "modularsimulatorinterfaces.h"
 #include "pmeloadbalancehelper.h"
 #include "topologyholder.h"
@@ -218,6 +220,8 @@ private:
     std::vector<std::unique_ptr<ISimulatorElement>> elementsOwnershipList_;
     //! List of schedulerElements (calling sequence)
     std::vector<compat::not_null<ISimulatorElement*>> elementCallList_;
+    //! The time spent in each element
+    ElementTimings elementTimings_;
 
     //! \cond
     //! Helper function to add elements or signallers to the call list via raw pointer
@@ -55,9 +55,12 @@
 #define GMX_MODULARSIMULATOR_MODULARSIMULATORINTERFACES_H
 
 #include <functional>
+#include <initializer_list>
 #include <memory>
+#include <string>
 
 #include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/enumerationhelpers.h"
 
 struct gmx_localtop_t;
 struct gmx_mdoutf;
@@ -91,6 +94,78 @@ typedef std::function<void(SimulatorRunFunctionPtr)> RegisterRunFunction;
 //! Pointer to the function type that allows to register run functions
 typedef std::unique_ptr<RegisterRunFunction> RegisterRunFunctionPtr;
 
+//! The data of the simulation state that run functions of elements access
+enum class SimulationData : int
+{
+    Positions,
+    Velocities,
+    Forces,
+    Box,
+    Energies,
+    Count
+};
+
+//! Short names of the simulation data, used when reporting the accesses of elements
+static const EnumerationArray<SimulationData, const char*> c_simulationDataNames = {
+    { "x", "v", "f", "box", "E" }
+};
+
+/*! \libinternal
+ * \brief The simulation data that the run functions of an element read and write
+ *
+ * Two elements depend on each other if one of them writes data that
+ * the other reads or writes. Elements that do not depend on each other
+ * could run in any order, or concurrently.
+ */
+struct SimulationDataAccess
+{
+    //! Declares no accesses
+    SimulationDataAccess() = default;
+    //! Declares that \p readData is read and \p writtenData is written
+    SimulationDataAccess(std::initializer_list<SimulationData> readData,
+                         std::initializer_list<SimulationData> writtenData)
+    {
+        for (SimulationData data : readData)
+        {
+            reads[data] = true;
+        }
+        for (SimulationData data : writtenData)
+        {
+            writes[data] = true;
+        }
+    }
+
+    //! Adds the accesses of \p other, as for an element containing both
+    SimulationDataAccess& operator|=(const SimulationDataAccess& other)
+    {
+        for (auto data : keysOf(reads))
+        {
+            reads[data]  = reads[data] || other.reads[data];
+            writes[data] = writes[data] || other.writes[data];
+        }
+        return *this;
+    }
+
+    //! Whether the result can depend on the order of this element and one accessing \p other
+    bool dependsOn(const SimulationDataAccess& other) const
+    {
+        for (auto data : keysOf(reads))
+        {
+            if ((writes[data] && (other.reads[data] || other.writes[data]))
+                || (reads[data] && other.writes[data]))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //! Whether each data is read
+    EnumerationArray<SimulationData, bool> reads = { {} };
+    //! Whether each data is written
+    EnumerationArray<SimulationData, bool> writes = { {} };
+};
+
 /*! \libinternal
  * \brief The general interface for elements of the modular simulator
  *
@@ -112,6 +187,14 @@ public:
      * the registration pointer.
      */
     virtual void scheduleTask(Step, Time, const RegisterRunFunctionPtr&) = 0;
+    //! The name of the element, used to report the time spent in it
+    virtual std::string name() const = 0;
+    /*! \brief The simulation data read and written by the run functions of the element
+     *
+     * Reading data the element owns itself, such as the coupling variables
+     * of a thermostat, is not declared.
+     */
+    virtual SimulationDataAccess dataAccess() const = 0;
     //! Method guaranteed to be called after construction, before simulator run
     virtual void elementSetup() = 0;
     //! Method guaranteed to be called after simulator run, before deconstruction
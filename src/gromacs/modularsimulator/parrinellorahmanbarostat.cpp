@@ -53,6 +53,7 @@
 #include "gromacs/mdtypes/mdatom.h"
 #include "gromacs/mdtypes/state.h"
 #include "gromacs/pbcutil/boxutilities.h"
+#include "gromacs/timing/wallcycle.h"
 
 #include "energyelement.h"
 #include "statepropagatordata.h"
@@ -73,7 +74,8 @@ ParrinelloRahmanBarostat::ParrinelloRahmanBarostat(int                   nstpcou
                                                    const MDAtoms*        mdAtoms,
                                                    const t_state*        globalState,
                                                    t_commrec*            cr,
-                                                   bool                  isRestart) :
+                                                   bool                  isRestart,
+                                                   gmx_wallcycle*        wcycle) :
     nstpcouple_(nstpcouple),
     offset_(offset),
     couplingTimeStep_(couplingTimeStep),
@@ -84,7 +86,8 @@ ParrinelloRahmanBarostat::ParrinelloRahmanBarostat(int                   nstpcou
     energyElement_(energyElement),
     fplog_(fplog),
     inputrec_(inputrec),
-    mdAtoms_(mdAtoms)
+    mdAtoms_(mdAtoms),
+    wcycle_(wcycle)
 {
     clear_mat(mu_);
     clear_mat(boxRel_);
@@ -128,17 +131,34 @@ void ParrinelloRahmanBarostat::scheduleTask(gmx::Step step,
     }
 }
 
+std::string ParrinelloRahmanBarostat::name() const
+{
+    return "Parrinello-Rahman barostat";
+}
+
+SimulationDataAccess ParrinelloRahmanBarostat::dataAccess() const
+{
+    // The propagator scales the velocities by the matrix computed here
+    return { { SimulationData::Positions, SimulationData::Box, SimulationData::Energies },
+             { SimulationData::Positions, SimulationData::Velocities, SimulationData::Box,
+               SimulationData::Energies } };
+}
+
 void ParrinelloRahmanBarostat::integrateBoxVelocityEquations(Step step)
 {
     auto box = statePropagatorData_->constBox();
+    wallcycle_start(wcycle_, ewcUPDATE);
     parrinellorahman_pcoupl(fplog_, step, inputrec_, couplingTimeStep_, energyElement_->pressure(step),
                             box, boxRel_, boxVelocity_, scalingTensor_.data(), mu_, false);
     // multiply matrix by the coupling time step to avoid having the propagator needing to know about that
     msmul(scalingTensor_.data(), couplingTimeStep_, scalingTensor_.data());
+    wallcycle_stop(wcycle_, ewcUPDATE);
 }
 
 void ParrinelloRahmanBarostat::scaleBoxAndPositions()
 {
+    wallcycle_start(wcycle_, ewcUPDATE);
+
     // Propagate the box by the box velocities
     auto box = statePropagatorData_->box();
     for (int i = 0; i < DIM; i++)
@@ -158,6 +178,8 @@ void ParrinelloRahmanBarostat::scaleBoxAndPositions()
     {
         tmvmul_ur0(mu_, x[n], x[n]);
     }
+
+    wallcycle_stop(wcycle_, ewcUPDATE);
 }
 
 void ParrinelloRahmanBarostat::elementSetup()
@@ -47,6 +47,7 @@
 #include "modularsimulatorinterfaces.h"
 #include "propagator.h"
 
+struct gmx_wallcycle;
 struct t_inputrec;
 struct t_commrec;
 
@@ -83,7 +84,8 @@ public:
                              const MDAtoms*        mdAtoms,
                              const t_state*        globalState,
                              t_commrec*            cr,
-                             bool                  isRestart);
+                             bool                  isRestart,
+                             gmx_wallcycle*        wcycle);
 
     /*! \brief Register run function for step / time
      *
@@ -92,6 +94,10 @@ public:
      * @param registerRunFunction  Function allowing to register a run function
      */
     void scheduleTask(Step step, Time time, const RegisterRunFunctionPtr& registerRunFunction) override;
+    //! The name of the element, used to report the time spent in it
+    std::string name() const override;
+    //! The simulation data read and written by the run functions of the element
+    SimulationDataAccess dataAccess() const override;
 
     //! Fix relative box shape
     void elementSetup() override;
@@ -143,6 +149,8 @@ private:
     const t_inputrec* inputrec_;
     //! Atom parameters for this domain.
     const MDAtoms* mdAtoms_;
+    //! Wall-clock cycle counter, P-coupling is accounted as update.
+    gmx_wallcycle* wcycle_;
 };
 
 } // namespace gmx
@@ -511,6 +511,36 @@ void Propagator<algorithm>::scheduleTask(Step gmx_unused step,
     }
 }
 
+template<IntegrationStep algorithm>
+std::string Propagator<algorithm>::name() const
+{
+    switch (algorithm)
+    {
+        case IntegrationStep::PositionsOnly: return "Propagator (positions)";
+        case IntegrationStep::VelocitiesOnly: return "Propagator (velocities)";
+        case IntegrationStep::LeapFrog: return "Propagator (leap-frog)";
+        default: return "Propagator (velocity Verlet)";
+    }
+}
+
+template<IntegrationStep algorithm>
+SimulationDataAccess Propagator<algorithm>::dataAccess() const
+{
+    switch (algorithm)
+    {
+        case IntegrationStep::PositionsOnly:
+            return { { SimulationData::Positions, SimulationData::Velocities },
+                     { SimulationData::Positions } };
+        case IntegrationStep::VelocitiesOnly:
+            return { { SimulationData::Velocities, SimulationData::Forces },
+                     { SimulationData::Velocities } };
+        default:
+            return { { SimulationData::Positions, SimulationData::Velocities,
+                       SimulationData::Forces },
+                     { SimulationData::Positions, SimulationData::Velocities } };
+    }
+}
+
 template<IntegrationStep algorithm>
 void Propagator<algorithm>::setNumVelocityScalingVariables(int numVelocityScalingVariables)
 {
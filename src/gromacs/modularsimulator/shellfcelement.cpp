@@ -153,6 +153,17 @@ void ShellFCElement::scheduleTask(Step step, Time time, const RegisterRunFunctio
     nSteps_++;
 }
 
+std::string ShellFCElement::name() const
+{
+    return "Shells and flexible constraints";
+}
+
+SimulationDataAccess ShellFCElement::dataAccess() const
+{
+    return { { SimulationData::Positions, SimulationData::Velocities, SimulationData::Box },
+             { SimulationData::Positions, SimulationData::Forces, SimulationData::Energies } };
+}
+
 void ShellFCElement::elementSetup()
 {
     GMX_ASSERT(localTopology_, "Setup called before local topology was set.");
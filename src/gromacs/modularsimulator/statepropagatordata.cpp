@@ -321,6 +321,18 @@ void StatePropagatorData::scheduleTask(Step step, Time gmx_unused time, const Re
     }
 }
 
+std::string StatePropagatorData::name() const
+{
+    return "State";
+}
+
+SimulationDataAccess StatePropagatorData::dataAccess() const
+{
+    // The velocities are only written when they are reset for velocity Verlet
+    return { { SimulationData::Positions, SimulationData::Velocities, SimulationData::Box },
+             { SimulationData::Velocities } };
+}
+
 void StatePropagatorData::saveState()
 {
     GMX_ASSERT(!localStateBackup_, "Save state called again before previous state was written.");
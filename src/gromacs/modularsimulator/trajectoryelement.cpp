@@ -160,6 +160,18 @@ void TrajectoryElement::scheduleTask(Step step, Time time, const RegisterRunFunc
     }
 }
 
+std::string TrajectoryElement::name() const
+{
+    return "Trajectory writing";
+}
+
+SimulationDataAccess TrajectoryElement::dataAccess() const
+{
+    return { { SimulationData::Positions, SimulationData::Velocities, SimulationData::Forces,
+               SimulationData::Box, SimulationData::Energies },
+             {} };
+}
+
 void TrajectoryElement::elementTeardown()
 {
     for (auto& client : writerClients_)
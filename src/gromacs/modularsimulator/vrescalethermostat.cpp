@@ -51,6 +51,7 @@
 #include "gromacs/mdtypes/commrec.h"
 #include "gromacs/mdtypes/group.h"
 #include "gromacs/mdtypes/state.h"
+#include "gromacs/timing/wallcycle.h"
 #include "gromacs/utility/fatalerror.h"
 
 namespace gmx
@@ -70,7 +71,8 @@ VRescaleThermostat::VRescaleThermostat(int                   nstcouple,
                                        PropagatorCallbackPtr propagatorCallback,
                                        const t_state*        globalState,
                                        t_commrec*            cr,
-                                       bool                  isRestart) :
+                                       bool                  isRestart,
+                                       gmx_wallcycle*        wcycle) :
     nstcouple_(nstcouple),
     offset_(offset),
     useFullStepKE_(useFullStepKE),
@@ -83,7 +85,8 @@ VRescaleThermostat::VRescaleThermostat(int                   nstcouple,
     thermostatIntegral_(numTemperatureGroups, 0.0),
     energyElement_(energyElement),
     lambda_(lambdaView),
-    propagatorCallback_(std::move(propagatorCallback))
+    propagatorCallback_(std::move(propagatorCallback)),
+    wcycle_(wcycle)
 {
     // TODO: This is only needed to restore the thermostatIntegral_ from cpt. Remove this when
     //       switching to purely client-based checkpointing.
@@ -124,10 +127,24 @@ void VRescaleThermostat::scheduleTask(Step step, Time gmx_unused time, const Reg
     }
 }
 
+std::string VRescaleThermostat::name() const
+{
+    return "V-rescale thermostat";
+}
+
+SimulationDataAccess VRescaleThermostat::dataAccess() const
+{
+    // The propagator scales the velocities by the factors computed here
+    return { { SimulationData::Energies },
+             { SimulationData::Velocities, SimulationData::Energies } };
+}
+
 void VRescaleThermostat::setLambda(Step step)
 {
     real currentKineticEnergy, referenceKineticEnergy, newKineticEnergy;
 
+    wallcycle_start(wcycle_, ewcUPDATE);
+
     auto ekind = energyElement_->ekindata();
 
     for (int i = 0; (i < numTemperatureGroups_); i++)
@@ -172,6 +189,8 @@ void VRescaleThermostat::setLambda(Step step)
             lambda_[i] = 1.0;
         }
     }
+
+    wallcycle_stop(wcycle_, ewcUPDATE);
 }
 
 void VRescaleThermostat::writeCheckpoint(t_state* localState, t_state gmx_unused* globalState)
@@ -48,6 +48,7 @@
 #include "modularsimulatorinterfaces.h"
 #include "propagator.h"
 
+struct gmx_wallcycle;
 struct t_commrec;
 
 namespace gmx
@@ -78,7 +79,8 @@ public:
                        PropagatorCallbackPtr propagatorCallback,
                        const t_state*        globalState,
                        t_commrec*            cr,
-                       bool                  isRestart);
+                       bool                  isRestart,
+                       gmx_wallcycle*        wcycle);
 
     /*! \brief Register run function for step / time
      *
@@ -87,6 +89,10 @@ public:
      * @param registerRunFunction  Function allowing to register a run function
      */
     void scheduleTask(Step step, Time time, const RegisterRunFunctionPtr& registerRunFunction) override;
+    //! The name of the element, used to report the time spent in it
+    std::string name() const override;
+    //! The simulation data read and written by the run functions of the element
+    SimulationDataAccess dataAccess() const override;
 
     //! No element setup needed
     void elementSetup() override {}
@@ -126,6 +132,8 @@ private:
     ArrayRef<real> lambda_;
     //! Callback to let propagator know that we updated lambda
     PropagatorCallbackPtr propagatorCallback_;
+    //! Wall-clock cycle counter, T-coupling is accounted as update.
+    gmx_wallcycle* wcycle_;
 
     //! Set new lambda value (at T-coupling steps)
     void setLambda(Step step);
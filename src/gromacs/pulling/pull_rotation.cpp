@@ -231,6 +231,8 @@ struct gmx_enfrotgrp
     rvec* slab_innersumvec;
     //! Holds atom positions and gaussian weights of atoms belonging to a slab
     gmx_slabdata* slab_data;
+    //! Whether the flexible potential is computed from the local atoms only at this step
+    gmx_bool bLocalFlex;
 
     /* For potential fits with varying angle: */
     //! Used for fit type 'potential'
@@ -273,6 +275,8 @@ struct gmx_enfrot
     gmx_bool restartWithAppending = false;
     //! Used to skip first output when appending to avoid duplicate entries in rotation outfiles
     gmx_bool bOut = false;
+    //! Whether flexible groups can avoid collecting all positions at steps without neighbor search
+    gmx_bool bLocalFlex = false;
     //! Stores working data per group
     std::vector<gmx_enfrotgrp> enfrotgrp;
     ~gmx_enfrot();
@@ -675,13 +679,13 @@ static double calc_beta_max(real min_gaussian, real slab_dist)
 }
 
 
-static inline real calc_beta(rvec curr_x, const gmx_enfrotgrp* erg, int n)
+static inline real calc_beta(const rvec curr_x, const gmx_enfrotgrp* erg, int n)
 {
     return iprod(curr_x, erg->vec) - erg->rotg->slab_dist * n;
 }
 
 
-static inline real gaussian_weight(rvec curr_x, const gmx_enfrotgrp* erg, int n)
+static inline real gaussian_weight(const rvec curr_x, const gmx_enfrotgrp* erg, int n)
 {
     const real norm = GAUSS_NORM;
     real       sigma;
@@ -721,23 +725,18 @@ static real get_slab_weight(int j, const gmx_enfrotgrp* erg, rvec xc[], const re
 }
 
 
-static void get_slab_centers(gmx_enfrotgrp* erg,  /* Enforced rotation group working data */
-                             rvec*          xc,   /* The rotation group positions; will
-                                                     typically be enfrotgrp->xc, but at first call
-                                                     it is enfrotgrp->xc_ref                      */
-                             real*    mc,         /* The masses of the rotation group atoms       */
-                             real     time,       /* Used for output only                         */
-                             FILE*    out_slabs,  /* For outputting center per slab information   */
-                             gmx_bool bOutStep,   /* Is this an output step?                      */
-                             gmx_bool bReference) /* If this routine is called from
-                                                     init_rot_group we need to store
-                                                     the reference slab centers                   */
+/* Divides the weighted position sums stored in erg->slab_center by the slab
+ * weights to obtain the slab centers, and outputs these on the master */
+static void finish_slab_centers(gmx_enfrotgrp* erg,
+                                real           time,       /* Used for output only */
+                                FILE*          out_slabs,  /* For outputting center per slab info */
+                                gmx_bool       bOutStep,   /* Is this an output step? */
+                                gmx_bool       bReference) /* Store the reference slab centers */
 {
     /* Loop over slabs */
     for (int j = erg->slab_first; j <= erg->slab_last; j++)
     {
-        int slabIndex                = j - erg->slab_first;
-        erg->slab_weights[slabIndex] = get_slab_weight(j, erg, xc, mc, &erg->slab_center[slabIndex]);
+        int slabIndex = j - erg->slab_first;
 
         /* We can do the calculations ONLY if there is weight in the slab! */
         if (erg->slab_weights[slabIndex] > WEIGHT_MIN)
@@ -774,6 +773,29 @@ static void get_slab_centers(gmx_enfrotgrp* erg,  /* Enforced rotation group wor
 }
 
 
+static void get_slab_centers(gmx_enfrotgrp* erg,  /* Enforced rotation group working data */
+                             rvec*          xc,   /* The rotation group positions; will
+                                                     typically be enfrotgrp->xc, but at first call
+                                                     it is enfrotgrp->xc_ref                      */
+                             real*    mc,         /* The masses of the rotation group atoms       */
+                             real     time,       /* Used for output only                         */
+                             FILE*    out_slabs,  /* For outputting center per slab information   */
+                             gmx_bool bOutStep,   /* Is this an output step?                      */
+                             gmx_bool bReference) /* If this routine is called from
+                                                     init_rot_group we need to store
+                                                     the reference slab centers                   */
+{
+    /* Loop over slabs */
+    for (int j = erg->slab_first; j <= erg->slab_last; j++)
+    {
+        int slabIndex                = j - erg->slab_first;
+        erg->slab_weights[slabIndex] = get_slab_weight(j, erg, xc, mc, &erg->slab_center[slabIndex]);
+    }
+
+    finish_slab_centers(erg, time, out_slabs, bOutStep, bReference);
+}
+
+
 static void calc_rotmat(const rvec vec,
                         real   degangle, /* Angle alpha of rotation at time t in degrees       */
                         matrix rotmat)   /* Rotation matrix                                    */
@@ -1790,34 +1812,84 @@ static int get_single_atom_gaussians(rvec curr_x, gmx_enfrotgrp* erg)
 }
 
 
-static void flex2_precalc_inner_sum(const gmx_enfrotgrp* erg)
+/* Adds the contribution of an atom at position xi, with reference position yi0
+ * and mass mi, to the inner sum of the flex2 potential for slab n */
+static inline void flex2_add_to_inner_sum(const gmx_enfrotgrp* erg,
+                                          int                  n,
+                                          const rvec           xi,
+                                          const rvec           yi0,
+                                          real                 mi,
+                                          rvec                 innersumvec)
 {
-    rvec xi;       /* positions in the i-sum                        */
     rvec xcn, ycn; /* the current and the reference slab centers    */
     real gaussian_xi;
-    rvec yi0;
     rvec rin; /* Helper variables                              */
     real fac, fac2;
-    rvec innersumvec;
     real OOpsii, OOpsiistar;
     real sin_rin; /* s_ii.r_ii */
     rvec s_in, tmpvec, tmpvec2;
-    real mi, wi; /* Mass-weighting of the positions                 */
-    real N_M;    /* N/M                                             */
+    real wi; /* Mass-weighting of the positions                 */
 
+    int slabIndex = n - erg->slab_first; /* slab index */
 
-    N_M = erg->rotg->nat * erg->invmass;
+    /* The current center of this slab is saved in xcn: */
+    copy_rvec(erg->slab_center[slabIndex], xcn);
+    /* ... and the reference center in ycn: */
+    copy_rvec(erg->slab_center_ref[slabIndex + erg->slab_buffer], ycn);
+
+    /* The i-weights */
+    gaussian_xi = gaussian_weight(xi, erg, n);
+    wi          = erg->rotg->nat * erg->invmass * mi;
+
+    /* Calculate rin */
+    rvec_sub(yi0, ycn, tmpvec2);      /* tmpvec2 = yi0 - ycn      */
+    mvmul(erg->rotmat, tmpvec2, rin); /* rin = Omega.(yi0 - ycn)  */
+
+    /* Calculate psi_i* and sin */
+    rvec_sub(xi, xcn, tmpvec2); /* tmpvec2 = xi - xcn       */
+
+    /* In rare cases, when an atom position coincides with a slab center
+     * (tmpvec2 == 0) we cannot compute the vector product for s_in.
+     * However, since the atom is located directly on the pivot, this
+     * slab's contribution to the force on that atom will be zero
+     * anyway. Therefore, we continue with the next atom. */
+    if (gmx_numzero(norm(tmpvec2))) /* 0 == norm(xi - xcn) */
+    {
+        return;
+    }
+
+    cprod(erg->vec, tmpvec2, tmpvec);            /* tmpvec = v x (xi - xcn)  */
+    OOpsiistar = norm2(tmpvec) + erg->rotg->eps; /* OOpsii* = 1/psii* = |v x (xi-xcn)|^2 + eps */
+    OOpsii     = norm(tmpvec);                   /* OOpsii = 1 / psii = |v x (xi - xcn)| */
+
+    /*                           *         v x (xi - xcn)          */
+    unitv(tmpvec, s_in); /*  sin = ----------------         */
+                         /*        |v x (xi - xcn)|         */
+
+    sin_rin = iprod(s_in, rin); /* sin_rin = sin . rin             */
+
+    /* Now the whole sum */
+    fac = OOpsii / OOpsiistar;
+    svmul(fac, rin, tmpvec);
+    fac2 = fac * fac * OOpsii;
+    svmul(fac2 * sin_rin, s_in, tmpvec2);
+    rvec_dec(tmpvec, tmpvec2);
+
+    svmul(wi * gaussian_xi * sin_rin, tmpvec, tmpvec2);
+
+    rvec_inc(innersumvec, tmpvec2);
+}
+
+
+static void flex2_precalc_inner_sum(const gmx_enfrotgrp* erg)
+{
+    rvec innersumvec;
 
     /* Loop over all slabs that contain something */
     for (int n = erg->slab_first; n <= erg->slab_last; n++)
     {
         int slabIndex = n - erg->slab_first; /* slab index */
 
-        /* The current center of this slab is saved in xcn: */
-        copy_rvec(erg->slab_center[slabIndex], xcn);
-        /* ... and the reference center in ycn: */
-        copy_rvec(erg->slab_center_ref[slabIndex + erg->slab_buffer], ycn);
-
         /*** D. Calculate the whole inner sum used for second and third sum */
         /* For slab n, we need to loop over all atoms i again. Since we sorted
          * the atoms with respect to the rotation vector, we know that it is sufficient
@@ -1826,84 +1898,84 @@ static void flex2_precalc_inner_sum(const gmx_enfrotgrp* erg)
         clear_rvec(innersumvec);
         for (int i = erg->firstatom[slabIndex]; i <= erg->lastatom[slabIndex]; i++)
         {
-            /* Coordinate xi of this atom */
-            copy_rvec(erg->xc[i], xi);
+            /* Need the sorted reference positions and masses here */
+            flex2_add_to_inner_sum(erg, n, erg->xc[i], erg->xc_ref_sorted[i], erg->mc_sorted[i],
+                                   innersumvec);
+        } /* now we have the inner sum, used both for sum2 and sum3 */
 
-            /* The i-weights */
-            gaussian_xi = gaussian_weight(xi, erg, n);
-            mi          = erg->mc_sorted[i]; /* need the sorted mass here */
-            wi          = N_M * mi;
+        /* Save it to be used in do_flex2_lowlevel */
+        copy_rvec(innersumvec, erg->slab_innersumvec[slabIndex]);
+    } /* END of loop over slabs */
+}
 
-            /* Calculate rin */
-            copy_rvec(erg->xc_ref_sorted[i], yi0); /* Reference position yi0   */
-            rvec_sub(yi0, ycn, tmpvec2);           /* tmpvec2 = yi0 - ycn      */
-            mvmul(erg->rotmat, tmpvec2, rin);      /* rin = Omega.(yi0 - ycn)  */
 
-            /* Calculate psi_i* and sin */
-            rvec_sub(xi, xcn, tmpvec2); /* tmpvec2 = xi - xcn       */
+/* Adds the contribution of an atom at position xi, with reference position yi0
+ * and mass mi, to the inner sum of the flex potential for slab n */
+static inline void flex_add_to_inner_sum(const gmx_enfrotgrp* erg,
+                                         int                  n,
+                                         const rvec           xi,
+                                         const rvec           yi0,
+                                         real                 mi,
+                                         rvec                 innersumvec)
+{
+    rvec xcn, ycn; /* the current and the reference slab centers    */
+    rvec qin, rin; /* q_i^n and r_i^n                               */
+    real bin;
+    rvec tmpvec;
+    real gaussian_xi; /* Gaussian weight gn(xi)                        */
+    real wi;          /* Mass-weighting of the positions               */
 
-            /* In rare cases, when an atom position coincides with a slab center
-             * (tmpvec2 == 0) we cannot compute the vector product for s_in.
-             * However, since the atom is located directly on the pivot, this
-             * slab's contribution to the force on that atom will be zero
-             * anyway. Therefore, we continue with the next atom. */
-            if (gmx_numzero(norm(tmpvec2))) /* 0 == norm(xi - xcn) */
-            {
-                continue;
-            }
+    int slabIndex = n - erg->slab_first; /* slab index */
 
-            cprod(erg->vec, tmpvec2, tmpvec);            /* tmpvec = v x (xi - xcn)  */
-            OOpsiistar = norm2(tmpvec) + erg->rotg->eps; /* OOpsii* = 1/psii* = |v x (xi-xcn)|^2 + eps */
-            OOpsii = norm(tmpvec);                       /* OOpsii = 1 / psii = |v x (xi - xcn)| */
+    /* The current center of this slab is saved in xcn: */
+    copy_rvec(erg->slab_center[slabIndex], xcn);
+    /* ... and the reference center in ycn: */
+    copy_rvec(erg->slab_center_ref[slabIndex + erg->slab_buffer], ycn);
 
-            /*                           *         v x (xi - xcn)          */
-            unitv(tmpvec, s_in); /*  sin = ----------------         */
-                                 /*        |v x (xi - xcn)|         */
+    /* The i-weights */
+    gaussian_xi = gaussian_weight(xi, erg, n);
+    wi          = erg->rotg->nat * erg->invmass * mi;
 
-            sin_rin = iprod(s_in, rin); /* sin_rin = sin . rin             */
+    /* Calculate rin and qin */
+    rvec_sub(yi0, ycn, tmpvec); /* tmpvec = yi0-ycn */
 
-            /* Now the whole sum */
-            fac = OOpsii / OOpsiistar;
-            svmul(fac, rin, tmpvec);
-            fac2 = fac * fac * OOpsii;
-            svmul(fac2 * sin_rin, s_in, tmpvec2);
-            rvec_dec(tmpvec, tmpvec2);
+    /* In rare cases, when an atom position coincides with a slab center
+     * (tmpvec == 0) we cannot compute the vector product for qin.
+     * However, since the atom is located directly on the pivot, this
+     * slab's contribution to the force on that atom will be zero
+     * anyway. Therefore, we continue with the next atom. */
+    if (gmx_numzero(norm(tmpvec))) /* 0 == norm(yi0 - ycn) */
+    {
+        return;
+    }
 
-            svmul(wi * gaussian_xi * sin_rin, tmpvec, tmpvec2);
+    mvmul(erg->rotmat, tmpvec, rin); /* rin = Omega.(yi0 - ycn)  */
+    cprod(erg->vec, rin, tmpvec);    /* tmpvec = v x Omega*(yi0-ycn) */
 
-            rvec_inc(innersumvec, tmpvec2);
-        } /* now we have the inner sum, used both for sum2 and sum3 */
+    /*                                *        v x Omega*(yi0-ycn)    */
+    unitv(tmpvec, qin); /* qin = ---------------------   */
+                        /*       |v x Omega*(yi0-ycn)|   */
 
-        /* Save it to be used in do_flex2_lowlevel */
-        copy_rvec(innersumvec, erg->slab_innersumvec[slabIndex]);
-    } /* END of loop over slabs */
+    /* Calculate bin */
+    rvec_sub(xi, xcn, tmpvec); /* tmpvec = xi-xcn          */
+    bin = iprod(qin, tmpvec);  /* bin  = qin*(xi-xcn)      */
+
+    svmul(wi * gaussian_xi * bin, qin, tmpvec);
+
+    /* Add this contribution to the inner sum: */
+    rvec_add(innersumvec, tmpvec, innersumvec);
 }
 
 
 static void flex_precalc_inner_sum(const gmx_enfrotgrp* erg)
 {
-    rvec xi;       /* position                                      */
-    rvec xcn, ycn; /* the current and the reference slab centers    */
-    rvec qin, rin; /* q_i^n and r_i^n                               */
-    real bin;
-    rvec tmpvec;
     rvec innersumvec; /* Inner part of sum_n2                          */
-    real gaussian_xi; /* Gaussian weight gn(xi)                        */
-    real mi, wi;      /* Mass-weighting of the positions               */
-    real N_M;         /* N/M                                           */
-
-    N_M = erg->rotg->nat * erg->invmass;
 
     /* Loop over all slabs that contain something */
     for (int n = erg->slab_first; n <= erg->slab_last; n++)
     {
         int slabIndex = n - erg->slab_first; /* slab index */
 
-        /* The current center of this slab is saved in xcn: */
-        copy_rvec(erg->slab_center[slabIndex], xcn);
-        /* ... and the reference center in ycn: */
-        copy_rvec(erg->slab_center_ref[slabIndex + erg->slab_buffer], ycn);
-
         /* For slab n, we need to loop over all atoms i again. Since we sorted
          * the atoms with respect to the rotation vector, we know that it is sufficient
          * to calculate from firstatom to lastatom only. All other contributions will
@@ -1911,42 +1983,9 @@ static void flex_precalc_inner_sum(const gmx_enfrotgrp* erg)
         clear_rvec(innersumvec);
         for (int i = erg->firstatom[slabIndex]; i <= erg->lastatom[slabIndex]; i++)
         {
-            /* Coordinate xi of this atom */
-            copy_rvec(erg->xc[i], xi);
-
-            /* The i-weights */
-            gaussian_xi = gaussian_weight(xi, erg, n);
-            mi          = erg->mc_sorted[i]; /* need the sorted mass here */
-            wi          = N_M * mi;
-
-            /* Calculate rin and qin */
-            rvec_sub(erg->xc_ref_sorted[i], ycn, tmpvec); /* tmpvec = yi0-ycn */
-
-            /* In rare cases, when an atom position coincides with a slab center
-             * (tmpvec == 0) we cannot compute the vector product for qin.
-             * However, since the atom is located directly on the pivot, this
-             * slab's contribution to the force on that atom will be zero
-             * anyway. Therefore, we continue with the next atom. */
-            if (gmx_numzero(norm(tmpvec))) /* 0 == norm(yi0 - ycn) */
-            {
-                continue;
-            }
-
-            mvmul(erg->rotmat, tmpvec, rin); /* rin = Omega.(yi0 - ycn)  */
-            cprod(erg->vec, rin, tmpvec);    /* tmpvec = v x Omega*(yi0-ycn) */
-
-            /*                                *        v x Omega*(yi0-ycn)    */
-            unitv(tmpvec, qin); /* qin = ---------------------   */
-                                /*       |v x Omega*(yi0-ycn)|   */
-
-            /* Calculate bin */
-            rvec_sub(xi, xcn, tmpvec); /* tmpvec = xi-xcn          */
-            bin = iprod(qin, tmpvec);  /* bin  = qin*(xi-xcn)      */
-
-            svmul(wi * gaussian_xi * bin, qin, tmpvec);
-
-            /* Add this contribution to the inner sum: */
-            rvec_add(innersumvec, tmpvec, innersumvec);
+            /* Need the sorted reference positions and masses here */
+            flex_add_to_inner_sum(erg, n, erg->xc[i], erg->xc_ref_sorted[i], erg->mc_sorted[i],
+                                  innersumvec);
         } /* now we have the inner sum vector S^n for this slab */
           /* Save it to be used in do_flex_lowlevel */
         copy_rvec(innersumvec, erg->slab_innersumvec[slabIndex]);
@@ -1991,10 +2030,6 @@ static real do_flex2_lowlevel(gmx_enfrotgrp* erg,
     real slab_sum3part, slab_sum4part;
     rvec slab_sum1vec, slab_sum2vec, slab_sum3vec, slab_sum4vec;
 
-    /* Pre-calculate the inner sums, so that we do not have to calculate
-     * them again for every atom */
-    flex2_precalc_inner_sum(erg);
-
     bCalcPotFit = (bOutstepRot || bOutstepSlab) && (erotgFitPOT == erg->rotg->eFittype);
 
     /********************************************************/
@@ -2238,10 +2273,6 @@ static real do_flex_lowlevel(gmx_enfrotgrp* erg,
     real     N_M;    /* N/M                                           */
     gmx_bool bCalcPotFit;
 
-    /* Pre-calculate the inner sums, so that we do not have to calculate
-     * them again for every atom */
-    flex_precalc_inner_sum(erg);
-
     bCalcPotFit = (bOutstepRot || bOutstepSlab) && (erotgFitPOT == erg->rotg->eFittype);
 
     /********************************************************/
@@ -2496,28 +2527,29 @@ static void get_firstlast_atom_per_slab(const gmx_enfrotgrp* erg)
  *
  */
 static inline int get_first_slab(const gmx_enfrotgrp* erg,
-                                 rvec firstatom) /* First atom after sorting along the rotation vector v */
+                                 real firstproj) /* Projection of the first atom on v */
 {
     /* Find the first slab for the first atom */
-    return static_cast<int>(ceil(
-            static_cast<double>((iprod(firstatom, erg->vec) - erg->max_beta) / erg->rotg->slab_dist)));
+    return static_cast<int>(
+            ceil(static_cast<double>((firstproj - erg->max_beta) / erg->rotg->slab_dist)));
 }
 
 
-static inline int get_last_slab(const gmx_enfrotgrp* erg, rvec lastatom) /* Last atom along v */
+static inline int get_last_slab(const gmx_enfrotgrp* erg,
+                                real lastproj) /* Projection of the last atom on v */
 {
     /* Find the last slab for the last atom */
-    return static_cast<int>(floor(
-            static_cast<double>((iprod(lastatom, erg->vec) + erg->max_beta) / erg->rotg->slab_dist)));
+    return static_cast<int>(
+            floor(static_cast<double>((lastproj + erg->max_beta) / erg->rotg->slab_dist)));
 }
 
 
 static void get_firstlast_slab_check(gmx_enfrotgrp* erg, /* The rotation group (data only accessible in this file) */
-                                     rvec firstatom, /* First atom after sorting along the rotation vector v */
-                                     rvec lastatom) /* Last atom along v */
+                                     real firstproj, /* Projection of the first atom on v */
+                                     real lastproj) /* Projection of the last atom on v */
 {
-    erg->slab_first = get_first_slab(erg, firstatom);
-    erg->slab_last  = get_last_slab(erg, lastatom);
+    erg->slab_first = get_first_slab(erg, firstproj);
+    erg->slab_last  = get_last_slab(erg, lastproj);
 
     /* Calculate the slab buffer size, which changes when slab_first changes */
     erg->slab_buffer = erg->slab_first - erg->slab_first_ref;
@@ -2554,20 +2586,37 @@ static void do_flexible(gmx_bool       bMaster,
     /* Define the sigma value */
     sigma = 0.7 * erg->rotg->slab_dist;
 
-    /* Sort the collective coordinates erg->xc along the rotation vector. This is
-     * an optimization for the inner loop. */
-    sort_collective_coordinates(erg, enfrot->data);
+    /* With local flexible rotation, the slab centers and inner sums have
+     * already been determined from the local atoms in prepare_flexible_local() */
+    if (!erg->bLocalFlex)
+    {
+        /* Sort the collective coordinates erg->xc along the rotation vector. This is
+         * an optimization for the inner loop. */
+        sort_collective_coordinates(erg, enfrot->data);
 
-    /* Determine the first relevant slab for the first atom and the last
-     * relevant slab for the last atom */
-    get_firstlast_slab_check(erg, erg->xc[0], erg->xc[erg->rotg->nat - 1]);
+        /* Determine the first relevant slab for the first atom and the last
+         * relevant slab for the last atom */
+        get_firstlast_slab_check(erg, iprod(erg->xc[0], erg->vec),
+                                 iprod(erg->xc[erg->rotg->nat - 1], erg->vec));
 
-    /* Determine for each slab depending on the min_gaussian cutoff criterium,
-     * a first and a last atom index inbetween stuff needs to be calculated */
-    get_firstlast_atom_per_slab(erg);
+        /* Determine for each slab depending on the min_gaussian cutoff criterium,
+         * a first and a last atom index inbetween stuff needs to be calculated */
+        get_firstlast_atom_per_slab(erg);
 
-    /* Determine the gaussian-weighted center of positions for all slabs */
-    get_slab_centers(erg, erg->xc, erg->mc_sorted, t, enfrot->out_slabs, bOutstepSlab, FALSE);
+        /* Determine the gaussian-weighted center of positions for all slabs */
+        get_slab_centers(erg, erg->xc, erg->mc_sorted, t, enfrot->out_slabs, bOutstepSlab, FALSE);
+
+        /* Pre-calculate the inner sums, so that we do not have to calculate
+         * them again for every atom */
+        if (erg->rotg->eType == erotgFLEX || erg->rotg->eType == erotgFLEXT)
+        {
+            flex_precalc_inner_sum(erg);
+        }
+        else
+        {
+            flex2_precalc_inner_sum(erg);
+        }
+    }
 
     /* Clear the torque per slab from last time step: */
     nslabs = erg->slab_last - erg->slab_first + 1;
@@ -2615,6 +2664,122 @@ static void do_flexible(gmx_bool       bMaster,
 }
 
 
+/* Determines the slab range, the slab centers and the inner sums of the
+ * flexible potentials from the local atoms of the rotation group only.
+ * This replaces collecting all positions of the group on every rank by
+ * a few reductions of small per-slab arrays. The local positions are put
+ * at the PBC image given by the shifts that make the group whole, which
+ * are determined at neighbor search steps, when the group is collected. */
+static void prepare_flexible_local(const t_commrec* cr,
+                                   gmx_enfrot*      enfrot,
+                                   gmx_enfrotgrp*   erg,
+                                   const rvec       x[],
+                                   const matrix     box,
+                                   real             t,
+                                   gmx_bool         bOutstepSlab)
+{
+    const t_rotgrp* rotg                         = erg->rotg;
+    const auto&     localRotationGroupIndex      = erg->atomSet->localIndex();
+    const auto&     collectiveRotationGroupIndex = erg->atomSet->collectiveIndex();
+    const int       numAtomsLocal                = erg->atomSet->numAtomsLocal();
+
+    for (int j = 0; j < numAtomsLocal; j++)
+    {
+        copy_rvec(x[localRotationGroupIndex[j]], erg->x_loc_pbc[j]);
+        shift_single_coord(box, erg->x_loc_pbc[j], erg->xc_shifts[collectiveRotationGroupIndex[j]]);
+    }
+
+    if (rotg->eType == erotgFLEXT || rotg->eType == erotgFLEX2T)
+    {
+        /* Subtract the center of the rotation group from the local positions */
+        rvec transvec;
+        get_center_comm(cr, erg->x_loc_pbc, erg->m_loc, numAtomsLocal, rotg->nat, erg->xc_center);
+        svmul(-1.0, erg->xc_center, transvec);
+        translate_x(erg->x_loc_pbc, numAtomsLocal, transvec);
+    }
+    else
+    {
+        /* Do NOT subtract the center of mass in the low level routines! */
+        clear_rvec(erg->xc_center);
+    }
+
+    /* Determine the first and last slab from the smallest and largest projection
+     * of the positions on the rotation vector. We store the negated minimum,
+     * so we can get both with a single max-reduction. */
+    double minmaxproj[2] = { -GMX_DOUBLE_MAX, -GMX_DOUBLE_MAX };
+    for (int j = 0; j < numAtomsLocal; j++)
+    {
+        real proj     = iprod(erg->x_loc_pbc[j], erg->vec);
+        minmaxproj[0] = std::max(minmaxproj[0], -static_cast<double>(proj));
+        minmaxproj[1] = std::max(minmaxproj[1], static_cast<double>(proj));
+    }
+#if GMX_MPI
+    double minmaxproj_loc[2] = { minmaxproj[0], minmaxproj[1] };
+    MPI_Allreduce(minmaxproj_loc, minmaxproj, 2, MPI_DOUBLE, MPI_MAX, cr->mpi_comm_mygroup);
+#endif
+    get_firstlast_slab_check(erg, -minmaxproj[0], minmaxproj[1]);
+
+    /* Sum the gaussian- and mass-weighted positions and the weights per slab */
+    const int           nslabs = erg->slab_last - erg->slab_first + 1;
+    std::vector<double> slabsums(4 * nslabs, 0.0);
+    for (int j = 0; j < numAtomsLocal; j++)
+    {
+        for (int n = erg->slab_first; n <= erg->slab_last; n++)
+        {
+            int  slabIndex = n - erg->slab_first;
+            real wgauss    = gaussian_weight(erg->x_loc_pbc[j], erg, n) * erg->m_loc[j];
+            for (int d = 0; d < DIM; d++)
+            {
+                slabsums[4 * slabIndex + d] += wgauss * erg->x_loc_pbc[j][d];
+            }
+            slabsums[4 * slabIndex + 3] += wgauss;
+        }
+    }
+    gmx_sumd(4 * nslabs, slabsums.data(), cr);
+    for (int slabIndex = 0; slabIndex < nslabs; slabIndex++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            erg->slab_center[slabIndex][d] = slabsums[4 * slabIndex + d];
+        }
+        erg->slab_weights[slabIndex] = slabsums[4 * slabIndex + 3];
+    }
+    finish_slab_centers(erg, t, enfrot->out_slabs, bOutstepSlab, FALSE);
+
+    /* Sum the inner sums over the local atoms. As with the sorted collective
+     * positions, only atoms with a Gaussian larger than min_gaussian contribute. */
+    const bool bFlex2 = (rotg->eType == erotgFLEX2 || rotg->eType == erotgFLEX2T);
+    for (int slabIndex = 0; slabIndex < nslabs; slabIndex++)
+    {
+        clear_rvec(erg->slab_innersumvec[slabIndex]);
+    }
+    for (int j = 0; j < numAtomsLocal; j++)
+    {
+        int iigrp = collectiveRotationGroupIndex[j];
+        for (int n = erg->slab_first; n <= erg->slab_last; n++)
+        {
+            real beta = calc_beta(erg->x_loc_pbc[j], erg, n);
+            if (beta < -erg->max_beta || beta > erg->max_beta)
+            {
+                continue;
+            }
+            int slabIndex = n - erg->slab_first;
+            if (bFlex2)
+            {
+                flex2_add_to_inner_sum(erg, n, erg->x_loc_pbc[j], rotg->x_ref[iigrp], erg->m_loc[j],
+                                       erg->slab_innersumvec[slabIndex]);
+            }
+            else
+            {
+                flex_add_to_inner_sum(erg, n, erg->x_loc_pbc[j], rotg->x_ref[iigrp], erg->m_loc[j],
+                                      erg->slab_innersumvec[slabIndex]);
+            }
+        }
+    }
+    gmx_sum(3 * nslabs, erg->slab_innersumvec[0], cr);
+}
+
+
 /* Calculate the angle between reference and actual rotation group atom,
  * both projected into a plane perpendicular to the rotation vector: */
 static void angle(const gmx_enfrotgrp* erg,
@@ -3307,8 +3472,8 @@ static void get_firstlast_slab_ref(gmx_enfrotgrp* erg, real mc[], int ref_firsti
 {
     rvec dummy;
 
-    int first = get_first_slab(erg, erg->rotg->x_ref[ref_firstindex]);
-    int last  = get_last_slab(erg, erg->rotg->x_ref[ref_lastindex]);
+    int first = get_first_slab(erg, iprod(erg->rotg->x_ref[ref_firstindex], erg->vec));
+    int last  = get_last_slab(erg, iprod(erg->rotg->x_ref[ref_lastindex], erg->vec));
 
     while (get_slab_weight(first, erg, erg->rotg->x_ref, mc, &dummy) > WEIGHT_MIN)
     {
@@ -3410,8 +3575,13 @@ static void init_rot_group(FILE*            fplog,
     else
     {
         snew(erg->xr_loc, erg->rotg->nat);
+    }
+    /* Flexible groups use local positions at steps without neighbor search */
+    if (!bColl || bFlex)
+    {
         snew(erg->x_loc_pbc, erg->rotg->nat);
     }
+    erg->bLocalFlex = FALSE;
 
     copy_rvec(erg->rotg->inputVec, erg->vec);
     snew(erg->f_rot_loc, erg->rotg->nat);
@@ -3444,7 +3614,7 @@ static void init_rot_group(FILE*            fplog,
     {
         snew(erg->mc_sorted, erg->rotg->nat);
     }
-    if (!bColl)
+    if (!bColl || bFlex)
     {
         snew(erg->m_loc, erg->rotg->nat);
     }
@@ -3713,6 +3883,18 @@ std::unique_ptr<gmx::EnforcedRotation> init_rot(FILE*                       fplo
         ++groupIndex;
     }
 
+    /* With DD, collecting the positions of large flexible groups every step
+     * is expensive. These are now only collected at neighbor search steps.
+     */
+    er->bLocalFlex = PAR(cr) && HaveFlexibleGroups(er->rot)
+                     && getenv("GMX_NO_LOCAL_FLEX_ROTATION") == nullptr;
+    if (er->bLocalFlex && nullptr != fplog)
+    {
+        fprintf(fplog,
+                "%s flexible groups are only collected at neighbor search and fit output steps\n",
+                RotStr);
+    }
+
     /* Allocate space for enforced rotation buffer variables */
     er->bufsize = nat_max;
     snew(er->data, nat_max);
@@ -3835,11 +4017,35 @@ void do_rotation(const t_commrec* cr, gmx_enfrot* er, const matrix box, rvec x[]
         /* Do we use a collective (global) set of coordinates? */
         bColl = ISCOLL(rotg);
 
+        /* Flexible groups only need to be collected when the shifts that keep
+         * the group whole can change, i.e. at neighbor search steps, and when
+         * the master fits the rotation angle of the whole group for output */
+        erg->bLocalFlex = er->bLocalFlex && ISFLEX(rotg) && !bNS
+                          && !((outstep_rot || outstep_slab) && erotgFitPOT != rotg->eFittype);
+
         /* Calculate the rotation matrix for this angle: */
         erg->degangle = rotg->rate * t;
         calc_rotmat(erg->vec, erg->degangle, erg->rotmat);
 
-        if (bColl)
+        /* Fill the local masses array;
+         * this array changes in DD/neighborsearching steps */
+        if (bNS && (!bColl || (er->bLocalFlex && ISFLEX(rotg))))
+        {
+            const auto& collectiveRotationGroupIndex = erg->atomSet->collectiveIndex();
+            for (gmx::index i = 0; i < collectiveRotationGroupIndex.ssize(); i++)
+            {
+                /* Index of local atom w.r.t. the collective rotation group */
+                int ii        = collectiveRotationGroupIndex[i];
+                erg->m_loc[i] = erg->mc[ii];
+            }
+        }
+
+        if (erg->bLocalFlex)
+        {
+            /* Get the slab centers and inner sums from the local positions */
+            prepare_flexible_local(cr, er, erg, x, box, t, outstep_slab);
+        }
+        else if (bColl)
         {
             /* Transfer the rotation group's positions such that every node has
              * all of them. Every node contributes its local positions x and stores
@@ -3851,19 +4057,6 @@ void do_rotation(const t_commrec* cr, gmx_enfrot* er, const matrix box, rvec x[]
         }
         else
         {
-            /* Fill the local masses array;
-             * this array changes in DD/neighborsearching steps */
-            if (bNS)
-            {
-                const auto& collectiveRotationGroupIndex = erg->atomSet->collectiveIndex();
-                for (gmx::index i = 0; i < collectiveRotationGroupIndex.ssize(); i++)
-                {
-                    /* Index of local atom w.r.t. the collective rotation group */
-                    int ii        = collectiveRotationGroupIndex[i];
-                    erg->m_loc[i] = erg->mc[ii];
-                }
-            }
-
             /* Calculate Omega*(y_i-y_c) for the local positions */
             rotate_local_reference(erg);
 
@@ -3936,9 +4129,12 @@ void do_rotation(const t_commrec* cr, gmx_enfrot* er, const matrix box, rvec x[]
                 /* Subtract the center of the rotation group from the collective positions array
                  * Also store the center in erg->xc_center since it needs to be subtracted
                  * in the low level routines from the local coordinates as well */
-                get_center(erg->xc, erg->mc, rotg->nat, erg->xc_center);
-                svmul(-1.0, erg->xc_center, transvec);
-                translate_x(erg->xc, rotg->nat, transvec);
+                if (!erg->bLocalFlex)
+                {
+                    get_center(erg->xc, erg->mc, rotg->nat, erg->xc_center);
+                    svmul(-1.0, erg->xc_center, transvec);
+                    translate_x(erg->xc, rotg->nat, transvec);
+                }
                 do_flexible(MASTER(cr), er, erg, x, box, t, outstep_rot, outstep_slab);
                 break;
             case erotgFLEX:
@@ -42,6 +42,8 @@
 #include <cassert>
 #include <cstdlib>
 
+#include <algorithm>
+
 #include "gromacs/fileio/confio.h"
 #include "gromacs/gmxlib/network.h"
 #include "gromacs/math/functions.h"
@@ -54,6 +56,7 @@
 #include "gromacs/mdtypes/state.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/pulling/pull.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
@@ -517,6 +520,103 @@ static void sum_com_part_cosweight(const pull_group_work_t* pgrp,
     sum_com->sum_smp = sum_smp;
 }
 
+/* Computes the local sums for the COM of non-cosine-weighted group \p g
+ * and stores them in \p comBuffer.
+ *
+ * With \p numThreads > 1 the atoms are divided over OpenMP threads,
+ * \p comSums should then have at least \p numThreads elements.
+ */
+static void sumComOfGroup(pull_t*                  pull,
+                          size_t                   g,
+                          const t_mdatoms*         md,
+                          const t_pbc*             pbc,
+                          const rvec               x[],
+                          const rvec*              xp,
+                          int                      numThreads,
+                          ComSums*                 comSums,
+                          gmx::ArrayRef<gmx::DVec> comBuffer)
+{
+    pull_group_work_t* pgrp = &pull->group[g];
+    pull_comm_t*       comm = &pull->comm;
+
+    rvec x_pbc = { 0, 0, 0 };
+
+    switch (pgrp->epgrppbc)
+    {
+        case epgrppbcREFAT:
+            /* Set the pbc atom */
+            copy_rvec(comm->pbcAtomBuffer[g], x_pbc);
+            break;
+        case epgrppbcPREVSTEPCOM:
+            /* Set the pbc reference to the COM of the group of the last step */
+            copy_dvec_to_rvec(pgrp->x_prev_step, comm->pbcAtomBuffer[g]);
+            copy_dvec_to_rvec(pgrp->x_prev_step, x_pbc);
+    }
+
+    /* The final sums should end up in comSums[0] */
+    ComSums& comSumsTotal = comSums[0];
+
+    /* If we have a single-atom group the mass is irrelevant, so
+     * we can remove the mass factor to avoid division by zero.
+     * Note that with constraint pulling the mass does matter, but
+     * in that case a check group mass != 0 has been done before.
+     */
+    if (pgrp->params.nat == 1 && pgrp->atomSet.numAtomsLocal() == 1
+        && md->massT[pgrp->atomSet.localIndex()[0]] == 0)
+    {
+        GMX_ASSERT(xp == nullptr,
+                   "We should not have groups with zero mass with constraints, i.e. "
+                   "xp!=NULL");
+
+        /* Copy the single atom coordinate */
+        for (int d = 0; d < DIM; d++)
+        {
+            comSumsTotal.sum_wmx[d] = x[pgrp->atomSet.localIndex()[0]][d];
+        }
+        /* Set all mass factors to 1 to get the correct COM */
+        comSumsTotal.sum_wm  = 1;
+        comSumsTotal.sum_wwm = 1;
+    }
+    else if (numThreads == 1)
+    {
+        sum_com_part(pgrp, 0, pgrp->atomSet.numAtomsLocal(), x, xp, md->massT, pbc, x_pbc,
+                     &comSumsTotal);
+    }
+    else
+    {
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+        for (int t = 0; t < numThreads; t++)
+        {
+            int ind_start = (pgrp->atomSet.numAtomsLocal() * (t + 0)) / numThreads;
+            int ind_end   = (pgrp->atomSet.numAtomsLocal() * (t + 1)) / numThreads;
+            sum_com_part(pgrp, ind_start, ind_end, x, xp, md->massT, pbc, x_pbc, &comSums[t]);
+        }
+
+        /* Reduce the thread contributions to sum_com[0] */
+        for (int t = 1; t < numThreads; t++)
+        {
+            comSumsTotal.sum_wm += comSums[t].sum_wm;
+            comSumsTotal.sum_wwm += comSums[t].sum_wwm;
+            dvec_inc(comSumsTotal.sum_wmx, comSums[t].sum_wmx);
+            dvec_inc(comSumsTotal.sum_wmxp, comSums[t].sum_wmxp);
+        }
+    }
+
+    if (pgrp->localWeights.empty())
+    {
+        comSumsTotal.sum_wwm = comSumsTotal.sum_wm;
+    }
+
+    /* Copy local sums to a buffer for global summing */
+    copy_dvec(comSumsTotal.sum_wmx, comBuffer[0]);
+
+    copy_dvec(comSumsTotal.sum_wmxp, comBuffer[1]);
+
+    comBuffer[2][0] = comSumsTotal.sum_wm;
+    comBuffer[2][1] = comSumsTotal.sum_wwm;
+    comBuffer[2][2] = 0;
+}
+
 /* calculates center of mass of selection index from all coordinates x */
 // Compiler segfault with 2019_update_5 and 2020_initial
 #if defined(__INTEL_COMPILER) \
@@ -574,6 +674,36 @@ void pull_calc_coms(const t_commrec* cr,
         twopi_box = 2.0 * M_PI / pbc->box[pull->cosdim][pull->cosdim];
     }
 
+    /* Returns whether the group is summed by a single thread */
+    auto isSmallGroup = [](const pull_group_work_t& group) {
+        return group.epgrppbc != epgrppbcCOS
+               && group.atomSet.numAtomsLocal() <= c_pullMaxNumLocalAtomsSingleThreaded;
+    };
+
+    /* With many pull groups, e.g. for umbrella sampling of many molecules,
+     * most groups have few local atoms. These are divided over the threads.
+     * The other groups are threaded over atoms in the serial loop below.
+     * We avoid the OpenMP overhead with only a few groups.
+     */
+    const int numGroups            = pull->group.size();
+    const int numThreadsOverGroups = std::max(1, std::min(pull->nthreads, numGroups / 4));
+#pragma omp parallel for num_threads(numThreadsOverGroups) schedule(static)
+    for (int g = 0; g < numGroups; g++)
+    {
+        try
+        {
+            const pull_group_work_t& group = pull->group[g];
+            if (group.needToCalcCom && isSmallGroup(group))
+            {
+                ComSums comSums = {};
+                sumComOfGroup(pull, g, md, pbc, x, xp, 1, &comSums,
+                              gmx::arrayRefFromArray(comm->comBuffer.data() + g * c_comBufferStride,
+                                                     c_comBufferStride));
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+
     for (size_t g = 0; g < pull->group.size(); g++)
     {
         pull_group_work_t* pgrp = &pull->group[g];
@@ -594,83 +724,12 @@ void pull_calc_coms(const t_commrec* cr,
         {
             if (pgrp->epgrppbc != epgrppbcCOS)
             {
-                rvec x_pbc = { 0, 0, 0 };
-
-                switch (pgrp->epgrppbc)
-                {
-                    case epgrppbcREFAT:
-                        /* Set the pbc atom */
-                        copy_rvec(comm->pbcAtomBuffer[g], x_pbc);
-                        break;
-                    case epgrppbcPREVSTEPCOM:
-                        /* Set the pbc reference to the COM of the group of the last step */
-                        copy_dvec_to_rvec(pgrp->x_prev_step, comm->pbcAtomBuffer[g]);
-                        copy_dvec_to_rvec(pgrp->x_prev_step, x_pbc);
-                }
-
-                /* The final sums should end up in comSums[0] */
-                ComSums& comSumsTotal = pull->comSums[0];
-
-                /* If we have a single-atom group the mass is irrelevant, so
-                 * we can remove the mass factor to avoid division by zero.
-                 * Note that with constraint pulling the mass does matter, but
-                 * in that case a check group mass != 0 has been done before.
-                 */
-                if (pgrp->params.nat == 1 && pgrp->atomSet.numAtomsLocal() == 1
-                    && md->massT[pgrp->atomSet.localIndex()[0]] == 0)
-                {
-                    GMX_ASSERT(xp == nullptr,
-                               "We should not have groups with zero mass with constraints, i.e. "
-                               "xp!=NULL");
-
-                    /* Copy the single atom coordinate */
-                    for (int d = 0; d < DIM; d++)
-                    {
-                        comSumsTotal.sum_wmx[d] = x[pgrp->atomSet.localIndex()[0]][d];
-                    }
-                    /* Set all mass factors to 1 to get the correct COM */
-                    comSumsTotal.sum_wm  = 1;
-                    comSumsTotal.sum_wwm = 1;
-                }
-                else if (pgrp->atomSet.numAtomsLocal() <= c_pullMaxNumLocalAtomsSingleThreaded)
+                /* Small groups have been summed above */
+                if (!isSmallGroup(*pgrp))
                 {
-                    sum_com_part(pgrp, 0, pgrp->atomSet.numAtomsLocal(), x, xp, md->massT, pbc,
-                                 x_pbc, &comSumsTotal);
+                    sumComOfGroup(pull, g, md, pbc, x, xp, pull->nthreads, pull->comSums.data(),
+                                  comBuffer);
                 }
-                else
-                {
-#pragma omp parallel for num_threads(pull->nthreads) schedule(static)
-                    for (int t = 0; t < pull->nthreads; t++)
-                    {
-                        int ind_start = (pgrp->atomSet.numAtomsLocal() * (t + 0)) / pull->nthreads;
-                        int ind_end   = (pgrp->atomSet.numAtomsLocal() * (t + 1)) / pull->nthreads;
-                        sum_com_part(pgrp, ind_start, ind_end, x, xp, md->massT, pbc, x_pbc,
-                                     &pull->comSums[t]);
-                    }
-
-                    /* Reduce the thread contributions to sum_com[0] */
-                    for (int t = 1; t < pull->nthreads; t++)
-                    {
-                        comSumsTotal.sum_wm += pull->comSums[t].sum_wm;
-                        comSumsTotal.sum_wwm += pull->comSums[t].sum_wwm;
-                        dvec_inc(comSumsTotal.sum_wmx, pull->comSums[t].sum_wmx);
-                        dvec_inc(comSumsTotal.sum_wmxp, pull->comSums[t].sum_wmxp);
-                    }
-                }
-
-                if (pgrp->localWeights.empty())
-                {
-                    comSumsTotal.sum_wwm = comSumsTotal.sum_wm;
-                }
-
-                /* Copy local sums to a buffer for global summing */
-                copy_dvec(comSumsTotal.sum_wmx, comBuffer[0]);
-
-                copy_dvec(comSumsTotal.sum_wmxp, comBuffer[1]);
-
-                comBuffer[2][0] = comSumsTotal.sum_wm;
-                comBuffer[2][1] = comSumsTotal.sum_wwm;
-                comBuffer[2][2] = 0;
             }
             else
             {
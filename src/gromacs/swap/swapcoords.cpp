@@ -48,8 +48,10 @@
 #include <cstdlib>
 #include <ctime>
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gromacs/domdec/domdec_struct.h"
@@ -144,7 +146,9 @@ std::unique_ptr<IMDModule> createSwapCoordinatesModule()
 typedef struct swap_compartment
 {
     int nMol;        /**< Number of ion or water molecules detected
-                          in this compartment.                          */
+                          in this compartment. For the solvent, only
+                          the molecules with their first atom on this
+                          rank are counted and listed.                  */
     int  nMolBefore; /**< Number of molecules before swapping.          */
     int  nMolReq;    /**< Requested number of molecules in compartment. */
     real nMolAv;     /**< Time-averaged number of molecules matching
@@ -1531,7 +1535,11 @@ t_swap* init_swapcoords(FILE*                       fplog,
     for (int i = 0; i < s->ngrp; i++)
     {
         g = &s->group[i];
-        snew(g->xc, g->atomset.numAtomsGlobal());
+        /* The solvent positions are never assembled, see sortLocalSolventIntoCompartments() */
+        if (i != eGrpSolvent)
+        {
+            snew(g->xc, g->atomset.numAtomsGlobal());
+        }
 
         /* For the split groups (the channels) we need some extra memory to
          * be able to make the molecules whole even if they span more than
@@ -1809,6 +1817,243 @@ void finish_swapcoords(t_swap* s)
     }
 }
 
+/*! \brief Determines which solvent molecules with their first atom on this rank are in
+ * compartment A and B.
+ *
+ * In contrast to sortMoleculesIntoCompartments(), this works on the local
+ * positions, so that the solvent positions never need to be assembled. The
+ * compartment lists contain the local molecules only; just the per-compartment
+ * counts are reduced, for output and the consistency checks.
+ */
+static void sortLocalSolventIntoCompartments(t_swapgrp*       g,
+                                             const t_commrec* cr,
+                                             t_swapcoords*    sc,
+                                             t_swap*          s,
+                                             const rvec       x[],
+                                             const matrix     box,
+                                             FILE*            fpout)
+{
+    const int sd = s->swapdim;
+
+    /* Molecule counts in A and B, and of molecules that are not in A and not in B */
+    int counts[2 * eCompNR] = { 0 };
+
+    for (int comp = eCompA; comp <= eCompB; comp++)
+    {
+        real left, right;
+
+        get_compartment_boundaries(comp, s, box, &left, &right);
+
+        g->comp[comp].nMol = 0;
+
+        auto collectiveIndex = g->atomset.collectiveIndex().begin();
+        for (const auto localIndex : g->atomset.localIndex())
+        {
+            const int iAtom = *collectiveIndex;
+            ++collectiveIndex;
+
+            /* Molecules are classified by their first atom, which is home on a single rank */
+            if (iAtom % g->apm != 0)
+            {
+                continue;
+            }
+
+            real dist;
+            if (compartment_contains_atom(left, right, x[localIndex][sd], box[sd][sd],
+                                          sc->bulkOffset[comp], &dist))
+            {
+                add_to_list(iAtom, &g->comp[comp], dist);
+                counts[comp]++;
+            }
+            else
+            {
+                counts[eCompNR + comp]++;
+            }
+        }
+    }
+
+    if (PAR(cr))
+    {
+        gmx_sumi(2 * eCompNR, counts, cr);
+    }
+
+    if (nullptr != fpout)
+    {
+        fprintf(fpout, "# Solv. molecules in comp.%s: %d   comp.%s: %d\n", CompStr[eCompA],
+                counts[eCompA], CompStr[eCompB], counts[eCompB]);
+    }
+
+    /* Consistency checks */
+    const auto numMolecules = static_cast<int>(g->atomset.numAtomsGlobal() / g->apm);
+    if (counts[eCompNR + eCompA] + counts[eCompNR + eCompB] != numMolecules)
+    {
+        fprintf(stderr,
+                "%s Warning: Inconsistency while assigning '%s' molecules to compartments. !inA: "
+                "%d, !inB: %d, total molecules %d\n",
+                SwS, g->molname, counts[eCompNR + eCompA], counts[eCompNR + eCompB], numMolecules);
+    }
+    if (counts[eCompA] + counts[eCompB] != numMolecules)
+    {
+        fprintf(stderr,
+                "%s Warning: %d molecules are in group '%s', but altogether %d have been assigned "
+                "to the compartments.\n",
+                SwS, numMolecules, g->molname, counts[eCompA] + counts[eCompB]);
+    }
+}
+
+
+/*! \brief Selects the molecules of a compartment that are closest to its bulk layer.
+ *
+ * Each rank determines the best numMolecules candidates among its local
+ * molecules in the compartment. Only these candidates are combined over the
+ * ranks, from which the globally best numMolecules are chosen. These are the
+ * molecules that get_index_of_distant_atom() would return on numMolecules
+ * subsequent calls for the collective compartment list, and in the same order.
+ *
+ * \param[in] comp         The compartment with the list of local molecules.
+ * \param[in] numMolecules The number of molecules to select.
+ * \param[in] molname      Name of the molecule.
+ * \param[in] cr           Communication record.
+ *
+ * \returns The collective indices of the first atoms of the selected molecules.
+ */
+static std::vector<int> selectDistantMolecules(const t_compartment& comp,
+                                               int                  numMolecules,
+                                               const char           molname[],
+                                               const t_commrec*     cr)
+{
+    /* Sorting pairs of distance and index reproduces the serial choice for equal distances */
+    std::vector<std::pair<real, int>> candidates;
+    for (int iMol = 0; iMol < comp.nMol; iMol++)
+    {
+        candidates.emplace_back(comp.dist[iMol], comp.ind[iMol]);
+    }
+    int numCandidates = std::min(numMolecules, static_cast<int>(candidates.size()));
+    std::partial_sort(candidates.begin(), candidates.begin() + numCandidates, candidates.end());
+    candidates.resize(numCandidates);
+
+    if (PAR(cr))
+    {
+        /* Each rank fills its own slots, a sum then combines the candidates of all ranks */
+        const int           numSlots = cr->nnodes * numMolecules;
+        std::vector<double> slotDistance(numSlots, 0);
+        std::vector<int>    slotIndex(numSlots, 0); /* Collective index + 1, 0 for empty slots */
+        for (int i = 0; i < numCandidates; i++)
+        {
+            const int slot     = cr->nodeid * numMolecules + i;
+            slotDistance[slot] = candidates[i].first;
+            slotIndex[slot]    = candidates[i].second + 1;
+        }
+        gmx_sumd(numSlots, slotDistance.data(), cr);
+        gmx_sumi(numSlots, slotIndex.data(), cr);
+
+        candidates.clear();
+        for (int slot = 0; slot < numSlots; slot++)
+        {
+            if (slotIndex[slot] > 0)
+            {
+                candidates.emplace_back(slotDistance[slot], slotIndex[slot] - 1);
+            }
+        }
+        numCandidates = std::min(numMolecules, static_cast<int>(candidates.size()));
+        std::partial_sort(candidates.begin(), candidates.begin() + numCandidates, candidates.end());
+    }
+
+    if (numCandidates < numMolecules)
+    {
+        gmx_fatal(FARGS, "Need %d %s molecules for swapping, but the compartment contains only %d.",
+                  numMolecules, molname, numCandidates);
+    }
+
+    std::vector<int> selected;
+    for (int i = 0; i < numMolecules; i++)
+    {
+        selected.push_back(candidates[i].second);
+    }
+
+    return selected;
+}
+
+
+/*! \brief Positions of the selected solvent molecules, assembled from the local atoms.
+ *
+ * The molecules are given by the collective indices of their first atoms,
+ * the positions of molecule i are stored at x[i*apm ... (i+1)*apm-1].
+ */
+struct SwapMolecules
+{
+    //! Pairs of collective index of the first atom and slot in x, sorted by index
+    std::vector<std::pair<int, int>> firstAtomToSlot;
+    //! The positions of the atoms of the selected molecules
+    std::vector<gmx::RVec> x;
+};
+
+
+/*! \brief Returns the slot of the molecule that collective atom iAtom belongs to, or -1 */
+static int slotOfAtom(const SwapMolecules& molecules, int iAtom, int apm)
+{
+    const int  firstAtom = iAtom - iAtom % apm;
+    const auto found =
+            std::lower_bound(molecules.firstAtomToSlot.begin(), molecules.firstAtomToSlot.end(),
+                             std::make_pair(firstAtom, -1));
+    if (found != molecules.firstAtomToSlot.end() && found->first == firstAtom)
+    {
+        return found->second;
+    }
+    return -1;
+}
+
+
+/*! \brief Assembles the positions of only the selected molecules of group g from the local atoms */
+static void assembleSwapMolecules(const t_swapgrp&        g,
+                                  const std::vector<int>& firstAtoms,
+                                  const rvec              x[],
+                                  const t_commrec*        cr,
+                                  SwapMolecules*          molecules)
+{
+    molecules->firstAtomToSlot.clear();
+    for (size_t i = 0; i < firstAtoms.size(); i++)
+    {
+        molecules->firstAtomToSlot.emplace_back(firstAtoms[i], static_cast<int>(i));
+    }
+    std::sort(molecules->firstAtomToSlot.begin(), molecules->firstAtomToSlot.end());
+    molecules->x.assign(firstAtoms.size() * g.apm, { 0, 0, 0 });
+
+    auto collectiveIndex = g.atomset.collectiveIndex().begin();
+    for (const auto localIndex : g.atomset.localIndex())
+    {
+        const int slot = slotOfAtom(*molecules, *collectiveIndex, g.apm);
+        if (slot >= 0)
+        {
+            copy_rvec(x[localIndex], molecules->x[slot * g.apm + *collectiveIndex % g.apm]);
+        }
+        ++collectiveIndex;
+    }
+
+    /* Each atom is home on exactly one rank */
+    if (PAR(cr))
+    {
+        gmx_sum(molecules->x.size() * DIM, as_rvec_array(molecules->x.data())[0], cr);
+    }
+}
+
+
+/*! \brief Write back the modified positions of the selected molecules to the local atoms. */
+static void applyModifiedSwapMolecules(const t_swapgrp& g, const SwapMolecules& molecules, rvec x[])
+{
+    auto collectiveIndex = g.atomset.collectiveIndex().begin();
+    for (const auto localIndex : g.atomset.localIndex())
+    {
+        const int slot = slotOfAtom(molecules, *collectiveIndex, g.apm);
+        if (slot >= 0)
+        {
+            copy_rvec(molecules.x[slot * g.apm + *collectiveIndex % g.apm], x[localIndex]);
+        }
+        ++collectiveIndex;
+    }
+}
+
+
 /*! \brief Do we need to swap a molecule in any of the ion groups with a water molecule at this step?
  *
  * From the requested and average molecule counts we determine whether a swap is needed
@@ -1938,7 +2183,7 @@ gmx_bool do_swapcoords(t_commrec*     cr,
     int           thisC, otherC; /* Index into this compartment and the other one */
     gmx_bool      bSwap = FALSE;
     t_swapgrp *   g, *gsol;
-    int           isol, iion;
+    int           iion;
     rvec          com_solvent, com_particle; /* solvent and swap molecule's center of mass */
 
 
@@ -1995,18 +2240,10 @@ gmx_bool do_swapcoords(t_commrec*     cr,
     if (bSwap)
     {
         /* Since we here know that we have to perform ion/water position exchanges,
-         * we now assemble the solvent positions */
-        g = &(s->group[eGrpSolvent]);
-        communicate_group_positions(cr, g->xc, nullptr, nullptr, FALSE, x, g->atomset.numAtomsGlobal(),
-                                    g->atomset.numAtomsLocal(), g->atomset.localIndex().data(),
-                                    g->atomset.collectiveIndex().data(), nullptr, nullptr);
-
-        /* Determine how many molecules of solvent each compartment contains */
-        sortMoleculesIntoCompartments(g, cr, sc, s, box, step, s->fpout, bRerun, TRUE);
-
-        /* Save number of solvent molecules per compartment prior to any swaps */
-        g->comp[eCompA].nMolBefore = g->comp[eCompA].nMol;
-        g->comp[eCompB].nMolBefore = g->comp[eCompB].nMol;
+         * we now classify the local solvent molecules. The solvent positions are
+         * not assembled, only those of the molecules selected for swapping are. */
+        gsol = &(s->group[eGrpSolvent]);
+        sortLocalSolventIntoCompartments(gsol, cr, sc, s, x, box, s->fpout);
 
         for (ig = eSwapFixedGrpNR; ig < s->ngrp; ig++)
         {
@@ -2022,8 +2259,36 @@ gmx_bool do_swapcoords(t_commrec*     cr,
             }
         }
 
+        /* The number of solvent molecules each compartment gives up follows
+         * from the vacancies alone, so that all of them can be selected at once */
+        int numSolventSwaps[eCompNR] = { 0 };
+        for (ig = eSwapFixedGrpNR; ig < s->ngrp; ig++)
+        {
+            real vacancy[eCompNR] = { s->group[ig].vacancy[eCompA], s->group[ig].vacancy[eCompB] };
+            for (thisC = 0; thisC < eCompNR; thisC++)
+            {
+                otherC = (thisC + 1) % eCompNR;
+                while (vacancy[thisC] >= sc->threshold)
+                {
+                    vacancy[thisC]--;
+                    vacancy[otherC]++;
+                    numSolventSwaps[thisC]++;
+                }
+            }
+        }
+        std::vector<int> solventFirstAtoms;
+        int              solventSlot[eCompNR];
+        for (ic = 0; ic < eCompNR; ic++)
+        {
+            solventSlot[ic] = static_cast<int>(solventFirstAtoms.size());
+            const std::vector<int> selected =
+                    selectDistantMolecules(gsol->comp[ic], numSolventSwaps[ic], gsol->molname, cr);
+            solventFirstAtoms.insert(solventFirstAtoms.end(), selected.begin(), selected.end());
+        }
+        SwapMolecules solvent;
+        assembleSwapMolecules(*gsol, solventFirstAtoms, x, cr, &solvent);
+
         /* Now actually perform the particle exchanges, one swap group after another */
-        gsol = &s->group[eGrpSolvent];
         for (ig = eSwapFixedGrpNR; ig < s->ngrp; ig++)
         {
             nswaps = 0;
@@ -2037,17 +2302,18 @@ gmx_bool do_swapcoords(t_commrec*     cr,
                 {
                     /* Swap in an ion */
 
-                    /* Get the xc-index of the first atom of a solvent molecule of this compartment */
-                    isol = get_index_of_distant_atom(&gsol->comp[thisC], gsol->molname);
+                    /* Get the next selected solvent molecule of this compartment */
+                    rvec* xsol = as_rvec_array(solvent.x.data()) + solventSlot[thisC] * gsol->apm;
+                    solventSlot[thisC]++;
 
                     /* Get the xc-index of a particle from the other compartment */
                     iion = get_index_of_distant_atom(&g->comp[otherC], g->molname);
 
-                    get_molecule_center(&gsol->xc[isol], gsol->apm, gsol->m, com_solvent, s->pbc);
+                    get_molecule_center(xsol, gsol->apm, gsol->m, com_solvent, s->pbc);
                     get_molecule_center(&g->xc[iion], g->apm, g->m, com_particle, s->pbc);
 
                     /* Subtract solvent molecule's center of mass and add swap particle's center of mass */
-                    translate_positions(&gsol->xc[isol], gsol->apm, com_solvent, com_particle, s->pbc);
+                    translate_positions(xsol, gsol->apm, com_solvent, com_particle, s->pbc);
                     /* Similarly for the swap particle, subtract com_particle and add com_solvent */
                     translate_positions(&g->xc[iion], g->apm, com_particle, com_solvent, s->pbc);
 
@@ -2092,7 +2358,8 @@ gmx_bool do_swapcoords(t_commrec*     cr,
 
         /* For the solvent and user-defined swap groups, each rank writes back its
          * (possibly modified) local positions to the official position array. */
-        for (ig = eGrpSolvent; ig < s->ngrp; ig++)
+        applyModifiedSwapMolecules(*gsol, solvent, x);
+        for (ig = eSwapFixedGrpNR; ig < s->ngrp; ig++)
         {
             g = &s->group[ig];
             apply_modified_positions(g, x);
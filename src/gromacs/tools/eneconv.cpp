@@ -164,6 +164,9 @@ static int scan_ene_files(const std::vector<std::string>& files, real* readtime,
         in  = open_enx(files[f].c_str(), "r");
         enm = nullptr;
         do_enxnms(in, &nre, &enm);
+        /* Only the frame times are used here */
+        enx_select_terms(in, {});
+        enx_select_blocks(in, {});
 
         if (f == 0)
         {
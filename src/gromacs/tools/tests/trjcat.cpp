@@ -0,0 +1,174 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for gmx trjcat.
+ *
+ * \ingroup module_tools
+ */
+#include "gmxpre.h"
+
+#include "gromacs/tools/trjcat.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/oenv.h"
+#include "gromacs/fileio/trxio.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/tools/trjconv.h"
+#include "gromacs/trajectory/trajectoryframe.h"
+
+#include "testutils/cmdlinetest.h"
+#include "testutils/testfilemanager.h"
+
+namespace
+{
+
+//! Coordinates and time of a trajectory frame.
+struct FrameContents
+{
+    //! Time of the frame.
+    real time;
+    //! Coordinates of the frame.
+    std::vector<gmx::RVec> x;
+};
+
+//! Returns the times and coordinates of all frames in \p fileName.
+std::vector<FrameContents> readFrames(const std::string& fileName)
+{
+    gmx_output_env_t* oenv;
+    output_env_init_default(&oenv);
+    std::vector<FrameContents> frames;
+    t_trxstatus*               status;
+    t_trxframe                 fr;
+    bool haveFrame = read_first_frame(oenv, &status, fileName.c_str(), &fr, TRX_NEED_X);
+    while (haveFrame)
+    {
+        frames.push_back({ fr.time, std::vector<gmx::RVec>(fr.x, fr.x + fr.natoms) });
+        haveFrame = read_next_frame(oenv, status, &fr);
+    }
+    close_trx(status);
+    done_frame(&fr);
+    output_env_done(oenv);
+    return frames;
+}
+
+class TrjcatTest : public gmx::test::CommandLineTestBase
+{
+};
+
+class TrjcatWithFormat : public TrjcatTest, public ::testing::WithParamInterface<const char*>
+{
+};
+
+TEST_P(TrjcatWithFormat, CopiesFramesOfSameFormatUnchanged)
+{
+    // Input and output have the same format, so frames are copied without decoding
+    const std::string inputFileName = fileManager().getInputFilePath(GetParam());
+    const std::string extension     = inputFileName.substr(inputFileName.rfind('.'));
+    const std::string outputFileName =
+            fileManager().getTemporaryFilePath(("concatenated" + extension).c_str());
+
+    gmx::test::CommandLine& cmdline = commandLine();
+    cmdline.addOption("-f");
+    cmdline.append(inputFileName);
+    cmdline.append(inputFileName);
+    cmdline.addOption("-o", outputFileName);
+    cmdline.append("-cat");
+    ASSERT_EQ(0, gmx_trjcat(cmdline.argc(), cmdline.argv()));
+
+    const auto inputFrames  = readFrames(inputFileName);
+    const auto outputFrames = readFrames(outputFileName);
+    ASSERT_EQ(2 * inputFrames.size(), outputFrames.size());
+    for (size_t i = 0; i < outputFrames.size(); i++)
+    {
+        const FrameContents& expected = inputFrames[i % inputFrames.size()];
+        EXPECT_EQ(expected.time, outputFrames[i].time);
+        ASSERT_EQ(expected.x.size(), outputFrames[i].x.size());
+        for (size_t a = 0; a < expected.x.size(); a++)
+        {
+            EXPECT_EQ(expected.x[a][XX], outputFrames[i].x[a][XX]);
+            EXPECT_EQ(expected.x[a][YY], outputFrames[i].x[a][YY]);
+            EXPECT_EQ(expected.x[a][ZZ], outputFrames[i].x[a][ZZ]);
+        }
+    }
+}
+
+TEST_F(TrjcatTest, CopiesCompressedXtcFramesUnchanged)
+{
+    // XTC frames with more than 9 atoms have compressed coordinates
+    const std::string inputFileName = fileManager().getTemporaryFilePath("spc216.xtc");
+    {
+        gmx::test::CommandLine toXtc;
+        toXtc.append("trjconv");
+        toXtc.addOption("-f", fileManager().getInputFilePath("spc216.gro"));
+        toXtc.addOption("-o", inputFileName);
+        ASSERT_EQ(0, gmx_trjconv(toXtc.argc(), toXtc.argv()));
+    }
+    const std::string outputFileName = fileManager().getTemporaryFilePath("concatenated.xtc");
+
+    gmx::test::CommandLine& cmdline = commandLine();
+    cmdline.addOption("-f");
+    cmdline.append(inputFileName);
+    cmdline.append(inputFileName);
+    cmdline.addOption("-o", outputFileName);
+    cmdline.append("-cat");
+    ASSERT_EQ(0, gmx_trjcat(cmdline.argc(), cmdline.argv()));
+
+    const auto inputFrames  = readFrames(inputFileName);
+    const auto outputFrames = readFrames(outputFileName);
+    ASSERT_EQ(1U, inputFrames.size());
+    ASSERT_EQ(2U, outputFrames.size());
+    for (const auto& frame : outputFrames)
+    {
+        ASSERT_EQ(inputFrames[0].x.size(), frame.x.size());
+        for (size_t a = 0; a < frame.x.size(); a++)
+        {
+            EXPECT_EQ(inputFrames[0].x[a][XX], frame.x[a][XX]);
+            EXPECT_EQ(inputFrames[0].x[a][YY], frame.x[a][YY]);
+            EXPECT_EQ(inputFrames[0].x[a][ZZ], frame.x[a][ZZ]);
+        }
+    }
+}
+
+//! Trajectory formats that trjcat copies without decoding.
+const char* const trajectoryFileNames[] = { "spc2-traj.xtc", "spc2-traj.trr" };
+
+INSTANTIATE_TEST_CASE_P(CopiesFrames, TrjcatWithFormat, ::testing::ValuesIn(trajectoryFileNames));
+
+} // namespace
@@ -48,6 +48,7 @@
 #include "testutils/cmdlinetest.h"
 #include "testutils/simulationdatabase.h"
 #include "testutils/stdiohelper.h"
+#include "testutils/testfilemanager.h"
 #include "testutils/textblockmatchers.h"
 
 namespace
@@ -134,4 +135,31 @@ TEST_P(TrjconvWithoutTopologyFile, WithDifferentInputFormats)
 INSTANTIATE_TEST_CASE_P(NoFatalErrorWhenWritingFrom,
                         TrjconvWithoutTopologyFile,
                         ::testing::ValuesIn(trajectoryFileNames));
+
+class TrjconvXtcRoundTrip : public gmx::test::CommandLineTestBase
+{
+};
+
+TEST_F(TrjconvXtcRoundTrip, KeepsFrameOrderAndContents)
+{
+    // Both conversions read and write XTC or TRR frames on separate threads
+    std::string xtcFileName = fileManager().getTemporaryFilePath("spc2-traj.xtc");
+    {
+        gmx::test::CommandLine toXtc;
+        toXtc.append("trjconv");
+        toXtc.addOption("-f", fileManager().getInputFilePath("spc2-traj.trr"));
+        toXtc.addOption("-o", xtcFileName);
+        ASSERT_EQ(0, gmx_trjconv(toXtc.argc(), toXtc.argv()));
+    }
+
+    auto& cmdline = commandLine();
+    cmdline.addOption("-f", xtcFileName);
+    setInputFile("-s", "spc2.gro");
+    setOutputFile("-o", "spc2-traj.gro", gmx::test::ExactTextMatch());
+
+    gmx::test::StdioTestHelper stdioHelper(&fileManager());
+    stdioHelper.redirectStringToStdin("System\n");
+    ASSERT_EQ(0, gmx_trjconv(cmdline.argc(), cmdline.argv()));
+    checkOutputFiles();
+}
 } // namespace
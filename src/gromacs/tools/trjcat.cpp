@@ -45,12 +45,14 @@
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/fileio/confio.h"
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/pdbio.h"
 #include "gromacs/fileio/tngio.h"
+#include "gromacs/fileio/trrio.h"
 #include "gromacs/fileio/trxio.h"
 #include "gromacs/fileio/xtcio.h"
 #include "gromacs/fileio/xvgr.h"
@@ -413,6 +415,74 @@ static void do_demux(gmx::ArrayRef<const std::string> inFiles,
     }
 }
 
+/*! \brief
+ * Frame of an XTC or TRR file kept in its encoded form.
+ *
+ * When the input and output formats are the same, frames can be copied
+ * by only rewriting their headers, which avoids decoding and re-encoding
+ * (and for XTC decompressing and recompressing) all coordinates.
+ */
+struct RawFrame
+{
+    //! File type, efXTC or efTRR.
+    int ftp = efXTC;
+    //! Number of atoms, for XTC.
+    int natoms = 0;
+    //! Frame header, for TRR.
+    gmx_trr_header_t trrHeader;
+    //! Encoded frame contents following the header.
+    std::vector<char> data;
+};
+
+//! Reads the next frame from \p fio into \p raw and sets the header fields of \p fr from it.
+static bool readNextRawFrame(t_fileio* fio, RawFrame* raw, t_trxframe* fr)
+{
+    gmx_bool bOK       = TRUE;
+    bool     haveFrame = false;
+    if (raw->ftp == efXTC)
+    {
+        haveFrame =
+                (read_next_xtc_raw(fio, &raw->natoms, &fr->step, &fr->time, &raw->data, &bOK) != 0);
+        fr->natoms = raw->natoms;
+    }
+    else
+    {
+        haveFrame  = gmx_trr_read_frame_raw(fio, &raw->trrHeader, &raw->data, &bOK);
+        fr->natoms = raw->trrHeader.natoms;
+        fr->step   = raw->trrHeader.step;
+        fr->time   = raw->trrHeader.t;
+        fr->lambda = raw->trrHeader.lambda;
+    }
+    if (!bOK)
+    {
+        fprintf(stderr, "\nWARNING: Incomplete frame: step %" PRId64 " time %g\n", fr->step,
+                fr->time);
+        haveFrame = false;
+    }
+    fr->bStep = haveFrame;
+    fr->bTime = haveFrame;
+
+    return haveFrame;
+}
+
+//! Writes \p raw to \p fio with the step and time of \p fr.
+static void writeRawFrame(t_fileio* fio, RawFrame* raw, const t_trxframe& fr)
+{
+    if (raw->ftp == efXTC)
+    {
+        if (write_xtc_raw(fio, raw->natoms, fr.step, fr.time, raw->data) == 0)
+        {
+            gmx_file("Cannot write trajectory frame; maybe you are out of disk space?");
+        }
+    }
+    else
+    {
+        raw->trrHeader.step = fr.step;
+        raw->trrHeader.t    = fr.time;
+        gmx_trr_write_frame_raw(fio, raw->trrHeader, raw->data);
+    }
+}
+
 int gmx_trjcat(int argc, char* argv[])
 {
     const char* desc[] = {
@@ -423,6 +493,10 @@ int gmx_trjcat(int argc, char* argv[])
         "such that a command like [TT]gmx trjcat -f *.trr -o fixed.trr[tt] should do ",
         "the trick. Using [TT]-cat[tt], you can simply paste several files ",
         "together without removal of frames with identical time stamps.[PAR]",
+        "When the input and output files are all [REF].xtc[ref] or all [REF].trr[ref]",
+        "files and no index group is used, frames are copied without decoding",
+        "their coordinates; only the step and time in the frame headers are",
+        "rewritten.[PAR]",
         "One important option is inferred when the output file is amongst the",
         "input files. In that case that particular file will be appended to",
         "which implies you do not need to store double the amount of data.",
@@ -756,6 +830,7 @@ int gmx_trjcat(int argc, char* argv[])
             frout = fr;
         }
         /* Lets stitch up some files */
+        RawFrame raw;
         timestep = timest[0];
         for (size_t i = n_append + 1; i < inFilesEdited.size(); i++)
         {
@@ -813,7 +888,23 @@ int gmx_trjcat(int argc, char* argv[])
             {
                 timestep = timest[i];
             }
-            read_first_frame(oenv, &status, inFilesEdited[i].c_str(), &fr, FLAGS);
+            /* Copy frames in their encoded form when we do not need to change their contents */
+            const int ftpCurrent = fn2ftp(inFilesEdited[i].c_str());
+            t_fileio* rawIn      = nullptr;
+            if (!bIndex && ftpCurrent == ftpout && (ftpout == efXTC || ftpout == efTRR))
+            {
+                rawIn   = gmx_fio_open(inFilesEdited[i].c_str(), "r");
+                raw.ftp = ftpout;
+                clear_trxframe(&fr, TRUE);
+                if (!readNextRawFrame(rawIn, &raw, &fr))
+                {
+                    gmx_fatal(FARGS, "Reading first frame from %s", inFilesEdited[i].c_str());
+                }
+            }
+            else
+            {
+                read_first_frame(oenv, &status, inFilesEdited[i].c_str(), &fr, FLAGS);
+            }
             if (!fr.bTime)
             {
                 fr.time = 0;
@@ -899,7 +990,11 @@ int gmx_trjcat(int argc, char* argv[])
                             bNewFile = FALSE;
                         }
 
-                        if (bIndex)
+                        if (rawIn)
+                        {
+                            writeRawFrame(trx_get_fileio(trxout), &raw, frout);
+                        }
+                        else if (bIndex)
                         {
                             write_trxframe_indexed(trxout, &frout, isize, index, nullptr);
                         }
@@ -915,9 +1010,17 @@ int gmx_trjcat(int argc, char* argv[])
                         }
                     }
                 }
-            } while (read_next_frame(oenv, status, &fr));
+            } while (rawIn ? readNextRawFrame(rawIn, &raw, &fr)
+                           : read_next_frame(oenv, status, &fr));
 
-            close_trx(status);
+            if (rawIn)
+            {
+                gmx_fio_close(rawIn);
+            }
+            else
+            {
+                close_trx(status);
+            }
         }
         if (trxout)
         {
@@ -44,7 +44,12 @@
 #include <cstring>
 
 #include <algorithm>
+#include <condition_variable>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/commandline/viewit.h"
@@ -71,6 +76,7 @@
 #include "gromacs/trajectory/trajectoryframe.h"
 #include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/arraysize.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/smalloc.h"
@@ -215,6 +221,341 @@ static std::unique_ptr<gmx_mtop_t> read_mtop_for_tng(const char* tps_file,
     return mtop;
 }
 
+namespace
+{
+
+//! Number of frames each pipeline stage can hold ahead of the next one.
+constexpr int c_framesInFlight = 2;
+
+/*! \brief
+ * Moves the contents of \p from to \p to without copying coordinates.
+ *
+ * The coordinate, velocity and force buffers of \p to are handed to
+ * \p from in return, so every buffer keeps exactly one owner.
+ */
+void moveFrame(t_trxframe* from, t_trxframe* to)
+{
+    rvec* x = to->x;
+    rvec* v = to->v;
+    rvec* f = to->f;
+    *to     = *from;
+    from->x = x;
+    from->v = v;
+    from->f = f;
+}
+
+//! Returns a copy of the header of \p frame with newly allocated buffers.
+t_trxframe frameWithOwnBuffers(const t_trxframe& frame)
+{
+    t_trxframe copy = frame;
+    copy.x          = nullptr;
+    copy.v          = nullptr;
+    copy.f          = nullptr;
+    if (frame.x != nullptr)
+    {
+        snew(copy.x, frame.natoms);
+    }
+    if (frame.v != nullptr)
+    {
+        snew(copy.v, frame.natoms);
+    }
+    if (frame.f != nullptr)
+    {
+        snew(copy.f, frame.natoms);
+    }
+    return copy;
+}
+
+//! Frees the buffers allocated by frameWithOwnBuffers(), leaving the shared header data.
+void freeOwnBuffers(t_trxframe* frame)
+{
+    sfree(frame->x);
+    sfree(frame->v);
+    sfree(frame->f);
+}
+
+/*! \brief
+ * Reads the frames of an XTC or TRR trajectory ahead on a background thread.
+ *
+ * Decoding, in particular of compressed XTC frames, overlaps with the
+ * processing of the frames read earlier. Frames are returned in file order.
+ */
+class FrameReadAhead
+{
+public:
+    /*! \brief Starts reading the frames following \p frame from \p status.
+     *
+     * \p status must not be used by the caller until this object is destroyed.
+     */
+    FrameReadAhead(const gmx_output_env_t* oenv, t_trxstatus* status, const t_trxframe& frame) :
+        oenv_(oenv),
+        status_(status)
+    {
+        for (int i = 0; i < c_framesInFlight; i++)
+        {
+            ring_.push_back(frameWithOwnBuffers(frame));
+        }
+        thread_ = std::thread([this, readFrame = frameWithOwnBuffers(frame)]() mutable {
+            readLoop(&readFrame);
+            freeOwnBuffers(&readFrame);
+        });
+    }
+    ~FrameReadAhead()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        condition_.notify_all();
+        thread_.join();
+        for (auto& frame : ring_)
+        {
+            freeOwnBuffers(&frame);
+        }
+    }
+
+    /*! \brief Replaces \p fr by the next frame.
+     *
+     * \returns Whether there was a next frame, like read_next_frame().
+     */
+    bool next(t_trxframe* fr)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this] { return count_ > 0 || endOfInput_; });
+        if (count_ == 0)
+        {
+            if (error_)
+            {
+                std::rethrow_exception(error_);
+            }
+            return false;
+        }
+        moveFrame(&ring_[first_], fr);
+        first_ = (first_ + 1) % c_framesInFlight;
+        count_--;
+        lock.unlock();
+        condition_.notify_all();
+        return true;
+    }
+
+private:
+    //! Reads frames into \p frame and queues them until the input ends or we are stopped.
+    void readLoop(t_trxframe* frame)
+    {
+        while (true)
+        {
+            bool haveFrame = false;
+            try
+            {
+                haveFrame = read_next_frame(oenv_, status_, frame);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                error_ = std::current_exception();
+            }
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                condition_.wait(lock, [this] { return count_ < c_framesInFlight || stop_; });
+                if (stop_)
+                {
+                    return;
+                }
+                if (!haveFrame)
+                {
+                    endOfInput_ = true;
+                }
+                else
+                {
+                    moveFrame(frame, &ring_[(first_ + count_) % c_framesInFlight]);
+                    count_++;
+                }
+            }
+            condition_.notify_all();
+            if (!haveFrame)
+            {
+                return;
+            }
+        }
+    }
+
+    //! Output environment used for reading.
+    const gmx_output_env_t* oenv_;
+    //! The trajectory that is read.
+    t_trxstatus* status_;
+    //! Ring of frames read, but not yet returned.
+    std::vector<t_trxframe> ring_;
+    //! Index of the oldest frame in \p ring_.
+    int first_ = 0;
+    //! Number of frames in \p ring_.
+    int count_ = 0;
+    //! Set by the reader when there are no more frames.
+    bool endOfInput_ = false;
+    //! Set to ask the reader to exit.
+    bool stop_ = false;
+    //! Exception thrown while reading, passed on to the caller.
+    std::exception_ptr error_;
+    //! Protects all of the above.
+    std::mutex mutex_;
+    //! Signals changes to the ring and flags.
+    std::condition_variable condition_;
+    //! The reading thread.
+    std::thread thread_;
+};
+
+/*! \brief
+ * Writes XTC or TRR frames on a background thread.
+ *
+ * Frames are copied when queued, so the caller can go on modifying its
+ * own frame while the previous ones are encoded. They are written in the
+ * order they were queued.
+ */
+class FrameWriteBehind
+{
+public:
+    FrameWriteBehind() : ring_(c_framesInFlight)
+    {
+        thread_ = std::thread([this] { writeLoop(); });
+    }
+    ~FrameWriteBehind()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        condition_.notify_all();
+        thread_.join();
+    }
+
+    //! Queues \p frame for writing to \p status.
+    void write(t_trxstatus* status, const t_trxframe& frame, gmx_conect gc)
+    {
+        int slotIndex;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this] { return count_ < c_framesInFlight || error_; });
+            if (error_)
+            {
+                std::rethrow_exception(error_);
+            }
+            slotIndex = (first_ + count_) % c_framesInFlight;
+        }
+        // The writer does not touch slots beyond count_, so we can fill it unlocked
+        QueuedFrame& slot = ring_[slotIndex];
+        slot.status       = status;
+        slot.gc           = gc;
+        slot.frame        = frame;
+        slot.frame.x      = copyVectors(frame.bX ? frame.x : nullptr, frame.natoms, &slot.x);
+        slot.frame.v      = copyVectors(frame.bV ? frame.v : nullptr, frame.natoms, &slot.v);
+        slot.frame.f      = copyVectors(frame.bF ? frame.f : nullptr, frame.natoms, &slot.f);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            count_++;
+        }
+        condition_.notify_all();
+    }
+
+    //! Waits until all queued frames are written.
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this] { return count_ == 0; });
+        if (error_)
+        {
+            std::rethrow_exception(error_);
+        }
+    }
+
+private:
+    //! A frame waiting to be written, with its own copy of the coordinates.
+    struct QueuedFrame
+    {
+        //! The trajectory to write to.
+        t_trxstatus* status = nullptr;
+        //! Connectivity passed to write_trxframe().
+        gmx_conect gc = nullptr;
+        //! The frame header, pointing into the buffers below.
+        t_trxframe frame;
+        //! Storage for the coordinates.
+        std::vector<gmx::RVec> x;
+        //! Storage for the velocities.
+        std::vector<gmx::RVec> v;
+        //! Storage for the forces.
+        std::vector<gmx::RVec> f;
+    };
+
+    //! Copies \p natoms vectors from \p source to \p storage, returns the copy or nullptr.
+    static rvec* copyVectors(const rvec* source, int natoms, std::vector<gmx::RVec>* storage)
+    {
+        if (source == nullptr)
+        {
+            return nullptr;
+        }
+        storage->assign(reinterpret_cast<const gmx::RVec*>(source),
+                        reinterpret_cast<const gmx::RVec*>(source) + natoms);
+        return as_rvec_array(storage->data());
+    }
+
+    //! Writes queued frames until asked to stop and nothing is left.
+    void writeLoop()
+    {
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                condition_.wait(lock, [this] { return count_ > 0 || stop_; });
+                if (count_ == 0)
+                {
+                    return;
+                }
+            }
+            QueuedFrame& slot = ring_[first_];
+            try
+            {
+                write_trxframe(slot.status, &slot.frame, slot.gc);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                error_ = std::current_exception();
+                count_ = 0;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_)
+                {
+                    first_ = (first_ + 1) % c_framesInFlight;
+                    count_--;
+                }
+            }
+            condition_.notify_all();
+            if (error_)
+            {
+                return;
+            }
+        }
+    }
+
+    //! Ring of frames queued for writing.
+    std::vector<QueuedFrame> ring_;
+    //! Index of the oldest frame in \p ring_.
+    int first_ = 0;
+    //! Number of frames in \p ring_.
+    int count_ = 0;
+    //! Set to ask the writer to exit once the ring is empty.
+    bool stop_ = false;
+    //! Exception thrown while writing, passed on to the caller.
+    std::exception_ptr error_;
+    //! Protects all of the above.
+    std::mutex mutex_;
+    //! Signals changes to the ring and flags.
+    std::condition_variable condition_;
+    //! The writing thread.
+    std::thread thread_;
+};
+
+} // namespace
+
 int gmx_trjconv(int argc, char* argv[])
 {
     const char* desc[] = {
@@ -969,6 +1310,23 @@ int gmx_trjconv(int argc, char* argv[])
                 }
             }
 
+            /* Decode and encode frames on separate threads, so that this
+             * thread only has to transform them. Frames are still processed
+             * one by one and in order, as -pbc nojump and progressive fitting
+             * depend on the previous frame. Commands run with -exec need
+             * the output file to be complete, so then we write here.
+             */
+            std::unique_ptr<FrameReadAhead> readAhead;
+            if (ftpin == efXTC || ftpin == efTRR)
+            {
+                readAhead = std::make_unique<FrameReadAhead>(oenv, trxin, fr);
+            }
+            std::unique_ptr<FrameWriteBehind> writeBehind;
+            if ((ftp == efXTC || ftp == efTRR) && !bExec)
+            {
+                writeBehind = std::make_unique<FrameWriteBehind>();
+            }
+
             /* Start the big loop over frames */
             file_nr  = 0;
             frame    = 0;
@@ -1334,11 +1692,22 @@ int gmx_trjconv(int argc, char* argv[])
                                 {
                                     if (trxout)
                                     {
+                                        if (writeBehind)
+                                        {
+                                            writeBehind->flush();
+                                        }
                                         close_trx(trxout);
                                     }
                                     trxout = open_trx(out_file2, filemode);
                                 }
-                                write_trxframe(trxout, &frout, gc);
+                                if (writeBehind)
+                                {
+                                    writeBehind->write(trxout, frout, gc);
+                                }
+                                else
+                                {
+                                    write_trxframe(trxout, &frout, gc);
+                                }
                                 break;
                             case efGRO:
                             case efG96:
@@ -1445,8 +1814,21 @@ int gmx_trjconv(int argc, char* argv[])
                     }
                 }
                 frame++;
-                bHaveNextFrame = read_next_frame(oenv, trxin, &fr);
+                if (readAhead)
+                {
+                    bHaveNextFrame = readAhead->next(&fr);
+                }
+                else
+                {
+                    bHaveNextFrame = read_next_frame(oenv, trxin, &fr);
+                }
             } while (!(bTDump && bDumpFrame) && bHaveNextFrame);
+
+            readAhead.reset();
+            if (writeBehind)
+            {
+                writeBehind->flush();
+            }
         }
 
         if (!bHaveFirstFrame || (bTDump && !bDumpFrame))
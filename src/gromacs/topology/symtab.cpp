@@ -48,9 +48,11 @@
 #include "symtab.h"
 
 #include <cstdio>
+#include <cstdint>
 #include <cstring>
 
 #include <algorithm>
+#include <unordered_map>
 
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/cstringutil.h"
@@ -166,9 +168,55 @@ StringTableEntry readStringTableEntry(gmx::ISerializer* serializer, const String
 // Old code for legacy data structure starts below.
 //! Maximum size of character string in table.
 constexpr int c_trimSize = 1024;
-//! Maximum number of entries in each element of the linked list.
+/*! \brief Minimum number of entries in each element of the linked list.
+ *
+ * New elements are sized to the number of entries already stored, so that
+ * the list length, and with it the cost of lookup_symtab() and
+ * get_symtab_handle(), only grows logarithmically with the table size.
+ */
 constexpr int c_maxBufSize = 5;
 
+namespace
+{
+
+//! FNV-1a hash of a null-terminated string.
+struct CStringHash
+{
+    size_t operator()(const char* s) const
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (; *s != '\0'; s++)
+        {
+            hash = (hash ^ static_cast<unsigned char>(*s)) * 1099511628211ULL;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+//! Compares null-terminated strings by content.
+struct CStringEqual
+{
+    bool operator()(const char* a, const char* b) const { return std::strcmp(a, b) == 0; }
+};
+
+} // namespace
+
+/*! \brief
+ * Hashed index into the storage of a legacy symbol table.
+ *
+ * Maps the strings stored in the table to their handles, and keeps track of
+ * the last element of the linked list, where new strings are appended.
+ */
+struct t_symtabIndex
+{
+    //! Handles of the stored strings, keyed by the stored strings themselves.
+    std::unordered_map<const char*, char**, CStringHash, CStringEqual> handles;
+    //! Last element of the linked list.
+    t_symbuf* last = nullptr;
+    //! Number of used entries in \p last.
+    int numUsedInLast = 0;
+};
+
 /*! \brief
  * Remove leading and trailing whitespace from string and enforce maximum length.
  *
@@ -249,19 +297,54 @@ char** get_symtab_handle(t_symtab* symtab, int name)
     gmx_fatal(FARGS, "symtab get_symtab_handle %d not found", name);
 }
 
-//! Returns a new initialized entry into the symtab linked list.
-static t_symbuf* new_symbuf()
+//! Returns a new initialized entry into the symtab linked list with space for \p bufsize entries.
+static t_symbuf* new_symbuf(int bufsize)
 {
     t_symbuf* symbuf;
 
     snew(symbuf, 1);
-    symbuf->bufsize = c_maxBufSize;
+    symbuf->bufsize = std::max(bufsize, c_maxBufSize);
     snew(symbuf->buf, symbuf->bufsize);
-    symbuf->next = nullptr;
+    symbuf->next  = nullptr;
+    symbuf->index = nullptr;
 
     return symbuf;
 }
 
+/*! \brief
+ * Builds the hashed index for all entries already stored in \p symtab.
+ *
+ * The storage can have been filled without the index, e.g. when reading
+ * a run input file, so the index is only created on the first insertion.
+ */
+static t_symtabIndex* buildSymtabIndex(const t_symtab* symtab)
+{
+    auto* symtabIndex = new t_symtabIndex;
+    symtabIndex->handles.reserve(symtab->nr);
+    for (t_symbuf* symbuf = symtab->symbuf; symbuf != nullptr; symbuf = symbuf->next)
+    {
+        symtabIndex->last          = symbuf;
+        symtabIndex->numUsedInLast = 0;
+        for (int i = 0; i < symbuf->bufsize && symbuf->buf[i] != nullptr; i++)
+        {
+            // Keeps the first of any duplicates, as the old linear search did
+            symtabIndex->handles.emplace(symbuf->buf[i], &symbuf->buf[i]);
+            symtabIndex->numUsedInLast++;
+        }
+    }
+    return symtabIndex;
+}
+
+//! Frees the hashed index of the symtab that starts with \p symbuf.
+static void freeSymtabIndex(t_symbuf* symbuf)
+{
+    if (symbuf != nullptr)
+    {
+        delete symbuf->index;
+        symbuf->index = nullptr;
+    }
+}
+
 /*! \brief
  * Low level function to enter new string into legacy symtab.
  *
@@ -271,48 +354,34 @@ static t_symbuf* new_symbuf()
  */
 static char** enter_buf(t_symtab* symtab, char* name)
 {
-    int       i;
-    t_symbuf* symbuf;
-    gmx_bool  bCont;
-
     if (symtab->symbuf == nullptr)
     {
-        symtab->symbuf = new_symbuf();
+        symtab->symbuf = new_symbuf(c_maxBufSize);
     }
-
-    symbuf = symtab->symbuf;
-    do
+    if (symtab->symbuf->index == nullptr)
     {
-        for (i = 0; (i < symbuf->bufsize); i++)
-        {
-            if (symbuf->buf[i] == nullptr)
-            {
-                symtab->nr++;
-                symbuf->buf[i] = gmx_strdup(name);
-                return &(symbuf->buf[i]);
-            }
-            else if (strcmp(symbuf->buf[i], name) == 0)
-            {
-                return &(symbuf->buf[i]);
-            }
-        }
-        if (symbuf->next != nullptr)
-        {
-            symbuf = symbuf->next;
-            bCont  = TRUE;
-        }
-        else
-        {
-            bCont = FALSE;
-        }
-    } while (bCont);
+        symtab->symbuf->index = buildSymtabIndex(symtab);
+    }
+    t_symtabIndex* symtabIndex = symtab->symbuf->index;
 
-    symbuf->next = new_symbuf();
-    symbuf       = symbuf->next;
+    const auto found = symtabIndex->handles.find(name);
+    if (found != symtabIndex->handles.end())
+    {
+        return found->second;
+    }
 
+    if (symtabIndex->numUsedInLast == symtabIndex->last->bufsize)
+    {
+        symtabIndex->last->next    = new_symbuf(symtab->nr);
+        symtabIndex->last          = symtabIndex->last->next;
+        symtabIndex->numUsedInLast = 0;
+    }
+    char** handle = &(symtabIndex->last->buf[symtabIndex->numUsedInLast++]);
+    *handle       = gmx_strdup(name);
     symtab->nr++;
-    symbuf->buf[0] = gmx_strdup(name);
-    return &(symbuf->buf[0]);
+    symtabIndex->handles.emplace(*handle, handle);
+
+    return handle;
 }
 
 char** put_symtab(t_symtab* symtab, const char* name)
@@ -371,6 +440,7 @@ void done_symtab(t_symtab* symtab)
     t_symbuf *symbuf, *freeptr;
 
     close_symtab(symtab);
+    freeSymtabIndex(symtab->symbuf);
     symbuf = symtab->symbuf;
     while (symbuf != nullptr)
     {
@@ -396,6 +466,7 @@ void free_symtab(t_symtab* symtab)
     t_symbuf *symbuf, *freeptr;
 
     close_symtab(symtab);
+    freeSymtabIndex(symtab->symbuf);
     symbuf = symtab->symbuf;
     while (symbuf != nullptr)
     {
@@ -223,6 +223,8 @@ private:
 
 // Below this is the legacy code for the old symbol table, only used in
 // deprecated datastructures.
+struct t_symtabIndex;
+
 /*! \libinternal \brief
  * Legacy symbol table entry as linked list.
  */
@@ -234,6 +236,12 @@ struct t_symbuf
     char** buf;
     //! Next item in linked list.
     struct t_symbuf* next;
+    /*! \brief Hashed index of the strings in the whole list, only used in the first item.
+     *
+     * Built on demand by put_symtab(). It is owned by the list, so that shallow copies
+     * of a t_symtab keep sharing it together with the storage it refers to.
+     */
+    t_symtabIndex* index;
 };
 
 /* \libinternal \brief
@@ -49,6 +49,7 @@
 #include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/inmemoryserializer.h"
+#include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/strconvert.h"
 #include "gromacs/utility/stringutil.h"
 #include "gromacs/utility/textreader.h"
@@ -614,6 +615,48 @@ TEST_F(LegacySymtabTest, NoDuplicatesInLargeTable)
     dumpSymtab();
 }
 
+TEST_F(LegacySymtabTest, HandlesStayValidInVeryLargeTable)
+{
+    int                 numStringsToAdd = 10000;
+    std::vector<char**> symbolsAdded;
+    symbolsAdded.reserve(numStringsToAdd);
+    for (int i = 0; i < numStringsToAdd; ++i)
+    {
+        symbolsAdded.push_back(put_symtab(symtab(), toString(i).c_str()));
+    }
+    ASSERT_EQ(numStringsToAdd, symtab()->nr);
+    for (int i = 0; i < numStringsToAdd; ++i)
+    {
+        EXPECT_STREQ(toString(i).c_str(), *symbolsAdded[i]);
+        EXPECT_EQ(i, lookup_symtab(symtab(), symbolsAdded[i]));
+        EXPECT_EQ(symbolsAdded[i], get_symtab_handle(symtab(), i));
+        EXPECT_EQ(symbolsAdded[i], put_symtab(symtab(), toString(i).c_str()));
+    }
+    ASSERT_EQ(numStringsToAdd, symtab()->nr);
+}
+
+TEST_F(LegacySymtabTest, FindsExistingEntriesInDuplicatedTable)
+{
+    int numStringsToAdd = 7; // Larger than c_maxBufSize limit for size of symbuf.
+    for (int i = 0; i < numStringsToAdd; ++i)
+    {
+        put_symtab(symtab(), toString(i).c_str());
+    }
+    // The copy is filled without going through put_symtab(), so
+    // its entries have to be found when adding to it afterwards.
+    t_symtab* copySymtab = duplicateSymtab(symtab());
+    for (int i = 0; i < numStringsToAdd; ++i)
+    {
+        EXPECT_EQ(get_symtab_handle(copySymtab, i), put_symtab(copySymtab, toString(i).c_str()));
+    }
+    ASSERT_EQ(numStringsToAdd, copySymtab->nr);
+    auto bazSymbol = put_symtab(copySymtab, "baz");
+    ASSERT_EQ(numStringsToAdd + 1, copySymtab->nr);
+    compareSymtabLookupAndHandle(copySymtab, bazSymbol);
+    done_symtab(copySymtab);
+    sfree(copySymtab);
+}
+
 } // namespace
 
 } // namespace test
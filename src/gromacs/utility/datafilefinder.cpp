@@ -124,6 +124,21 @@ void DataFileFinder::setSearchPathFromEnv(const char* envVarName)
     }
 }
 
+std::vector<std::string> DataFileFinder::searchPath() const
+{
+    std::vector<std::string> path;
+    if (impl_ != nullptr)
+    {
+        path = impl_->searchPath_;
+    }
+    const std::string defaultPath = Impl::getDefaultPath();
+    if (!defaultPath.empty())
+    {
+        path.push_back(defaultPath);
+    }
+    return path;
+}
+
 FilePtr DataFileFinder::openFile(const DataFileOptions& options) const
 {
     // TODO: There is a small race here, since there is some time between
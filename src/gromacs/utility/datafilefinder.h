@@ -197,6 +197,16 @@ public:
      * directory is searched first.
      */
     void setSearchPathFromEnv(const char* envVarName);
+    /*! \brief
+     * Returns the directories searched for data files, in search order.
+     *
+     * \throws std::bad_alloc if out of memory.
+     *
+     * This includes the paths from setSearchPathFromEnv() and the default
+     * directory specified by the global program context, but not the
+     * current directory.
+     */
+    std::vector<std::string> searchPath() const;
 
     /*! \brief
      * Opens a data file (if found) in an RAII-style `FILE` handle.